@@ -0,0 +1,105 @@
+//  Implantation du module arena - la réserve est une liste de blocs obtenus par
+//    malloc, de taille doublant à chaque ajout jusqu'à ARENA__CHUNK_MAX octets.
+//    Les allocations se font dans le bloc de tête ; une demande plus grande
+//    que la taille courante d'un bloc reçoit son propre bloc, chainé derrière
+//    celui de tête.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define ARENA__CHUNK_MIN ((size_t) 1 << 16)
+#define ARENA__CHUNK_MAX ((size_t) 1 << 24)
+
+typedef struct chunk chunk;
+
+//  struct chunk : en-tête d'un bloc de la réserve, suivi des size octets
+//    utilisables du bloc.
+struct chunk {
+  chunk *next;
+  size_t size;
+  max_align_t data[];
+};
+
+//  struct arena, arena : le composant head pointe sur le bloc de tête, dans
+//    lequel les octets d'indices [used; head->size[ sont libres. Le
+//    composant chunksize mémorise la taille du prochain bloc à ajouter,
+//    footprint le nombre d'octets obtenus par malloc.
+struct arena {
+  chunk *head;
+  size_t used;
+  size_t chunksize;
+  size_t footprint;
+};
+
+arena *arena_empty(void) {
+  arena *a = malloc(sizeof *a);
+  if (a == NULL) {
+    return NULL;
+  }
+  a->head = NULL;
+  a->used = 0;
+  a->chunksize = ARENA__CHUNK_MIN;
+  a->footprint = 0;
+  return a;
+}
+
+//  arena__grow : ajoute à la réserve associée à a un bloc d'au moins size
+//    octets utilisables et renvoie l'adresse de son premier octet. Un bloc
+//    de plus de chunksize octets est dédié à la demande et chainé derrière le
+//    bloc de tête, dont les octets libres restent ainsi disponibles ; un bloc
+//    ordinaire devient le bloc de tête. Renvoie NULL en cas de dépassement de
+//    capacité.
+static void *arena__grow(arena *a, size_t size) {
+  bool dedicated = size > a->chunksize;
+  size_t n = dedicated ? size : a->chunksize;
+  if (n > SIZE_MAX - sizeof(chunk)) {
+    return NULL;
+  }
+  chunk *c = malloc(sizeof(chunk) + n);
+  if (c == NULL) {
+    return NULL;
+  }
+  c->size = n;
+  a->footprint += sizeof(chunk) + n;
+  if (dedicated && a->head != NULL) {
+    c->next = a->head->next;
+    a->head->next = c;
+    return c->data;
+  }
+  c->next = a->head;
+  a->head = c;
+  a->used = size;
+  if (!dedicated && a->chunksize < ARENA__CHUNK_MAX) {
+    a->chunksize *= 2;
+  }
+  return c->data;
+}
+
+void *arena_alloc(arena *a, size_t size, size_t align) {
+  size_t k = (a->used + align - 1) & ~(align - 1);
+  if (a->head == NULL || k > a->head->size || size > a->head->size - k) {
+    return arena__grow(a, size);
+  }
+  a->used = k + size;
+  return (char *) a->head->data + k;
+}
+
+size_t arena_footprint(const arena *a) {
+  return a->footprint;
+}
+
+void arena_dispose(arena **aptr) {
+  if (*aptr == NULL) {
+    return;
+  }
+  chunk *c = (*aptr)->head;
+  while (c != NULL) {
+    chunk *t = c;
+    c = c->next;
+    free(t);
+  }
+  free(*aptr);
+  *aptr = NULL;
+}
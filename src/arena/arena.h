@@ -0,0 +1,43 @@
+//  Interface du module arena - module implémentant une réserve de mémoire dans
+//    laquelle les allocations se font par simple incrémentation d'un pointeur
+//    et dont la libération n'a lieu qu'en bloc.
+
+#ifndef ARENA__H
+#define ARENA__H
+
+#include <stdlib.h>
+
+//  struct arena, arena : structure regroupant les informations permettant de
+//    gérer une réserve de mémoire. La création de la structure de données
+//    associée est confiée à la fonction arena_empty. Les zones allouées dans
+//    la réserve ne peuvent être libérées individuellement : elles le sont
+//    toutes à la fois par arena_dispose.
+typedef struct arena arena;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type arena * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    arena_empty et non révoqué depuis par arena_dispose. Cette règle ne
+//    souffre que d'une seule exception : arena_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  arena_empty : crée une structure de données correspondant initialement à
+//    une réserve vide. Renvoie NULL en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers l'objet qui gère la structure de données.
+extern arena *arena_empty(void);
+
+//  arena_alloc : alloue dans la réserve associée à a une zone de size octets
+//    dont l'adresse est un multiple de align, qui doit être une puissance de 2
+//    au plus égale à _Alignof(max_align_t). Renvoie NULL en cas de dépassement
+//    de capacité. Renvoie sinon l'adresse de la zone.
+extern void *arena_alloc(arena *a, size_t size, size_t align);
+
+//  arena_footprint : renvoie le nombre d'octets obtenus du système par la
+//    réserve associée à a.
+extern size_t arena_footprint(const arena *a);
+
+//  arena_dispose : si *aptr ne vaut pas NULL, libère l'ensemble des zones
+//    allouées dans la réserve associée à *aptr ainsi que les ressources
+//    allouées à la structure de données, puis affecte à *aptr la valeur NULL.
+extern void arena_dispose(arena **aptr);
+
+#endif
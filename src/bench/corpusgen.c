@@ -0,0 +1,234 @@
+//  corpusgen - générateur de corpus synthétiques pour les mesures de
+//    performance de ws. Les mots sont tirés selon une loi de Zipf, soit dans un
+//    vocabulaire commun à tous les fichiers, soit dans un vocabulaire propre à
+//    chacun, certains dépassant la longueur de troncature par défaut de ws.
+//    Affiche sur la sortie standard le nombre d'octets puis le nombre de mots
+//    produits, séparés par une tabulation.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define USAGE "Usage: %s [-n FILES] [-s SIZE] [-v VOCAB] [-z EXPONENT]"        \
+  " [-p SHARED] [-l LONG] [-r SEED] DIR\n"
+#define EARG "%s: Invalid argument for -%c: '%s'.\n"
+#define EFIL "%s: '%s': %s.\n"
+#define EMEM "%s: Not enough memory.\n"
+
+//  DEF_* : valeurs par défaut des paramètres du corpus.
+#define DEF_FILES 8
+#define DEF_SIZE (16 * 1024 * 1024)
+#define DEF_VOCAB 100000
+#define DEF_EXPONENT 1.0
+#define DEF_SHARED 0.9
+#define DEF_LONG 0.001
+#define DEF_SEED 1
+
+//  LONG_MIN_LEN, LONG_MAX_LEN : bornes de la longueur des mots longs, choisies
+//    au-delà de la longueur de troncature par défaut de ws.
+#define LONG_MIN_LEN 64
+#define LONG_MAX_LEN 255
+
+//  WORD_MIN_LEN, WORD_MAX_LEN : bornes de la longueur des autres mots.
+#define WORD_MIN_LEN 2
+#define WORD_MAX_LEN 12
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de la suite d'état
+//    *stateptr, selon l'algorithme splitmix64.
+static uint64_t rng_next(uint64_t *stateptr) {
+  uint64_t z = (*stateptr += 0x9E3779B97F4A7C15u);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+  return z ^ (z >> 31);
+}
+
+//  rng_unit : renvoie un réel pseudo-aléatoire de l'intervalle [0, 1[.
+static double rng_unit(uint64_t *stateptr) {
+  return (double) (rng_next(stateptr) >> 11) * 0x1.0p-53;
+}
+
+//  zipf_table : renvoie un tableau de n réels dont celui d'indice r est la
+//    probabilité cumulée des rangs 0 à r selon une loi de Zipf d'exposant s.
+//    Renvoie NULL en cas de dépassement de capacité.
+static double *zipf_table(size_t n, double s) {
+  double *cdf = malloc(n * sizeof *cdf);
+  if (cdf == NULL) {
+    return NULL;
+  }
+  double sum = 0.0;
+  for (size_t r = 0; r < n; ++r) {
+    sum += 1.0 / pow((double) (r + 1), s);
+    cdf[r] = sum;
+  }
+  for (size_t r = 0; r < n; ++r) {
+    cdf[r] /= sum;
+  }
+  return cdf;
+}
+
+//  zipf_draw : tire un rang dans la table cdf de n probabilités cumulées.
+static size_t zipf_draw(const double *cdf, size_t n, uint64_t *stateptr) {
+  double u = rng_unit(stateptr);
+  size_t lo = 0;
+  size_t hi = n - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cdf[mid] < u) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+//  spell : écrit dans buf le mot de rang r du vocabulaire de graine seed et
+//    renvoie sa longueur. Le mot ne dépend que de r et de seed.
+static size_t spell(char *buf, size_t r, uint64_t seed) {
+  uint64_t state = seed ^ ((uint64_t) r * 0xD1B54A32D192ED03u);
+  uint64_t h = rng_next(&state);
+  size_t len = WORD_MIN_LEN + h % (WORD_MAX_LEN - WORD_MIN_LEN + 1);
+  h = rng_next(&state);
+  for (size_t k = 0; k < len; ++k) {
+    if (k % 12 == 11) {
+      h = rng_next(&state);
+    }
+    buf[k] = (char) ('a' + h % 26);
+    h /= 26;
+  }
+  return len;
+}
+
+//  parse_size : convertit la chaine s, éventuellement suffixée par K, M ou G,
+//    en un nombre d'octets affecté à *nptr. Renvoie une valeur non nulle si s
+//    n'est pas valide. Renvoie sinon zéro.
+static int parse_size(const char *s, size_t *nptr) {
+  char *end;
+  errno = 0;
+  unsigned long long n = strtoull(s, &end, 10);
+  if (errno != 0 || end == s || *s == '-') {
+    return -1;
+  }
+  unsigned shift = *end == 'K' ? 10 : *end == 'M' ? 20 : *end == 'G' ? 30 : 0;
+  if ((shift != 0 && *++end != '\0') || *end != '\0'
+      || n > SIZE_MAX >> shift) {
+    return -1;
+  }
+  *nptr = (size_t) n << shift;
+  return 0;
+}
+
+//  parse_ratio : convertit la chaine s en un réel de l'intervalle [0, 1]
+//    affecté à *xptr. Renvoie une valeur non nulle si s n'est pas valide.
+//    Renvoie sinon zéro.
+static int parse_ratio(const char *s, double *xptr) {
+  char *end;
+  double x = strtod(s, &end);
+  if (end == s || *end != '\0' || !(x >= 0.0 && x <= 1.0)) {
+    return -1;
+  }
+  *xptr = x;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  size_t filecnt = DEF_FILES;
+  size_t size = DEF_SIZE;
+  size_t vocab = DEF_VOCAB;
+  double exponent = DEF_EXPONENT;
+  double shared = DEF_SHARED;
+  double longratio = DEF_LONG;
+  size_t seed = DEF_SEED;
+  int c;
+  while ((c = getopt(argc, argv, "n:s:v:z:p:l:r:")) != -1) {
+    int e = 0;
+    char *end;
+    switch (c) {
+      case 'n': e = parse_size(optarg, &filecnt) != 0 || filecnt == 0; break;
+      case 's': e = parse_size(optarg, &size); break;
+      case 'v': e = parse_size(optarg, &vocab) != 0 || vocab == 0; break;
+      case 'z':
+        exponent = strtod(optarg, &end);
+        e = end == optarg || *end != '\0' || !(exponent >= 0.0);
+        break;
+      case 'p': e = parse_ratio(optarg, &shared); break;
+      case 'l': e = parse_ratio(optarg, &longratio); break;
+      case 'r': e = parse_size(optarg, &seed); break;
+      default:
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (e != 0) {
+      fprintf(stderr, EARG, argv[0], c, optarg);
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char *dir = argv[optind];
+  double *cdf = zipf_table(vocab, exponent);
+  size_t pathsize = strlen(dir) + sizeof "/c.txt" + 3 * sizeof(size_t);
+  char *path = malloc(pathsize);
+  if (cdf == NULL || path == NULL) {
+    fprintf(stderr, EMEM, argv[0]);
+    free(cdf);
+    free(path);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  uint64_t state = seed;
+  size_t bytes = 0;
+  size_t words = 0;
+  char word[LONG_MAX_LEN];
+  for (size_t k = 0; r == EXIT_SUCCESS && k < filecnt; ++k) {
+    snprintf(path, pathsize, "%s/c%zu.txt", dir, k);
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+      fprintf(stderr, EFIL, argv[0], path, strerror(errno));
+      r = EXIT_FAILURE;
+      break;
+    }
+    //  Le vocabulaire commun a pour graine 0, celui du fichier k la graine
+    //    k + 1.
+    size_t n = 0;
+    while (n < size) {
+      size_t len;
+      if (rng_unit(&state) < longratio) {
+        len = LONG_MIN_LEN + rng_next(&state)
+            % (LONG_MAX_LEN - LONG_MIN_LEN + 1);
+        for (size_t j = 0; j < len; ++j) {
+          word[j] = (char) ('a' + rng_next(&state) % 26);
+        }
+      } else {
+        uint64_t vs = rng_unit(&state) < shared ? 0 : k + 1;
+        len = spell(word, zipf_draw(cdf, vocab, &state), vs);
+      }
+      //  Les mots sont séparés par une espace, une virgule suivie d'une
+      //    espace ou une fin de ligne.
+      uint64_t sep = rng_next(&state) % 16;
+      fwrite(word, 1, len, f);
+      fputs(sep == 0 ? "\n" : sep == 1 ? ", " : " ", f);
+      n += len + (sep == 1 ? 2 : 1);
+      ++words;
+    }
+    bytes += n;
+    if (fclose(f) != 0) {
+      fprintf(stderr, EFIL, argv[0], path, strerror(errno));
+      r = EXIT_FAILURE;
+    }
+  }
+  if (r == EXIT_SUCCESS) {
+    printf("%zu\t%zu\n", bytes, words);
+  }
+  free(cdf);
+  free(path);
+  return r;
+}
@@ -0,0 +1,385 @@
+//  microbench - mesures de performance des modules de ws pris isolément :
+//    lecture mot à mot, table de hachage, débit et latence de ses ajouts, tri
+//    des fourretouts et affichage des mots partagés. Chaque mesure est écrite
+//    sur la sortie standard sous la forme d'une ligne nom, paramètre, valeur
+//    et unité, séparés par des tabulations.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "arena.h"
+#include "hashtable.h"
+#include "holdall.h"
+#include "output.h"
+#include "reader.h"
+#include "shword.h"
+#include "strhash.h"
+
+#define EMEM "microbench: Not enough memory.\n"
+#define EFIL "microbench: Failed to create temporary file.\n"
+
+//  READ_SIZE : taille du texte lu par les mesures de lecture.
+#define READ_SIZE (16 * 1024 * 1024)
+
+//  READ_LEN : nombre de caractères significatifs des mots lus.
+#define READ_LEN 63
+
+//  TABLE_OPS : nombre minimal d'opérations de chaque mesure de la table de
+//    hachage, atteint en répétant la mesure pour les petites tailles.
+#define TABLE_OPS 2000000
+
+//  LATENCY_STEP : nombre de compartiments migrés à chaque opération par la
+//    table de hachage agrandie de manière incrémentale des mesures de latence.
+#define LATENCY_STEP 4
+
+//  SHW_INPUTCNT : nombre de fichiers des mots partagés créés par les mesures
+//    de tri et d'affichage.
+#define SHW_INPUTCNT 8
+
+//  MB : nombre d'octets d'un mégaoctet.
+#define MB (1024.0 * 1024.0)
+
+//  now : renvoie le temps écoulé depuis une origine fixe, en secondes.
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+//  report : écrit la mesure value de nom name et de paramètre param, exprimée
+//    dans l'unité unit.
+static void report(const char *name, size_t param, double value,
+    const char *unit) {
+  printf("%s\t%zu\t%.2f\t%s\n", name, param, value, unit);
+  fflush(stdout);
+}
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de la suite d'état
+//    *stateptr, selon l'algorithme splitmix64.
+static uint64_t rng_next(uint64_t *stateptr) {
+  uint64_t z = (*stateptr += 0x9E3779B97F4A7C15u);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+  return z ^ (z >> 31);
+}
+
+//  make_words : renvoie un tableau de n chaines distinctes allouées dans la
+//    réserve ar. Renvoie NULL en cas de dépassement de capacité.
+static char **make_words(arena *ar, size_t n, uint64_t *stateptr) {
+  char **words = malloc(n * sizeof *words);
+  if (words == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    //  Le rang k garantit que les chaines sont distinctes.
+    char tmp[2 * OUTPUT_ULONG_LEN + 2];
+    int len = snprintf(tmp, sizeof tmp, "%lx%c%zu",
+        (unsigned long) (rng_next(stateptr) & 0xFFFFFF),
+        'g' + (int) (k % 20), k);
+    words[k] = arena_alloc(ar, (size_t) len + 1, 1);
+    if (words[k] == NULL) {
+      free(words);
+      return NULL;
+    }
+    memcpy(words[k], tmp, (size_t) len + 1);
+  }
+  return words;
+}
+
+//  make_text : renvoie un fichier temporaire contenant au moins size octets
+//    de mots de la liste words de longueur n séparés par des espaces et des
+//    fins de ligne, positionné à son début. Renvoie NULL en cas d'échec.
+static FILE *make_text(char **words, size_t n, size_t size,
+    uint64_t *stateptr) {
+  FILE *f = tmpfile();
+  if (f == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < size; ) {
+    const char *w = words[rng_next(stateptr) % n];
+    fputs(w, f);
+    fputc(k % 64 == 0 ? '\n' : ' ', f);
+    k += strlen(w) + 1;
+  }
+  if (ferror(f) || fseek(f, 0, SEEK_SET) != 0) {
+    fclose(f);
+    return NULL;
+  }
+  return f;
+}
+
+//  bench_reader : mesure le débit de reader_read puis de reader_next sur le
+//    contenu du flot f, de size octets.
+static int bench_reader(FILE *f, size_t size) {
+  char buf[READ_LEN + 1];
+  size_t words = 0;
+  double t = now();
+  while (reader_read(f, buf, READ_LEN, false, false) > 0) {
+    ++words;
+  }
+  t = now() - t;
+  report("reader_read", size, (double) size / MB / t, "MB/s");
+  report("reader_read", size, (double) words / t, "words/s");
+  if (fseek(f, 0, SEEK_SET) != 0) {
+    return -1;
+  }
+  reader *r = reader_open(f, 0);
+  if (r == NULL) {
+    return -1;
+  }
+  words = 0;
+  size_t wlen;
+  size_t h;
+  t = now();
+  while (reader_next(r, buf, READ_LEN, &wlen, &h) > 0) {
+    ++words;
+  }
+  t = now() - t;
+  reader_dispose(&r);
+  report("reader_next", size, (double) size / MB / t, "MB/s");
+  report("reader_next", size, (double) words / t, "words/s");
+  return 0;
+}
+
+//  bench_hashtable : mesure le débit de hashtable_add, puis de
+//    hashtable_search pour des clés présentes et absentes, sur une table de n
+//    clés prises dans la liste words, de longueur 2 * n.
+static int bench_hashtable(char **words, size_t n) {
+  size_t rounds = TABLE_OPS / n > 0 ? TABLE_OPS / n : 1;
+  double tadd = 0.0;
+  double thit = 0.0;
+  double tmiss = 0.0;
+  size_t found = 0;
+  for (size_t k = 0; k < rounds; ++k) {
+    hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+        (size_t (*)(const void *))strhash);
+    if (ht == NULL) {
+      return -1;
+    }
+    double t = now();
+    for (size_t j = 0; j < n; ++j) {
+      if (hashtable_add(ht, words[j], words[j]) == NULL) {
+        hashtable_dispose(&ht);
+        return -1;
+      }
+    }
+    tadd += now() - t;
+    t = now();
+    for (size_t j = 0; j < n; ++j) {
+      found += hashtable_search(ht, words[j]) != NULL;
+    }
+    thit += now() - t;
+    t = now();
+    for (size_t j = n; j < 2 * n; ++j) {
+      found += hashtable_search(ht, words[j]) != NULL;
+    }
+    tmiss += now() - t;
+    hashtable_dispose(&ht);
+  }
+  if (found != n * rounds) {
+    return -1;
+  }
+  double ops = (double) (n * rounds) / 1e6;
+  report("hashtable_add", n, ops / tadd, "Mops/s");
+  report("hashtable_search_hit", n, ops / thit, "Mops/s");
+  report("hashtable_search_miss", n, ops / tmiss, "Mops/s");
+  return 0;
+}
+
+//  compar_double : fonction de comparaison de deux durées, pour qsort.
+static int compar_double(const void *a, const void *b) {
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+//  bench_hashtable_latency : mesure les quantiles à 99 % et 99,9 % et le
+//    maximum des durées des appels à hashtable_add pour n clés prises dans la
+//    liste words, la table étant agrandie en une fois si step est nul, de
+//    manière incrémentale par step compartiments sinon. Aucune mesure n'est
+//    faite si l'implantation ne prend pas en charge ce dernier mode.
+static int bench_hashtable_latency(char **words, size_t n, size_t step) {
+  static const char *names[][3] = {
+    { "hashtable_add_p99", "hashtable_add_p999", "hashtable_add_max", },
+    { "hashtable_add_p99_incr", "hashtable_add_p999_incr",
+      "hashtable_add_max_incr", },
+  };
+  if (hashtable_setup_incremental(step) != 0) {
+    return 0;
+  }
+  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))strhash);
+  hashtable_setup_incremental(0);
+  double *lat = malloc(n * sizeof *lat);
+  int e = -1;
+  if (ht == NULL || lat == NULL) {
+    goto dispose;
+  }
+  for (size_t j = 0; j < n; ++j) {
+    double t = now();
+    if (hashtable_add(ht, words[j], words[j]) == NULL) {
+      goto dispose;
+    }
+    lat[j] = now() - t;
+  }
+  qsort(lat, n, sizeof *lat, compar_double);
+  const char * const *name = names[step > 0];
+  report(name[0], n, lat[n - n / 100 - 1] * 1e9, "ns");
+  report(name[1], n, lat[n - n / 1000 - 1] * 1e9, "ns");
+  report(name[2], n, lat[n - 1] * 1e9, "ns");
+  e = 0;
+  dispose:
+  free(lat);
+  hashtable_dispose(&ht);
+  return e;
+}
+
+//  make_shwords : renvoie un fourretout de n mots partagés créés dans la
+//    réserve ar à partir de la liste words, de nombres d'occurrences et de
+//    fichiers aléatoires. Renvoie NULL en cas de dépassement de capacité.
+static holdall *make_shwords(arena *ar, char **words, size_t n,
+    uint64_t *stateptr) {
+  holdall *ha = holdall_empty();
+  if (ha == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    shword *shw = shword_create(ar, words[k], strlen(words[k]));
+    if (shw == NULL || holdall_put(ha, shw) != 0) {
+      holdall_dispose(&ha);
+      return NULL;
+    }
+    uint64_t r = rng_next(stateptr);
+    size_t files = 1 + r % SHW_INPUTCNT;
+    for (size_t j = 0; j < files; ++j) {
+      shword_add(shw, j, 1 + (r >> 8) % 1000);
+    }
+  }
+  return ha;
+}
+
+//  bench_holdall_sort : mesure la durée du tri par holdall_sort, selon
+//    shword_compare, de n mots partagés créés à partir de la liste words.
+static int bench_holdall_sort(char **words, size_t n, uint64_t *stateptr) {
+  arena *ar = arena_empty();
+  holdall *ha = ar == NULL ? NULL : make_shwords(ar, words, n, stateptr);
+  if (ha == NULL) {
+    arena_dispose(&ar);
+    return -1;
+  }
+  double t = now();
+  int e = holdall_sort(ha,
+      (int (*)(const void *, const void *))shword_compare);
+  t = now() - t;
+  holdall_dispose(&ha);
+  arena_dispose(&ar);
+  if (e != 0) {
+    return -1;
+  }
+  report("holdall_sort", n, (double) n / 1e6 / t, "Mitems/s");
+  return 0;
+}
+
+//  bench_shword_display : mesure le débit de shword_display pour n mots
+//    partagés créés à partir de la liste words, écrits sur le flot f.
+static int bench_shword_display(FILE *f, char **words, size_t n,
+    uint64_t *stateptr) {
+  arena *ar = arena_empty();
+  holdall *ha = ar == NULL ? NULL : make_shwords(ar, words, n, stateptr);
+  output *out = output_open(f);
+  int e = -1;
+  if (ha == NULL || out == NULL) {
+    goto dispose;
+  }
+  struct print_race pr = {
+    .inputcnt = SHW_INPUTCNT,
+    .last = NULL,
+    .remaining = n,
+    .samenumbers = false,
+    .out = out,
+  };
+  double t = now();
+  for (size_t k = 0; k < n; ++k) {
+    if (shword_display(holdall_at(ha, k), &pr) != 0) {
+      goto dispose;
+    }
+  }
+  if (output_flush(out) != 0) {
+    goto dispose;
+  }
+  t = now() - t;
+  report("shword_display", n, (double) n / 1e6 / t, "Mwords/s");
+  e = 0;
+  dispose:
+  output_dispose(&out);
+  holdall_dispose(&ha);
+  arena_dispose(&ar);
+  return e;
+}
+
+int main(void) {
+  reader_setup();
+  strhash_setup();
+  if (shword_setup(SHW_INPUTCNT) != 0) {
+    fprintf(stderr, EMEM);
+    return EXIT_FAILURE;
+  }
+  static const size_t sizes[] = {
+    1000, 10000, 100000, 1000000,
+  };
+  size_t maxn = sizes[sizeof sizes / sizeof *sizes - 1];
+  uint64_t state = 1;
+  int r = EXIT_FAILURE;
+  FILE *text = NULL;
+  FILE *null = NULL;
+  arena *ar = arena_empty();
+  char **words = ar == NULL ? NULL : make_words(ar, 2 * maxn, &state);
+  if (words == NULL) {
+    fprintf(stderr, EMEM);
+    goto dispose;
+  }
+  text = make_text(words, 10000, READ_SIZE, &state);
+  null = fopen("/dev/null", "w");
+  if (text == NULL || null == NULL) {
+    fprintf(stderr, EFIL);
+    goto dispose;
+  }
+  if (bench_reader(text, READ_SIZE) != 0) {
+    goto error_capacity;
+  }
+  for (size_t k = 0; k < sizeof sizes / sizeof *sizes; ++k) {
+    if (bench_hashtable(words, sizes[k]) != 0) {
+      goto error_capacity;
+    }
+  }
+  if (bench_hashtable_latency(words, maxn, 0) != 0
+      || bench_hashtable_latency(words, maxn, LATENCY_STEP) != 0) {
+    goto error_capacity;
+  }
+  for (size_t k = 1; k < sizeof sizes / sizeof *sizes; ++k) {
+    if (bench_holdall_sort(words, sizes[k], &state) != 0) {
+      goto error_capacity;
+    }
+  }
+  if (bench_shword_display(null, words, maxn, &state) != 0) {
+    goto error_capacity;
+  }
+  r = EXIT_SUCCESS;
+  goto dispose;
+  error_capacity:
+  fprintf(stderr, EMEM);
+  dispose:
+  if (text != NULL) {
+    fclose(text);
+  }
+  if (null != NULL) {
+    fclose(null);
+  }
+  free(words);
+  arena_dispose(&ar);
+  return r;
+}
@@ -0,0 +1,58 @@
+#!/bin/sh
+# wsbench.sh : mesure le temps d'exécution de ws sur un corpus produit par
+#   corpusgen, pour chaque moteur de comptage et chaque nombre de fils
+#   d'exécution. Chaque mesure est écrite sur la sortie standard sous la forme
+#   d'une ligne nom, paramètre, valeur et unité, séparés par des tabulations,
+#   comme celles de microbench. Le meilleur de RUNS essais est retenu.
+#
+# Usage : wsbench.sh WS CORPUSGEN "CORPUSGEN OPTIONS" [JOBS...]
+
+set -e
+
+if [ $# -lt 3 ]; then
+  echo "Usage: $0 WS CORPUSGEN \"CORPUSGEN OPTIONS\" [JOBS...]" >&2
+  exit 1
+fi
+ws=$1
+corpusgen=$2
+corpus=$3
+shift 3
+jobs=${*:-1}
+runs=${RUNS:-3}
+engines=${ENGINES:-hash merge shard shared}
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+# shellcheck disable=SC2086
+set -- $("$corpusgen" $corpus "$dir")
+bytes=$1
+words=$2
+report() {
+  printf '%s\t%s\t%s\t%s\n' "$1" "$2" "$3" "$4"
+}
+report corpus files "$(ls "$dir" | wc -l)" files
+report corpus bytes "$bytes" B
+report corpus words "$words" words
+
+for engine in $engines; do
+  for j in $jobs; do
+    best=
+    k=0
+    while [ "$k" -lt "$runs" ]; do
+      start=$(date +%s%N)
+      "$ws" --engine="$engine" -j "$j" "$dir"/*.txt > /dev/null 2>&1
+      t=$(( $(date +%s%N) - start ))
+      if [ -z "$best" ] || [ "$t" -lt "$best" ]; then
+        best=$t
+      fi
+      k=$((k + 1))
+    done
+    awk -v e="ws-$engine" -v j="$j" -v t="$best" -v b="$bytes" -v w="$words" \
+      'BEGIN {
+        s = t / 1e9
+        printf "%s\tj%s\t%.3f\ts\n", e, j, s
+        printf "%s\tj%s\t%.2f\tMB/s\n", e, j, b / 1048576 / s
+        printf "%s\tj%s\t%.0f\twords/s\n", e, j, w / s
+      }'
+  done
+done
@@ -0,0 +1,374 @@
+//  Implantation du module cache - une entrée de cache est formée d'un en-tête,
+//    du chemin absolu de la source, de la suite des mots distincts précédés de
+//    leur nombre d'occurrences puis de la suite des mots tronqués. Les entiers
+//    sont enregistrés sur 64 bits dans l'ordre des octets de la machine, sans
+//    alignement. Une entrée existante est relue par projection en mémoire et
+//    entièrement vérifiée par cache_open avant toute utilisation.
+
+#define _XOPEN_SOURCE 700
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cache.h"
+
+//  CACHE__MAGIC, CACHE__VERSION : respectivement la signature qui débute toute
+//    entrée de cache et la version de son format.
+#define CACHE__MAGIC "WSCACHE"
+#define CACHE__VERSION 1
+
+//  CACHE__BYTEORDER : valeur enregistrée dans l'en-tête permettant de vérifier
+//    que l'ordre des octets est celui de l'exécutable.
+#define CACHE__BYTEORDER 0x01020304
+
+//  CACHE__SUFFIX : suffixe du nom d'une entrée de cache.
+#define CACHE__SUFFIX ".wsc"
+
+//  struct cache__key : identité d'une source de fichier et options de lecture
+//    pour lesquelles une entrée de cache est valide.
+struct cache__key {
+  uint64_t size;
+  uint64_t mtime;
+  uint64_t mtimensec;
+  uint64_t ino;
+  uint64_t dev;
+  uint64_t charcnt;
+  uint64_t mode;
+};
+
+//  struct cache__header : en-tête d'une entrée de cache. Le composant total est
+//    la taille de l'entrée, pathlen la longueur du chemin absolu qui la suit.
+struct cache__header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteorder;
+  struct cache__key key;
+  uint64_t pathlen;
+  uint64_t wordcnt;
+  uint64_t trunccnt;
+  uint64_t total;
+};
+
+//  struct cache, cache : le composant name est le nom de l'entrée de cache,
+//    path le chemin absolu de la source et key son identité. Si une entrée
+//    valide a été trouvée, data pointe sur sa projection, de size octets, next
+//    sur le prochain mot à lire et nexttrunc sur le prochain mot tronqué à
+//    lire, wordsleft et truncsleft étant leurs nombres restants. Sinon, data
+//    vaut NULL et les mots tronqués à enregistrer sont mémorisés à la suite
+//    les uns des autres, avec leur caractère nul, dans le tableau de
+//    trunclen octets sur trunccap alloués pointé par truncs ; trunccnt est
+//    leur nombre.
+struct cache {
+  char *name;
+  char *path;
+  struct cache__key key;
+  unsigned char *data;
+  size_t size;
+  const unsigned char *next;
+  size_t wordsleft;
+  const unsigned char *nexttrunc;
+  size_t truncsleft;
+  char *truncs;
+  size_t trunclen;
+  size_t trunccap;
+  size_t trunccnt;
+};
+
+//  cache__fnv : renvoie la somme FNV-1a sur 64 bits des n octets pointés par p
+//    à partir de la valeur h. Contrairement à strhash, cette somme ne dépend
+//    pas de l'exécution : elle sert à nommer les entrées de cache.
+static uint64_t cache__fnv(uint64_t h, const void *p, size_t n) {
+  const unsigned char *s = p;
+  for (size_t k = 0; k < n; ++k) {
+    h = (h ^ s[k]) * 0x100000001b3;
+  }
+  return h;
+}
+
+#define CACHE__FNV_INIT 0xcbf29ce484222325
+
+//  cache__check : vérifie que l'entrée de cache projetée associée à c est
+//    valide pour la source associée à c, puis prépare sa lecture. Renvoie une
+//    valeur non nulle si elle ne l'est pas. Renvoie sinon zéro.
+static int cache__check(cache *c) {
+  if (c->size < sizeof(struct cache__header)) {
+    return -1;
+  }
+  struct cache__header hd;
+  memcpy(&hd, c->data, sizeof hd);
+  size_t pathlen = strlen(c->path);
+  if (memcmp(hd.magic, CACHE__MAGIC, sizeof hd.magic) != 0
+      || hd.version != CACHE__VERSION
+      || hd.byteorder != CACHE__BYTEORDER
+      || memcmp(&hd.key, &c->key, sizeof hd.key) != 0
+      || hd.total != c->size
+      || hd.pathlen != pathlen
+      || c->size - sizeof hd <= pathlen
+      || memcmp(c->data + sizeof hd, c->path, pathlen + 1) != 0) {
+    return -1;
+  }
+  const unsigned char *p = c->data + sizeof hd + pathlen + 1;
+  const unsigned char *end = c->data + c->size;
+  for (uint64_t k = 0; k < hd.wordcnt; ++k) {
+    if ((size_t) (end - p) <= sizeof(uint64_t)) {
+      return -1;
+    }
+    p += sizeof(uint64_t);
+    const unsigned char *q = memchr(p, '\0', (size_t) (end - p));
+    if (q == NULL) {
+      return -1;
+    }
+    p = q + 1;
+  }
+  const unsigned char *t = p;
+  for (uint64_t k = 0; k < hd.trunccnt; ++k) {
+    const unsigned char *q = p < end ? memchr(p, '\0', (size_t) (end - p))
+        : NULL;
+    if (q == NULL) {
+      return -1;
+    }
+    p = q + 1;
+  }
+  if (p != end) {
+    return -1;
+  }
+  c->next = c->data + sizeof hd + pathlen + 1;
+  c->wordsleft = (size_t) hd.wordcnt;
+  c->nexttrunc = t;
+  c->truncsleft = (size_t) hd.trunccnt;
+  return 0;
+}
+
+int cache_open(cache **cptr, const char *dir, const char *path, int fd,
+    size_t charcnt, int mode) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return errno;
+  }
+  cache *c = malloc(sizeof *c);
+  if (c == NULL) {
+    return ENOMEM;
+  }
+  memset(c, 0, sizeof *c);
+  c->key = (struct cache__key) {
+    .size = (uint64_t) st.st_size,
+    .mtime = (uint64_t) st.st_mtim.tv_sec,
+    .mtimensec = (uint64_t) st.st_mtim.tv_nsec,
+    .ino = (uint64_t) st.st_ino,
+    .dev = (uint64_t) st.st_dev,
+    .charcnt = charcnt,
+    .mode = (uint64_t) mode,
+  };
+  c->path = realpath(path, NULL);
+  if (c->path == NULL) {
+    int e = errno;
+    free(c);
+    return e;
+  }
+  uint64_t h = cache__fnv(CACHE__FNV_INIT, c->path, strlen(c->path) + 1);
+  h = cache__fnv(h, &c->key.charcnt, sizeof c->key.charcnt);
+  h = cache__fnv(h, &c->key.mode, sizeof c->key.mode);
+  size_t n = strlen(dir) + 1 + 16 + sizeof CACHE__SUFFIX;
+  c->name = malloc(n);
+  if (c->name == NULL) {
+    cache_dispose(&c);
+    return ENOMEM;
+  }
+  snprintf(c->name, n, "%s/%016llx" CACHE__SUFFIX, dir, (unsigned long long) h);
+  int efd = open(c->name, O_RDONLY);
+  if (efd == -1) {
+    *cptr = c;
+    return 0;
+  }
+  struct stat est;
+  if (fstat(efd, &est) == 0 && S_ISREG(est.st_mode)
+      && (uintmax_t) est.st_size <= SIZE_MAX && est.st_size > 0) {
+    c->size = (size_t) est.st_size;
+    void *data = mmap(NULL, c->size, PROT_READ, MAP_PRIVATE, efd, 0);
+    if (data != MAP_FAILED) {
+      c->data = data;
+      if (cache__check(c) != 0) {
+        munmap(c->data, c->size);
+        c->data = NULL;
+      }
+    }
+  }
+  close(efd);
+  *cptr = c;
+  return 0;
+}
+
+bool cache_hit(const cache *c) {
+  return c->data != NULL;
+}
+
+bool cache_next_word(cache *c, const char **wptr, size_t *lenptr,
+    SHW_OCCURRENCES_TYPE *occptr) {
+  if (c->data == NULL || c->wordsleft == 0) {
+    return false;
+  }
+  uint64_t occ;
+  memcpy(&occ, c->next, sizeof occ);
+  *occptr = occ > SHW_OCCURRENCES_MAX ? SHW_OCCURRENCES_MAX
+      : (SHW_OCCURRENCES_TYPE) occ;
+  *wptr = (const char *) c->next + sizeof occ;
+  *lenptr = strlen(*wptr);
+  c->next += sizeof occ + *lenptr + 1;
+  c->wordsleft -= 1;
+  return true;
+}
+
+bool cache_next_trunc(cache *c, const char **wptr) {
+  if (c->data == NULL || c->truncsleft == 0) {
+    return false;
+  }
+  *wptr = (const char *) c->nexttrunc;
+  c->nexttrunc += strlen(*wptr) + 1;
+  c->truncsleft -= 1;
+  return true;
+}
+
+int cache_trunc(cache *c, const char *w) {
+  size_t n = strlen(w) + 1;
+  if (c->trunclen + n > c->trunccap) {
+    size_t m = c->trunccap == 0 ? 256 : c->trunccap;
+    while (m < c->trunclen + n) {
+      if (m > SIZE_MAX / 2) {
+        return -1;
+      }
+      m *= 2;
+    }
+    char *a = realloc(c->truncs, m);
+    if (a == NULL) {
+      return -1;
+    }
+    c->truncs = a;
+    c->trunccap = m;
+  }
+  memcpy(c->truncs + c->trunclen, w, n);
+  c->trunclen += n;
+  c->trunccnt += 1;
+  return 0;
+}
+
+//  struct cache__writer : flot d'écriture d'une entrée de cache et nombre de
+//    mots déjà écrits.
+struct cache__writer {
+  FILE *f;
+  uint64_t wordcnt;
+};
+
+//  cache__record : écrit sur le flot de w le nombre d'occurrences et la chaine
+//    du mot partagé associé à shw. Renvoie NULL en cas d'erreur d'écriture.
+//    Renvoie sinon w.
+static struct cache__writer *cache__record(struct cache__writer *w,
+    const shword *shw) {
+  uint64_t occ = shword_occurrences(shw);
+  const char *s = shword_word(shw);
+  if (fwrite(&occ, sizeof occ, 1, w->f) != 1
+      || fwrite(s, 1, strlen(s) + 1, w->f) != strlen(s) + 1) {
+    return NULL;
+  }
+  w->wordcnt += 1;
+  return w;
+}
+
+//  cache__status : renvoie une valeur non nulle si w vaut NULL. Renvoie sinon
+//    zéro.
+static int cache__status(const shword *shw, const struct cache__writer *w) {
+  (void) shw;
+  return w == NULL ? -1 : 0;
+}
+
+//  CACHE__TMPSUFFIX : suffixe, modèle de mkstemp, du nom temporaire d'une
+//    entrée de cache en cours d'écriture.
+#define CACHE__TMPSUFFIX ".XXXXXX"
+
+int cache_store(cache *c, holdall *ha) {
+  char *tmp = malloc(strlen(c->name) + sizeof CACHE__TMPSUFFIX);
+  if (tmp == NULL) {
+    return ENOMEM;
+  }
+  strcpy(tmp, c->name);
+  strcat(tmp, CACHE__TMPSUFFIX);
+  int e = 0;
+  int fd = mkstemp(tmp);
+  if (fd == -1) {
+    e = errno;
+    free(tmp);
+    return e;
+  }
+  struct cache__writer w = {
+    .f = fdopen(fd, "wb"),
+    .wordcnt = 0,
+  };
+  if (w.f == NULL) {
+    e = errno;
+    close(fd);
+    goto error;
+  }
+  errno = 0;
+  struct cache__header hd;
+  memset(&hd, 0, sizeof hd);
+  size_t pathlen = strlen(c->path);
+  if (fwrite(&hd, sizeof hd, 1, w.f) != 1
+      || fwrite(c->path, 1, pathlen + 1, w.f) != pathlen + 1
+      || holdall_apply_context(ha, &w,
+          (void *(*)(void *, void *))cache__record,
+          (int (*)(void *, void *))cache__status) != 0) {
+    goto error_write;
+  }
+  //  Sans mot tronqué, c->truncs vaut NULL, adresse que fwrite n'accepte pas.
+  if (c->trunclen > 0
+      && fwrite(c->truncs, 1, c->trunclen, w.f) != c->trunclen) {
+    goto error_write;
+  }
+  long total = ftell(w.f);
+  memcpy(hd.magic, CACHE__MAGIC, sizeof hd.magic);
+  hd.version = CACHE__VERSION;
+  hd.byteorder = CACHE__BYTEORDER;
+  hd.key = c->key;
+  hd.pathlen = pathlen;
+  hd.wordcnt = w.wordcnt;
+  hd.trunccnt = c->trunccnt;
+  hd.total = (uint64_t) total;
+  if (total < 0 || fseek(w.f, 0, SEEK_SET) != 0
+      || fwrite(&hd, sizeof hd, 1, w.f) != 1) {
+    goto error_write;
+  }
+  FILE *f = w.f;
+  w.f = NULL;
+  if (fclose(f) != 0 || rename(tmp, c->name) != 0) {
+    goto error_write;
+  }
+  free(tmp);
+  return 0;
+  error_write:
+  e = errno != 0 ? errno : EIO;
+  if (w.f != NULL) {
+    fclose(w.f);
+  }
+  error:
+  remove(tmp);
+  free(tmp);
+  return e;
+}
+
+void cache_dispose(cache **cptr) {
+  if (*cptr == NULL) {
+    return;
+  }
+  if ((*cptr)->data != NULL) {
+    munmap((*cptr)->data, (*cptr)->size);
+  }
+  free((*cptr)->name);
+  free((*cptr)->path);
+  free((*cptr)->truncs);
+  free(*cptr);
+  *cptr = NULL;
+}
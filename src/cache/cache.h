@@ -0,0 +1,79 @@
+//  Interface du module cache - module implémentant un cache disque des
+//    vocabulaires des sources de fichiers : pour chaque source, la liste de ses
+//    mots distincts et de leurs nombres d'occurrences.
+
+#ifndef CACHE__H
+#define CACHE__H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "holdall.h"
+#include "shword.h"
+
+//  Une entrée de cache est un fichier du répertoire de cache dont le nom
+//    dépend du chemin absolu de la source et des options de lecture, ce qui
+//    assure qu'une source modifiée remplace son ancienne entrée. L'entrée
+//    mémorise de plus la taille, la date de modification, le numéro d'inode et
+//    le périphérique de la source : elle n'est utilisée que si tous coïncident
+//    avec ceux de la source au moment de sa lecture. Les entrées sont écrites
+//    sous un nom temporaire unique puis renommées, si bien que plusieurs
+//    processus ou fils d'exécution peuvent partager un même répertoire.
+
+//  struct cache, cache : structure regroupant les informations relatives à
+//    l'entrée de cache d'une source de fichier. La création de la structure de
+//    données associée est confiée à la fonction cache_open.
+typedef struct cache cache;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type cache * n'est pas l'adresse d'un objet préalablement obtenu par
+//    cache_open et non révoqué depuis par cache_dispose. Cette règle ne souffre
+//    que d'une seule exception : cache_dispose tolère que la déréférence de son
+//    argument ait pour valeur NULL.
+
+//  cache_open : recherche dans le répertoire de nom dir l'entrée de cache de
+//    la source de nom path, ouverte sur le descripteur fd, pour une lecture
+//    avec charcnt caractères significatifs et les drapeaux mode au sens de
+//    reader_open. L'identité de la source est obtenue à partir de fd. Renvoie
+//    ENOMEM en cas de dépassement de capacité, un autre code d'erreur au sens
+//    de errno si l'identité de la source n'a pu être obtenue. Renvoie sinon
+//    zéro après avoir affecté à *cptr un pointeur vers l'objet qui gère la
+//    structure de données, que l'entrée existe ou non.
+extern int cache_open(cache **cptr, const char *dir, const char *path, int fd,
+    size_t charcnt, int mode);
+
+//  cache_hit : renvoie true si une entrée valide pour la source associée à c
+//    a été trouvée. Renvoie sinon false.
+extern bool cache_hit(const cache *c);
+
+//  cache_next_word : si une entrée valide a été trouvée pour la source
+//    associée à c et qu'il lui reste des mots à lire, affecte à *wptr
+//    l'adresse de la chaine du prochain mot, à *lenptr sa longueur et à
+//    *occptr son nombre d'occurrences dans la source, puis renvoie true.
+//    Renvoie sinon false. La chaine reste valide jusqu'à la révocation de c.
+extern bool cache_next_word(cache *c, const char **wptr, size_t *lenptr,
+    SHW_OCCURRENCES_TYPE *occptr);
+
+//  cache_next_trunc : si une entrée valide a été trouvée pour la source
+//    associée à c et qu'il lui reste des mots tronqués à lire, affecte à *wptr
+//    l'adresse de la chaine du prochain d'entre eux, dans l'ordre de lecture
+//    de la source, puis renvoie true. Renvoie sinon false.
+extern bool cache_next_trunc(cache *c, const char **wptr);
+
+//  cache_trunc : mémorise, en vue de son enregistrement par cache_store, que
+//    le mot de chaine w a été tronqué lors de la lecture de la source associée
+//    à c. Renvoie une valeur non nulle en cas de dépassement de capacité.
+//    Renvoie sinon zéro.
+extern int cache_trunc(cache *c, const char *w);
+
+//  cache_store : enregistre comme entrée de cache de la source associée à c
+//    les mots partagés du fourretout associé à ha, qui doivent provenir de
+//    cette seule source, ainsi que les mots tronqués mémorisés. Renvoie zéro
+//    en cas de succès. Renvoie sinon le code d'erreur au sens de errno.
+extern int cache_store(cache *c, holdall *ha);
+
+//  cache_dispose : si *cptr ne vaut pas NULL, libère les ressources allouées à
+//    la structure de données associée à *cptr puis affecte à *cptr la valeur
+//    NULL.
+extern void cache_dispose(cache **cptr);
+
+#endif
@@ -0,0 +1,414 @@
+//  Implantation du module chashtable - adressage ouvert et sondage linéaire
+//    sur un tableau de compartiments dont chacun mémorise l'adresse d'une
+//    valeur et la valeur de la fonction de pré-hachage pour sa clé. Un
+//    compartiment libre, d'adresse NULL, n'est occupé que par une comparaison
+//    suivie d'un échange atomique : parmi plusieurs fils d'exécution qui
+//    tentent d'y placer une valeur, un seul y parvient et les autres lisent la
+//    valeur placée.
+
+//  Lorsque le taux de remplissage d'un tableau dépasse le seuil, un tableau
+//    deux fois plus long lui est adjoint comme successeur. Dès lors, tout fil
+//    d'exécution qui accède à la table participe au transfert : il réserve une
+//    tranche de compartiments de l'ancien tableau et déplace leurs valeurs dans
+//    le nouveau, en marquant chaque compartiment transféré de l'adresse
+//    réservée CHT__MOVED, ou CHT__SEALED s'il était libre. Les marques sont
+//    posées par échange atomique, si bien qu'aucun ajout ne peut plus avoir
+//    lieu dans un compartiment marqué.
+//  Un fil d'exécution n'attend pas la fin du transfert : il transfère
+//    lui-même les compartiments de la séquence de sondage de sa clé dans
+//    l'ancien tableau, jusqu'au premier qui était libre, puis poursuit dans le
+//    nouveau. La clé, si elle figurait dans l'ancien tableau, est alors dans le
+//    nouveau, et aucun ajout de cette clé ne peut plus avoir lieu dans
+//    l'ancien, dont le sondage rencontre une marque avant tout compartiment
+//    libre : l'unicité des clés est ainsi garantie. Un même compartiment
+//    pouvant être transféré simultanément par plusieurs fils d'exécution, le
+//    placement d'une valeur est idempotent : il s'arrête sur le premier
+//    compartiment libre ou qui contient déjà cette même valeur, et se poursuit
+//    dans le successeur si une marque est rencontrée auparavant.
+
+//  Les anciens tableaux ne sont libérés qu'à la révocation de la table : un
+//    fil d'exécution peut encore les lire après le transfert.
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "chashtable.h"
+
+//  Le nombre de compartiments du premier tableau vaut 2^CHT__LBNSLOTS_MIN. Dès
+//    que le taux de remplissage d'un tableau est strictement supérieur à
+//    (double) CHT__LDFACT_MAX_NUMER / (double) CHT__LDFACT_MAX_DENOM, son
+//    successeur est créé. Les transferts se font par tranches de CHT__CHUNK
+//    compartiments.
+
+#define CHT__LBNSLOTS_MIN     10
+#define CHT__LDFACT_MAX_NUMER 1
+#define CHT__LDFACT_MAX_DENOM 2
+#define CHT__CHUNK            1024
+
+#define POW2(p)       ((size_t) 1 << (p))
+
+//  cht__moved, cht__sealed, CHT__MOVED, CHT__SEALED : marques d'un
+//    compartiment transféré, respectivement occupé et libre lors de son
+//    transfert. CHT__MARKED : teste si v est l'une de ces marques.
+static char cht__moved;
+static char cht__sealed;
+#define CHT__MOVED ((void *) &cht__moved)
+#define CHT__SEALED ((void *) &cht__sealed)
+#define CHT__MARKED(v) ((v) == CHT__MOVED || (v) == CHT__SEALED)
+
+//  struct cht__slot : compartiment. Le composant hash vaut zéro tant que la
+//    valeur de la fonction de pré-hachage n'a pas été écrite par le fil
+//    d'exécution qui a placé la valeur ; il vaut ensuite cette valeur dont le
+//    bit de poids faible est forcé à un.
+struct cht__slot {
+  _Atomic(void *) valptr;
+  atomic_size_t hash;
+};
+
+//  struct cht__array : tableau de 2^lbnslots compartiments, dont count sont
+//    occupés, et son successeur next, NULL tant qu'il n'a pas été créé. Les
+//    composants claimed et migrated sont respectivement le nombre de
+//    compartiments réservés et transférés. Le composant older est le tableau
+//    dont celui-ci est le successeur.
+struct cht__array {
+  size_t lbnslots;
+  struct cht__slot *slots;
+  atomic_size_t count;
+  _Atomic(struct cht__array *) next;
+  atomic_size_t claimed;
+  atomic_size_t migrated;
+  struct cht__array *older;
+};
+
+//  cht__resizes : nombre total de successeurs créés par cht__grow, toutes
+//    tables confondues.
+static atomic_size_t cht__resizes = 0;
+
+//  struct chashtable, chashtable : le composant current est le tableau le plus
+//    ancien dont le transfert n'est peut-être pas achevé, ou le plus récent.
+struct chashtable {
+  int (*compar)(const void *, const void *);
+  size_t (*hashfun)(const void *);
+  const void *(*keyof)(const void *);
+  _Atomic(struct cht__array *) current;
+};
+
+//  cht__array_new : crée un tableau vide de 2^lbnslots compartiments. Les
+//    objets atomiques utilisés étant sans verrou, leur représentation est
+//    celle de leur type de base et calloc les initialise à zéro. Renvoie NULL
+//    en cas de dépassement de capacité.
+static struct cht__array *cht__array_new(size_t lbnslots) {
+  if (lbnslots >= sizeof(size_t) * 8
+      || POW2(lbnslots) > SIZE_MAX / sizeof(struct cht__slot)) {
+    return NULL;
+  }
+  struct cht__array *a = malloc(sizeof *a);
+  if (a == NULL) {
+    return NULL;
+  }
+  a->slots = calloc(POW2(lbnslots), sizeof *a->slots);
+  if (a->slots == NULL) {
+    free(a);
+    return NULL;
+  }
+  a->lbnslots = lbnslots;
+  atomic_init(&a->count, 0);
+  atomic_init(&a->next, NULL);
+  atomic_init(&a->claimed, 0);
+  atomic_init(&a->migrated, 0);
+  a->older = NULL;
+  return a;
+}
+
+chashtable *chashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), const void *(*keyof)(const void *)) {
+  chashtable *ht = malloc(sizeof *ht);
+  if (ht == NULL) {
+    return NULL;
+  }
+  struct cht__array *a = cht__array_new(CHT__LBNSLOTS_MIN);
+  if (a == NULL) {
+    free(ht);
+    return NULL;
+  }
+  ht->compar = compar;
+  ht->hashfun = hashfun;
+  ht->keyof = keyof;
+  atomic_init(&ht->current, a);
+  return ht;
+}
+
+//  cht__grow : crée le successeur du tableau associé à a s'il n'existe pas.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité. Renvoie
+//    sinon zéro.
+static int cht__grow(struct cht__array *a) {
+  if (atomic_load_explicit(&a->next, memory_order_acquire) != NULL) {
+    return 0;
+  }
+  struct cht__array *nx = cht__array_new(a->lbnslots + 1);
+  if (nx == NULL) {
+    return -1;
+  }
+  nx->older = a;
+  struct cht__array *expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&a->next, &expected, nx,
+      memory_order_acq_rel, memory_order_acquire)) {
+    free(nx->slots);
+    free(nx);
+  } else {
+    atomic_fetch_add_explicit(&cht__resizes, 1, memory_order_relaxed);
+  }
+  return 0;
+}
+
+//  cht__place : place la valeur valptr, de valeur de pré-hachage marquée h,
+//    dans le premier compartiment libre de sa séquence de sondage dans le
+//    tableau associé à a, à moins qu'elle ne figure déjà dans un compartiment
+//    qui le précède. Si une marque est rencontrée auparavant, la valeur est
+//    placée de même dans le successeur du tableau ; il en va de même si le
+//    tableau est plein, son successeur étant alors créé au besoin.
+static void cht__place(struct cht__array *a, void *valptr, size_t h) {
+  for (;;) {
+    size_t mask = POW2(a->lbnslots) - 1;
+    size_t i = h & mask;
+    for (size_t n = 0; n <= mask; ++n, i = (i + 1) & mask) {
+      struct cht__slot *s = &a->slots[i];
+      void *v = atomic_load_explicit(&s->valptr, memory_order_acquire);
+      if (v == NULL && atomic_compare_exchange_strong_explicit(&s->valptr,
+          &v, valptr, memory_order_acq_rel, memory_order_acquire)) {
+        atomic_store_explicit(&s->hash, h, memory_order_relaxed);
+        atomic_fetch_add_explicit(&a->count, 1, memory_order_relaxed);
+        return;
+      }
+      if (v == valptr) {
+        return;
+      }
+      if (CHT__MARKED(v)) {
+        break;
+      }
+    }
+    struct cht__array *nx;
+    while ((nx = atomic_load_explicit(&a->next, memory_order_acquire))
+        == NULL) {
+      cht__grow(a);
+    }
+    a = nx;
+  }
+}
+
+//  cht__move : transfère, sauf s'il porte déjà une marque, le compartiment
+//    d'indice i du tableau associé à a vers son successeur associé à nx. Au
+//    retour, le compartiment porte une marque.
+static void cht__move(chashtable *ht, struct cht__array *a, size_t i,
+    struct cht__array *nx) {
+  struct cht__slot *s = &a->slots[i];
+  void *v = atomic_load_explicit(&s->valptr, memory_order_acquire);
+  while (v == NULL) {
+    if (atomic_compare_exchange_weak_explicit(&s->valptr, &v, CHT__SEALED,
+        memory_order_acq_rel, memory_order_acquire)) {
+      return;
+    }
+  }
+  if (CHT__MARKED(v)) {
+    return;
+  }
+  //  La valeur de pré-hachage n'a peut-être pas encore été écrite par le fil
+  //    d'exécution qui a placé la valeur.
+  size_t h = atomic_load_explicit(&s->hash, memory_order_relaxed);
+  if (h == 0) {
+    h = ht->hashfun(ht->keyof(v)) | 1;
+  }
+  cht__place(nx, v, h);
+  atomic_store_explicit(&s->valptr, CHT__MOVED, memory_order_release);
+}
+
+//  cht__advance : fait du successeur du tableau courant de la table associée
+//    à ht le nouveau tableau courant tant que le transfert de celui-ci est
+//    achevé.
+static void cht__advance(chashtable *ht) {
+  struct cht__array *a = atomic_load_explicit(&ht->current,
+      memory_order_acquire);
+  struct cht__array *nx;
+  while ((nx = atomic_load_explicit(&a->next, memory_order_acquire)) != NULL
+      && atomic_load_explicit(&a->migrated, memory_order_acquire)
+      == POW2(a->lbnslots)) {
+    atomic_compare_exchange_strong_explicit(&ht->current, &a, nx,
+        memory_order_acq_rel, memory_order_acquire);
+    a = atomic_load_explicit(&ht->current, memory_order_acquire);
+  }
+}
+
+//  cht__help : transfère, s'il en reste, une tranche de compartiments du
+//    tableau associé à a vers son successeur associé à nx. Le fil d'exécution
+//    qui achève le transfert fait avancer le tableau courant de la table
+//    associée à ht.
+static void cht__help(chashtable *ht, struct cht__array *a,
+    struct cht__array *nx) {
+  size_t n = POW2(a->lbnslots);
+  if (atomic_load_explicit(&a->claimed, memory_order_relaxed) >= n) {
+    return;
+  }
+  size_t c = atomic_fetch_add_explicit(&a->claimed, CHT__CHUNK,
+      memory_order_relaxed);
+  if (c >= n) {
+    return;
+  }
+  size_t end = n - c < CHT__CHUNK ? n : c + CHT__CHUNK;
+  for (size_t i = c; i < end; ++i) {
+    cht__move(ht, a, i, nx);
+  }
+  if (atomic_fetch_add_explicit(&a->migrated, end - c, memory_order_acq_rel)
+      + (end - c) == n) {
+    cht__advance(ht);
+  }
+}
+
+//  cht__seal : transfère du tableau associé à a vers son successeur associé à
+//    nx les compartiments de la séquence de sondage de la valeur de
+//    pré-hachage marquée h, jusqu'au premier qui était libre. Aucune valeur de
+//    même clé ne peut ensuite plus être trouvée ni ajoutée dans le tableau.
+static void cht__seal(chashtable *ht, struct cht__array *a,
+    struct cht__array *nx, size_t h) {
+  size_t mask = POW2(a->lbnslots) - 1;
+  size_t i = h & mask;
+  for (size_t n = 0; n <= mask; ++n, i = (i + 1) & mask) {
+    cht__move(ht, a, i, nx);
+    if (atomic_load_explicit(&a->slots[i].valptr, memory_order_acquire)
+        == CHT__SEALED) {
+      return;
+    }
+  }
+}
+
+//  cht__probe : a le même comportement que chashtable_find_or_insert, limitée
+//    au tableau associé à a et h étant la valeur de pré-hachage marquée. La
+//    valeur créée est mémorisée dans *createdptr, où elle est reprise par les
+//    tentatives suivantes. Renvoie CHT__MOVED si la séquence de sondage
+//    rencontre une marque ou si le tableau est plein.
+static void *cht__probe(chashtable *ht, struct cht__array *a,
+    const void *keyptr, size_t h, void *(*create)(void *, const void *),
+    void *context, void **createdptr) {
+  size_t mask = POW2(a->lbnslots) - 1;
+  size_t i = h & mask;
+  for (size_t n = 0; n <= mask; ++n, i = (i + 1) & mask) {
+    struct cht__slot *s = &a->slots[i];
+    void *v = atomic_load_explicit(&s->valptr, memory_order_acquire);
+    if (v == NULL) {
+      if (*createdptr == NULL) {
+        *createdptr = create(context, keyptr);
+        if (*createdptr == NULL) {
+          return NULL;
+        }
+      }
+      if (atomic_compare_exchange_strong_explicit(&s->valptr, &v,
+          *createdptr, memory_order_acq_rel, memory_order_acquire)) {
+        atomic_store_explicit(&s->hash, h, memory_order_relaxed);
+        size_t count = atomic_fetch_add_explicit(&a->count, 1,
+            memory_order_relaxed) + 1;
+        if (count / CHT__LDFACT_MAX_NUMER
+            > (mask + 1) / CHT__LDFACT_MAX_DENOM) {
+          //  Un échec est sans conséquence : le tableau n'est pas plein.
+          cht__grow(a);
+        }
+        return *createdptr;
+      }
+    }
+    if (CHT__MARKED(v)) {
+      return CHT__MOVED;
+    }
+    size_t vh = atomic_load_explicit(&s->hash, memory_order_relaxed);
+    if ((vh == 0 || vh == h) && ht->compar(ht->keyof(v), keyptr) == 0) {
+      return v;
+    }
+  }
+  return CHT__MOVED;
+}
+
+void *chashtable_find_or_insert(chashtable *ht, const void *keyptr,
+    size_t h, void *(*create)(void *context, const void *keyptr),
+    void *context) {
+  void *created = NULL;
+  struct cht__array *a = atomic_load_explicit(&ht->current,
+      memory_order_acquire);
+  for (;;) {
+    struct cht__array *nx = atomic_load_explicit(&a->next,
+        memory_order_acquire);
+    if (nx != NULL) {
+      cht__help(ht, a, nx);
+      cht__seal(ht, a, nx, h | 1);
+      a = nx;
+      continue;
+    }
+    void *v = cht__probe(ht, a, keyptr, h | 1, create, context, &created);
+    if (v != CHT__MOVED) {
+      return v;
+    }
+    //  Sans marque rencontrée, le tableau est plein et doit être agrandi.
+    if (atomic_load_explicit(&a->next, memory_order_acquire) == NULL
+        && cht__grow(a) != 0) {
+      return NULL;
+    }
+  }
+}
+
+//  cht__settle : achève les transferts en cours de la table de hachage
+//    associée à ht et renvoie son tableau le plus récent.
+static struct cht__array *cht__settle(chashtable *ht) {
+  struct cht__array *a = atomic_load_explicit(&ht->current,
+      memory_order_acquire);
+  struct cht__array *nx;
+  while ((nx = atomic_load_explicit(&a->next, memory_order_acquire))
+      != NULL) {
+    while (atomic_load_explicit(&a->claimed, memory_order_relaxed)
+        < POW2(a->lbnslots)) {
+      cht__help(ht, a, nx);
+    }
+    a = nx;
+  }
+  return a;
+}
+
+int chashtable_apply_context(chashtable *ht, void *context,
+    int (*fun)(void *context, void *valptr)) {
+  struct cht__array *a = cht__settle(ht);
+  for (size_t i = 0; i < POW2(a->lbnslots); ++i) {
+    void *v = atomic_load_explicit(&a->slots[i].valptr,
+        memory_order_acquire);
+    if (v != NULL) {
+      int r = fun(context, v);
+      if (r != 0) {
+        return r;
+      }
+    }
+  }
+  return 0;
+}
+
+size_t chashtable_count(chashtable *ht) {
+  return atomic_load_explicit(&cht__settle(ht)->count, memory_order_relaxed);
+}
+
+size_t chashtable_resizecount(void) {
+  return atomic_load_explicit(&cht__resizes, memory_order_relaxed);
+}
+
+void chashtable_dispose(chashtable **htptr) {
+  if (*htptr == NULL) {
+    return;
+  }
+  struct cht__array *a = atomic_load_explicit(&(*htptr)->current,
+      memory_order_acquire);
+  struct cht__array *nx;
+  while ((nx = atomic_load_explicit(&a->next, memory_order_acquire))
+      != NULL) {
+    a = nx;
+  }
+  while (a != NULL) {
+    struct cht__array *older = a->older;
+    free(a->slots);
+    free(a);
+    a = older;
+  }
+  free(*htptr);
+  *htptr = NULL;
+}
@@ -0,0 +1,78 @@
+//  Interface du module chashtable - module implémentant une table de hachage
+//    partagée par plusieurs fils d'exécution, sans verrou : la recherche d'une
+//    clé et l'ajout de sa valeur si elle est absente forment une seule
+//    opération atomique, et l'agrandissement de la table est réalisé
+//    conjointement par les fils d'exécution qui l'utilisent, sans qu'aucun ne
+//    soit interrompu.
+
+#ifndef CHASHTABLE__H
+#define CHASHTABLE__H
+
+#include <stdlib.h>
+
+//  struct chashtable, chashtable : structure regroupant les informations
+//    permettant de gérer une table de hachage partagée dont les valeurs sont
+//    des objets quelconques, la clé de chacune étant obtenue à partir de
+//    celle-ci. La création de la structure de données associée est confiée à
+//    la fonction chashtable_empty dont les paramètres compar, hashfun et keyof
+//    précisent respectivement la fonction de comparaison des clés, leur
+//    fonction de pré-hachage et la fonction qui donne l'adresse de la clé
+//    d'une valeur.
+//  La structure de données ne stocke pas les objets mais des pointeurs vers ces
+//    objets, qui ne sont jamais retirés. L'utilisateur doit garantir que
+//    l'adresse de chaque valeur reste valide jusqu'à la révocation de la
+//    table.
+typedef struct chashtable chashtable;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type chashtable * n'est pas l'adresse d'un objet préalablement renvoyé
+//    par chashtable_empty et non révoqué depuis par chashtable_dispose. Cette
+//    règle ne souffre que d'une seule exception : chashtable_dispose tolère que
+//    la déréférence de son argument ait pour valeur NULL. Seule la fonction
+//    chashtable_find_or_insert peut être appelée simultanément par plusieurs
+//    fils d'exécution.
+
+//  chashtable_empty : crée une structure de données correspondant initialement
+//    à la table de hachage vide. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers l'objet qui gère la structure de
+//    données.
+extern chashtable *chashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), const void *(*keyof)(const void *));
+
+//  chashtable_find_or_insert : recherche dans la table de hachage associée à
+//    ht une valeur dont la clé est égale à celle d'adresse keyptr au sens de
+//    compar. Si une telle valeur existe, renvoie son adresse. Sinon, ajoute à
+//    la table la valeur renvoyée par create(context, keyptr), dont la clé doit
+//    être égale à celle d'adresse keyptr, et renvoie cette dernière. Si
+//    plusieurs fils d'exécution ajoutent simultanément une même clé, un seul
+//    ajout a lieu et tous obtiennent la même valeur : les valeurs créées par
+//    les autres sont abandonnées. Le comportement est indéterminé si h n'est
+//    pas égal à hashfun(keyptr). Renvoie NULL si create renvoie NULL ou en cas
+//    de dépassement de capacité.
+extern void *chashtable_find_or_insert(chashtable *ht, const void *keyptr,
+    size_t h, void *(*create)(void *context, const void *keyptr),
+    void *context);
+
+//  chashtable_apply_context : exécute fun(context, valptr) sur chacune des
+//    valeurs valptr de la table de hachage associée à ht, dans un ordre
+//    quelconque. Si, pour une valeur, fun renvoie une valeur non nulle,
+//    l'exécution prend fin et chashtable_apply_context renvoie cette valeur.
+//    Renvoie sinon zéro.
+extern int chashtable_apply_context(chashtable *ht, void *context,
+    int (*fun)(void *context, void *valptr));
+
+//  chashtable_count : renvoie le nombre de valeurs de la table de hachage
+//    associée à ht.
+extern size_t chashtable_count(chashtable *ht);
+
+//  chashtable_resizecount : renvoie le nombre total d'agrandissements effectués
+//    jusque-là par l'ensemble des tables de hachage partagées. Peut être
+//    appelée simultanément à toute autre fonction.
+extern size_t chashtable_resizecount(void);
+
+//  chashtable_dispose : si *htptr ne vaut pas NULL, libère les ressources
+//    allouées à la structure de données associée à *htptr puis affecte à
+//    *htptr la valeur NULL.
+extern void chashtable_dispose(chashtable **htptr);
+
+#endif
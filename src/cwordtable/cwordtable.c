@@ -0,0 +1,125 @@
+//  Implantation du module cwordtable.
+
+#include <string.h>
+#include "arena.h"
+#include "chashtable.h"
+#include "cwordtable.h"
+#include "strhash.h"
+
+//  struct cwordtable, cwordtable : le composant ht est l'index concurrent des
+//    mots partagés, de clés leurs chaines, et words le tableau des réserves des
+//    writercnt rédacteurs.
+struct cwordtable {
+  chashtable *ht;
+  arena **words;
+  size_t writercnt;
+};
+
+cwordtable *cwordtable_empty(size_t writercnt) {
+  cwordtable *cwt = malloc(sizeof *cwt);
+  if (cwt == NULL) {
+    return NULL;
+  }
+  cwt->ht = chashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))strhash,
+      (const void *(*)(const void *))shword_word);
+  cwt->words = calloc(writercnt, sizeof *cwt->words);
+  cwt->writercnt = writercnt;
+  if (cwt->ht == NULL || cwt->words == NULL) {
+    cwordtable_dispose(&cwt);
+    return NULL;
+  }
+  for (size_t k = 0; k < writercnt; ++k) {
+    cwt->words[k] = arena_empty();
+    if (cwt->words[k] == NULL) {
+      cwordtable_dispose(&cwt);
+      return NULL;
+    }
+  }
+  return cwt;
+}
+
+//  struct cwordtable__creation : réserve ar dans laquelle créer le mot
+//    partagé de chaine de longueur len recherché par cwordtable_insert_hashed.
+struct cwordtable__creation {
+  arena *ar;
+  size_t len;
+};
+
+//  cwordtable__create : crée dans la réserve de c le mot partagé associé à la
+//    chaine de longueur c->len pointée par w. Renvoie NULL en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le mot partagé.
+static shword *cwordtable__create(const struct cwordtable__creation *c,
+    const char *w) {
+  return shword_create(c->ar, w, c->len);
+}
+
+shword *cwordtable_insert_hashed(cwordtable *cwt, size_t writer,
+    const char *w, size_t len, size_t h) {
+  struct cwordtable__creation c = {
+    .ar = cwt->words[writer],
+    .len = len,
+  };
+  return chashtable_find_or_insert(cwt->ht, w, h,
+      (void *(*)(void *, const void *))cwordtable__create, &c);
+}
+
+int cwordtable_import(cwordtable *cwt, size_t writer, const shword *img,
+    size_t inputcnt) {
+  const char *w = shword_image_word(img, inputcnt);
+  size_t len = strlen(w);
+  shword *d = cwordtable_insert_hashed(cwt, writer, w, len,
+      strhash_mem(w, len));
+  if (d == NULL) {
+    return -1;
+  }
+  //  Inutile de vérifier la valeur de retour : le compteur est saturé.
+  shword_merge_image(d, img, inputcnt);
+  return 0;
+}
+
+size_t cwordtable_count(cwordtable *cwt) {
+  return chashtable_count(cwt->ht);
+}
+
+//  struct cwordtable__collection : fourretout ha destiné à accueillir les mots
+//    partagés présents dans au moins minfiles fichiers.
+struct cwordtable__collection {
+  holdall *ha;
+  size_t minfiles;
+};
+
+//  cwordtable__collect : ajoute le mot partagé associé à shw au fourretout de
+//    c s'il est présent dans au moins c->minfiles fichiers. Renvoie une valeur
+//    non nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+static int cwordtable__collect(struct cwordtable__collection *c,
+    shword *shw) {
+  return shword_filecount(shw) >= c->minfiles ? holdall_put(c->ha, shw) : 0;
+}
+
+holdall *cwordtable_collect(cwordtable *cwt, size_t minfiles) {
+  struct cwordtable__collection c = {
+    .ha = holdall_empty(),
+    .minfiles = minfiles,
+  };
+  if (c.ha == NULL || chashtable_apply_context(cwt->ht, &c,
+      (int (*)(void *, void *))cwordtable__collect) != 0) {
+    holdall_dispose(&c.ha);
+    return NULL;
+  }
+  return c.ha;
+}
+
+void cwordtable_dispose(cwordtable **cwtptr) {
+  if (*cwtptr == NULL) {
+    return;
+  }
+  chashtable_dispose(&(*cwtptr)->ht);
+  for (size_t k = 0; (*cwtptr)->words != NULL && k < (*cwtptr)->writercnt;
+      ++k) {
+    arena_dispose(&(*cwtptr)->words[k]);
+  }
+  free((*cwtptr)->words);
+  free(*cwtptr);
+  *cwtptr = NULL;
+}
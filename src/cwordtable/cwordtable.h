@@ -0,0 +1,69 @@
+//  Interface du module cwordtable - module regroupant, au sein d'une même
+//    structure partagée par plusieurs fils d'exécution, les mots partagés lus
+//    dans diverses sources de fichiers ainsi que l'index concurrent permettant
+//    de les retrouver à partir de leur chaine.
+
+#ifndef CWORDTABLE__H
+#define CWORDTABLE__H
+
+#include <stdlib.h>
+#include "holdall.h"
+#include "shword.h"
+
+//  struct cwordtable, cwordtable : structure associant à des chaines de
+//    caractères des mots partagés, accessible simultanément à plusieurs
+//    rédacteurs. La création de la structure de données associée est confiée
+//    à la fonction cwordtable_empty. Les mots partagés sont créés par la
+//    structure elle-même, dans une réserve propre à chaque rédacteur, et
+//    détruits avec elle.
+typedef struct cwordtable cwordtable;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type cwordtable * n'est pas l'adresse d'un objet préalablement renvoyé
+//    par cwordtable_empty et non révoqué depuis par cwordtable_dispose. Cette
+//    règle ne souffre que d'une seule exception : cwordtable_dispose tolère que
+//    la déréférence de son argument ait pour valeur NULL. Seule la fonction
+//    cwordtable_insert_hashed peut être appelée simultanément par plusieurs
+//    fils d'exécution, à condition qu'ils utilisent des rédacteurs distincts.
+
+//  cwordtable_empty : crée une structure de données correspondant initialement
+//    à une table de mots vide, pour writercnt rédacteurs, d'indices 0 à
+//    writercnt - 1. Renvoie NULL en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers l'objet qui gère la structure de données.
+extern cwordtable *cwordtable_empty(size_t writercnt);
+
+//  cwordtable_insert_hashed : recherche dans la table associée à cwt le mot
+//    partagé associé à la chaine de longueur len et de somme de hachage h au
+//    sens de strhash pointée par w. S'il n'existe pas, il est créé sans aucune
+//    occurrence dans la réserve du rédacteur d'indice writer. Les occurrences
+//    du mot renvoyé doivent être marquées par shword_increment_atomic ou
+//    shword_add_atomic. Renvoie NULL en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers le mot partagé.
+extern shword *cwordtable_insert_hashed(cwordtable *cwt, size_t writer,
+    const char *w, size_t len, size_t h);
+
+//  cwordtable_import : ajoute à la table associée à cwt, par le rédacteur
+//    d'indice writer, le mot partagé dont l'image, créée alors que inputcnt
+//    fichiers étaient pris en charge, est associée à img, au sens de
+//    shword_merge_image. Ne doit pas être appelée simultanément à une autre
+//    fonction du module. Renvoie une valeur non nulle en cas de dépassement de
+//    capacité. Renvoie sinon zéro.
+extern int cwordtable_import(cwordtable *cwt, size_t writer,
+    const shword *img, size_t inputcnt);
+
+//  cwordtable_count : renvoie le nombre de mots partagés de la table associée
+//    à cwt.
+extern size_t cwordtable_count(cwordtable *cwt);
+
+//  cwordtable_collect : renvoie un fourretout des mots partagés de la table
+//    associée à cwt présents dans au moins minfiles fichiers, dans un ordre
+//    quelconque. Ils restent valides jusqu'à la révocation de cwt. Renvoie
+//    NULL en cas de dépassement de capacité.
+extern holdall *cwordtable_collect(cwordtable *cwt, size_t minfiles);
+
+//  cwordtable_dispose : si *cwtptr ne vaut pas NULL, libère les ressources
+//    allouées à la structure de données associée à *cwtptr, mots partagés
+//    compris, puis affecte à *cwtptr la valeur NULL.
+extern void cwordtable_dispose(cwordtable **cwtptr);
+
+#endif
@@ -0,0 +1,331 @@
+//  Implantation du module decomp - le fil de décompression remplit les
+//    tampons d'une file spsc de DECOMP__SLOTCNT tampons, dont l'utilisateur
+//    est le consommateur : decomp_next lit directement le tampon le plus ancien
+//    et ne le rend qu'à l'appel suivant. Une source peut être formée de
+//    plusieurs trames (membres gzip ou trames zstd) mises bout à bout ; elle
+//    est tronquée si elle se termine au milieu d'une trame.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include "decomp.h"
+#include "spsc.h"
+
+#ifdef HAVE_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+//  DECOMP__SLOTCNT : nombre de tampons d'octets décompressés.
+#define DECOMP__SLOTCNT 2
+
+//  DECOMP__INSIZE : taille minimale du tampon des octets compressés lus sur le
+//    descripteur.
+#define DECOMP__INSIZE (1 << 20)
+
+//  struct decomp, decomp : le composant format mémorise le format de la
+//    source, fd le descripteur sur lequel lire la suite de la source, négatif
+//    s'il n'y en a pas. Les inlen octets compressés à décompresser sont
+//    pointés par in ; ils sont lus au besoin dans le tampon inbuf de insize
+//    octets. Les tampons d'octets décompressés, de slotsize octets, forment la
+//    file q ; held indique si l'utilisateur en détient un. Le composant stop
+//    demande au fil de décompression de s'interrompre, errnum mémorise le code
+//    d'erreur qu'il a rencontré, écrit avant la fermeture de la file.
+struct decomp {
+  int format;
+  int fd;
+  const unsigned char *in;
+  size_t inlen;
+  unsigned char *inbuf;
+  size_t insize;
+  spsc *q;
+  size_t slotsize;
+  bool held;
+  atomic_bool stop;
+  int errnum;
+  pthread_t thread;
+#ifdef HAVE_ZLIB
+  z_stream zs;
+#endif
+#ifdef HAVE_ZSTD
+  ZSTD_DStream *zds;
+#endif
+};
+
+int decomp_format(const unsigned char *p, size_t n) {
+  if (n >= 2 && p[0] == 0x1F && p[1] == 0x8B) {
+    return DECOMP_GZIP;
+  }
+  if (n >= 4 && p[0] == 0x28 && p[1] == 0xB5 && p[2] == 0x2F && p[3] == 0xFD) {
+    return DECOMP_ZSTD;
+  }
+  return DECOMP_NONE;
+}
+
+bool decomp_supported(int format) {
+  switch (format) {
+#ifdef HAVE_ZLIB
+    case DECOMP_GZIP:
+      return true;
+#endif
+#ifdef HAVE_ZSTD
+    case DECOMP_ZSTD:
+      return true;
+#endif
+  }
+  return false;
+}
+
+//  decomp__init : prépare le décompresseur de la structure associée à d.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité. Renvoie
+//    sinon zéro.
+static int decomp__init(decomp *d) {
+  switch (d->format) {
+#ifdef HAVE_ZLIB
+    case DECOMP_GZIP:
+      memset(&d->zs, 0, sizeof d->zs);
+      //  Fenêtre maximale, entête gzip attendu.
+      return inflateInit2(&d->zs, 16 + MAX_WBITS) == Z_OK ? 0 : -1;
+#endif
+#ifdef HAVE_ZSTD
+    case DECOMP_ZSTD:
+      d->zds = ZSTD_createDStream();
+      return d->zds == NULL || ZSTD_isError(ZSTD_initDStream(d->zds)) ? -1
+          : 0;
+#endif
+  }
+  return -1;
+}
+
+//  decomp__end : libère le décompresseur de la structure associée à d.
+static void decomp__end(decomp *d) {
+  switch (d->format) {
+#ifdef HAVE_ZLIB
+    case DECOMP_GZIP:
+      inflateEnd(&d->zs);
+      break;
+#endif
+#ifdef HAVE_ZSTD
+    case DECOMP_ZSTD:
+      ZSTD_freeDStream(d->zds);
+      break;
+#endif
+  }
+}
+
+//  decomp__step : décompresse les octets compressés disponibles de la
+//    structure associée à d vers le tableau de *outlenptr octets pointé par
+//    out, puis affecte à *outlenptr le nombre d'octets produits et à *endptr
+//    true si une trame s'est terminée, false sinon. Renvoie EIO si la source
+//    est altérée, ENOMEM en cas de dépassement de capacité. Renvoie sinon zéro.
+static int decomp__step(decomp *d, unsigned char *out, size_t *outlenptr,
+    bool *endptr) {
+  *endptr = false;
+  switch (d->format) {
+#ifdef HAVE_ZLIB
+    case DECOMP_GZIP: {
+      uInt inc = d->inlen > UINT_MAX ? UINT_MAX : (uInt) d->inlen;
+      uInt outc = *outlenptr > UINT_MAX ? UINT_MAX : (uInt) *outlenptr;
+      d->zs.next_in = d->in;
+      d->zs.avail_in = inc;
+      d->zs.next_out = out;
+      d->zs.avail_out = outc;
+      int ret = inflate(&d->zs, Z_NO_FLUSH);
+      d->in += inc - d->zs.avail_in;
+      d->inlen -= inc - d->zs.avail_in;
+      *outlenptr = outc - d->zs.avail_out;
+      if (ret == Z_STREAM_END) {
+        //  Le membre suivant éventuel est décompressé à neuf.
+        *endptr = true;
+        return inflateReset(&d->zs) == Z_OK ? 0 : EIO;
+      }
+      if (ret == Z_MEM_ERROR) {
+        return ENOMEM;
+      }
+      return ret == Z_OK || ret == Z_BUF_ERROR ? 0 : EIO;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    case DECOMP_ZSTD: {
+      ZSTD_inBuffer in = {
+        d->in, d->inlen, 0,
+      };
+      ZSTD_outBuffer o = {
+        out, *outlenptr, 0,
+      };
+      size_t ret = ZSTD_decompressStream(d->zds, &o, &in);
+      d->in += in.pos;
+      d->inlen -= in.pos;
+      *outlenptr = o.pos;
+      if (ZSTD_isError(ret)) {
+        return EIO;
+      }
+      //  Une trame terminée et entièrement produite : la trame suivante
+      //    éventuelle est décompressée sans réinitialisation.
+      *endptr = ret == 0;
+      return 0;
+    }
+#endif
+  }
+  //  Format non pris en charge, seul cas sans bibliothèque.
+  (void) out;
+  (void) outlenptr;
+  return EIO;
+}
+
+//  decomp__refill : lit la suite de la source de la structure associée à d,
+//    dont les octets compressés disponibles ont été consommés. Renvoie le code
+//    d'erreur au sens de errno en cas d'erreur de lecture. Renvoie sinon zéro,
+//    aucun octet n'étant disponible à la fin de la source.
+static int decomp__refill(decomp *d) {
+  if (d->fd < 0) {
+    return 0;
+  }
+  ssize_t n;
+  do {
+    n = read(d->fd, d->inbuf, d->insize);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errno;
+  }
+  d->in = d->inbuf;
+  d->inlen = (size_t) n;
+  return 0;
+}
+
+//  decomp__run : fil de décompression, de paramètre un pointeur vers la
+//    structure struct decomp qui le concerne. La variable inframe indique si
+//    une trame a été entamée sans être terminée : même une fois la source lue,
+//    le décompresseur peut alors avoir encore des octets à produire.
+static void *decomp__run(void *arg) {
+  decomp *d = arg;
+  int e = 0;
+  bool inframe = false;
+  bool eof = false;
+  bool done = false;
+  while (!done && e == 0
+      && !atomic_load_explicit(&d->stop, memory_order_relaxed)) {
+    unsigned char *out = spsc_back(d->q);
+    size_t len = 0;
+    while (len < d->slotsize && e == 0) {
+      if (d->inlen == 0 && !eof) {
+        e = decomp__refill(d);
+        eof = e == 0 && d->inlen == 0;
+      }
+      if (e != 0 || (eof && !inframe)) {
+        done = true;
+        break;
+      }
+      size_t before = d->inlen;
+      size_t n = d->slotsize - len;
+      bool end;
+      e = decomp__step(d, out + len, &n, &end);
+      len += n;
+      if (end) {
+        inframe = false;
+      } else if (n > 0 || d->inlen < before) {
+        inframe = true;
+      } else if (e == 0) {
+        //  Ni octet consommé ni octet produit : la source est altérée ou
+        //    tronquée.
+        e = EIO;
+      }
+    }
+    if (len > 0) {
+      spsc_push(d->q, len);
+    }
+  }
+  d->errnum = e;
+  spsc_close(d->q);
+  return NULL;
+}
+
+decomp *decomp_open(int format, const unsigned char *head, size_t n,
+    int fd, size_t slotsize) {
+  decomp *d = malloc(sizeof *d);
+  if (d == NULL) {
+    return NULL;
+  }
+  d->format = format;
+  d->fd = fd;
+  d->in = head;
+  d->inlen = n;
+  d->inbuf = NULL;
+  d->insize = 0;
+  d->slotsize = slotsize;
+  d->held = false;
+  atomic_init(&d->stop, false);
+  d->errnum = 0;
+  d->q = spsc_empty(DECOMP__SLOTCNT, slotsize, NULL);
+  if (d->q == NULL) {
+    goto error;
+  }
+  if (fd >= 0) {
+    d->insize = n > DECOMP__INSIZE ? n : DECOMP__INSIZE;
+    d->inbuf = malloc(d->insize);
+    if (d->inbuf == NULL) {
+      goto error;
+    }
+    memcpy(d->inbuf, head, n);
+    d->in = d->inbuf;
+  }
+  if (decomp__init(d) != 0) {
+    goto error;
+  }
+  if (pthread_create(&d->thread, NULL, decomp__run, d) != 0) {
+    decomp__end(d);
+    goto error;
+  }
+  return d;
+  error:
+  spsc_dispose(&d->q);
+  free(d->inbuf);
+  free(d);
+  return NULL;
+}
+
+size_t decomp_next(decomp *d, const unsigned char **pptr) {
+  if (d->held) {
+    spsc_pop(d->q);
+    d->held = false;
+  }
+  size_t len;
+  const void *p = spsc_front_wait(d->q, &len);
+  if (p == NULL) {
+    return 0;
+  }
+  d->held = true;
+  *pptr = p;
+  return len;
+}
+
+int decomp_error(const decomp *d) {
+  return d->errnum;
+}
+
+void decomp_dispose(decomp **dptr) {
+  if (*dptr == NULL) {
+    return;
+  }
+  decomp *d = *dptr;
+  //  Le fil de décompression peut attendre qu'un tampon soit rendu : ils le
+  //    sont tous jusqu'à ce qu'il ferme la file.
+  atomic_store_explicit(&d->stop, true, memory_order_relaxed);
+  const unsigned char *p;
+  while (decomp_next(d, &p) > 0);
+  pthread_join(d->thread, NULL);
+  decomp__end(d);
+  spsc_dispose(&d->q);
+  free(d->inbuf);
+  free(d);
+  *dptr = NULL;
+}
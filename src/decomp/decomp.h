@@ -0,0 +1,78 @@
+//  Interface du module decomp - module implémentant la décompression au fil de
+//    l'eau d'une source compressée au format gzip ou zstd. La décompression est
+//    confiée à un fil d'exécution propre à la source, qui remplit
+//    alternativement deux tampons pendant que l'utilisateur lit l'autre. Chaque
+//    format n'est pris en charge que si le programme a été compilé avec sa
+//    bibliothèque : zlib pour gzip (macroconstante HAVE_ZLIB), libzstd pour
+//    zstd (macroconstante HAVE_ZSTD).
+
+#ifndef DECOMP__H
+#define DECOMP__H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+//  DECOMP_NONE, DECOMP_GZIP, DECOMP_ZSTD : formats de compression reconnus par
+//    decomp_format, DECOMP_NONE désignant une source non compressée.
+enum DECOMP_FORMATS {
+  DECOMP_NONE,
+  DECOMP_GZIP,
+  DECOMP_ZSTD,
+};
+
+//  DECOMP_MAGICLEN : nombre d'octets du début d'une source suffisant à
+//    decomp_format pour en reconnaître le format.
+#define DECOMP_MAGICLEN 4
+
+//  decomp_format : renvoie le format de compression de la source débutant par
+//    le tableau de n octets pointé par p, reconnu d'après ses premiers octets.
+//    Renvoie DECOMP_NONE si aucun format n'est reconnu.
+extern int decomp_format(const unsigned char *p, size_t n);
+
+//  decomp_supported : teste si le format de compression format est pris en
+//    charge.
+extern bool decomp_supported(int format);
+
+//  struct decomp, decomp : structure regroupant les informations permettant
+//    de décompresser une source. La création de la structure de données
+//    associée est confiée à la fonction decomp_open.
+typedef struct decomp decomp;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type decomp * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    decomp_open et non révoqué depuis par decomp_dispose. Cette règle ne
+//    souffre que d'une seule exception : decomp_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  decomp_open : lance la décompression, au format format pris en charge, de
+//    la source formée des n octets du tableau pointé par head suivis, si fd
+//    n'est pas négatif, des octets lus sur le descripteur fd jusqu'à la fin du
+//    fichier. Si fd est négatif, le tableau doit rester valide jusqu'à la
+//    révocation de la structure ; il est sinon recopié. Les octets décompressés
+//    sont mis à disposition par tampons d'au plus slotsize octets. Renvoie
+//    NULL en cas de dépassement de capacité ou si le fil d'exécution n'a pu
+//    être lancé. Renvoie sinon un pointeur vers l'objet qui gère la structure
+//    de données.
+extern decomp *decomp_open(int format, const unsigned char *head, size_t n,
+    int fd, size_t slotsize);
+
+//  decomp_next : rend le tampon obtenu par l'appel précédent à decomp_next sur
+//    la structure associée à d, puis attend le tampon suivant d'octets
+//    décompressés. Affecte son adresse à *pptr et renvoie son nombre d'octets,
+//    non nul. Renvoie zéro si la source a été décompressée jusqu'à sa fin ou
+//    si une erreur est survenue.
+extern size_t decomp_next(decomp *d, const unsigned char **pptr);
+
+//  decomp_error : renvoie zéro si, decomp_next ayant renvoyé zéro sur la
+//    structure associée à d, la source a été décompressée jusqu'à sa fin.
+//    Renvoie sinon le code d'erreur au sens de errno de l'erreur survenue, EIO
+//    pour une source altérée ou tronquée.
+extern int decomp_error(const decomp *d);
+
+//  decomp_dispose : si *dptr ne vaut pas NULL, interrompt au besoin la
+//    décompression, libère les ressources allouées à la structure de données
+//    associée à *dptr puis affecte à *dptr la valeur NULL. Le descripteur
+//    n'est pas fermé.
+extern void decomp_dispose(decomp **dptr);
+
+#endif
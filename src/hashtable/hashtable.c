@@ -1,14 +1,18 @@
 //  Implantation polymorphe pour la spécification TABLE du TDA Table(T, T') dans
 //    le cas d'une table de hachage par chainage séparé.
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include "arena.h"
 #include "hashtable.h"
 
 //  Le nombre de compartiments du tableau de hachage est une puissance de 2. Il
 //    vaut initialement 2^HT__LBNSLOTS_MIN. Dès le taux de remplissage de la
-//    table de hachage est strictement supérieur à
-//    (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM, le nombre
-//    de compartiments est multiplié par 2.
+//    table de hachage est strictement supérieur à son seuil maximum, qui vaut
+//    par défaut (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM
+//    et peut être fixé par hashtable_setup, le nombre de compartiments est
+//    multiplié par 2.
 
 #define HT__LBNSLOTS_MIN      6
 #define HT__LDFACT_MAX_NUMER  1
@@ -36,6 +40,17 @@
 #undef HT__NSLOTS_MIN
 #undef HT__NENTRIESMAX_MIN
 
+//  hashtable__ldnumer, hashtable__lddenom : numérateur et dénominateur du
+//    seuil maximum des tables de hachage créées ensuite, fixés par
+//    hashtable_setup.
+static size_t hashtable__ldnumer = HT__LDFACT_MAX_NUMER;
+static size_t hashtable__lddenom = HT__LDFACT_MAX_DENOM;
+
+//  hashtable__step : nombre de listes migrées à chaque opération par les
+//    tables de hachage créées ensuite, fixé par hashtable_setup_incremental,
+//    zéro si leurs agrandissements se font en une fois.
+static size_t hashtable__step = 0;
+
 //  struct hashtable, hashtable : gestion du chainage séparé par liste dynamique
 //    simplement chainée. Le composant compar mémorise la fonction de
 //    comparaison des clés, hashfun, leur fonction de pré-hachage. Le tableau de
@@ -49,14 +64,35 @@
 //    initialisée : 1) tant que le tableau de hachage n'a pas été alloué,
 //    la valeur de hasharray est l'adresse du champ null ; 2) la fonction de
 //    recherche locale hashtable__search est toujours définie car la valeur du
-//    champ null est NULL.
+//    champ null est NULL. Les cellules sont allouées dans la réserve cells et
+//    libérées en bloc par hashtable_dispose ; les cellules retirées par
+//    hashtable_remove sont chainées par leur champ next dans la liste
+//    freecells pour être réutilisées par les ajouts suivants. Les composants
+//    ldnumer et lddenom mémorisent le seuil maximum de la table de hachage,
+//    fixé à sa création.
 
 //  L'ajout d'une nouvelle entrée a lieu en queue de liste. L'ordre induit est
 //    respecté lors de tout agrandissement du tableau de hachage.
 
+//  Si le composant step n'est pas nul, un agrandissement se contente d'allouer
+//    le nouveau tableau : l'ancien, mémorisé par les composants oldarray et
+//    oldlbnslots, coexiste avec lui le temps de la migration de ses listes,
+//    step à la fois lors de chaque ajout et de chaque recherche. Les listes
+//    d'indices [0, migrated[ de l'ancien tableau ont été réparties dans le
+//    nouveau ; les autres restent à migrer. Une clé se trouve ainsi dans
+//    l'ancien tableau si et seulement si l'indice de sa liste y est au moins
+//    égal à migrated. Hors migration, oldarray vaut NULL.
+
+//  Chaque cellule mémorise la valeur complète de la fonction de pré-hachage
+//    pour sa clé, calculée une seule fois lors de l'ajout : elle sert à
+//    répartir les cellules lors des agrandissements sans rappeler hashfun, et
+//    à écarter lors des recherches les cellules de valeur différente sans
+//    appeler compar.
+
 typedef struct cell cell;
 
 struct cell {
+  size_t hash;
   const void *keyptr;
   const void *valptr;
   cell *next;
@@ -67,8 +103,16 @@ struct hashtable {
   size_t (*hashfun)(const void *);
   cell **hasharray;
   cell *null;
+  arena *cells;
+  cell *freecells;
   size_t lbnslots;
   size_t nfreeentries;
+  size_t ldnumer;
+  size_t lddenom;
+  size_t step;
+  cell **oldarray;
+  size_t oldlbnslots;
+  size_t migrated;
 };
 
 #define HT__MAKE_BLANK(ht)  ((ht)->hasharray = &(ht)->null)
@@ -79,22 +123,110 @@ struct hashtable {
 #define MODPOW2(m, p) ((m) % POW2(p))
 
 //  hashtable__search : recherche dans la table de hachage associé à ht une clé
-//    égale à celle d'adresse keyptr au sens de compar. Renvoie l'adresse du
-//    pointeur qui repère la cellule qui contient cette occurrence si elle
-//    existe. Renvoie sinon l'adresse du pointeur qui marque la fin de la liste.
-static cell **hashtable__search(const hashtable *ht, const void *keyptr) {
-  cell * const *pp = &ht->hasharray[MODPOW2(ht->hashfun(keyptr), ht->lbnslots)];
-  while (*pp != NULL && ht->compar(keyptr, (*pp)->keyptr) != 0) {
+//    égale à celle d'adresse keyptr, de valeur de pré-hachage h, au sens de
+//    compar. Renvoie l'adresse du pointeur qui repère la cellule qui contient
+//    cette occurrence si elle existe. Renvoie sinon l'adresse du pointeur qui
+//    marque la fin de la liste.
+static cell **hashtable__search(const hashtable *ht, const void *keyptr,
+    size_t h) {
+  cell * const *pp = ht->oldarray != NULL
+      && MODPOW2(h, ht->oldlbnslots) >= ht->migrated
+      ? &ht->oldarray[MODPOW2(h, ht->oldlbnslots)]
+      : &ht->hasharray[MODPOW2(h, ht->lbnslots)];
+  while (*pp != NULL
+      && ((*pp)->hash != h || ht->compar(keyptr, (*pp)->keyptr) != 0)) {
     pp = &(*pp)->next;
   }
   return (cell **) pp;
 }
 
+//  hashtable__capacity : renvoie le nombre d'entrées maximal associé au seuil
+//    de la table de hachage associée à ht pour un tableau de hachage de
+//    longueur 2^lbm.
+static size_t hashtable__capacity(const hashtable *ht, size_t lbm) {
+  size_t m = POW2(lbm);
+  return m / ht->lddenom * ht->ldnumer
+    + m % ht->lddenom * ht->ldnumer / ht->lddenom;
+}
+
+//  hashtable__too_large : teste si un tableau de hachage de longueur 2^lbm
+//    ou le nombre d'entrées maximal associé au seuil de la table de hachage
+//    associée à ht excèdent les capacités de représentation.
+static bool hashtable__too_large(const hashtable *ht, size_t lbm) {
+  size_t m = POW2(lbm);
+  return m > SIZE_MAX / sizeof(void *)
+    || (ht->ldnumer > ht->lddenom
+      && m / ht->lddenom > SIZE_MAX / ht->ldnumer - 1);
+}
+
+//  hashtable__resizes : nombre total d'agrandissements des tables, y compris
+//    ceux de hashtable_reserve, toutes tables confondues, incrémenté de
+//    manière atomique puisque des tables distinctes peuvent être agrandies
+//    simultanément par plusieurs fils d'exécution.
+static atomic_size_t hashtable__resizes = 0;
+
+//  hashtable__migrate : si une migration est en cours pour la table de hachage
+//    associée à ht, répartit au plus n listes de l'ancien tableau dans le
+//    nouveau, de longueur double, puis libère l'ancien tableau si toutes l'ont
+//    été.
+static void hashtable__migrate(hashtable *ht, size_t n) {
+  if (ht->oldarray == NULL) {
+    return;
+  }
+  size_t m_ = POW2(ht->oldlbnslots);
+  for (; n > 0 && ht->migrated < m_; --n) {
+    size_t k = ht->migrated;
+    cell **pp_ = &ht->hasharray[k];
+    cell **pp = &ht->hasharray[k + m_];
+    for (cell *p = ht->oldarray[k]; p != NULL; p = p->next) {
+      if (MODPOW2(p->hash, ht->lbnslots) < m_) {
+        *pp_ = p;
+        pp_ = &p->next;
+      } else {
+        *pp = p;
+        pp = &p->next;
+      }
+    }
+    *pp_ = NULL;
+    *pp = NULL;
+    ht->oldarray[k] = NULL;
+    ht->migrated = k + 1;
+  }
+  if (ht->migrated == m_) {
+    free(ht->oldarray);
+    ht->oldarray = NULL;
+  }
+}
+
 //  hashtable__add_enlarge : initialise ou agrandit le tableau de hachage de la
 //    table de hachage associée à ht. Il est supposé que la valeur de
-//    nfreeentries est nulle. Renvoie une valeur non nulle en cas de dépassement
-//    de capacité. Renvoie sinon zéro.
+//    nfreeentries est nulle. Une éventuelle migration en cours est d'abord
+//    achevée ; une nouvelle migration commence si le composant step n'est pas
+//    nul. Renvoie une valeur non nulle en cas de dépassement de capacité.
+//    Renvoie sinon zéro.
 static int hashtable__add_enlarge(hashtable *ht) {
+  hashtable__migrate(ht, SIZE_MAX);
+  if (!HT__IS_BLANK(ht) && ht->step > 0) {
+    size_t lbm = ht->lbnslots + 1;
+    size_t m = POW2(lbm);
+    cell **a;
+    if (hashtable__too_large(ht, lbm)
+        || (a = malloc(m * sizeof(void *))) == NULL) {
+      return -1;
+    }
+    for (size_t k = 0; k < m; ++k) {
+      a[k] = NULL;
+    }
+    atomic_fetch_add_explicit(&hashtable__resizes, 1, memory_order_relaxed);
+    ht->oldarray = ht->hasharray;
+    ht->oldlbnslots = ht->lbnslots;
+    ht->migrated = 0;
+    ht->hasharray = a;
+    ht->lbnslots = lbm;
+    ht->nfreeentries = hashtable__capacity(ht, lbm)
+      - hashtable__capacity(ht, lbm - 1);
+    return 0;
+  }
   int b;
   size_t lbm;
   size_t m;
@@ -110,10 +242,7 @@ static int hashtable__add_enlarge(hashtable *ht) {
     m_ = HALF(m);
   }
   cell **a;
-  if (m > SIZE_MAX / sizeof(void *)
-      || (HT__LDFACT_MAX_NUMER > sizeof(void *)
-      && HT__LDFACT_MAX_NUMER > HT__LDFACT_MAX_DENOM
-      && m > SIZE_MAX / HT__LDFACT_MAX_NUMER * HT__LDFACT_MAX_DENOM)
+  if (hashtable__too_large(ht, lbm)
       || (a = realloc(ht->hasharray, m * sizeof(void *))) == NULL) {
     if (b) {
       HT__MAKE_BLANK(ht);
@@ -125,11 +254,12 @@ static int hashtable__add_enlarge(hashtable *ht) {
       a[k] = NULL;
     }
   } else {
+    atomic_fetch_add_explicit(&hashtable__resizes, 1, memory_order_relaxed);
     for (size_t k = 0; k < m_; ++k) {
       cell **pp_ = &a[k];
       cell **pp = &a[k + m_];
       while (*pp_ != NULL) {
-        if (MODPOW2(ht->hashfun((*pp_)->keyptr), lbm) < m_) {
+        if (MODPOW2((*pp_)->hash, lbm) < m_) {
           pp_ = &(*pp_)->next;
         } else {
           *pp = *pp_;
@@ -142,9 +272,23 @@ static int hashtable__add_enlarge(hashtable *ht) {
   }
   ht->hasharray = a;
   ht->lbnslots = lbm;
-  ht->nfreeentries
-    = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER
-      - m_ / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER;
+  ht->nfreeentries = hashtable__capacity(ht, lbm)
+    - (b ? 0 : hashtable__capacity(ht, lbm - 1));
+  return 0;
+}
+
+int hashtable_setup(size_t ldnumer, size_t lddenom) {
+  if (ldnumer == 0 || lddenom == 0 || ldnumer > SIZE_MAX / lddenom
+      || ldnumer <= (lddenom - 1) / POW2(HT__LBNSLOTS_MIN)) {
+    return -1;
+  }
+  hashtable__ldnumer = ldnumer;
+  hashtable__lddenom = lddenom;
+  return 0;
+}
+
+int hashtable_setup_incremental(size_t step) {
+  hashtable__step = step;
   return 0;
 }
 
@@ -154,21 +298,39 @@ hashtable *hashtable_empty(int (*compar)(const void *, const void *),
   if (ht == NULL) {
     return NULL;
   }
+  ht->cells = arena_empty();
+  if (ht->cells == NULL) {
+    free(ht);
+    return NULL;
+  }
+  ht->freecells = NULL;
   ht->compar = compar;
   ht->hashfun = hashfun;
   HT__MAKE_BLANK(ht);
   ht->null = NULL;
   ht->lbnslots = 0;
   ht->nfreeentries = 0;
+  ht->ldnumer = hashtable__ldnumer;
+  ht->lddenom = hashtable__lddenom;
+  ht->step = hashtable__step;
+  ht->oldarray = NULL;
+  ht->oldlbnslots = 0;
+  ht->migrated = 0;
   return ht;
 }
 
 const void *hashtable_add(hashtable *ht, const void *keyptr,
     const void *valptr) {
+  return hashtable_add_hashed(ht, keyptr, ht->hashfun(keyptr), valptr);
+}
+
+const void *hashtable_add_hashed(hashtable *ht, const void *keyptr, size_t h,
+    const void *valptr) {
   if (valptr == NULL) {
     return NULL;
   }
-  cell **pp = hashtable__search(ht, keyptr);
+  hashtable__migrate(ht, ht->step);
+  cell **pp = hashtable__search(ht, keyptr, h);
   if (*pp != NULL) {
     (*pp)->valptr = valptr;
   } else {
@@ -176,12 +338,16 @@ const void *hashtable_add(hashtable *ht, const void *keyptr,
       if (hashtable__add_enlarge(ht) != 0) {
         return NULL;
       }
-      pp = hashtable__search(ht, keyptr);
+      pp = hashtable__search(ht, keyptr, h);
     }
-    cell *p = malloc(sizeof *p);
-    if (p == NULL) {
+    cell *p = ht->freecells;
+    if (p != NULL) {
+      ht->freecells = p->next;
+    } else if ((p = arena_alloc(ht->cells, sizeof *p, _Alignof(cell)))
+        == NULL) {
       return NULL;
     }
+    p->hash = h;
     p->keyptr = keyptr;
     p->valptr = valptr;
     p->next = *pp;
@@ -192,39 +358,98 @@ const void *hashtable_add(hashtable *ht, const void *keyptr,
 }
 
 const void *hashtable_remove(hashtable *ht, const void *keyptr) {
-  cell **pp = hashtable__search(ht, keyptr);
+  cell **pp = hashtable__search(ht, keyptr, ht->hashfun(keyptr));
   if (*pp == NULL) {
     return NULL;
   }
   cell *p = *pp;
   const void *valptr = p->valptr;
   *pp = p->next;
-  free(p);
+  p->next = ht->freecells;
+  ht->freecells = p;
   ht->nfreeentries += 1;
   return valptr;
 }
 
 const void *hashtable_search(hashtable *ht, const void *keyptr) {
-  const cell *p = *hashtable__search(ht, keyptr);
+  return hashtable_search_hashed(ht, keyptr, ht->hashfun(keyptr));
+}
+
+const void *hashtable_search_hashed(hashtable *ht, const void *keyptr,
+    size_t h) {
+  hashtable__migrate(ht, ht->step);
+  const cell *p = *hashtable__search(ht, keyptr, h);
   return p == NULL ? NULL : p->valptr;
 }
 
+int hashtable_reserve(hashtable *ht, size_t n) {
+  hashtable__migrate(ht, SIZE_MAX);
+  bool b = HT__IS_BLANK(ht);
+  size_t lbm = b ? HT__LBNSLOTS_MIN : ht->lbnslots;
+  while (hashtable__capacity(ht, lbm) < n) {
+    ++lbm;
+    if (hashtable__too_large(ht, lbm)) {
+      return -1;
+    }
+  }
+  if (n == 0 || (!b && lbm == ht->lbnslots)) {
+    return 0;
+  }
+  size_t m = POW2(lbm);
+  cell **a = malloc(m * sizeof(void *));
+  if (a == NULL) {
+    return -1;
+  }
+  for (size_t k = 0; k < m; ++k) {
+    a[k] = NULL;
+  }
+  size_t count = 0;
+  if (!b) {
+    count = hashtable__capacity(ht, ht->lbnslots) - ht->nfreeentries;
+    //  Les cellules d'une même liste du nouveau tableau proviennent toutes de
+    //    la même liste de l'ancien : les ajouter en queue respecte leur ordre.
+    for (size_t k = 0; k < POW2(ht->lbnslots); ++k) {
+      cell *p = ht->hasharray[k];
+      while (p != NULL) {
+        cell *q = p->next;
+        cell **pp = &a[MODPOW2(p->hash, lbm)];
+        while (*pp != NULL) {
+          pp = &(*pp)->next;
+        }
+        p->next = NULL;
+        *pp = p;
+        p = q;
+      }
+    }
+    free(ht->hasharray);
+    atomic_fetch_add_explicit(&hashtable__resizes, 1, memory_order_relaxed);
+  }
+  ht->hasharray = a;
+  ht->lbnslots = lbm;
+  ht->nfreeentries = hashtable__capacity(ht, lbm) - count;
+  return 0;
+}
+
+size_t hashtable_footprint(const hashtable *ht) {
+  return sizeof *ht + arena_footprint(ht->cells)
+      + (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots) * sizeof *ht->hasharray)
+      + (ht->oldarray == NULL ? 0
+        : POW2(ht->oldlbnslots) * sizeof *ht->oldarray);
+}
+
+size_t hashtable_resizecount(void) {
+  return atomic_load_explicit(&hashtable__resizes, memory_order_relaxed);
+}
+
 void hashtable_dispose(hashtable **htptr) {
   if (*htptr == NULL) {
     return;
   }
   if (!HT__IS_BLANK(*htptr)) {
-    size_t m = POW2((*htptr)->lbnslots);
-    for (size_t k = 0; k < m; ++k) {
-      cell *p = (*htptr)->hasharray[k];
-      while (p != NULL) {
-        cell *t = p;
-        p = p->next;
-        free(t);
-      }
-    }
     free((*htptr)->hasharray);
   }
+  free((*htptr)->oldarray);
+  arena_dispose(&(*htptr)->cells);
   free(*htptr);
   *htptr = NULL;
 }
@@ -234,12 +459,19 @@ void hashtable_dispose(hashtable **htptr) {
 void hashtable_get_checkup(hashtable *ht,
     struct hashtable_checkup *htcuptr) {
   size_t m = (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots));
-  size_t n = m / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER - ht->nfreeentries;
+  size_t n = (HT__IS_BLANK(ht) ? 0
+      : hashtable__capacity(ht, ht->lbnslots) - ht->nfreeentries);
+  //  Les listes de l'ancien tableau qui restent à migrer suivent celles du
+  //    nouveau.
+  size_t m_ = (ht->oldarray == NULL ? 0 : POW2(ht->oldlbnslots));
   size_t g = 0;
   double s = 0.0;
-  for (size_t k = 0; k < m; ++k) {
+  for (size_t k = 0; k < m + m_; ++k) {
+    if (k >= m && k - m < ht->migrated) {
+      continue;
+    }
     size_t f = 0;
-    const cell *p = ht->hasharray[k];
+    const cell *p = k < m ? ht->hasharray[k] : ht->oldarray[k - m];
     while (p != NULL) {
       ++f;
       p = p->next;
@@ -253,11 +485,13 @@ void hashtable_get_checkup(hashtable *ht,
   *htcuptr = (struct hashtable_checkup) {
     .nslots = m,
     .nentries = n,
-    .ldfactmax = (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM,
+    .ldfactmax = (double) ht->ldnumer / (double) ht->lddenom,
     .ldfactcurr = r,
     .maxlen = g,
     .postheo = (n == 0 ? 0.0 : 1.0 + (r - 1.0 / (double) m) / 2.0),
     .poscurr = s / (double) n,
+    .oldnslots = m_,
+    .migrated = (ht->oldarray == NULL ? 0 : ht->migrated),
   };
 }
 
@@ -276,7 +510,9 @@ int hashtable_display_checkup(hashtable *ht, FILE *textstream) {
     || 0 > P_VALUE(textstream, "ld.fact.curr", "%lf", htcu.ldfactcurr)
     || 0 > P_VALUE(textstream, "max.len", "%zu", htcu.maxlen)
     || 0 > P_VALUE(textstream, "pos.theo", "%lf", htcu.postheo)
-    || 0 > P_VALUE(textstream, "pos.curr", "%lf", htcu.poscurr);
+    || 0 > P_VALUE(textstream, "pos.curr", "%lf", htcu.poscurr)
+    || 0 > P_VALUE(textstream, "old.slots", "%zu", htcu.oldnslots)
+    || 0 > P_VALUE(textstream, "migrated", "%zu", htcu.migrated);
 }
 
 #endif
@@ -1,5 +1,7 @@
 //  Interface polymorphe pour la spécification TABLE du TDA Table(T, T') dans le
-//    cas d'une table de hachage par chainage séparé.
+//    cas d'une table de hachage. Deux implantations en sont fournies : par
+//    chainage séparé (hashtable.c) et par adressage ouvert (hashtable_oa.c).
+//    Le choix se fait à la compilation, en liant l'une ou l'autre.
 
 #ifndef HASHTABLE__H
 #define HASHTABLE__H
@@ -32,6 +34,30 @@ typedef struct hashtable hashtable;
 //    hashtable_get_checkup et hashtable_display_checkup requiert la définition
 //    de la macroconstante HASHTABLE_CHECKUP.
 
+//  hashtable_setup : fixe à ldnumer / lddenom le seuil maximum du taux de
+//    remplissage des tables de hachage créées ensuite, au-delà duquel leur
+//    tableau de hachage est agrandi, en lieu et place du seuil par défaut de
+//    l'implantation. Le seuil d'une table de hachage est celui en vigueur à sa
+//    création. Doit être appelée avant le lancement de tout fil d'exécution.
+//    Renvoie une valeur non nulle si le seuil n'est pas accepté par
+//    l'implantation : il doit être strictement positif pour le chainage séparé,
+//    strictement compris entre 0 et 1 pour l'adressage ouvert, et permettre au
+//    plus petit tableau de hachage de compter au moins une entrée. Le seuil en
+//    vigueur reste alors inchangé. Renvoie sinon zéro.
+extern int hashtable_setup(size_t ldnumer, size_t lddenom);
+
+//  hashtable_setup_incremental : si step n'est pas nul, fait que les tables de
+//    hachage créées ensuite soient agrandies de manière incrémentale : l'ancien
+//    tableau de hachage coexiste avec le nouveau, et step de ses compartiments
+//    au plus sont migrés à chaque ajout et à chaque recherche, au lieu de
+//    l'être tous lors de l'ajout qui déclenche l'agrandissement. Si step est
+//    nul, elles sont agrandies en une fois, comme par défaut. Doit être
+//    appelée avant le lancement de tout fil d'exécution. Renvoie une valeur
+//    non nulle si l'implantation ne prend pas en charge le mode demandé, seul
+//    le chainage séparé prenant en charge l'agrandissement incrémental.
+//    Renvoie sinon zéro.
+extern int hashtable_setup_incremental(size_t step);
+
 //  hashtable_empty : crée une structure de données correspondant initialement
 //    à la table de hachage vide. La fonction de comparaison des clés est
 //    compar et leur fonction de pré-hachage, hashfun. Renvoie NULL en cas de
@@ -49,6 +75,16 @@ extern hashtable *hashtable_empty(int (*compar)(const void *, const void *),
 extern const void *hashtable_add(hashtable *ht, const void *keyptr,
     const void *valptr);
 
+//  hashtable_add_hashed, hashtable_search_hashed : ont respectivement le même
+//    comportement que hashtable_add et hashtable_search, la valeur de la
+//    fonction de pré-hachage pour la clé d'adresse keyptr étant fournie par h
+//    au lieu d'être calculée. Le comportement est indéterminé si h n'est pas
+//    égal à hashfun(keyptr).
+extern const void *hashtable_add_hashed(hashtable *ht, const void *keyptr,
+    size_t h, const void *valptr);
+extern const void *hashtable_search_hashed(hashtable *ht, const void *keyptr,
+    size_t h);
+
 //  hashtable_remove : recherche dans la table de hachage associée à ht une clé
 //    égale à celle d'adresse keyptr au sens de compar. Si un telle clé existe,
 //    retire le couple (ekeyptr, evalptr) de la structure, où ekeyptr est
@@ -63,6 +99,22 @@ extern const void *hashtable_remove(hashtable *ht, const void *keyptr);
 //    correspondant à la clé trouvée.
 extern const void *hashtable_search(hashtable *ht, const void *keyptr);
 
+//  hashtable_reserve : dimensionne le tableau de hachage de la table de hachage
+//    associée à ht pour que n entrées au moins y tiennent sans qu'il ait à être
+//    agrandi. Le tableau de hachage n'est jamais réduit. Renvoie une valeur non
+//    nulle en cas de dépassement de capacité, la table de hachage restant alors
+//    inchangée. Renvoie sinon zéro.
+extern int hashtable_reserve(hashtable *ht, size_t n);
+
+//  hashtable_footprint : renvoie le nombre d'octets obtenus du système par la
+//    table de hachage associée à ht, hors clés et valeurs.
+extern size_t hashtable_footprint(const hashtable *ht);
+
+//  hashtable_resizecount : renvoie le nombre total d'agrandissements de leur
+//    tableau de hachage effectués jusque-là par l'ensemble des tables de
+//    hachage. Peut être appelée simultanément à toute autre fonction.
+extern size_t hashtable_resizecount(void);
+
 //  hashtable_dispose : si *htptr ne vaut pas NULL, libère les ressources
 //    allouées à la structure de données associée à *htptr puis affecte à *htptr
 //    la valeur NULL.
@@ -84,6 +136,10 @@ struct hashtable_checkup {
                       //    d'une recherche positive
   double poscurr;     //  nombre moyen courant de comparaisons dans le cas d'une
                       //    recherche positive
+  size_t oldnslots;   //  nombre de compartiments de l'ancien tableau en cours
+                      //    de migration, zéro hors migration
+  size_t migrated;    //  nombre de compartiments de l'ancien tableau déjà
+                      //    migrés
 };
 
 //  hashtable_get_checkup : effectue un bilan de santé pour la table de hachage
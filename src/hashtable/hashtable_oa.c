@@ -0,0 +1,367 @@
+//  Implantation polymorphe pour la spécification TABLE du TDA Table(T, T') dans
+//    le cas d'une table de hachage par adressage ouvert et sondage linéaire.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "hashtable.h"
+
+//  Le nombre de compartiments du tableau de hachage est une puissance de 2. Il
+//    vaut initialement 2^HT__LBNSLOTS_MIN. Dès le taux de remplissage de la
+//    table de hachage est strictement supérieur à son seuil maximum, qui vaut
+//    par défaut (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM
+//    et peut être fixé par hashtable_setup, le nombre de compartiments est
+//    multiplié par 2. Le seuil maximum reste strictement inférieur à 1.0 : un
+//    compartiment libre au moins termine tout sondage.
+
+#define HT__LBNSLOTS_MIN      6
+#define HT__LDFACT_MAX_NUMER  3
+#define HT__LDFACT_MAX_DENOM  4
+
+//  Les définitions précédentes vont pour un nombre de compartiments initial de
+//    64 et un seuil maximum de 0.75 ; ces définitions peuvent être modifiées
+//    tant que le seuil reste strictement inférieur à 1.0. Les directives qui
+//    suivent s'assurent de leur cohérence ; ces directives ne doivent pas être
+//    modifiées.
+
+#define HT__NSLOTS_MIN \
+  (1ULL << HT__LBNSLOTS_MIN)
+#define HT__NENTRIESMAX_MIN \
+  (HT__NSLOTS_MIN / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER)
+
+#if HT__LBNSLOTS_MIN < 0                                                       \
+  || HT__LDFACT_MAX_NUMER < 0                                                  \
+  || HT__LDFACT_MAX_DENOM < 1                                                  \
+  || HT__LDFACT_MAX_NUMER >= HT__LDFACT_MAX_DENOM                              \
+  || HT__NSLOTS_MIN == 0                                                       \
+  || HT__NSLOTS_MIN > SIZE_MAX                                                 \
+  || HT__NENTRIESMAX_MIN == 0
+#error Bad choice of HT__ constants.
+#endif
+
+#undef HT__NSLOTS_MIN
+#undef HT__NENTRIESMAX_MIN
+
+//  hashtable__ldnumer, hashtable__lddenom : numérateur et dénominateur du
+//    seuil maximum des tables de hachage créées ensuite, fixés par
+//    hashtable_setup.
+static size_t hashtable__ldnumer = HT__LDFACT_MAX_NUMER;
+static size_t hashtable__lddenom = HT__LDFACT_MAX_DENOM;
+
+//  struct hashtable, hashtable : gestion de l'adressage ouvert par un tableau
+//    de compartiments contigus. Chaque compartiment mémorise, outre les
+//    adresses de la clé et de la valeur, la valeur complète de la fonction de
+//    pré-hachage pour la clé : lors d'une recherche, la fonction compar n'est
+//    appelée que sur les compartiments dont cette valeur coïncide avec celle de
+//    la clé recherchée, et les agrandissements se font sans rappeler hashfun.
+//    Un compartiment est libre si et seulement si l'adresse de sa valeur vaut
+//    NULL. Le tableau de hachage est alloué dynamiquement ; son adresse et le
+//    logarithme binaire de sa longueur sont mémorisés par les composants
+//    slots et lbnslots. Le composant nfreeentries mémorise le nombre d'entrées
+//    libres avant le prochain agrandissement. Tant que le tableau de hachage
+//    n'a pas été alloué, la valeur de slots est l'adresse du champ null, qui
+//    est un compartiment libre : la fonction de recherche locale
+//    hashtable__search est ainsi toujours définie. Les composants ldnumer et
+//    lddenom mémorisent le seuil maximum de la table de hachage, fixé à sa
+//    création.
+
+//  Les retraits sont réalisés par décalage arrière des compartiments qui
+//    suivent : aucun compartiment « supprimé » n'est jamais laissé dans le
+//    tableau.
+
+typedef struct slot slot;
+
+struct slot {
+  size_t hash;
+  const void *keyptr;
+  const void *valptr;
+};
+
+struct hashtable {
+  int (*compar)(const void *, const void *);
+  size_t (*hashfun)(const void *);
+  slot *slots;
+  slot null;
+  size_t lbnslots;
+  size_t nfreeentries;
+  size_t ldnumer;
+  size_t lddenom;
+};
+
+#define HT__MAKE_BLANK(ht)  ((ht)->slots = &(ht)->null, (ht)->lbnslots = 0)
+#define HT__IS_BLANK(ht)    ((ht)->slots == &(ht)->null)
+
+#define POW2(p)       ((size_t) 1 << (p))
+#define MODPOW2(m, p) ((m) & (POW2(p) - 1))
+
+//  hashtable__search : recherche dans la table de hachage associé à ht une clé
+//    égale à celle d'adresse keyptr, de valeur de pré-hachage h, au sens de
+//    compar. Renvoie l'adresse du compartiment qui contient cette occurrence si
+//    elle existe. Renvoie sinon l'adresse du premier compartiment libre
+//    rencontré.
+static slot *hashtable__search(const hashtable *ht, const void *keyptr,
+    size_t h) {
+  size_t k = MODPOW2(h, ht->lbnslots);
+  slot *p = &ht->slots[k];
+  while (p->valptr != NULL
+      && (p->hash != h || ht->compar(keyptr, p->keyptr) != 0)) {
+    k = MODPOW2(k + 1, ht->lbnslots);
+    p = &ht->slots[k];
+  }
+  return p;
+}
+
+//  hashtable__capacity : renvoie le nombre d'entrées maximal associé au seuil
+//    de la table de hachage associée à ht pour un tableau de hachage de
+//    longueur 2^lbm.
+static size_t hashtable__capacity(const hashtable *ht, size_t lbm) {
+  size_t m = POW2(lbm);
+  return m / ht->lddenom * ht->ldnumer
+    + m % ht->lddenom * ht->ldnumer / ht->lddenom;
+}
+
+//  hashtable__resizes : nombre total d'agrandissements des tables, y compris
+//    ceux de hashtable_reserve, toutes tables confondues, incrémenté de
+//    manière atomique puisque des tables distinctes peuvent être agrandies
+//    simultanément par plusieurs fils d'exécution.
+static atomic_size_t hashtable__resizes = 0;
+
+//  hashtable__rehash : remplace le tableau de hachage, éventuellement non
+//    encore alloué, de la table de hachage associée à ht par un tableau de
+//    longueur 2^lbm dans lequel ses entrées sont réinsérées. Il est supposé que
+//    le nombre d'entrées maximal associé au seuil pour ce tableau est au moins
+//    égal au nombre d'entrées. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité, la table restant alors inchangée. Renvoie sinon
+//    zéro.
+static int hashtable__rehash(hashtable *ht, size_t lbm) {
+  size_t m = POW2(lbm);
+  size_t m_ = HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots);
+  size_t n = HT__IS_BLANK(ht) ? 0
+      : hashtable__capacity(ht, ht->lbnslots) - ht->nfreeentries;
+  slot *a;
+  if (m > SIZE_MAX / sizeof(slot)
+      || (a = malloc(m * sizeof(slot))) == NULL) {
+    return -1;
+  }
+  for (size_t k = 0; k < m; ++k) {
+    a[k].valptr = NULL;
+  }
+  for (size_t k = 0; k < m_; ++k) {
+    const slot *p = &ht->slots[k];
+    if (p->valptr != NULL) {
+      size_t j = MODPOW2(p->hash, lbm);
+      while (a[j].valptr != NULL) {
+        j = MODPOW2(j + 1, lbm);
+      }
+      a[j] = *p;
+    }
+  }
+  if (!HT__IS_BLANK(ht)) {
+    free(ht->slots);
+    atomic_fetch_add_explicit(&hashtable__resizes, 1, memory_order_relaxed);
+  }
+  ht->slots = a;
+  ht->lbnslots = lbm;
+  ht->nfreeentries = hashtable__capacity(ht, lbm) - n;
+  return 0;
+}
+
+//  hashtable__add_enlarge : initialise ou agrandit le tableau de hachage de la
+//    table de hachage associée à ht. Il est supposé que la valeur de
+//    nfreeentries est nulle. Renvoie une valeur non nulle en cas de dépassement
+//    de capacité. Renvoie sinon zéro.
+static int hashtable__add_enlarge(hashtable *ht) {
+  return hashtable__rehash(ht,
+      HT__IS_BLANK(ht) ? HT__LBNSLOTS_MIN : ht->lbnslots + 1);
+}
+
+int hashtable_setup(size_t ldnumer, size_t lddenom) {
+  if (ldnumer == 0 || ldnumer >= lddenom || ldnumer > SIZE_MAX / lddenom
+      || ldnumer <= (lddenom - 1) / POW2(HT__LBNSLOTS_MIN)) {
+    return -1;
+  }
+  hashtable__ldnumer = ldnumer;
+  hashtable__lddenom = lddenom;
+  return 0;
+}
+
+int hashtable_setup_incremental(size_t step) {
+  //  Le sondage linéaire de deux tableaux à la fois n'est pas pris en charge.
+  return step == 0 ? 0 : -1;
+}
+
+hashtable *hashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *)) {
+  hashtable *ht = malloc(sizeof *ht);
+  if (ht == NULL) {
+    return NULL;
+  }
+  ht->compar = compar;
+  ht->hashfun = hashfun;
+  ht->null.valptr = NULL;
+  HT__MAKE_BLANK(ht);
+  ht->nfreeentries = 0;
+  ht->ldnumer = hashtable__ldnumer;
+  ht->lddenom = hashtable__lddenom;
+  return ht;
+}
+
+const void *hashtable_add(hashtable *ht, const void *keyptr,
+    const void *valptr) {
+  return hashtable_add_hashed(ht, keyptr, ht->hashfun(keyptr), valptr);
+}
+
+const void *hashtable_add_hashed(hashtable *ht, const void *keyptr, size_t h,
+    const void *valptr) {
+  if (valptr == NULL) {
+    return NULL;
+  }
+  slot *p = hashtable__search(ht, keyptr, h);
+  if (p->valptr != NULL) {
+    p->valptr = valptr;
+  } else {
+    if (ht->nfreeentries == 0) {
+      if (hashtable__add_enlarge(ht) != 0) {
+        return NULL;
+      }
+      p = hashtable__search(ht, keyptr, h);
+    }
+    p->hash = h;
+    p->keyptr = keyptr;
+    p->valptr = valptr;
+    ht->nfreeentries -= 1;
+  }
+  return valptr;
+}
+
+const void *hashtable_remove(hashtable *ht, const void *keyptr) {
+  slot *p = hashtable__search(ht, keyptr, ht->hashfun(keyptr));
+  if (p->valptr == NULL) {
+    return NULL;
+  }
+  const void *valptr = p->valptr;
+  //  Décalage arrière : tout compartiment qui suit le trou, jusqu'au prochain
+  //    compartiment libre, est ramené dans le trou si ce dernier se trouve sur
+  //    son chemin de sondage, c'est-à-dire entre son compartiment d'origine et
+  //    lui-même.
+  size_t i = (size_t) (p - ht->slots);
+  size_t j = i;
+  for (;;) {
+    j = MODPOW2(j + 1, ht->lbnslots);
+    slot *q = &ht->slots[j];
+    if (q->valptr == NULL) {
+      break;
+    }
+    size_t k = MODPOW2(q->hash, ht->lbnslots);
+    if (MODPOW2(j - k, ht->lbnslots) >= MODPOW2(j - i, ht->lbnslots)) {
+      ht->slots[i] = *q;
+      i = j;
+    }
+  }
+  ht->slots[i].valptr = NULL;
+  ht->nfreeentries += 1;
+  return valptr;
+}
+
+const void *hashtable_search(hashtable *ht, const void *keyptr) {
+  return hashtable_search_hashed(ht, keyptr, ht->hashfun(keyptr));
+}
+
+const void *hashtable_search_hashed(hashtable *ht, const void *keyptr,
+    size_t h) {
+  return hashtable__search(ht, keyptr, h)->valptr;
+}
+
+int hashtable_reserve(hashtable *ht, size_t n) {
+  size_t lbm = HT__IS_BLANK(ht) ? HT__LBNSLOTS_MIN : ht->lbnslots;
+  while (hashtable__capacity(ht, lbm) < n) {
+    ++lbm;
+    if (POW2(lbm) > SIZE_MAX / sizeof(slot)) {
+      return -1;
+    }
+  }
+  if (n == 0 || (!HT__IS_BLANK(ht) && lbm == ht->lbnslots)) {
+    return 0;
+  }
+  return hashtable__rehash(ht, lbm);
+}
+
+size_t hashtable_footprint(const hashtable *ht) {
+  return sizeof *ht
+      + (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots) * sizeof *ht->slots);
+}
+
+size_t hashtable_resizecount(void) {
+  return atomic_load_explicit(&hashtable__resizes, memory_order_relaxed);
+}
+
+void hashtable_dispose(hashtable **htptr) {
+  if (*htptr == NULL) {
+    return;
+  }
+  if (!HT__IS_BLANK(*htptr)) {
+    free((*htptr)->slots);
+  }
+  free(*htptr);
+  *htptr = NULL;
+}
+
+#ifdef HASHTABLE_CHECKUP
+
+//  Pour l'adressage ouvert, le composant maxlen de struct hashtable_checkup
+//    désigne la longueur maximale d'une séquence de sondage réussie, et les
+//    composants postheo et poscurr le nombre moyen de compartiments consultés
+//    lors d'une recherche positive : 1/2 (1 + 1 / (1 - r)) en théorie pour un
+//    sondage linéaire de taux de remplissage r.
+
+void hashtable_get_checkup(hashtable *ht,
+    struct hashtable_checkup *htcuptr) {
+  size_t m = (HT__IS_BLANK(ht) ? 0 : POW2(ht->lbnslots));
+  size_t n = (HT__IS_BLANK(ht) ? 0
+      : hashtable__capacity(ht, ht->lbnslots) - ht->nfreeentries);
+  size_t g = 0;
+  double s = 0.0;
+  for (size_t k = 0; k < m; ++k) {
+    const slot *p = &ht->slots[k];
+    if (p->valptr != NULL) {
+      size_t f = MODPOW2(k - MODPOW2(p->hash, ht->lbnslots), ht->lbnslots) + 1;
+      if (f > g) {
+        g = f;
+      }
+      s += (double) f;
+    }
+  }
+  double r = (double) n / (double) m;
+  *htcuptr = (struct hashtable_checkup) {
+    .nslots = m,
+    .nentries = n,
+    .ldfactmax = (double) ht->ldnumer / (double) ht->lddenom,
+    .ldfactcurr = r,
+    .maxlen = g,
+    .postheo = (n == 0 ? 0.0 : (1.0 + 1.0 / (1.0 - r)) / 2.0),
+    .poscurr = s / (double) n,
+    .oldnslots = 0,
+    .migrated = 0,
+  };
+}
+
+#define P_TITLE(textstream, name) \
+  fprintf(textstream, "--- Info: %s\n", name)
+#define P_VALUE(textstream, name, format, value) \
+  fprintf(textstream, "%12s\t" format "\n", name, value)
+
+int hashtable_display_checkup(hashtable *ht, FILE *textstream) {
+  struct hashtable_checkup htcu;
+  hashtable_get_checkup(ht, &htcu);
+  return 0 > P_TITLE(textstream, "Hashtable checkup (open addressing)")
+    || 0 > P_VALUE(textstream, "n.slots", "%zu", htcu.nslots)
+    || 0 > P_VALUE(textstream, "n.entries", "%zu", htcu.nentries)
+    || 0 > P_VALUE(textstream, "ld.fact.max", "%lf", htcu.ldfactmax)
+    || 0 > P_VALUE(textstream, "ld.fact.curr", "%lf", htcu.ldfactcurr)
+    || 0 > P_VALUE(textstream, "max.len", "%zu", htcu.maxlen)
+    || 0 > P_VALUE(textstream, "pos.theo", "%lf", htcu.postheo)
+    || 0 > P_VALUE(textstream, "pos.curr", "%lf", htcu.poscurr)
+    || 0 > P_VALUE(textstream, "old.slots", "%zu", htcu.oldnslots)
+    || 0 > P_VALUE(textstream, "migrated", "%zu", htcu.migrated);
+}
+
+#endif
@@ -1,57 +1,75 @@
 //  Partie implantation du module holdall.
 
+#include <stdint.h>
+#include <string.h>
 #include "holdall.h"
 
-//  struct holdall, holdall : implantation par liste dynamique simplement
-//    chainée. L'insertion a lieu en queue si la macroconstante
-//    HOLDALL_INSERT_TAIL est définie, en tête sinon.
+//  struct holdall, holdall : implantation par tableau dynamique contigu. Le
+//    composant array pointe sur un tableau de capacity adresses dont les count
+//    premières sont celles ajoutées au fourretout, dans l'ordre des ajouts. Si
+//    la macroconstante HOLDALL_INSERT_TAIL est définie, les parcours suivent
+//    cet ordre ; sinon, ils le suivent à rebours, comme si l'insertion avait eu
+//    lieu en tête.
 
-typedef struct choldall choldall;
-
-struct choldall {
-  void *value;
-  choldall *next;
+struct holdall {
+  void **array;
+  size_t count;
+  size_t capacity;
 };
 
-struct holdall {
-  choldall *head;
+//  HOLDALL__CAPACITY_MIN : capacité du tableau lors du premier ajout. La
+//    capacité est ensuite doublée à chaque fois que le tableau est plein.
+#define HOLDALL__CAPACITY_MIN 64
+
+//  HOLDALL__PREFETCH, HOLDALL__PREFETCH_DIST : lors des parcours, l'objet
+//    pointé par l'adresse située HOLDALL__PREFETCH_DIST rangs plus loin est
+//    préchargé dans le cache pendant le traitement de l'adresse courante.
+#define HOLDALL__PREFETCH_DIST 8
+#ifdef __GNUC__
+#define HOLDALL__PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HOLDALL__PREFETCH(p) ((void) (p))
+#endif
+
+//  HOLDALL__FOREACH : parcourt les indices k du tableau du fourretout associé
+//    à ha dans l'ordre des parcours, en préchargeant l'objet pointé par
+//    l'adresse qui sera traitée HOLDALL__PREFETCH_DIST rangs plus loin.
 #ifdef HOLDALL_INSERT_TAIL
-  choldall *tail;
+#define HOLDALL__FOREACH(ha, k)                                                \
+  for (size_t k = 0; k < (ha)->count                                           \
+      && (k + HOLDALL__PREFETCH_DIST >= (ha)->count                            \
+        || (HOLDALL__PREFETCH((ha)->array[k + HOLDALL__PREFETCH_DIST]), 1));   \
+      ++k)
+#else
+#define HOLDALL__FOREACH(ha, k)                                                \
+  for (size_t k = (ha)->count; k-- > 0                                         \
+      && (k < HOLDALL__PREFETCH_DIST                                           \
+        || (HOLDALL__PREFETCH((ha)->array[k - HOLDALL__PREFETCH_DIST]), 1));)
 #endif
-  size_t count;
-};
 
 holdall *holdall_empty(void) {
   holdall *ha = malloc(sizeof *ha);
   if (ha == NULL) {
     return NULL;
   }
-  ha->head = NULL;
-#ifdef HOLDALL_INSERT_TAIL
-  ha->tail = NULL;
-#endif
+  ha->array = NULL;
   ha->count = 0;
+  ha->capacity = 0;
   return ha;
 }
 
 int holdall_put(holdall *ha, void *ptr) {
-  choldall *p = malloc(sizeof *p);
-  if (p == NULL) {
-    return -1;
-  }
-  p->value = ptr;
-#ifdef HOLDALL_INSERT_TAIL
-  p->next = NULL;
-  if (ha->tail == NULL) {
-    ha->head = p;
-  } else {
-    ha->tail->next = p;
+  if (ha->count == ha->capacity) {
+    size_t m = ha->capacity == 0 ? HOLDALL__CAPACITY_MIN : 2 * ha->capacity;
+    void **a;
+    if (m > SIZE_MAX / 2 / sizeof *a
+        || (a = realloc(ha->array, m * sizeof *a)) == NULL) {
+      return -1;
+    }
+    ha->array = a;
+    ha->capacity = m;
   }
-  ha->tail = p;
-#else
-  p->next = ha->head;
-  ha->head = p;
-#endif
+  ha->array[ha->count] = ptr;
   ha->count += 1;
   return 0;
 }
@@ -60,9 +78,25 @@ size_t holdall_count(holdall *ha) {
   return ha->count;
 }
 
+size_t holdall_footprint(holdall *ha) {
+  return sizeof *ha + ha->capacity * sizeof *ha->array;
+}
+
+void *holdall_at(holdall *ha, size_t k) {
+#ifdef HOLDALL_INSERT_TAIL
+  return ha->array[k];
+#else
+  return ha->array[ha->count - 1 - k];
+#endif
+}
+
+void *holdall_at_added(holdall *ha, size_t k) {
+  return ha->array[k];
+}
+
 int holdall_apply(holdall *ha, int (*fun)(void *)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun(p->value);
+  HOLDALL__FOREACH(ha, k) {
+    int r = fun(ha->array[k]);
     if (r != 0) {
       return r;
     }
@@ -73,8 +107,8 @@ int holdall_apply(holdall *ha, int (*fun)(void *)) {
 int holdall_apply_context(holdall *ha,
     void *context, void *(*fun1)(void *context, void *ptr),
     int (*fun2)(void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun2(p->value, fun1(context, p->value));
+  HOLDALL__FOREACH(ha, k) {
+    int r = fun2(ha->array[k], fun1(context, ha->array[k]));
     if (r != 0) {
       return r;
     }
@@ -85,8 +119,8 @@ int holdall_apply_context(holdall *ha,
 int holdall_apply_context2(holdall *ha,
     void *context1, void *(*fun1)(void *context1, void *ptr),
     void *context2, int (*fun2)(void *context2, void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != NULL; p = p->next) {
-    int r = fun2(context2, p->value, fun1(context1, p->value));
+  HOLDALL__FOREACH(ha, k) {
+    int r = fun2(context2, ha->array[k], fun1(context1, ha->array[k]));
     if (r != 0) {
       return r;
     }
@@ -98,86 +132,198 @@ void holdall_dispose(holdall **haptr) {
   if (*haptr == NULL) {
     return;
   }
-  choldall *p = (*haptr)->head;
-  while (p != NULL) {
-    choldall *t = p;
-    p = p->next;
-    free(t);
-  }
+  free((*haptr)->array);
   free(*haptr);
   *haptr = NULL;
 }
 
-//  choldall__split : divise la liste chainée pointée par cha en deux listes de
-//    taille à peu près égales. Si |cha| est impair, alors la première liste
-//    contiendra un élément de plus que la seconde. *frontptr se voit affectée
-//    la première moitié, et *backptr la seconde moitié de la liste séparée.
-//    Si la liste ne contient qu'un seul élément, alors celui-ci sera affecté
-//    à la première moitié, et la seconde sera vide.
-static void choldall__split(choldall *cha,
-    choldall **frontptr, choldall **backptr) {
-  if (cha == NULL || cha->next == NULL) {
-    *frontptr = cha;
-    *backptr = NULL;
-    return;
+//  Le tri est un tri fusion ascendant, donc stable et sans récursivité : des
+//    segments de HOLDALL__RUN adresses sont d'abord triés par insertion, puis
+//    fusionnés deux à deux en alternant entre le tableau et un tableau
+//    auxiliaire de même longueur. Si les parcours ont lieu à rebours du
+//    tableau, celui-ci est trié dans l'ordre décroissant, ce qui revient à
+//    trier dans l'ordre croissant la suite parcourue tout en préservant
+//    l'ordre relatif des adresses égales.
+
+#define HOLDALL__RUN 32
+
+//  HOLDALL__LE : détermine si x doit précéder ou peut précéder y dans le
+//    tableau lorsque x se trouve avant y, selon compar et le sens dir du tri.
+#define HOLDALL__LE(compar, dir, x, y) \
+  ((dir) > 0 ? (compar)((x), (y)) <= 0 : (compar)((y), (x)) <= 0)
+
+//  holdall__insertion_sort : trie par insertion les n adresses du tableau
+//    pointé par a selon compar et le sens dir.
+static void holdall__insertion_sort(void **a, size_t n,
+    int (*compar)(const void *, const void *), int dir) {
+  for (size_t i = 1; i < n; ++i) {
+    void *x = a[i];
+    size_t j = i;
+    while (j > 0 && !HOLDALL__LE(compar, dir, a[j - 1], x)) {
+      a[j] = a[j - 1];
+      --j;
+    }
+    a[j] = x;
+  }
+}
+
+//  holdall__merge : fusionne dans le tableau pointé par d les segments triés
+//    s[0..m[ et s[m..n[ selon compar et le sens dir.
+static void holdall__merge(void **d, void * const *s, size_t m, size_t n,
+    int (*compar)(const void *, const void *), int dir) {
+  size_t i = 0;
+  size_t j = m;
+  size_t k = 0;
+  while (i < m && j < n) {
+    d[k++] = HOLDALL__LE(compar, dir, s[i], s[j]) ? s[i++] : s[j++];
+  }
+  while (i < m) {
+    d[k++] = s[i++];
   }
-  choldall *s = cha;
-  choldall *f = cha->next;
-  while (f != NULL) {
-    f = f->next;
-    if (f != NULL) {
-      s = s->next;
-      f = f->next;
+  while (j < n) {
+    d[k++] = s[j++];
+  }
+}
+
+//  holdall__sort : trie les n adresses du tableau pointé par a selon compar et
+//    le sens dir, en utilisant le tableau auxiliaire de même longueur pointé
+//    par t. Renvoie l'adresse de celui des deux tableaux qui contient le
+//    résultat.
+static void **holdall__sort(void **a, void **t, size_t n,
+    int (*compar)(const void *, const void *), int dir) {
+  for (size_t k = 0; k < n; k += HOLDALL__RUN) {
+    holdall__insertion_sort(a + k,
+        n - k < HOLDALL__RUN ? n - k : HOLDALL__RUN, compar, dir);
+  }
+  void **s = a;
+  void **d = t;
+  for (size_t w = HOLDALL__RUN; w < n; w *= 2) {
+    for (size_t k = 0; k < n; k += 2 * w) {
+      size_t m = n - k < w ? n - k : w;
+      size_t e = n - k < 2 * w ? n - k : 2 * w;
+      holdall__merge(d + k, s + k, m, e, compar, dir);
     }
+    void **u = s;
+    s = d;
+    d = u;
   }
-  *frontptr = cha;
-  *backptr = s->next;
-  s->next = NULL;
+  return s;
 }
 
-//  choldall__merge : fusionne les listes chainées pointées par a et b et
-//    affecte à *dest la liste résultante de la fusion. L'insertion est
-//    déterminée par le résultat de la fonction pointée par compar sur les
-//    têtes des listes a et b.
-static void choldall__merge(choldall *a, choldall *b,
-    choldall **dest,
-    int (*compar)(const void *, const void *)) {
-  if (a == NULL) {
-    *dest = b;
-    return;
+#ifdef HOLDALL_INSERT_TAIL
+#define HOLDALL__DIR 1
+#else
+#define HOLDALL__DIR -1
+#endif
+
+int holdall_sort(holdall *ha, int (*compar)(const void *, const void *)) {
+  size_t n = ha->count;
+  void **t = NULL;
+  if (n > HOLDALL__RUN && (t = malloc(ha->capacity * sizeof *t)) == NULL) {
+    return -1;
   }
-  if (b == NULL) {
-    *dest = a;
-    return;
+  void **s = holdall__sort(ha->array, t, n, compar, HOLDALL__DIR);
+  if (s != ha->array) {
+    t = ha->array;
+    ha->array = s;
   }
-  if (compar(a->value, b->value) <= 0) {
-    *dest = a;
-    choldall__merge(a->next, b, &(*dest)->next, compar);
-  } else {
-    *dest = b;
-    choldall__merge(a, b->next, &(*dest)->next, compar);
+  free(t);
+  return 0;
+}
+
+//  La sélection est réalisée en deux passes sur le tableau. La première
+//    détermine, à l'aide d'un tas maximum de k adresses, la plus grande des k
+//    plus petites adresses au sens de compar : une adresse n'est comparée qu'au
+//    sommet du tas, sauf si elle lui est inférieure. La seconde regroupe du
+//    côté du début des parcours les adresses qui ne lui sont pas supérieures ou
+//    qui lui sont équivalentes. Seules ces adresses sont ensuite triées.
+
+//  holdall__sift_down : rétablit la propriété de tas maximum selon compar du
+//    tas de n adresses pointé par h dont seul le sommet est éventuellement mal
+//    placé.
+static void holdall__sift_down(void **h, size_t n,
+    int (*compar)(const void *, const void *)) {
+  size_t i = 0;
+  void *x = h[0];
+  for (;;) {
+    size_t j = 2 * i + 1;
+    if (j >= n) {
+      break;
+    }
+    if (j + 1 < n && compar(h[j + 1], h[j]) > 0) {
+      ++j;
+    }
+    if (compar(h[j], x) <= 0) {
+      break;
+    }
+    h[i] = h[j];
+    i = j;
   }
+  h[i] = x;
 }
 
-//  choldall__sort : trie la liste chainée pointée par *chaptr selon la méthode
-//    du tri fusion et à l'aide de la fonction de comparaison pointée par
-//    compar.
-static void choldall__sort(choldall **chaptr,
+//  holdall__sift_up : rétablit la propriété de tas maximum selon compar du tas
+//    de n adresses pointé par h dont seule la dernière adresse est
+//    éventuellement mal placée.
+static void holdall__sift_up(void **h, size_t n,
     int (*compar)(const void *, const void *)) {
-  if (*chaptr == NULL || (*chaptr)->next == NULL) {
-    return;
+  size_t i = n - 1;
+  void *x = h[i];
+  while (i > 0 && compar(h[(i - 1) / 2], x) < 0) {
+    h[i] = h[(i - 1) / 2];
+    i = (i - 1) / 2;
   }
-  choldall *a;
-  choldall *b;
-  choldall__split(*chaptr, &a, &b);
-  choldall__sort(&a, compar);
-  choldall__sort(&b, compar);
-  choldall__merge(a, b, chaptr, compar);
+  h[i] = x;
 }
 
-int holdall_sort(holdall *ha, int (*compar)(const void *, const void *)) {
-  if (ha->count > 1) {
-    choldall__sort(&(ha->head), compar);
+int holdall_sort_top(holdall *ha, size_t k,
+    int (*compar)(const void *, const void *),
+    int (*equiv)(const void *, const void *)) {
+  size_t n = ha->count;
+  if (k == 0 || k >= n) {
+    return holdall_sort(ha, compar);
+  }
+  void **h = malloc(k * sizeof *h);
+  if (h == NULL) {
+    return -1;
+  }
+  size_t m = 0;
+  for (size_t i = 0; i < n; ++i) {
+    void *x = ha->array[i];
+    if (m < k) {
+      h[m] = x;
+      ++m;
+      holdall__sift_up(h, m, compar);
+    } else if (compar(x, h[0]) < 0) {
+      h[0] = x;
+      holdall__sift_down(h, m, compar);
+    }
+  }
+  void *top = h[0];
+  free(h);
+  //  Les adresses retenues sont échangées vers le début du tableau, ou vers sa
+  //    fin si les parcours ont lieu à rebours.
+  void **a = ha->array;
+  size_t p = 0;
+  for (size_t i = 0; i < n; ++i) {
+    void **q = HOLDALL__DIR > 0 ? &a[i] : &a[n - 1 - i];
+    if (compar(*q, top) <= 0 || (equiv != NULL && equiv(*q, top) == 0)) {
+      void **r = HOLDALL__DIR > 0 ? &a[p] : &a[n - 1 - p];
+      void *x = *q;
+      *q = *r;
+      *r = x;
+      ++p;
+    }
+  }
+  void **s = HOLDALL__DIR > 0 ? a : a + n - p;
+  void **t = NULL;
+  if (p > HOLDALL__RUN && (t = malloc(p * sizeof *t)) == NULL) {
+    return -1;
+  }
+  void **r = holdall__sort(s, t, p, compar, HOLDALL__DIR);
+  if (r != s) {
+    memcpy(s, r, p * sizeof *s);
   }
+  free(t);
   return 0;
 }
@@ -40,6 +40,20 @@ extern int holdall_put(holdall *ha, void *ptr);
 //     ha depuis sa création.
 extern size_t holdall_count(holdall *ha);
 
+//  holdall_footprint : renvoie le nombre d'octets obtenus du système par le
+//    fourretout associé à ha, hors objets pointés par les adresses ajoutées.
+extern size_t holdall_footprint(holdall *ha);
+
+//  holdall_at : renvoie l'adresse de rang k, dans l'ordre des parcours, du
+//    fourretout associé à ha. Le comportement est indéterminé si k est
+//    supérieur ou égal à holdall_count(ha).
+extern void *holdall_at(holdall *ha, size_t k);
+
+//  holdall_at_added : renvoie l'adresse de rang k, dans l'ordre des ajouts, du
+//    fourretout associé à ha. Le comportement est indéterminé si k est
+//    supérieur ou égal à holdall_count(ha) ou si le fourretout a été trié.
+extern void *holdall_at_added(holdall *ha, size_t k);
+
 //  holdall_apply : exécute fun sur les adresses ajoutées au fourretout associé
 //    à ha. Si, pour une adresse, fun renvoie une valeur non nulle, l'exécution
 //    prend fin et holdall_apply renvoie cette valeur. Sinon, fun est exécutée
@@ -69,6 +83,20 @@ extern int holdall_apply_context2(holdall *ha,
 //    nulle en cas de dépassement de capacité. Renvoie sinon zéro.
 extern int holdall_sort(holdall *ha, int (*compar)(const void *, const void *));
 
+//  holdall_sort_top : réordonne le fourretout associé à ha de sorte que ses
+//    premières adresses dans l'ordre des parcours soient, triées selon compar,
+//    les k plus petites au sens de compar, suivies des adresses qui ne sont pas
+//    parmi celles-ci mais que equiv déclare équivalentes à la plus grande
+//    d'entre elles, c'est-à-dire pour lesquelles equiv renvoie zéro. Les autres
+//    adresses suivent, dans un ordre quelconque. Si equiv vaut NULL, aucune
+//    adresse n'est ajoutée aux k premières. Si k vaut zéro ou est supérieur ou
+//    égal au nombre d'adresses du fourretout, équivaut à holdall_sort. Renvoie
+//    une valeur non nulle en cas de dépassement de capacité. Renvoie sinon
+//    zéro.
+extern int holdall_sort_top(holdall *ha, size_t k,
+    int (*compar)(const void *, const void *),
+    int (*equiv)(const void *, const void *));
+
 //  holdall_dispose : si *haptr ne vaut pas NULL, libère les ressources allouées
 //    à la structure de données associée à *haptr puis affecte à *haptr la
 //    valeur NULL.
@@ -1,22 +1,243 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <errno.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "chashtable.h"
+#include "cwordtable.h"
 #include "hashtable.h"
 #include "holdall.h"
+#include "merge.h"
 #include "options.h"
+#include "output.h"
 #include "reader.h"
+#include "server.h"
+#include "shard.h"
 #include "shword.h"
+#include "snapshot.h"
+#include "spill.h"
+#include "stats.h"
+#include "strhash.h"
+#include "vocab.h"
+#include "wordtable.h"
 
 #define EFIL "'%s': %s."
 #define EMEM "Not enough memory."
 #define ETRU "Word '%s...' was truncated in file '%s'."
 #define EDIS "Failed to display shared words: %s."
 #define EMOR "Try '%s --help' for more information."
+#define ETHR "Failed to start reading threads: %s."
+#define ESAV "Failed to save index '%s': %s."
+#define ECAC "Failed to update cache for '%s': %s."
+#define ESPI "Failed to use temporary spill files: %s."
+#define EMEMENG "--memory-limit can only be used with --engine=hash."
+#define ELDFACT "Load factor %zu%% is not supported by the hash table."
+#define EBADIDX "Not a valid index file"
+#define EOPTIDX "Index was built with other -i, -p, -u or --utf8 options"
+#define ESRV "Failed to serve on '%s': %s."
+#define ECON "Failed to query server '%s': %s."
+#define ESRVOPT "--%s cannot be used with --load-index, --save-index,"         \
+  " --cache-dir, --memory-limit, --engine or --stats."
+#define ESRVINP "--serve takes no file."
+#define ECONSTD "Standard input cannot be sent to a server."
+#define EREQ "Malformed request."
+#define EREQMAX "A request cannot have more than %d files."
+
+//  INGEST_* : codes de retour de la fonction ingest autres que les codes
+//    d'erreur au sens de errno.
+#define INGEST_OK 0
+#define INGEST_MEM -1
+#define INGEST_SPILL -2
+
+//  SPILL_PARTCNT : nombre de partitions des mots déversés sur disque lorsque
+//    la table de comptage dépasse la taille fixée par --memory-limit.
+#define SPILL_PARTCNT 64
+
+//  SPILL_PERIOD : nombre de mots lus entre deux comparaisons de la taille de
+//    la table de comptage à celle fixée par --memory-limit.
+#define SPILL_PERIOD 4096
+
+//  ESTIMATE_SAMPLE : nombre maximal de mots lus par estimate_vocabulary.
+#define ESTIMATE_SAMPLE 65536
+
+//  SERVE_MAGIC : premier champ des requêtes envoyées par --connect. Les champs
+//    suivants sont le répertoire courant du client, le nombre de caractères
+//    significatifs, le nombre de mots à produire et les drapeaux de
+//    SERVE_FLAGS, suivis des noms des sources. SERVE_HEADCNT est le nombre de
+//    champs qui précèdent les noms des sources.
+#define SERVE_MAGIC "ws-1"
+#define SERVE_HEADCNT 5
+
+//  SERVE_FLAGS : drapeaux transmis au serveur avec --connect.
+#define SERVE_FLAGS                                                            \
+  (1 << FLAG_PLSP | 1 << FLAG_SNUM | 1 << FLAG_UPPR | 1 << FLAG_UTF8)
+
+//  SERVE_REHASH_STEP : nombre de listes migrées à chaque opération par les
+//    tables de hachage agrandies de manière incrémentale avec --serve.
+#define SERVE_REHASH_STEP 4
+
+//  ingest : lit mot à mot l'entrée d'indice k de la structure associée à opts
+//    et marque dans la table associée à wt une occurrence de chacun des mots
+//    lus dans ce fichier. Le tampon pointé par buf doit être de taille au moins
+//    BUF_SIZE(opts). Si sp ne vaut pas NULL, la table est soumise à
+//    ingest_spill avec la structure associée à sp. Renvoie INGEST_MEM en cas
+//    de dépassement de capacité, INGEST_SPILL en cas d'erreur de ingest_spill,
+//    le code d'erreur au sens de errno si la source n'a pu être ouverte ou
+//    lue.
+//    Renvoie sinon INGEST_OK.
+static int ingest(wordtable *wt, const options *opts, size_t k, char *buf,
+    spill *sp);
+
+//  ingest_spill : soumet la table associée à wt à spill_over avec la
+//    structure associée à sp et la taille fixée par l'option --memory-limit de
+//    la structure associée à opts. Renvoie INGEST_MEM en cas de dépassement de
+//    capacité. Affiche un message et renvoie INGEST_SPILL en cas d'erreur
+//    d'écriture. Renvoie sinon INGEST_OK.
+static int ingest_spill(wordtable *wt, const options *opts, spill *sp);
+
+//  ingest_run : lit l'entrée d'indice k de la structure associée à opts dans
+//    une table qui lui est propre, affectée à runs[k], puis trie les mots de
+//    cette table selon shword_compare_words. Renvoie les mêmes valeurs que la
+//    fonction ingest.
+static int ingest_run(wordtable **runs, const options *opts, size_t k,
+    char *buf);
+
+//  ingest_parallel : lit les entrées d'indice au moins first de la structure
+//    associée à opts qui ne désignent pas l'entrée standard à l'aide de jobcnt
+//    fils d'exécution. Si runs vaut NULL, chaque fil dispose de sa propre
+//    table, fusionnée ensuite dans celle associée à wt. Sinon, chaque entrée
+//    est lue par ingest_run dans le tableau de tables pointé par runs.
+//    L'indice de la première entrée en erreur est affecté à *failedptr.
+//    Renvoie les mêmes valeurs que la fonction ingest.
+static int ingest_parallel(wordtable *wt, wordtable **runs,
+    const options *opts, size_t first, size_t jobcnt, size_t *failedptr);
+
+//  ingest_sharded : lit les entrées d'indice au moins first de la structure
+//    associée à opts à l'aide d'au plus jobcnt fils d'exécution de lecture,
+//    l'entrée standard étant lue par le fil principal. Chaque mot lu est
+//    transmis, au sens de shard_route, au fil d'agrégation de la table
+//    d'indice SHARD_OF(h, shardcnt) du tableau de shardcnt tables pointé par
+//    shards, h étant sa somme de hachage : chaque table n'est modifiée que par
+//    son fil d'agrégation. Les tables sont enfin réduites par
+//    wordtable_compact avec minfiles si minfiles est supérieur à un. L'indice
+//    de la première entrée en erreur est affecté à *failedptr. Renvoie les
+//    mêmes valeurs que la fonction ingest.
+static int ingest_sharded(wordtable **shards, size_t shardcnt,
+    const options *opts, size_t first, size_t jobcnt, size_t minfiles,
+    size_t *failedptr);
+
+//  ingest_shared : lit les entrées d'indice au moins first de la structure
+//    associée à opts dans la table commune associée à cwt à l'aide d'au plus
+//    jobcnt fils d'exécution, rédacteurs d'indices 0 à jobcnt - 1, l'entrée
+//    standard étant lue par le fil principal, rédacteur d'indice jobcnt, dans
+//    le tampon pointé par buf. L'indice de la première entrée en erreur est
+//    affecté à *failedptr. Renvoie les mêmes valeurs que la fonction ingest.
+static int ingest_shared(cwordtable *cwt, const options *opts, size_t first,
+    size_t jobcnt, char *buf, size_t *failedptr);
+
+//  concat_shards : renvoie un fourretout des mots partagés des n tables du
+//    tableau pointé par shards, mis bout à bout. Renvoie NULL en cas de
+//    dépassement de capacité.
+static holdall *concat_shards(wordtable **shards, size_t n);
+
+//  merge_runs : fusionne dans la structure associée à m, au sens de merge_join
+//    avec minfiles, les tables non nulles du tableau de n tables pointé par
+//    runs. Renvoie une valeur non nulle en cas de dépassement de capacité.
+//    Renvoie sinon zéro.
+static int merge_runs(merge *m, wordtable **runs, size_t n, size_t minfiles);
+
+//  dispose_runs : si *runsptr ne vaut pas NULL, révoque les tables non nulles
+//    du tableau de n tables pointé par *runsptr, libère ce tableau puis affecte
+//    à *runsptr la valeur NULL.
+static void dispose_runs(wordtable ***runsptr, size_t n);
+
+//  prepend_snapshot : insère en tête des entrées de la structure associée à
+//    opts les sources de l'index associé à snap. Renvoie une valeur non nulle
+//    en cas de dépassement de capacité. Renvoie sinon zéro.
+static int prepend_snapshot(options *opts, const snapshot *snap);
+
+//  select_snapshot : renvoie un fourretout des images de mots partagés de
+//    l'index associé à snap susceptibles d'être affichées selon les options de
+//    la structure associée à opts : les opts->wordcnt premières présentes dans
+//    au moins deux fichiers, suivies avec --same-numbers de celles qui ont les
+//    mêmes nombres que la dernière d'entre elles. Renvoie NULL en cas de
+//    dépassement de capacité.
+static holdall *select_snapshot(const snapshot *snap, const options *opts);
+
+//  count_shared : renvoie le nombre de mots partagés du fourretout associé à
+//    ha présents dans au moins deux fichiers.
+static size_t count_shared(holdall *ha);
+
+//  estimate_vocabulary : renvoie une estimation du nombre de mots distincts des
+//    entrées d'indices [first, opts->inputcnt[ de la structure associée à
+//    opts, faite d'après la taille des fichiers réguliers et un échantillon
+//    d'au plus ESTIMATE_SAMPLE mots lus au début du premier d'entre eux qui
+//    n'est pas vide. Le tampon pointé par buf doit être de taille au moins
+//    BUF_SIZE(opts). Renvoie zéro si aucune estimation n'a pu être faite.
+static size_t estimate_vocabulary(const options *opts, size_t first,
+    char *buf);
 
-//  str_hashfun : calcule la somme de hachage de la chaine de caractères pointée
-//    par s.
-static size_t str_hashfun(const char *s);
+//  sort_words : trie selon shword_compare les mots partagés du fourretout
+//    associé à ha, limités à ceux susceptibles d'être affichés selon les
+//    options de la structure associée à opts : les opts->wordcnt premiers,
+//    suivis avec --same-numbers de ceux qui ont les mêmes nombres que le
+//    dernier d'entre eux. Renvoie une valeur non nulle en cas de dépassement
+//    de capacité. Renvoie sinon zéro.
+static int sort_words(holdall *ha, const options *opts);
+
+//  display_words : affiche sur le flot contrôlé par f les mots partagés du
+//    fourretout associé à ha, trié par sort_words, selon les options de la
+//    structure associée à opts. Renvoie INGEST_MEM en cas de dépassement de
+//    capacité, le code d'erreur au sens de errno en cas d'erreur d'écriture.
+//    Renvoie sinon INGEST_OK.
+static int display_words(holdall *ha, const options *opts, FILE *f);
+
+//  serve : répond sur la socket de l'option --serve de la structure associée
+//    à opts, jusqu'à son arrêt par un signal, aux requêtes de connect_request
+//    à l'aide de serve_request et de opts->jobcnt fils d'exécution, une mémoire
+//    des vocabulaires étant commune à toutes. Renvoie le code de retour du
+//    programme.
+static int serve(const options *opts);
+
+//  serve_request : gestionnaire de requêtes, au sens du module server, de la
+//    fonction serve, de contexte la mémoire des vocabulaires associée à v.
+//    Affiche sur le flot contrôlé par out les mots partagés des sources de la
+//    requête formée des fieldcnt champs du tableau pointé par fields, comme le
+//    ferait le programme lui-même pour les mêmes options, et ses messages
+//    d'erreur sur le flot contrôlé par err. Renvoie le code de retour du
+//    programme.
+static int serve_request(vocab *v, size_t fieldcnt, char * const *fields,
+    FILE *out, FILE *err);
+
+//  connect_request : envoie au serveur de la socket de l'option --connect de
+//    la structure associée à opts la requête formée de ses sources et de ses
+//    options, puis affiche sa réponse. Renvoie le code de retour du programme.
+static int connect_request(const options *opts);
+
+//  READ_MODE : drapeaux de lecture au sens de reader_open correspondant aux
+//    options de la structure associée à opts.
+#define READ_MODE(opts)                                                        \
+  ((FLAG_HAS((opts)->flags, FLAG_PLSP) ? READER_PLSP : 0)                      \
+    | (FLAG_HAS((opts)->flags, FLAG_UPPR) ? READER_UPPR : 0)                  \
+    | (FLAG_HAS((opts)->flags, FLAG_UTF8) ? READER_UTF8 : 0))
+
+//  BUF_SIZE : taille du tampon de lecture fourni à ingest pour les options de
+//    la structure associée à opts, SIZE_MAX si elle ne peut être représentée.
+#define BUF_SIZE(opts)                                                         \
+  (!FLAG_HAS((opts)->flags, FLAG_UTF8) ? (opts)->charcnt + 1                   \
+    : (opts)->charcnt > (SIZE_MAX - 1) / READER_MAXSEQ ? SIZE_MAX              \
+    : (opts)->charcnt * READER_MAXSEQ + 1)
+
+//  INPUT_NAME : nom d'affichage de l'entrée d'indice k de la structure
+//    associée à opts.
+#define INPUT_NAME(opts, k) \
+  ((opts)->input[k] == NULL ? "stdin" : (opts)->input[k])
 
 int main(int argc, char *argv[]) {
   options opts;
@@ -24,78 +245,360 @@ int main(int argc, char *argv[]) {
   switch (options_parse(argc, argv, &opts)) {
     case -1:
       fprintf(stderr, EMOR "\n", PRNAME);
+      options_dispose(&opts);
       exit(EXIT_FAILURE);
     case 1: exit(EXIT_SUCCESS);
   }
+  reader_setup();
+  strhash_setup();
+  if (opts.ldfactor > 0 && hashtable_setup(opts.ldfactor, 100) != 0) {
+    ERRORA(ELDFACT, opts.ldfactor);
+    options_dispose(&opts);
+    exit(EXIT_FAILURE);
+  }
+  //  Un serveur comme un client ne font que transmettre les requêtes.
+  bool serving = opts.servepath != NULL;
+  bool connecting = opts.connpath != NULL;
+  if ((serving || connecting) && (opts.loadpath != NULL
+      || opts.savepath != NULL || opts.cachedir != NULL || opts.memlimit > 0
+      || opts.engine != NULL || FLAG_HAS(opts.flags, FLAG_STAT))) {
+    ERRORA(ESRVOPT, serving ? "serve" : "connect");
+    options_dispose(&opts);
+    exit(EXIT_FAILURE);
+  }
+  if (serving || connecting) {
+    int r = serving ? serve(&opts) : connect_request(&opts);
+    options_dispose(&opts);
+    return r;
+  }
   int r = EXIT_SUCCESS;
-  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
-      (size_t (*)(const void *))str_hashfun);
-  holdall *ha = holdall_empty();
-  char *buf = malloc(opts.charcnt + 1);
-  if (ht == NULL || ha == NULL || buf == NULL) {
+  snapshot *snap = NULL;
+  wordtable *wt = NULL;
+  holdall *sel = NULL;
+  wordtable **runs = NULL;
+  wordtable **shards = NULL;
+  size_t shardcnt = 0;
+  cwordtable *cwt = NULL;
+  merge *mg = NULL;
+  spill *sp = NULL;
+  char *buf = NULL;
+  holdall *ha;
+  //  Les sources de l'index éventuellement chargé précèdent celles de la ligne
+  //    de commande : elles portent les indices [0, first[.
+  size_t first = 0;
+  if (opts.loadpath != NULL) {
+    int e = snapshot_open(&snap, opts.loadpath);
+    if (e != 0) {
+      ERRORA(EFIL, opts.loadpath, e == SNAPSHOT_BADFORMAT ? EBADIDX
+          : strerror(e));
+      goto error;
+    }
+    first = snapshot_inputcnt(snap);
+    if (opts.inputcnt > 0 && (snapshot_charcnt(snap) != opts.charcnt
+        || snapshot_mode(snap) != READ_MODE(&opts))) {
+      ERRORA(EFIL, opts.loadpath, EOPTIDX);
+      goto error;
+    }
+    if (prepend_snapshot(&opts, snap) != 0) {
+      goto error_capacity;
+    }
+  }
+  if (shword_setup(opts.inputcnt) != 0) {
+    goto error_capacity;
+  }
+  //  Les compteurs matériels doivent être ouverts avant le lancement des fils
+  //    d'exécution pour que ceux-ci soient aussi mesurés.
+  if (FLAG_HAS(opts.flags, FLAG_STAT) && stats_setup(opts.inputcnt) != 0) {
     goto error_capacity;
   }
-  for (size_t k = 0; k < opts.inputcnt; ++k) {
-    bool isstdin = opts.input[k] == NULL;
-    FILE *f = isstdin ? stdin : fopen(opts.input[k], "r");
-    const char *filename = isstdin ? "stdin" : opts.input[k];
-    if (f == NULL) {
-      ERRORA(EFIL, filename, strerror(errno));
+  stats_begin(STATS_INGEST);
+  if (snap != NULL && first == opts.inputcnt && opts.savepath == NULL) {
+    //  Ni source à ajouter ni index à produire : les mots sont lus directement
+    //    dans la projection de l'index, où ils sont déjà triés.
+    sel = select_snapshot(snap, &opts);
+    if (sel == NULL) {
+      goto error_capacity;
+    }
+    ha = sel;
+    stats_words(snapshot_wordcnt(snap), snapshot_sharedcnt(snap));
+  } else {
+    //  Avec le moteur merge, chaque source d'indice k est lue dans sa propre
+    //    table runs[k], l'index éventuellement chargé formant la table
+    //    supplémentaire runs[opts.inputcnt]. Les tables sont ensuite fusionnées
+    //    par merge_join.
+    //  Avec le moteur shard, les mots sont répartis selon leur somme de
+    //    hachage entre shardcnt tables disjointes, mises bout à bout une fois
+    //    toutes les entrées lues.
+    //  Avec le moteur shared, tous les fils d'exécution marquent les mots dans
+    //    une même table concurrente, cwt, sans verrou.
+    bool merging = opts.engine != NULL
+        && strcmp(opts.engine, ENGINE_MERGE) == 0;
+    bool sharding = opts.engine != NULL
+        && strcmp(opts.engine, ENGINE_SHARD) == 0;
+    bool sharing = opts.engine != NULL
+        && strcmp(opts.engine, ENGINE_SHARED) == 0;
+    if ((merging || sharding || sharing) && opts.memlimit > 0) {
+      ERROR(EMEMENG);
       goto error;
     }
-    size_t rcount;
-    while ((rcount = reader_read(f, buf, opts.charcnt,
-        FLAG_HAS(opts.flags, FLAG_PLSP),
-        FLAG_HAS(opts.flags, FLAG_UPPR))) > 0) {
-      if (rcount == opts.charcnt + 1) {
-        ERRORA(ETRU, buf, filename);
-      }
-      shword *shw = (shword *) hashtable_search(ht, buf);
-      if (shw == NULL) {
-        shw = shword_create(buf);
-        if (shw == NULL) {
+    //  Une seule table de comptage est soumise à la taille maximale : les
+    //    entrées sont alors toutes lues par le fil principal.
+    size_t jobcnt = opts.memlimit > 0 ? 1 : opts.jobcnt;
+    if (jobcnt == 0) {
+      long n = sysconf(_SC_NPROCESSORS_ONLN);
+      jobcnt = n > 0 ? (size_t) n : 1;
+    }
+    buf = malloc(BUF_SIZE(&opts));
+    if (buf == NULL) {
+      goto error_capacity;
+    }
+    if (merging) {
+      runs = calloc(opts.inputcnt + 1, sizeof *runs);
+      if (runs == NULL) {
+        goto error_capacity;
+      }
+    }
+    if (sharding) {
+      //  Chaque table disjointe est confiée à un fil d'agrégation et reçoit
+      //    une file de chaque fil de lecture : au-delà d'une table par
+      //    processeur, leur nombre ne ferait qu'accroître celui des files.
+      long n = sysconf(_SC_NPROCESSORS_ONLN);
+      shardcnt = n > 0 && (size_t) n < jobcnt ? (size_t) n : jobcnt;
+      shards = calloc(shardcnt, sizeof *shards);
+      if (shards == NULL) {
+        goto error_capacity;
+      }
+      for (size_t k = 0; k < shardcnt; ++k) {
+        shards[k] = wordtable_empty();
+        if (shards[k] == NULL) {
           goto error_capacity;
         }
-        if (holdall_put(ha, shw) != 0) {
-          shword_destroy(shw);
+      }
+    }
+    if (sharing) {
+      cwt = cwordtable_empty(jobcnt + 1);
+      if (cwt == NULL) {
+        goto error_capacity;
+      }
+    }
+    if ((!merging && !sharding && !sharing) || (merging && snap != NULL)) {
+      wt = wordtable_empty();
+      if (wt == NULL) {
+        goto error_capacity;
+      }
+    }
+    //  Les tables de comptage sont dimensionnées d'emblée pour le vocabulaire
+    //    estimé, sauf avec une taille maximale, où la table a vocation à être
+    //    déversée, et avec le moteur merge, dont les tables sont propres à
+    //    chaque source. L'estimation n'étant qu'une indication, l'échec d'une
+    //    réservation n'est pas une erreur : la table s'agrandira au besoin.
+    if (opts.memlimit == 0 && !merging && !sharing) {
+      size_t vocab = estimate_vocabulary(&opts, first, buf);
+      if (snap != NULL && snapshot_wordcnt(snap) > vocab) {
+        vocab = snapshot_wordcnt(snap);
+      }
+      stats_vocabulary(vocab);
+      if (wt != NULL) {
+        (void) wordtable_reserve(wt, vocab);
+      }
+      for (size_t k = 0; k < shardcnt; ++k) {
+        (void) wordtable_reserve(shards[k], vocab / shardcnt);
+      }
+    }
+    //  Avec une taille maximale, la table de comptage est déversée sur disque
+    //    chaque fois qu'elle la dépasse. Les partitions sont agrégées une fois
+    //    toutes les entrées lues.
+    if (opts.memlimit > 0) {
+      sp = spill_open(SPILL_PARTCNT);
+      if (sp == NULL) {
+        goto error_capacity;
+      }
+    }
+    int e = INGEST_OK;
+    for (size_t k = 0; snap != NULL && k < snapshot_wordcnt(snap); ++k) {
+      const shword *img = snapshot_word(snap, k);
+      if (img == NULL) {
+        ERRORA(EFIL, opts.loadpath, EBADIDX);
+        goto error;
+      }
+      wordtable *dest = wt;
+      if (sharding) {
+        const char *w = shword_image_word(img, first);
+        dest = shards[SHARD_OF(strhash(w), shardcnt)];
+      }
+      if (sharing ? cwordtable_import(cwt, jobcnt, img, first) != 0
+          : wordtable_import(dest, img, first) != 0) {
+        goto error_capacity;
+      }
+      if (sp != NULL && (k + 1) % SPILL_PERIOD == 0) {
+        e = ingest_spill(wt, &opts, sp);
+        if (e == INGEST_MEM) {
           goto error_capacity;
         }
-        if (hashtable_add(ht, shword_word(shw), shw) == NULL) {
-          goto error_capacity;
+        if (e != INGEST_OK) {
+          goto error;
         }
       }
-      //  Inutile de vérifier la valeur de retour puisque k sera toujours borné
-      //    à INPUT_MAX lui-même borné par SHW_PATTERN_MAX, et que si le nb.
-      //    d'occ. a été atteint on ignore juste le retour puisque de toute
-      //    manière le compteur ne bougera plus.
-      shword_increment(shw, k);
     }
-    if (!feof(f)) {
-      ERRORA(EFIL, filename, strerror(errno));
+    if (merging && snap != NULL) {
+      if (holdall_sort(wordtable_words(wt),
+          (int (*)(const void *, const void *))shword_compare_words) != 0) {
+        goto error_capacity;
+      }
+      runs[opts.inputcnt] = wt;
+      wt = NULL;
+    }
+    size_t failed = 0;
+    if (sharding) {
+      e = ingest_sharded(shards, shardcnt, &opts, first, jobcnt,
+          opts.savepath != NULL ? 1 : 2, &failed);
+    } else if (sharing) {
+      e = ingest_shared(cwt, &opts, first, jobcnt, buf, &failed);
+    } else if (jobcnt > 1 && first < opts.inputcnt) {
+      e = ingest_parallel(wt, runs, &opts, first, jobcnt, &failed);
+    }
+    //  L'entrée standard, ainsi que toutes les entrées si un seul fil
+    //    d'exécution est demandé, sont lues dans l'ordre par le fil principal.
+    for (size_t k = first; !sharding && !sharing && e == INGEST_OK
+        && k < opts.inputcnt; ++k) {
+      if (jobcnt == 1 || opts.input[k] == NULL) {
+        e = merging ? ingest_run(runs, &opts, k, buf)
+            : ingest(wt, &opts, k, buf, sp);
+        failed = k;
+      }
+    }
+    if (e == INGEST_MEM) {
+      goto error_capacity;
+    }
+    if (e == INGEST_SPILL) {
       goto error;
     }
-    if (isstdin) {
-      clearerr(f);
+    if (e != INGEST_OK) {
+      ERRORA(EFIL, INPUT_NAME(&opts, failed), strerror(e));
+      goto error;
+    }
+    if (sp != NULL && spill_used(sp)) {
+      //  Sauf si un index est à produire, seuls sont conservés les mots
+      //    susceptibles d'être affichés.
+      size_t distinct = 0;
+      size_t shared = 0;
+      e = spill_gather(sp, wt, opts.inputcnt, opts.savepath != NULL ? 1 : 2,
+          opts.wordcnt, FLAG_HAS(opts.flags, FLAG_SNUM), &distinct, &shared);
+      if (e == ENOMEM) {
+        goto error_capacity;
+      }
+      if (e != 0) {
+        ERRORA(ESPI, strerror(e));
+        goto error;
+      }
+      stats_words(distinct, shared);
+    }
+    if (merging) {
+      //  Les mots présents dans un seul fichier ne sont conservés que pour
+      //    l'index. Les tables ne sont plus utiles une fois fusionnées.
+      mg = merge_empty();
+      if (mg == NULL || merge_runs(mg, runs, opts.inputcnt + 1,
+          opts.savepath != NULL ? 1 : 2) != 0) {
+        goto error_capacity;
+      }
+      dispose_runs(&runs, opts.inputcnt + 1);
+      ha = merge_words(mg);
+    } else if (sharding) {
+      //  Les tables ont été réduites par leurs fils d'agrégation, sauf pour
+      //    l'index.
+      sel = concat_shards(shards, shardcnt);
+      if (sel == NULL) {
+        goto error_capacity;
+      }
+      ha = sel;
+    } else if (sharing) {
+      //  Les mots présents dans un seul fichier ne sont retenus que pour
+      //    l'index.
+      sel = cwordtable_collect(cwt, opts.savepath != NULL ? 1 : 2);
+      if (sel == NULL) {
+        goto error_capacity;
+      }
+      ha = sel;
     } else {
-      fclose(f);
+      ha = wordtable_words(wt);
+    }
+    //  Les mots distincts ont été comptés par ingest_sharded pour le moteur
+    //    shard, par spill_gather avec des partitions, sauf si un index est à
+    //    produire : leurs tables n'ont alors pas été réduites.
+    if (FLAG_HAS(opts.flags, FLAG_STAT)) {
+      bool reduced = opts.savepath == NULL
+          && (sharding || (sp != NULL && spill_used(sp)));
+      stats_words(merging ? merge_distinct(mg)
+          : sharing ? cwordtable_count(cwt)
+          : reduced ? 0 : holdall_count(ha),
+          sp != NULL && spill_used(sp) && opts.savepath == NULL ? 0
+          : count_shared(ha));
+    }
+    if (opts.savepath != NULL) {
+      //  L'index comprend tous les mots, triés : les mots présents dans
+      //    plusieurs fichiers en forment le début.
+      if (holdall_sort(ha,
+          (int (*)(const void *, const void *))shword_compare) != 0) {
+        goto error_capacity;
+      }
+      e = snapshot_save(opts.savepath, ha, opts.inputcnt, opts.input,
+          opts.charcnt, READ_MODE(&opts));
+      if (e != 0) {
+        ERRORA(ESAV, opts.savepath, strerror(e));
+        goto error;
+      }
+    }
+    //  Les mots présents dans un seul fichier ne sont jamais affichés : ils
+    //    sont abandonnés avant le tri.
+    if (!merging && !sharding && !sharing) {
+      if (wordtable_compact(wt, 2) != 0) {
+        goto error_capacity;
+      }
+      ha = wordtable_words(wt);
+    }
+    if (sharding && opts.savepath != NULL) {
+      holdall_dispose(&sel);
+      for (size_t k = 0; k < shardcnt; ++k) {
+        if (wordtable_compact(shards[k], 2) != 0) {
+          goto error_capacity;
+        }
+      }
+      sel = concat_shards(shards, shardcnt);
+      if (sel == NULL) {
+        goto error_capacity;
+      }
+      ha = sel;
+    }
+    if (sharing && opts.savepath != NULL) {
+      holdall_dispose(&sel);
+      sel = cwordtable_collect(cwt, 2);
+      if (sel == NULL) {
+        goto error_capacity;
+      }
+      ha = sel;
     }
   }
-  if (holdall_sort(ha,
-      (int (*)(const void *, const void *))shword_compare) != 0) {
+  stats_end(STATS_INGEST);
+  //  Seuls les opts.wordcnt premiers mots sont triés, ainsi qu'avec
+  //    --same-numbers ceux qui ont les mêmes nombres que le dernier d'entre
+  //    eux.
+  stats_begin(STATS_SORT);
+  if (sort_words(ha, &opts) != 0) {
     goto error_capacity;
   }
-  struct print_race pr = {
-      .inputcnt = opts.inputcnt,
-      .last = NULL,
-      .remaining = opts.wordcnt > 0 ? opts.wordcnt : holdall_count(ha),
-      .samenumbers = FLAG_HAS(opts.flags, FLAG_SNUM),
-  };
-  if (holdall_apply_context(ha, &pr,
-      (void *(*)(void *, void *))shword_predisplay,
-      (int (*)(void *, void *))shword_display) < 0) {
-    ERRORA(EDIS, strerror(errno));
+  stats_end(STATS_SORT);
+  stats_begin(STATS_DISPLAY);
+  int e = display_words(ha, &opts, stdout);
+  if (e == INGEST_MEM) {
+    goto error_capacity;
+  }
+  if (e != INGEST_OK) {
+    ERRORA(EDIS, strerror(e));
     goto error;
   }
+  stats_end(STATS_DISPLAY);
+  stats_report(stderr, PRNAME, opts.input,
+      hashtable_resizecount() + chashtable_resizecount());
 
   goto dispose;
   error_capacity:
@@ -104,19 +607,1011 @@ int main(int argc, char *argv[]) {
   error:
   r = EXIT_FAILURE;
   dispose:
-  hashtable_dispose(&ht);
-  if (ha != NULL) {
-    holdall_apply(ha, (int (*)(void *))shword_destroy);
-  }
-  holdall_dispose(&ha);
+  wordtable_dispose(&wt);
+  holdall_dispose(&sel);
+  dispose_runs(&runs, opts.inputcnt + 1);
+  dispose_runs(&shards, shardcnt);
+  cwordtable_dispose(&cwt);
+  merge_dispose(&mg);
+  spill_dispose(&sp);
   free(buf);
+  stats_dispose();
+  options_dispose(&opts);
+  snapshot_dispose(&snap);
+  return r;
+}
+
+int sort_words(holdall *ha, const options *opts) {
+  return holdall_sort_top(ha, opts->wordcnt,
+      (int (*)(const void *, const void *))shword_compare,
+      FLAG_HAS(opts->flags, FLAG_SNUM)
+      ? (int (*)(const void *, const void *))shword_compare_numbers
+      : NULL);
+}
+
+int display_words(holdall *ha, const options *opts, FILE *f) {
+  output *out = output_open(f);
+  if (out == NULL) {
+    return INGEST_MEM;
+  }
+  struct print_race pr = {
+      .inputcnt = opts->inputcnt,
+      .last = NULL,
+      .remaining = opts->wordcnt > 0 ? opts->wordcnt : holdall_count(ha),
+      .samenumbers = FLAG_HAS(opts->flags, FLAG_SNUM),
+      .out = out,
+  };
+  int e = INGEST_OK;
+  if (holdall_apply_context(ha, &pr,
+      (void *(*)(void *, void *))shword_predisplay,
+      (int (*)(void *, void *))shword_display) < 0
+      || output_flush(out) != 0) {
+    e = errno;
+  }
+  output_dispose(&out);
+  return e;
+}
+
+int serve(const options *opts) {
+  if (opts->inputcnt > 0) {
+    ERROR(ESRVINP);
+    return EXIT_FAILURE;
+  }
+  //  Les motifs d'occurrences de tous les mots, ceux des vocabulaires comme
+  //    ceux des requêtes, ont la taille de la plus grande requête acceptée.
+  if (shword_setup(SERVE_INPUTMAX) != 0) {
+    ERROR(EMEM);
+    return EXIT_FAILURE;
+  }
+  //  Un serveur ne doit pas suspendre une requête le temps d'agrandir une
+  //    table d'un seul coup. L'adressage ouvert ne prend pas en charge
+  //    l'agrandissement incrémental : ses tables sont alors agrandies en une
+  //    fois.
+  (void) hashtable_setup_incremental(SERVE_REHASH_STEP);
+  size_t threadcnt = opts->jobcnt;
+  if (threadcnt == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    threadcnt = n > 0 ? (size_t) n : 1;
+  }
+  vocab *v = vocab_empty();
+  if (v == NULL) {
+    ERROR(EMEM);
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  int e = server_run(opts->servepath, threadcnt,
+      (server_handler) serve_request, v);
+  if (e != 0) {
+    ERRORA(ESRV, opts->servepath, strerror(e));
+    r = EXIT_FAILURE;
+  }
+  vocab_dispose(&v);
+  return r;
+}
+
+int serve_request(vocab *v, size_t fieldcnt, char * const *fields,
+    FILE *out, FILE *err) {
+  options opts;
+  options_defaults(&opts);
+  size_t flags;
+  if (fieldcnt < SERVE_HEADCNT + 2 || strcmp(fields[0], SERVE_MAGIC) != 0
+      || *fields[1] != '/'
+      || server_field_size(fields[2], &opts.charcnt) != 0
+      || server_field_size(fields[3], &opts.wordcnt) != 0
+      || server_field_size(fields[4], &flags) != 0
+      || (flags & ~(size_t) SERVE_FLAGS) != 0) {
+    FERROR(err, EREQ);
+    return EXIT_FAILURE;
+  }
+  if (fieldcnt - SERVE_HEADCNT > SERVE_INPUTMAX) {
+    FERRORA(err, EREQMAX, SERVE_INPUTMAX);
+    return EXIT_FAILURE;
+  }
+  opts.flags = (int) flags;
+  opts.input = (const char **) fields + SERVE_HEADCNT;
+  opts.inputcnt = fieldcnt - SERVE_HEADCNT;
+  int r = EXIT_FAILURE;
+  wordtable *wt = wordtable_empty();
+  vocab_file **vfs = calloc(opts.inputcnt, sizeof *vfs);
+  if (wt == NULL || vfs == NULL) {
+    goto error_capacity;
+  }
+  size_t failed = 0;
+  int e = vocab_gather(v, wt, vfs, fields[1], opts.input, opts.inputcnt,
+      opts.charcnt, READ_MODE(&opts), &failed);
+  for (size_t k = 0; k < opts.inputcnt && vfs[k] != NULL; ++k) {
+    const char *w;
+    for (size_t j = 0; (w = vocab_file_trunc(vfs[k], j)) != NULL; ++j) {
+      FERRORA(err, ETRU, w, opts.input[k]);
+    }
+  }
+  if (e == ENOMEM) {
+    goto error_capacity;
+  }
+  if (e != 0) {
+    FERRORA(err, EFIL, opts.input[failed], strerror(e));
+    goto dispose;
+  }
+  if (wordtable_compact(wt, 2) != 0
+      || sort_words(wordtable_words(wt), &opts) != 0) {
+    goto error_capacity;
+  }
+  e = display_words(wordtable_words(wt), &opts, out);
+  if (e == INGEST_MEM) {
+    goto error_capacity;
+  }
+  if (e != INGEST_OK) {
+    FERRORA(err, EDIS, strerror(e));
+    goto dispose;
+  }
+  r = EXIT_SUCCESS;
+  goto dispose;
+  error_capacity:
+  FERROR(err, EMEM);
+  dispose:
+  for (size_t k = 0; vfs != NULL && k < opts.inputcnt; ++k) {
+    if (vfs[k] != NULL) {
+      vocab_release(v, &vfs[k]);
+    }
+  }
+  free(vfs);
+  wordtable_dispose(&wt);
+  return r;
+}
+
+//  current_dir : renvoie le chemin absolu du répertoire courant, alloué.
+//    Renvoie NULL en cas d'échec, errno étant alors fixé.
+static char *current_dir(void) {
+  char *cwd = NULL;
+  for (size_t size = 256; ; size *= 2) {
+    char *p = realloc(cwd, size);
+    if (p == NULL) {
+      free(cwd);
+      errno = ENOMEM;
+      return NULL;
+    }
+    cwd = p;
+    if (getcwd(cwd, size) != NULL) {
+      return cwd;
+    }
+    if (errno != ERANGE || size > SIZE_MAX / 2) {
+      int e = errno;
+      free(cwd);
+      errno = e;
+      return NULL;
+    }
+  }
+}
+
+int connect_request(const options *opts) {
+  for (size_t k = 0; k < opts->inputcnt; ++k) {
+    if (opts->input[k] == NULL) {
+      ERROR(ECONSTD);
+      return EXIT_FAILURE;
+    }
+  }
+  int r = EXIT_FAILURE;
+  char nums[3][3 * sizeof(size_t) + 1];
+  snprintf(nums[0], sizeof nums[0], "%zu", opts->charcnt);
+  snprintf(nums[1], sizeof nums[1], "%zu", opts->wordcnt);
+  snprintf(nums[2], sizeof nums[2], "%d", opts->flags & SERVE_FLAGS);
+  const char **fields = NULL;
+  char *cwd = current_dir();
+  if (cwd == NULL) {
+    ERRORA(EFIL, ".", strerror(errno));
+    goto dispose;
+  }
+  fields = malloc((SERVE_HEADCNT + opts->inputcnt) * sizeof *fields);
+  if (fields == NULL) {
+    ERROR(EMEM);
+    goto dispose;
+  }
+  fields[0] = SERVE_MAGIC;
+  fields[1] = cwd;
+  fields[2] = nums[0];
+  fields[3] = nums[1];
+  fields[4] = nums[2];
+  for (size_t k = 0; k < opts->inputcnt; ++k) {
+    fields[SERVE_HEADCNT + k] = opts->input[k];
+  }
+  int e = server_request(opts->connpath, SERVE_HEADCNT + opts->inputcnt,
+      fields, stdout, stderr, &r);
+  if (e != 0) {
+    ERRORA(ECON, opts->connpath, strerror(e));
+    r = EXIT_FAILURE;
+    goto dispose;
+  }
+  if (fflush(stdout) != 0) {
+    ERRORA(EDIS, strerror(errno));
+    r = EXIT_FAILURE;
+  }
+  dispose:
+  free(fields);
+  free(cwd);
+  return r;
+}
+
+size_t count_shared(holdall *ha) {
+  size_t n = 0;
+  for (size_t k = 0; k < holdall_count(ha); ++k) {
+    n += shword_filecount(holdall_at(ha, k)) >= 2;
+  }
+  return n;
+}
+
+size_t estimate_vocabulary(const options *opts, size_t first, char *buf) {
+  uintmax_t total = 0;
+  const char *sample = NULL;
+  for (size_t k = first; k < opts->inputcnt; ++k) {
+    struct stat st;
+    if (opts->input[k] != NULL && stat(opts->input[k], &st) == 0
+        && S_ISREG(st.st_mode)) {
+      total += (uintmax_t) st.st_size;
+      if (sample == NULL && st.st_size > 0) {
+        sample = opts->input[k];
+      }
+    }
+  }
+  FILE *f = sample == NULL ? NULL : fopen(sample, "r");
+  if (f == NULL) {
+    return 0;
+  }
+  size_t estimate = 0;
+  reader *rd = reader_open(f, READ_MODE(opts));
+  wordtable *wt = wordtable_empty();
+  if (rd == NULL || wt == NULL || wordtable_reserve(wt, ESTIMATE_SAMPLE) != 0) {
+    goto dispose;
+  }
+  //  dprev, dlast : nombres de mots distincts après la lecture de 2^(j - 1)
+  //    puis de 2^j mots, où 2^j est la plus grande puissance de 2 atteinte.
+  size_t words = 0;
+  size_t dprev = 0;
+  size_t dlast = 0;
+  size_t wlen;
+  size_t h;
+  while (words < ESTIMATE_SAMPLE
+      && reader_next(rd, buf, opts->charcnt, &wlen, &h) > 0) {
+    if (wordtable_insert_hashed(wt, buf, wlen, h) == NULL) {
+      goto dispose;
+    }
+    ++words;
+    if ((words & (words - 1)) == 0) {
+      dprev = dlast;
+      dlast = holdall_count(wordtable_words(wt));
+    }
+  }
+  size_t distinct = holdall_count(wordtable_words(wt));
+  size_t consumed = reader_consumed(rd);
+  if (dprev == 0 || consumed == 0) {
+    estimate = distinct;
+    goto dispose;
+  }
+  //  Loi de Heaps : le vocabulaire d'un texte de n mots croît comme K n^b,
+  //    avec 0 <= b <= 1. L'exposant est déduit du dernier doublement du
+  //    nombre de mots de l'échantillon, le nombre total de mots de la part des
+  //    octets qu'il représente.
+  double b = log2((double) dlast / (double) dprev);
+  if (b > 1.0) {
+    b = 1.0;
+  }
+  double n = (double) words * (double) total / (double) consumed;
+  double v = (double) distinct * pow(n / (double) words, b);
+  if (v > n) {
+    v = n;
+  }
+  estimate = v < (double) distinct ? distinct
+      : v >= (double) SIZE_MAX ? SIZE_MAX : (size_t) v;
+  dispose:
+  wordtable_dispose(&wt);
+  reader_dispose(&rd);
+  fclose(f);
+  return estimate;
+}
+
+holdall *concat_shards(wordtable **shards, size_t n) {
+  holdall *ha = holdall_empty();
+  if (ha == NULL) {
+    return NULL;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    holdall *words = wordtable_words(shards[k]);
+    for (size_t j = 0; j < holdall_count(words); ++j) {
+      if (holdall_put(ha, holdall_at(words, j)) != 0) {
+        holdall_dispose(&ha);
+        return NULL;
+      }
+    }
+  }
+  return ha;
+}
+
+int merge_runs(merge *m, wordtable **runs, size_t n, size_t minfiles) {
+  holdall **hs = malloc(n * sizeof *hs);
+  if (hs == NULL) {
+    return -1;
+  }
+  size_t cnt = 0;
+  for (size_t k = 0; k < n; ++k) {
+    if (runs[k] != NULL) {
+      hs[cnt++] = wordtable_words(runs[k]);
+    }
+  }
+  int r = merge_join(m, hs, cnt, minfiles);
+  free(hs);
   return r;
 }
 
-size_t str_hashfun(const char *s) {
-  size_t h = 0;
-  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
-    h = 37 * h + *p;
+void dispose_runs(wordtable ***runsptr, size_t n) {
+  if (*runsptr == NULL) {
+    return;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    wordtable_dispose(&(*runsptr)[k]);
+  }
+  free(*runsptr);
+  *runsptr = NULL;
+}
+
+int prepend_snapshot(options *opts, const snapshot *snap) {
+  size_t n = snapshot_inputcnt(snap);
+  if (opts->inputcnt > SIZE_MAX / sizeof *opts->input - n) {
+    return -1;
+  }
+  const char **input = malloc((n + opts->inputcnt) * sizeof *input);
+  if (input == NULL) {
+    return -1;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    input[k] = snapshot_input(snap, k);
+  }
+  for (size_t k = 0; k < opts->inputcnt; ++k) {
+    input[n + k] = opts->input[k];
+  }
+  free(opts->input);
+  opts->input = input;
+  opts->inputcnt += n;
+  return 0;
+}
+
+holdall *select_snapshot(const snapshot *snap, const options *opts) {
+  holdall *ha = holdall_empty();
+  if (ha == NULL) {
+    return NULL;
+  }
+  const shword *last = NULL;
+  for (size_t k = 0; k < snapshot_sharedcnt(snap); ++k) {
+    const shword *shw = snapshot_word(snap, k);
+    if (shw == NULL) {
+      break;
+    }
+    if (opts->wordcnt > 0 && k >= opts->wordcnt
+        && (!FLAG_HAS(opts->flags, FLAG_SNUM)
+          || shword_compare_numbers(shw, last) != 0)) {
+      break;
+    }
+    if (holdall_put(ha, (void *) shw) != 0) {
+      holdall_dispose(&ha);
+      return NULL;
+    }
+    last = shw;
+  }
+  return ha;
+}
+
+//  ingest_cached : marque dans la table associée à wt les occurrences, dans le
+//    fichier d'indice k de nom filename, des mots de l'entrée de cache associée
+//    à c, puis signale les mots qui avaient été tronqués à sa lecture. Renvoie
+//    INGEST_MEM en cas de dépassement de capacité. Renvoie sinon INGEST_OK.
+static int ingest_cached(wordtable *wt, cache *c, size_t k,
+    const char *filename) {
+  const char *w;
+  size_t len;
+  SHW_OCCURRENCES_TYPE occ;
+  size_t wordcnt = 0;
+  while (cache_next_word(c, &w, &len, &occ)) {
+    shword *shw = wordtable_insert_hashed(wt, w, len, strhash_mem(w, len));
+    if (shw == NULL) {
+      return INGEST_MEM;
+    }
+    shword_add(shw, k, occ);
+    wordcnt += occ;
+  }
+  //  Aucun octet de la source n'a été lu.
+  stats_input(k, 0, wordcnt);
+  while (cache_next_trunc(c, &w)) {
+    ERRORA(ETRU, w, filename);
+  }
+  return INGEST_OK;
+}
+
+int ingest(wordtable *wt, const options *opts, size_t k, char *buf,
+    spill *sp) {
+  bool isstdin = opts->input[k] == NULL;
+  const char *filename = INPUT_NAME(opts, k);
+  FILE *f = isstdin ? stdin : fopen(opts->input[k], "r");
+  if (f == NULL) {
+    return errno;
+  }
+  int e = INGEST_MEM;
+  //  Avec un cache, une entrée valide remplace la lecture. Sinon, la source
+  //    est lue dans une table qui lui est propre afin d'enregistrer son seul
+  //    vocabulaire, table fusionnée ensuite dans celle associée à wt.
+  cache *c = NULL;
+  wordtable *dest = wt;
+  if (!isstdin && opts->cachedir != NULL) {
+    int ce = cache_open(&c, opts->cachedir, opts->input[k], fileno(f),
+        opts->charcnt, READ_MODE(opts));
+    if (ce == ENOMEM) {
+      goto close;
+    }
+    if (ce == 0 && cache_hit(c)) {
+      e = ingest_cached(wt, c, k, filename);
+      if (e == INGEST_OK && sp != NULL) {
+        e = ingest_spill(wt, opts, sp);
+      }
+      goto close;
+    }
+    if (c != NULL) {
+      dest = wordtable_empty();
+      if (dest == NULL) {
+        goto close;
+      }
+    }
+  }
+  reader *rd = reader_open(f, READ_MODE(opts));
+  if (rd == NULL) {
+    goto close;
+  }
+  size_t rcount;
+  size_t wlen;
+  size_t h;
+  size_t wordcnt = 0;
+  while ((rcount = reader_next(rd, buf, opts->charcnt, &wlen, &h)) > 0) {
+    if (rcount == opts->charcnt + 1) {
+      ERRORA(ETRU, buf, filename);
+      if (c != NULL && cache_trunc(c, buf) != 0) {
+        goto dispose;
+      }
+    }
+    shword *shw = wordtable_insert_hashed(dest, buf, wlen, h);
+    if (shw == NULL) {
+      goto dispose;
+    }
+    //  Inutile de vérifier la valeur de retour puisque k sera toujours
+    //    inférieur au nombre d'entrées fourni à shword_setup, et que si le nb.
+    //    d'occ. a été atteint on ignore juste le retour puisque de toute
+    //    manière le compteur ne bougera plus.
+    shword_increment(shw, k);
+    //  Avec un cache, la table propre à la source n'est soumise à la taille
+    //    maximale qu'une fois fusionnée dans celle associée à wt.
+    if (++wordcnt % SPILL_PERIOD == 0 && sp != NULL && dest == wt) {
+      int se = ingest_spill(wt, opts, sp);
+      if (se != INGEST_OK) {
+        e = se;
+        goto dispose;
+      }
+    }
+  }
+  e = reader_error(rd);
+  stats_input(k, reader_bytes(rd), wordcnt);
+  if (e == 0 && dest != wt) {
+    int ce = cache_store(c, wordtable_words(dest));
+    if (ce != 0) {
+      ERRORA(ECAC, filename, strerror(ce));
+    }
+    e = wordtable_merge(wt, dest) != 0 ? INGEST_MEM : INGEST_OK;
+    if (e == INGEST_OK && sp != NULL) {
+      e = ingest_spill(wt, opts, sp);
+    }
+  }
+  dispose:
+  reader_dispose(&rd);
+  close:
+  if (dest != wt) {
+    wordtable_dispose(&dest);
+  }
+  cache_dispose(&c);
+  if (isstdin) {
+    clearerr(f);
+  } else {
+    fclose(f);
+  }
+  return e;
+}
+
+int ingest_run(wordtable **runs, const options *opts, size_t k, char *buf) {
+  runs[k] = wordtable_empty();
+  if (runs[k] == NULL) {
+    return INGEST_MEM;
+  }
+  int e = ingest(runs[k], opts, k, buf, NULL);
+  if (e == INGEST_OK && holdall_sort(wordtable_words(runs[k]),
+      (int (*)(const void *, const void *))shword_compare_words) != 0) {
+    e = INGEST_MEM;
+  }
+  return e;
+}
+
+int ingest_spill(wordtable *wt, const options *opts, spill *sp) {
+  int e = spill_over(sp, wt, opts->memlimit);
+  if (e == ENOMEM) {
+    return INGEST_MEM;
+  }
+  if (e != 0) {
+    ERRORA(ESPI, strerror(e));
+    return INGEST_SPILL;
+  }
+  return INGEST_OK;
+}
+
+//  struct ingest_pool : structure partagée par les fils d'exécution lancés
+//    par ingest_parallel. Le composant next est l'indice de la prochaine
+//    entrée à lire, protégé par le verrou lock ; failed et error mémorisent
+//    l'indice et le code de retour de la première entrée en erreur, error
+//    valant INGEST_OK tant qu'aucune erreur n'est survenue.
+struct ingest_pool {
+  const options *opts;
+  wordtable **runs;
+  pthread_mutex_t lock;
+  size_t next;
+  size_t failed;
+  int error;
+};
+
+//  struct ingest_job : structure propre à chaque fil d'exécution lancé par
+//    ingest_parallel : sa table, son tampon de lecture et le lot commun.
+struct ingest_job {
+  struct ingest_pool *pool;
+  wordtable *wt;
+  char *buf;
+};
+
+//  ingest_pool_take : renvoie l'indice de la prochaine entrée ne désignant pas
+//    l'entrée standard restant à lire dans le lot associé à pool, ou le nombre
+//    d'entrées s'il n'en reste plus ou si une erreur est survenue.
+static size_t ingest_pool_take(struct ingest_pool *pool) {
+  pthread_mutex_lock(&pool->lock);
+  size_t k = pool->next;
+  while (k < pool->opts->inputcnt && pool->opts->input[k] == NULL) {
+    ++k;
+  }
+  if (pool->error != INGEST_OK) {
+    k = pool->opts->inputcnt;
+  }
+  pool->next = k < pool->opts->inputcnt ? k + 1 : k;
+  pthread_mutex_unlock(&pool->lock);
+  return k;
+}
+
+//  ingest_pool_fail : mémorise dans le lot associé à pool l'erreur e survenue
+//    sur l'entrée d'indice k si aucune erreur sur une entrée d'indice
+//    inférieur n'a déjà été mémorisée.
+static void ingest_pool_fail(struct ingest_pool *pool, size_t k, int e) {
+  pthread_mutex_lock(&pool->lock);
+  if (pool->error == INGEST_OK || k < pool->failed) {
+    pool->error = e;
+    pool->failed = k;
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+//  ingest_worker : fonction exécutée par les fils d'exécution lancés par
+//    ingest_parallel. Lit les entrées du lot dans la table du travail associé
+//    à job jusqu'à ce qu'il n'en reste plus.
+static void *ingest_worker(struct ingest_job *job) {
+  struct ingest_pool *pool = job->pool;
+  size_t k;
+  while ((k = ingest_pool_take(pool)) < pool->opts->inputcnt) {
+    int e = pool->runs != NULL ? ingest_run(pool->runs, pool->opts, k, job->buf)
+        : ingest(job->wt, pool->opts, k, job->buf, NULL);
+    if (e != INGEST_OK) {
+      ingest_pool_fail(pool, k, e);
+    }
+  }
+  return NULL;
+}
+
+int ingest_parallel(wordtable *wt, wordtable **runs, const options *opts,
+    size_t first, size_t jobcnt, size_t *failedptr) {
+  struct ingest_pool pool = {
+    .opts = opts,
+    .runs = runs,
+    .next = first,
+    .failed = 0,
+    .error = INGEST_OK,
+  };
+  if (jobcnt > opts->inputcnt - first) {
+    jobcnt = opts->inputcnt - first;
+  }
+  struct ingest_job *jobs = calloc(jobcnt, sizeof *jobs);
+  pthread_t *threads = malloc(jobcnt * sizeof *threads);
+  if (jobs == NULL || threads == NULL
+      || pthread_mutex_init(&pool.lock, NULL) != 0) {
+    free(jobs);
+    free(threads);
+    return INGEST_MEM;
+  }
+  size_t started = 0;
+  while (started < jobcnt) {
+    struct ingest_job *job = &jobs[started];
+    job->pool = &pool;
+    job->wt = runs == NULL ? wordtable_empty() : NULL;
+    job->buf = malloc(BUF_SIZE(opts));
+    if ((runs == NULL && job->wt == NULL) || job->buf == NULL) {
+      ingest_pool_fail(&pool, 0, INGEST_MEM);
+      break;
+    }
+    int e = pthread_create(&threads[started], NULL,
+        (void *(*)(void *))ingest_worker, job);
+    if (e != 0) {
+      ERRORA(ETHR, strerror(e));
+      ingest_pool_fail(&pool, 0, INGEST_MEM);
+      break;
+    }
+    ++started;
+  }
+  for (size_t k = 0; k < started; ++k) {
+    pthread_join(threads[k], NULL);
+  }
+  //  La fusion a lieu dans l'ordre des fils d'exécution ; l'ordre final des
+  //    mots ne dépend que de shword_compare et est donc indifférent à celui-ci.
+  for (size_t k = 0; runs == NULL && k < started
+      && pool.error == INGEST_OK; ++k) {
+    if (wordtable_merge(wt, jobs[k].wt) != 0) {
+      pool.error = INGEST_MEM;
+    }
+  }
+  for (size_t k = 0; k < jobcnt; ++k) {
+    wordtable_dispose(&jobs[k].wt);
+    free(jobs[k].buf);
+  }
+  pthread_mutex_destroy(&pool.lock);
+  free(jobs);
+  free(threads);
+  *failedptr = pool.failed;
+  return pool.error;
+}
+
+//  struct ingest_sink : fonction sink à exécuter, avec le contexte context,
+//    pour chacun des mots de l'entrée d'indice k lue par ingest_each dans une
+//    table qui lui est propre.
+struct ingest_sink {
+  int (*sink)(void *context, const char *w, size_t len, size_t h, size_t k,
+      SHW_OCCURRENCES_TYPE occ);
+  void *context;
+  size_t k;
+};
+
+//  ingest_sink_word : exécute la fonction de s sur le mot partagé associé à
+//    shw, de longueur len et de somme de hachage h, avec son nombre
+//    d'occurrences. Renvoie la valeur renvoyée par celle-ci.
+static int ingest_sink_word(struct ingest_sink *s, const shword *shw,
+    size_t len, size_t h) {
+  return s->sink(s->context, shword_word(shw), len, h, s->k,
+      shword_occurrences(shw));
+}
+
+//  ingest_each : lit mot à mot l'entrée d'indice k de la structure associée à
+//    opts et exécute sink(context, w, len, h, k, 1) pour chacun des mots lus,
+//    de chaine w, de longueur len et de somme de hachage h. Avec un cache,
+//    l'entrée est lue par ingest dans une table qui lui est propre, et sink
+//    est exécutée pour chacun de ses mots avec son nombre d'occurrences et la
+//    longueur et la somme de hachage mémorisées par la table. Le tampon
+//    pointé par buf doit être de taille au moins BUF_SIZE(opts). Renvoie
+//    INGEST_MEM si sink a renvoyé une valeur non nulle. Renvoie sinon
+//    les mêmes valeurs que la fonction ingest.
+static int ingest_each(const options *opts, size_t k, char *buf,
+    int (*sink)(void *context, const char *w, size_t len, size_t h, size_t k,
+      SHW_OCCURRENCES_TYPE occ),
+    void *context) {
+  if (opts->cachedir != NULL && opts->input[k] != NULL) {
+    wordtable *wt = wordtable_empty();
+    if (wt == NULL) {
+      return INGEST_MEM;
+    }
+    int e = ingest(wt, opts, k, buf, NULL);
+    struct ingest_sink s = {
+      .sink = sink,
+      .context = context,
+      .k = k,
+    };
+    if (e == INGEST_OK && wordtable_apply_hashed(wt, &s,
+        (int (*)(void *, shword *, size_t, size_t))ingest_sink_word) != 0) {
+      e = INGEST_MEM;
+    }
+    wordtable_dispose(&wt);
+    return e;
+  }
+  bool isstdin = opts->input[k] == NULL;
+  const char *filename = INPUT_NAME(opts, k);
+  FILE *f = isstdin ? stdin : fopen(opts->input[k], "r");
+  if (f == NULL) {
+    return errno;
+  }
+  int e = INGEST_MEM;
+  reader *rd = reader_open(f, READ_MODE(opts));
+  if (rd == NULL) {
+    goto close;
+  }
+  size_t rcount;
+  size_t wlen;
+  size_t h;
+  size_t wordcnt = 0;
+  while ((rcount = reader_next(rd, buf, opts->charcnt, &wlen, &h)) > 0) {
+    if (rcount == opts->charcnt + 1) {
+      ERRORA(ETRU, buf, filename);
+    }
+    if (sink(context, buf, wlen, h, k, 1) != 0) {
+      goto dispose;
+    }
+    ++wordcnt;
+  }
+  e = reader_error(rd);
+  stats_input(k, reader_bytes(rd), wordcnt);
+  dispose:
+  reader_dispose(&rd);
+  close:
+  if (isstdin) {
+    clearerr(f);
+  } else {
+    fclose(f);
+  }
+  return e;
+}
+
+//  INGEST_SINK : conversion de la fonction f en fonction de traitement des
+//    mots lus par ingest_each.
+#define INGEST_SINK(f)                                                         \
+  ((int (*)(void *, const char *, size_t, size_t, size_t,                      \
+    SHW_OCCURRENCES_TYPE))(f))
+
+//  struct shard_job : structure propre à chaque fil de lecture lancé par
+//    ingest_sharded, ainsi qu'au fil principal : le moteur d'agrégation, son
+//    indice de producteur dans celui-ci, son tampon de lecture et le lot
+//    commun.
+struct shard_job {
+  struct ingest_pool *pool;
+  shard *sd;
+  size_t producer;
+  char *buf;
+};
+
+//  shard_send : transmet au moteur d'agrégation du travail associé à job occ
+//    occurrences dans l'entrée d'indice k du mot de longueur len et de somme
+//    de hachage h pointé par w. Renvoie zéro.
+static int shard_send(struct shard_job *job, const char *w, size_t len,
+    size_t h, size_t k, SHW_OCCURRENCES_TYPE occ) {
+  return shard_route(job->sd, job->producer, w, len, h, k, occ);
+}
+
+//  shard_tokenize : fonction exécutée par les fils de lecture lancés par
+//    ingest_sharded. Lit les entrées du lot et transmet leurs mots jusqu'à ce
+//    qu'il n'en reste plus, puis clôt les files du producteur.
+static void *shard_tokenize(struct shard_job *job) {
+  struct ingest_pool *pool = job->pool;
+  size_t k;
+  while ((k = ingest_pool_take(pool)) < pool->opts->inputcnt) {
+    int e = ingest_each(pool->opts, k, job->buf, INGEST_SINK(shard_send),
+        job);
+    if (e != INGEST_OK) {
+      ingest_pool_fail(pool, k, e);
+    }
+  }
+  shard_finish(job->sd, job->producer);
+  return NULL;
+}
+
+int ingest_sharded(wordtable **shards, size_t shardcnt, const options *opts,
+    size_t first, size_t jobcnt, size_t minfiles, size_t *failedptr) {
+  struct ingest_pool pool = {
+    .opts = opts,
+    .runs = NULL,
+    .next = first,
+    .failed = 0,
+    .error = INGEST_OK,
+  };
+  size_t filecnt = 0;
+  for (size_t k = first; k < opts->inputcnt; ++k) {
+    filecnt += opts->input[k] != NULL;
+  }
+  //  Le dernier des tokcnt + 1 producteurs est le fil principal, qui lit
+  //    l'entrée standard.
+  size_t tokcnt = jobcnt < filecnt ? jobcnt : filecnt;
+  shard *sd = NULL;
+  struct shard_job *jobs = calloc(tokcnt + 1, sizeof *jobs);
+  pthread_t *threads = malloc((tokcnt + 1) * sizeof *threads);
+  size_t started = 0;
+  bool locked = false;
+  if (jobs == NULL || threads == NULL) {
+    pool.error = INGEST_MEM;
+    goto dispose;
+  }
+  for (size_t p = 0; p <= tokcnt; ++p) {
+    jobs[p].buf = malloc(BUF_SIZE(opts));
+    if (jobs[p].buf == NULL) {
+      pool.error = INGEST_MEM;
+      goto dispose;
+    }
+  }
+  if (pthread_mutex_init(&pool.lock, NULL) != 0) {
+    pool.error = INGEST_MEM;
+    goto dispose;
+  }
+  locked = true;
+  int e = shard_open(&sd, shards, shardcnt, tokcnt + 1, BUF_SIZE(opts),
+      minfiles);
+  if (e != 0) {
+    if (e != ENOMEM) {
+      ERRORA(ETHR, strerror(e));
+    }
+    pool.error = INGEST_MEM;
+    goto dispose;
+  }
+  for (size_t p = 0; p <= tokcnt; ++p) {
+    jobs[p].pool = &pool;
+    jobs[p].sd = sd;
+    jobs[p].producer = p;
+  }
+  //  Les fils de lecture ne sont lancés qu'une fois chaque file pourvue de son
+  //    fil d'agrégation : aucun d'eux ne peut alors rester endormi sur une
+  //    file pleine. Les files des producteurs qui n'ont pas été lancés sont
+  //    closes par shard_join.
+  while (started < tokcnt) {
+    e = pthread_create(&threads[started], NULL,
+        (void *(*)(void *))shard_tokenize, &jobs[started]);
+    if (e != 0) {
+      ERRORA(ETHR, strerror(e));
+      ingest_pool_fail(&pool, 0, INGEST_MEM);
+      break;
+    }
+    ++started;
+  }
+  for (size_t k = first; k < opts->inputcnt; ++k) {
+    if (opts->input[k] == NULL && pool.error == INGEST_OK) {
+      e = ingest_each(opts, k, jobs[tokcnt].buf, INGEST_SINK(shard_send),
+          &jobs[tokcnt]);
+      if (e != INGEST_OK) {
+        ingest_pool_fail(&pool, k, e);
+      }
+    }
+  }
+  for (size_t t = 0; t < started; ++t) {
+    pthread_join(threads[t], NULL);
+  }
+  size_t distinct = 0;
+  if (shard_join(sd, &distinct) != 0) {
+    ingest_pool_fail(&pool, 0, INGEST_MEM);
+  }
+  if (minfiles > 1) {
+    stats_words(distinct, 0);
+  }
+  dispose:
+  shard_dispose(&sd);
+  for (size_t p = 0; jobs != NULL && p <= tokcnt; ++p) {
+    free(jobs[p].buf);
+  }
+  if (locked) {
+    pthread_mutex_destroy(&pool.lock);
+  }
+  free(jobs);
+  free(threads);
+  *failedptr = pool.failed;
+  return pool.error;
+}
+
+//  struct shared_job : structure propre à chaque fil d'exécution lancé par
+//    ingest_shared, ainsi qu'au fil principal : la table commune, l'indice de
+//    son rédacteur dans celle-ci, son tampon de lecture et le lot commun.
+struct shared_job {
+  struct ingest_pool *pool;
+  cwordtable *cwt;
+  size_t writer;
+  char *buf;
+};
+
+//  shared_mark : marque dans la table commune du travail associé à job occ
+//    occurrences dans l'entrée d'indice k du mot de longueur len et de somme
+//    de hachage h pointé par w. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int shared_mark(struct shared_job *job, const char *w, size_t len,
+    size_t h, size_t k, SHW_OCCURRENCES_TYPE occ) {
+  shword *shw = cwordtable_insert_hashed(job->cwt, job->writer, w, len, h);
+  if (shw == NULL) {
+    return -1;
+  }
+  if (occ == 1) {
+    shword_increment_atomic(shw, k);
+  } else {
+    shword_add_atomic(shw, k, occ);
+  }
+  return 0;
+}
+
+//  shared_worker : fonction exécutée par les fils d'exécution lancés par
+//    ingest_shared. Lit les entrées du lot dans la table commune jusqu'à ce
+//    qu'il n'en reste plus.
+static void *shared_worker(struct shared_job *job) {
+  struct ingest_pool *pool = job->pool;
+  size_t k;
+  while ((k = ingest_pool_take(pool)) < pool->opts->inputcnt) {
+    int e = ingest_each(pool->opts, k, job->buf, INGEST_SINK(shared_mark),
+        job);
+    if (e != INGEST_OK) {
+      ingest_pool_fail(pool, k, e);
+    }
+  }
+  return NULL;
+}
+
+int ingest_shared(cwordtable *cwt, const options *opts, size_t first,
+    size_t jobcnt, char *buf, size_t *failedptr) {
+  struct ingest_pool pool = {
+    .opts = opts,
+    .runs = NULL,
+    .next = first,
+    .failed = 0,
+    .error = INGEST_OK,
+  };
+  size_t filecnt = 0;
+  for (size_t k = first; k < opts->inputcnt; ++k) {
+    filecnt += opts->input[k] != NULL;
+  }
+  //  Le fil principal, qui lit l'entrée standard, est le rédacteur d'indice
+  //    jobcnt.
+  struct shared_job main_job = {
+    .pool = &pool,
+    .cwt = cwt,
+    .writer = jobcnt,
+    .buf = buf,
+  };
+  if (jobcnt > filecnt) {
+    jobcnt = filecnt;
+  }
+  struct shared_job *jobs = calloc(jobcnt, sizeof *jobs);
+  pthread_t *threads = malloc(jobcnt * sizeof *threads);
+  if ((jobcnt > 0 && (jobs == NULL || threads == NULL))
+      || pthread_mutex_init(&pool.lock, NULL) != 0) {
+    free(jobs);
+    free(threads);
+    return INGEST_MEM;
+  }
+  size_t started = 0;
+  while (started < jobcnt) {
+    struct shared_job *job = &jobs[started];
+    job->pool = &pool;
+    job->cwt = cwt;
+    job->writer = started;
+    job->buf = malloc(BUF_SIZE(opts));
+    if (job->buf == NULL) {
+      ingest_pool_fail(&pool, 0, INGEST_MEM);
+      break;
+    }
+    int e = pthread_create(&threads[started], NULL,
+        (void *(*)(void *))shared_worker, job);
+    if (e != 0) {
+      ERRORA(ETHR, strerror(e));
+      ingest_pool_fail(&pool, 0, INGEST_MEM);
+      break;
+    }
+    ++started;
+  }
+  for (size_t k = first; k < opts->inputcnt; ++k) {
+    if (opts->input[k] == NULL && pool.error == INGEST_OK) {
+      int e = ingest_each(opts, k, buf, INGEST_SINK(shared_mark), &main_job);
+      if (e != INGEST_OK) {
+        ingest_pool_fail(&pool, k, e);
+      }
+    }
+  }
+  for (size_t k = 0; k < started; ++k) {
+    pthread_join(threads[k], NULL);
+  }
+  for (size_t k = 0; k < jobcnt; ++k) {
+    free(jobs[k].buf);
   }
-  return h;
+  pthread_mutex_destroy(&pool.lock);
+  free(jobs);
+  free(threads);
+  *failedptr = pool.failed;
+  return pool.error;
 }
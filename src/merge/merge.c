@@ -0,0 +1,161 @@
+//  Implantation du module merge - l'arbre des perdants de n vocabulaires est
+//    un tableau tree de n cases : tree[0] est l'indice du vocabulaire dont le
+//    mot courant est le plus petit, les cases tree[1] à tree[n - 1] forment un
+//    tas dont chaque nœud mémorise le perdant du match qui s'y est joué. Les
+//    feuilles, implicites, sont d'indices n à 2n - 1. Le remplacement du mot
+//    courant du vainqueur ne rejoue que les matchs de sa feuille à la racine,
+//    soit environ log2(n) comparaisons.
+
+#include <string.h>
+#include "arena.h"
+#include "merge.h"
+
+//  struct merge, merge : le composant words est le fourretout des mots
+//    partagés produits, alloués dans la réserve ar, et distinct le nombre de
+//    chaines distinctes rencontrées.
+struct merge {
+  holdall *words;
+  arena *ar;
+  size_t distinct;
+};
+
+merge *merge_empty(void) {
+  merge *m = malloc(sizeof *m);
+  if (m == NULL) {
+    return NULL;
+  }
+  m->words = holdall_empty();
+  m->ar = arena_empty();
+  m->distinct = 0;
+  if (m->words == NULL || m->ar == NULL) {
+    merge_dispose(&m);
+    return NULL;
+  }
+  return m;
+}
+
+//  struct merge__run : état du parcours d'un vocabulaire : le fourretout ha,
+//    le rang pos du mot courant, le nombre count de mots et la chaine key du
+//    mot courant, NULL si le vocabulaire est épuisé.
+struct merge__run {
+  holdall *ha;
+  size_t pos;
+  size_t count;
+  const char *key;
+};
+
+//  merge__advance : passe au mot suivant du vocabulaire associé à r.
+static void merge__advance(struct merge__run *r) {
+  r->pos += 1;
+  r->key = r->pos < r->count
+      ? shword_word(holdall_at(r->ha, r->pos)) : NULL;
+}
+
+//  merge__beats : détermine si le mot courant du vocabulaire d'indice a du
+//    tableau pointé par runs précède celui du vocabulaire d'indice b, un
+//    vocabulaire épuisé étant précédé de tous les autres. L'indice n désigne
+//    une sentinelle qui précède tous les vocabulaires, utilisée lors de la
+//    construction de l'arbre.
+static bool merge__beats(const struct merge__run *runs, size_t n, size_t a,
+    size_t b) {
+  if (a == n || b == n) {
+    return a == n;
+  }
+  if (runs[b].key == NULL) {
+    return runs[a].key != NULL;
+  }
+  return runs[a].key != NULL && strcmp(runs[a].key, runs[b].key) < 0;
+}
+
+//  merge__replay : rejoue les matchs de la feuille du vocabulaire d'indice s à
+//    la racine de l'arbre des perdants tree de n vocabulaires.
+static void merge__replay(size_t *tree, const struct merge__run *runs,
+    size_t n, size_t s) {
+  for (size_t t = (s + n) / 2; t > 0; t /= 2) {
+    if (merge__beats(runs, n, tree[t], s)) {
+      size_t w = tree[t];
+      tree[t] = s;
+      s = w;
+    }
+  }
+  tree[0] = s;
+}
+
+int merge_join(merge *m, holdall * const *runs, size_t runcnt,
+    size_t minfiles) {
+  if (runcnt == 0) {
+    return 0;
+  }
+  int r = -1;
+  struct merge__run *rs = malloc(runcnt * sizeof *rs);
+  size_t *tree = malloc(runcnt * sizeof *tree);
+  const shword **group = malloc(runcnt * sizeof *group);
+  if (rs == NULL || tree == NULL || group == NULL) {
+    goto dispose;
+  }
+  for (size_t k = 0; k < runcnt; ++k) {
+    rs[k] = (struct merge__run) {
+      .ha = runs[k],
+      .pos = (size_t) -1,
+      .count = holdall_count(runs[k]),
+      .key = NULL,
+    };
+    merge__advance(&rs[k]);
+    tree[k] = runcnt;
+  }
+  for (size_t k = runcnt; k-- > 0; ) {
+    merge__replay(tree, rs, runcnt, k);
+  }
+  while (rs[tree[0]].key != NULL) {
+    //  Les mots de même chaine que le plus petit mot courant sont regroupés ;
+    //    leurs fichiers étant distincts, leurs nombres de fichiers s'ajoutent.
+    const char *w = rs[tree[0]].key;
+    size_t n = 0;
+    size_t fcount = 0;
+    do {
+      struct merge__run *run = &rs[tree[0]];
+      group[n] = holdall_at(run->ha, run->pos);
+      fcount += shword_filecount(group[n]);
+      ++n;
+      merge__advance(run);
+      merge__replay(tree, rs, runcnt, tree[0]);
+    } while (rs[tree[0]].key != NULL && strcmp(rs[tree[0]].key, w) == 0);
+    ++m->distinct;
+    if (fcount < minfiles) {
+      continue;
+    }
+    shword *shw = shword_create(m->ar, w, strlen(w));
+    if (shw == NULL || holdall_put(m->words, shw) != 0) {
+      goto dispose;
+    }
+    for (size_t k = 0; k < n; ++k) {
+      //  Inutile de vérifier la valeur de retour : si le nb. d'occ. a été
+      //    atteint, le compteur est simplement saturé.
+      shword_merge(shw, group[k]);
+    }
+  }
+  r = 0;
+  dispose:
+  free(rs);
+  free(tree);
+  free(group);
+  return r;
+}
+
+size_t merge_distinct(const merge *m) {
+  return m->distinct;
+}
+
+holdall *merge_words(merge *m) {
+  return m->words;
+}
+
+void merge_dispose(merge **mptr) {
+  if (*mptr == NULL) {
+    return;
+  }
+  holdall_dispose(&(*mptr)->words);
+  arena_dispose(&(*mptr)->ar);
+  free(*mptr);
+  *mptr = NULL;
+}
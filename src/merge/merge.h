@@ -0,0 +1,55 @@
+//  Interface du module merge - module implémentant la fusion de vocabulaires
+//    triés : chaque vocabulaire est un fourretout de mots partagés de chaines
+//    distinctes, trié selon shword_compare_words, et la fusion produit pour
+//    chaque chaine un seul mot partagé réunissant leurs motifs d'occurrences et
+//    leurs nombres d'occurrences.
+
+#ifndef MERGE__H
+#define MERGE__H
+
+#include <stdlib.h>
+#include "holdall.h"
+#include "shword.h"
+
+//  struct merge, merge : structure regroupant les mots partagés produits par
+//    la fusion et la réserve dans laquelle ils sont alloués. La création de la
+//    structure de données associée est confiée à la fonction merge_empty.
+typedef struct merge merge;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type merge * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    merge_empty et non révoqué depuis par merge_dispose. Cette règle ne
+//    souffre que d'une seule exception : merge_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  merge_empty : crée une structure de données ne contenant aucun mot partagé.
+//    Renvoie NULL en cas de dépassement de capacité. Renvoie sinon un pointeur
+//    vers l'objet qui gère la structure de données.
+extern merge *merge_empty(void);
+
+//  merge_join : fusionne les runcnt vocabulaires du tableau pointé par runs,
+//    dont les fichiers doivent être deux à deux distincts, et ajoute à la
+//    structure associée à m les mots partagés résultant de la fusion présents
+//    dans au moins minfiles fichiers, dans l'ordre croissant de leurs chaines.
+//    La fusion se fait en un seul parcours séquentiel de chaque vocabulaire, le
+//    plus petit mot courant étant désigné par un arbre des perdants. Renvoie
+//    une valeur non nulle en cas de dépassement de capacité. Renvoie sinon
+//    zéro.
+extern int merge_join(merge *m, holdall * const *runs, size_t runcnt,
+    size_t minfiles);
+
+//  merge_distinct : renvoie le nombre de chaines distinctes rencontrées par
+//    merge_join sur la structure associée à m, y compris celles présentes dans
+//    moins de minfiles fichiers.
+extern size_t merge_distinct(const merge *m);
+
+//  merge_words : renvoie le fourretout des mots partagés de la structure
+//    associée à m. Ils restent valides jusqu'à la révocation de m.
+extern holdall *merge_words(merge *m);
+
+//  merge_dispose : si *mptr ne vaut pas NULL, libère les ressources allouées à
+//    la structure de données associée à *mptr, mots partagés compris, puis
+//    affecte à *mptr la valeur NULL.
+extern void merge_dispose(merge **mptr);
+
+#endif
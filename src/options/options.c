@@ -11,12 +11,22 @@
 //  DEF_* : valeurs par défaut pour une option donnée.
 #define DEF_INIT 63
 #define DEF_TOP 10
+#define DEF_JOBS 1
+#define DEF_MEML 0
+#define DEF_LDFA 0
+
+//  ARG_SIZE : nom de l'argument des options entières qui acceptent les
+//    suffixes multiplicatifs K, M et G.
+#define ARG_SIZE "SIZE"
 
 //  DESC_* : description succinte de l'option et de ses conséquences. Affiché
 //    dans l'aide du programme.
 #define DESC_INIT "\tThe number of significant characters in a word. If the"   \
   " word read is longer than the given value, then it is cut. Default is"      \
   " " XSTR(DEF_INIT) "."
+#define DESC_JOBS "\tThe number of threads reading the input files, each"      \
+  " one reading whole files. 0 means one per online processor. Default is"     \
+  " " XSTR(DEF_JOBS) "."
 #define DESC_PLSP "Treats punctuation characters as space characters."
 #define DESC_SNUM "\tDisplays words that share the same number of"             \
   " occurrences or presence as the last word displayed in the limit."
@@ -24,19 +34,55 @@
   " standard output. 0 means all the words. Default is " XSTR(DEF_TOP) "."
 #define DESC_UPPR "\tConverts all read lowercase characters to their"          \
   " uppercase form."
+#define DESC_UTF8 "\t\tReads the files as UTF-8: Unicode spaces and"           \
+  " punctuation are recognized, -u applies to all letters and -i counts"       \
+  " characters instead of bytes."
+#define DESC_ENGI "\tSelects how words are counted: hash, with a single hash"  \
+  " table, merge, with a sorted vocabulary per file joined by a k-way merge,"  \
+  " or shard, with words routed by hash from the reading threads to as many"   \
+  " aggregating threads, at most one per online processor, each owning its"    \
+  " own table, or shared, with all threads counting into a single lock-free"   \
+  " table. Default is hash."
+#define DESC_MEML "\tBounds the memory used to count words to the given"     \
+  " number of bytes, optionally suffixed with K, M or G. Beyond it, words"     \
+  " are spilled to temporary files and counted again, one part at a time."    \
+  " 0 means no limit. Default is " XSTR(DEF_MEML) "."
+#define DESC_LDFA "\tSets the load factor, in percent, beyond which the"       \
+  " word hash tables are enlarged. 0 means the default of the hash table:"     \
+  " 100 with separate chaining, 75 with open addressing, which only accepts"   \
+  " values below 100. Default is " XSTR(DEF_LDFA) "."
+#define DESC_LOAD "\tStarts from the word table saved in the given index"      \
+  " file instead of an empty one. The files given are added to it."
+#define DESC_SAVE "\tSaves the final word table, single-file words"            \
+  " included, to the given index file."
+#define DESC_CACH "\tKeeps the vocabulary of each file read in the given"      \
+  " directory and reuses it while the file is unchanged."
+#define DESC_SERV "\tRuns as a server answering, on the given local socket,"  \
+  " the requests of ws --connect, with as many threads as -j. The vocabulary" \
+  " of each file is kept in memory and read again once the file changes. A"   \
+  " request can name at most " XSTR(SERVE_INPUTMAX) " files."
+#define DESC_CONN "\tSends the files and the -i, -p, -s, -t, -u and --utf8"   \
+  " options to the server of the given local socket instead of reading the"   \
+  " files itself, and prints its answer."
+#define DESC_STAT "\t\tPrints to the standard error a report of the run:"    \
+  " time and hardware counters of the reading, sorting and display phases,"    \
+  " bytes and words read per file, distinct and shared word counts."
 #define DESC_HELP "\t\tDisplays this help message and exits."
 #define DESC_USAG "\t\tDisplays the expected syntax and exits."
 #define DESC_VERS "\t\tDisplays version information and exits."
 
 //  struct option : structure regroupant les informations d'une option : ses
-//    identificateurs, une description, son type (à argument ou non), sa valeur
-//    par défaut (ignorée si !has_arg) ainsi que l'emplacement où affecter sa
-//    valeur.
+//    identificateurs, une description, son type (à argument ou non, entier ou
+//    chaine), le nom de son argument dans l'aide, sa valeur par défaut
+//    (ignorée si !has_arg ou si is_str, la valeur par défaut d'une chaine étant
+//    NULL) ainsi que l'emplacement où affecter sa valeur.
 struct option {
   int short_id;         //  Identificateur court de l'option.
   const char *long_id;  //  Identificateur long de l'option.
   const char *desc;     //  Description succinte de l'option.
   bool has_arg;         //  true : option à valeur | false : drapeau
+  bool is_str;          //  si has_arg, true : chaine | false : entier
+  const char *arg;      //  si has_arg, nom de l'argument dans l'aide.
   size_t default_value; //  si has_arg, la valeur par défaut de l'option.
   size_t offset;        //  has_arg
                         //    ? décalage du champ par rapport à options.
@@ -47,15 +93,38 @@ struct option {
 //    tableau est de type struct option. La fin du tableau est marquée par une
 //    option sans identificateur court ni identificateur long.
 const struct option optlist[] = {
-    {'i', "initial", DESC_INIT, true, DEF_INIT, offsetof(options, charcnt)},
-    {'p', "punctuation-like-space", DESC_PLSP, false, 0, FLAG_PLSP},
-    {'s', "same-numbers", DESC_SNUM, false, 0, FLAG_SNUM},
-    {'t', "top", DESC_TOP, true, DEF_TOP, offsetof(options, wordcnt)},
-    {'u', "uppercasing", DESC_UPPR, false, 0, FLAG_UPPR},
-    {'?', "help", DESC_HELP, false, 0, FLAG_HELP},
-    {0, "usage", DESC_USAG, false, 0, FLAG_USAG},
-    {0, "version", DESC_VERS, false, 0, FLAG_VERS},
-    {0, NULL, NULL, false, 0, 0},
+    {'i', "initial", DESC_INIT, true, false, "VALUE", DEF_INIT,
+        offsetof(options, charcnt)},
+    {'j', "jobs", DESC_JOBS, true, false, "VALUE", DEF_JOBS,
+        offsetof(options, jobcnt)},
+    {'p', "punctuation-like-space", DESC_PLSP, false, false, NULL, 0,
+        FLAG_PLSP},
+    {'s', "same-numbers", DESC_SNUM, false, false, NULL, 0, FLAG_SNUM},
+    {'t', "top", DESC_TOP, true, false, "VALUE", DEF_TOP,
+        offsetof(options, wordcnt)},
+    {'u', "uppercasing", DESC_UPPR, false, false, NULL, 0, FLAG_UPPR},
+    {0, "utf8", DESC_UTF8, false, false, NULL, 0, FLAG_UTF8},
+    {0, "engine", DESC_ENGI, true, true, "ENGINE", 0,
+        offsetof(options, engine)},
+    {0, "memory-limit", DESC_MEML, true, false, ARG_SIZE, DEF_MEML,
+        offsetof(options, memlimit)},
+    {0, "load-factor", DESC_LDFA, true, false, "PERCENT", DEF_LDFA,
+        offsetof(options, ldfactor)},
+    {0, "load-index", DESC_LOAD, true, true, "FILE", 0,
+        offsetof(options, loadpath)},
+    {0, "save-index", DESC_SAVE, true, true, "FILE", 0,
+        offsetof(options, savepath)},
+    {0, "cache-dir", DESC_CACH, true, true, "DIR", 0,
+        offsetof(options, cachedir)},
+    {0, "serve", DESC_SERV, true, true, "SOCKET", 0,
+        offsetof(options, servepath)},
+    {0, "connect", DESC_CONN, true, true, "SOCKET", 0,
+        offsetof(options, connpath)},
+    {0, "stats", DESC_STAT, false, false, NULL, 0, FLAG_STAT},
+    {'?', "help", DESC_HELP, false, false, NULL, 0, FLAG_HELP},
+    {0, "usage", DESC_USAG, false, false, NULL, 0, FLAG_USAG},
+    {0, "version", DESC_VERS, false, false, NULL, 0, FLAG_VERS},
+    {0, NULL, NULL, false, false, NULL, 0, 0},
 };
 
 //  OPTLIST_END : détermine si p pointe sur le dernier élément du tableau
@@ -68,8 +137,14 @@ void options_defaults(options *o) {
     if (!p->has_arg) {
       continue;
     }
+    if (p->is_str) {
+      const char *null = NULL;
+      memcpy((char *) o + p->offset, &null, sizeof null);
+      continue;
+    }
     memcpy((char *) o + p->offset, &(p->default_value), sizeof(size_t));
   }
+  o->input = NULL;
   o->inputcnt = 0;
 }
 
@@ -100,7 +175,10 @@ static const struct option *options_find_bylong(const char *s, size_t len) {
 
 #define HELP_VALIDSYNTAX "Usage: %s [OPTION]... FILES"
 #define HELP_DESCRIPTION "%s — Prints a list of shared words between text files"
-#define HELP_FILESNUMBER "Between 2 and %lu files are expected."
+#define HELP_FILESNUMBER "At least 2 files are expected, unless an index is"   \
+  " loaded or a server is run."
+#define HELP_COMPRESSED "Files compressed with gzip or zstd are read"          \
+  " decompressed, if the format is supported by this build."
 #define HELP_OCCURRENCES "If a word occurs more than %lu times, many is shown" \
   " instead."
 #define HELP_VERSIONINFO "%s — Compiled on " __DATE__ " at " __TIME__ "."
@@ -131,12 +209,12 @@ static void options_help() {
     }
     printf("--%s", p->long_id);
     if (p->has_arg) {
-      printf("=VALUE");
+      printf("=%s", p->arg);
     }
     printf("\t%s\n", p->desc);
   }
-  printf("\n" HELP_FILESNUMBER "\n" HELP_OCCURRENCES "\n",
-         INPUT_MAX, SHW_OCCURRENCES_MAX - 1);
+  printf("\n" HELP_FILESNUMBER "\n" HELP_COMPRESSED "\n" HELP_OCCURRENCES "\n",
+         SHW_OCCURRENCES_MAX - 1);
   exit(EXIT_SUCCESS);
 }
 
@@ -147,12 +225,31 @@ static void options_help() {
 
 #define ENOFILE "Missing filename: '%s'."
 #define EFILEUN "At least 2 files are expected."
-#define EFILEOV "Number of files exceeding capacity."
+#define ENOMEMO "Not enough memory."
 #define EUKNOPT "Unrecognized option '%s'."
 #define EMISARG "Missing argument '%s'."
 #define EINVARG "Invalid argument '%s'."
 #define EOVEARG "Overflowing argument '%s'."
 #define ENOAARG "No argument allowed '%s'."
+#define EUKNENG "Unknown engine '%s'."
+
+//  options_size_shift : renvoie le décalage binaire correspondant au suffixe
+//    multiplicatif c d'une valeur d'argument ARG_SIZE, zéro si c n'en est pas
+//    un.
+static int options_size_shift(char c) {
+  switch (c) {
+    case 'K':
+    case 'k':
+      return 10;
+    case 'M':
+    case 'm':
+      return 20;
+    case 'G':
+    case 'g':
+      return 30;
+  }
+  return 0;
+}
 
 //  options_parse : augmente la structure associée à o des options et sources
 //    fournies par l'utilisateur via le tableau d'arguments de longueur argc
@@ -161,14 +258,17 @@ static void options_help() {
 //    Renvoie une valeur négative si une erreur de traitement est survenue.
 //    Renvoie sinon zéro.
 int options_parse(int argc, char *argv[], options *o) {
+  //  Chaque argument désigne au plus une source : argc places suffisent.
+  const char **input = realloc(o->input, (size_t) argc * sizeof *input);
+  if (input == NULL) {
+    ERROR(ENOMEMO);
+    return -1;
+  }
+  o->input = input;
   int idx = 1;
   while (idx < argc) {
     const char *optstr = argv[idx++];
     if (IS_INPUT(optstr)) {
-      if (o->inputcnt == INPUT_MAX) {
-        ERROR(EFILEOV);
-        return -1;
-      }
       o->input[o->inputcnt++] = strcmp(optstr, "-") == 0 ? NULL : optstr;
       continue;
     }
@@ -178,10 +278,6 @@ int options_parse(int argc, char *argv[], options *o) {
         ERRORA(ENOFILE, optstr);
         return -1;
       }
-      if (o->inputcnt == INPUT_MAX) {
-        ERROR(EFILEOV);
-        return -1;
-      }
       o->input[o->inputcnt++] = filename;
       continue;
     }
@@ -202,20 +298,35 @@ int options_parse(int argc, char *argv[], options *o) {
         ERRORA(EMISARG, optstr);
         return -1;
       }
-      if (*value == '\0' || strchr(value, '-')) {
+      if (*value == '\0') {
+        ERRORA(EINVARG, optstr);
+        return -1;
+      }
+      if (curopt->is_str) {
+        memcpy((char *) o + curopt->offset, &value, sizeof value);
+        continue;
+      }
+      if (strchr(value, '-')) {
         ERRORA(EINVARG, optstr);
         return -1;
       }
       char *end;
       unsigned long n = strtoul(value, &end, 10);
+      int shift = 0;
+      if (strcmp(curopt->arg, ARG_SIZE) == 0 && *end != '\0'
+          && *(end + 1) == '\0') {
+        shift = options_size_shift(*end);
+        end += shift > 0;
+      }
       if (*end != '\0') {
         ERRORA(EINVARG, optstr);
         return -1;
       }
-      if (n > SIZE_MAX) {
+      if (n > SIZE_MAX >> shift) {
         ERRORA(EOVEARG, optstr);
         return -1;
       }
+      n <<= shift;
       memcpy((char *) o + curopt->offset, &n, sizeof(size_t));
     } else {
       if (strchr(optstr + 2, '=') != NULL) {
@@ -235,9 +346,22 @@ int options_parse(int argc, char *argv[], options *o) {
       o->flags |= (1 << curopt->offset);
     }
   }
-  if (o->inputcnt < 2) {
+  if (o->engine != NULL && strcmp(o->engine, ENGINE_HASH) != 0
+      && strcmp(o->engine, ENGINE_MERGE) != 0
+      && strcmp(o->engine, ENGINE_SHARD) != 0
+      && strcmp(o->engine, ENGINE_SHARED) != 0) {
+    ERRORA(EUKNENG, o->engine);
+    return -1;
+  }
+  if (o->loadpath == NULL && o->servepath == NULL && o->inputcnt < 2) {
     ERROR(EFILEUN);
     return -1;
   }
   return 0;
 }
+
+void options_dispose(options *o) {
+  free(o->input);
+  o->input = NULL;
+  o->inputcnt = 0;
+}
@@ -24,9 +24,11 @@ extern char *program_invocation_short_name;
 #define ERROR(STR) fprintf(stderr, "%s: " STR "\n", PRNAME)
 #define ERRORA(STR, ...) fprintf(stderr, "%s: " STR "\n", PRNAME, __VA_ARGS__)
 
-//  INPUT_MAX : le nombre maximal de sources de fichier pouvant être prises en
-//    compte par le programme.
-#define INPUT_MAX SHW_PATTERN_MAX
+//  FERROR, FERRORA : mêmes macrofonctions, l'erreur étant affichée sur le flot
+//    contrôlé par F.
+#define FERROR(F, STR) fprintf((F), "%s: " STR "\n", PRNAME)
+#define FERRORA(F, STR, ...)                                                   \
+  fprintf((F), "%s: " STR "\n", PRNAME, __VA_ARGS__)
 
 //  FLAG_HAS, FLAG_SET : macrofonctions utilitaires sur la gestion des drapeaux.
 #define FLAG_HAS(d, f) (((d) & (1 << (f))) == (1 << (f)))
@@ -41,24 +43,48 @@ enum OPTIONS_FLAGS {
   FLAG_PLSP,
   FLAG_SNUM,
   FLAG_UPPR,
+  FLAG_UTF8,
+  FLAG_STAT,
 };
 
+//  ENGINE_HASH, ENGINE_MERGE, ENGINE_SHARD, ENGINE_SHARED : noms des moteurs
+//    de comptage acceptés par l'option --engine.
+#define ENGINE_HASH "hash"
+#define ENGINE_MERGE "merge"
+#define ENGINE_SHARD "shard"
+#define ENGINE_SHARED "shared"
+
+//  SERVE_INPUTMAX : nombre maximal de sources d'une requête adressée au
+//    serveur de l'option --serve, qui fixe pour toute sa durée la taille des
+//    motifs d'occurrences des mots.
+#define SERVE_INPUTMAX 256
+
 //  struct options, options : structure regroupant les données fournissables par
 //    l'utilisateur via la ligne de commande. La conformité du contenu de la
 //    structure n'est garantie qu'après une initialisation aux valeurs par
 //    défaut (à l'aide de options_defaults) et la récupération en bonne et due
-//    forme de l'entrée utilisateur (à l'aide de options_parse).
+//    forme de l'entrée utilisateur (à l'aide de options_parse). Le tableau des
+//    sources est alloué par options_parse et libéré par options_dispose.
 typedef struct options {
   int flags;        //  Options à drapeaux (8 options max avec le type char).
   size_t charcnt;   //  Nb. de caractères significatifs d'un mot.
   size_t wordcnt;   //  Nb. de mots à produire sur la sortie standard.
-  const char *input[INPUT_MAX]; //  Tableau des sources d'entrées.
+  size_t jobcnt;    //  Nb. de fils d'exécution consacrés à la lecture.
+  size_t memlimit;  //  Taille maximale de la table de comptage, 0 sinon.
+  size_t ldfactor;  //  Seuil des tables de hachage en pourcentage, 0 sinon.
+  const char *engine;   //  Moteur de comptage, ou NULL pour ENGINE_HASH.
+  const char *loadpath; //  Fichier d'index de départ, ou NULL.
+  const char *savepath; //  Fichier d'index à produire, ou NULL.
+  const char *cachedir; //  Répertoire du cache des vocabulaires, ou NULL.
+  const char *servepath; // Socket sur laquelle servir les requêtes, ou NULL.
+  const char *connpath; //  Socket du serveur à interroger, ou NULL.
+  const char **input; //  Tableau des sources d'entrées.
   size_t inputcnt;  //  Taille utile du tableau input.
 } options;
 
 //  options_defaults : affecte à la structure associée à o les valeurs par
-//    défaut pour chaque option et initialise la taille du tableau de sources à
-//    zéro.
+//    défaut pour chaque option et initialise le tableau de sources à un tableau
+//    vide.
 extern void options_defaults(options *o);
 
 //  options_parse : augmente la structure associée à o des options et sources
@@ -69,4 +95,8 @@ extern void options_defaults(options *o);
 //    Renvoie sinon zéro.
 extern int options_parse(int argc, char *argv[], options *o);
 
+//  options_dispose : libère le tableau de sources de la structure associée à
+//    o puis le remplace par un tableau vide.
+extern void options_dispose(options *o);
+
 #endif
@@ -0,0 +1,110 @@
+//  Implantation du module output.
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include "output.h"
+
+//  OUTPUT__CAPACITY : capacité initiale du tampon d'écriture.
+#define OUTPUT__CAPACITY (256 * 1024)
+
+//  output__digits : table des écritures décimales, sur deux caractères, des
+//    entiers de 0 à 99.
+static const char output__digits[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+size_t output_format_ulong(char *dest, unsigned long n) {
+  //  Les chiffres sont produits deux à deux, des poids faibles aux poids
+  //    forts, à la fin d'un tampon local.
+  char tmp[OUTPUT_ULONG_LEN];
+  char *p = tmp + sizeof tmp;
+  while (n >= 100) {
+    const char *d = output__digits + 2 * (n % 100);
+    n /= 100;
+    p -= 2;
+    memcpy(p, d, 2);
+  }
+  if (n >= 10) {
+    p -= 2;
+    memcpy(p, output__digits + 2 * n, 2);
+  } else {
+    *--p = (char) ('0' + n);
+  }
+  size_t len = (size_t) (tmp + sizeof tmp - p);
+  memcpy(dest, p, len);
+  return len;
+}
+
+//  struct output : le tampon de capacity caractères pointé par buf contient
+//    les len caractères pas encore transmis au flot contrôlé par f.
+struct output {
+  FILE *f;
+  char *buf;
+  size_t len;
+  size_t capacity;
+};
+
+output *output_open(FILE *f) {
+  output *o = malloc(sizeof *o);
+  if (o == NULL) {
+    return NULL;
+  }
+  o->buf = malloc(OUTPUT__CAPACITY);
+  if (o->buf == NULL) {
+    free(o);
+    return NULL;
+  }
+  o->f = f;
+  o->len = 0;
+  o->capacity = OUTPUT__CAPACITY;
+  return o;
+}
+
+char *output_reserve(output *o, size_t n) {
+  if (o->capacity - o->len >= n) {
+    return o->buf + o->len;
+  }
+  if (output_flush(o) != 0) {
+    return NULL;
+  }
+  if (o->capacity < n) {
+    char *a = realloc(o->buf, n);
+    if (a == NULL) {
+      errno = ENOMEM;
+      return NULL;
+    }
+    o->buf = a;
+    o->capacity = n;
+  }
+  return o->buf;
+}
+
+void output_commit(output *o, size_t n) {
+  o->len += n;
+}
+
+int output_flush(output *o) {
+  if (o->len > 0 && fwrite(o->buf, 1, o->len, o->f) != o->len) {
+    return EOF;
+  }
+  o->len = 0;
+  return fflush(o->f) == EOF ? EOF : 0;
+}
+
+void output_dispose(output **optr) {
+  if (*optr == NULL) {
+    return;
+  }
+  free((*optr)->buf);
+  free(*optr);
+  *optr = NULL;
+}
@@ -0,0 +1,59 @@
+//  Interface du module output - module implémentant l'écriture tamponnée de
+//    lignes de texte sur un flot : les lignes sont formées directement dans un
+//    tampon de grande taille qui n'est transmis au flot que lorsqu'il est plein
+//    ou sur demande explicite, en un seul appel à fwrite.
+
+#ifndef OUTPUT__H
+#define OUTPUT__H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  OUTPUT_ULONG_LEN : nombre maximal de caractères de l'écriture décimale d'un
+//    objet de type unsigned long, pour un type d'au plus 64 bits.
+#define OUTPUT_ULONG_LEN 20
+
+//  output_format_ulong : écrit en base dix, sans caractère nul final, la
+//    valeur n à l'adresse dest, qui doit disposer d'au moins OUTPUT_ULONG_LEN
+//    caractères. Renvoie le nombre de caractères écrits.
+extern size_t output_format_ulong(char *dest, unsigned long n);
+
+//  struct output, output : structure regroupant les informations permettant
+//    d'écrire de façon tamponnée sur un flot. La création de la structure de
+//    données associée est confiée à la fonction output_open.
+typedef struct output output;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type output * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    output_open et non révoqué depuis par output_dispose. Cette règle ne
+//    souffre que d'une seule exception : output_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  output_open : crée une structure de données permettant l'écriture tamponnée
+//    sur le flot contrôlé par f. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers l'objet qui gère la structure de
+//    données.
+extern output *output_open(FILE *f);
+
+//  output_reserve : garantit qu'au moins n caractères sont disponibles dans le
+//    tampon associé à o, quitte à transmettre son contenu au flot ou à
+//    l'agrandir. Renvoie NULL en cas d'erreur d'écriture ou de dépassement de
+//    capacité. Renvoie sinon l'adresse du premier caractère disponible, qui
+//    reste valide jusqu'au prochain appel d'une fonction du module sur o.
+extern char *output_reserve(output *o, size_t n);
+
+//  output_commit : ajoute au contenu du tampon associé à o les n premiers
+//    caractères disponibles, écrits depuis l'appel à output_reserve qui les a
+//    garantis.
+extern void output_commit(output *o, size_t n);
+
+//  output_flush : transmet le contenu du tampon associé à o au flot puis vide
+//    ce dernier. Renvoie EOF en cas d'erreur d'écriture. Renvoie sinon zéro.
+extern int output_flush(output *o);
+
+//  output_dispose : si *optr ne vaut pas NULL, libère les ressources allouées
+//    à la structure de données associée à *optr puis affecte à *optr la valeur
+//    NULL. Le contenu du tampon qui n'a pas été transmis est perdu.
+extern void output_dispose(output **optr);
+
+#endif
@@ -1,6 +1,31 @@
+//  Implantation du module reader - la lecture par reader_next se fait depuis
+//    une projection en mémoire du fichier lorsque celui-ci est régulier, depuis
+//    un tampon rempli par blocs de READER__BUFSIZE octets sinon. Une source
+//    compressée est reconnue à ses premiers octets puis lue directement dans
+//    les tampons du module decomp, remplis par son fil de décompression, la
+//    projection ou le descripteur n'étant plus lus que par ce dernier. Le
+//    découpage en mots est confié à un noyau de classification travaillant
+//    par blocs de 16 (SSE2) ou 32 (AVX2) octets, choisi par reader_setup selon
+//    le processeur ; un noyau scalaire de référence est utilisé à défaut.
+
+#define _POSIX_C_SOURCE 200809L
+
 #include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "decomp.h"
 #include "reader.h"
+#include "strhash.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define READER__X86
+#include <immintrin.h>
+#endif
 
 #define READER_SOP(c, p) (isspace(c) || (p && ispunct(c)))
 
@@ -25,8 +50,883 @@ size_t reader_read(FILE *f, char *buf, size_t len, bool plsp, bool uppr) {
       break;
     }
   }
+  if (c == EOF && k <= len) {
+    buf[k] = '\0';
+  }
   if (c == EOF && !feof(f)) {
     return 0;
   }
   return k;
 }
+
+//  reader__delim : tables des séparateurs indexées par la valeur de plsp puis
+//    par l'octet lu ; reader__upper : table de passage en majuscule. Elles sont
+//    calculées par reader_setup à partir des classes de caractères de la locale
+//    "C".
+static unsigned char reader__delim[2][256];
+static unsigned char reader__upper[256];
+
+//  struct reader__kernel : regroupe les fonctions de découpage utilisées par
+//    reader_next.
+//  * skip(p, n, plsp) : renvoie la longueur du plus long préfixe de
+//      séparateurs des n octets pointés par p ;
+//  * span(p, n, plsp) : renvoie la longueur du plus long préfixe sans
+//      séparateur des n octets pointés par p ;
+//  * upper(d, p, n) : copie à l'adresse d les n octets pointés par p en
+//      convertissant les minuscules en majuscules.
+struct reader__kernel {
+  size_t (*skip)(const unsigned char *p, size_t n, bool plsp);
+  size_t (*span)(const unsigned char *p, size_t n, bool plsp);
+  void (*upper)(unsigned char *d, const unsigned char *p, size_t n);
+};
+
+//  Noyau scalaire de référence.
+
+static size_t reader__skip_scalar(const unsigned char *p, size_t n,
+    bool plsp) {
+  const unsigned char *t = reader__delim[plsp];
+  size_t k = 0;
+  while (k < n && t[p[k]]) {
+    ++k;
+  }
+  return k;
+}
+
+static size_t reader__span_scalar(const unsigned char *p, size_t n,
+    bool plsp) {
+  const unsigned char *t = reader__delim[plsp];
+  size_t k = 0;
+  while (k < n && !t[p[k]]) {
+    ++k;
+  }
+  return k;
+}
+
+static void reader__upper_scalar(unsigned char *d, const unsigned char *p,
+    size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    d[k] = reader__upper[p[k]];
+  }
+}
+
+static struct reader__kernel reader__kernel = {
+  reader__skip_scalar,
+  reader__span_scalar,
+  reader__upper_scalar,
+};
+
+#ifdef READER__X86
+
+//  Noyau SSE2 : les classes de la locale "C" y sont codées en dur par des
+//    comparaisons d'intervalles ; reader_setup ne le retient que si elles
+//    coïncident avec celles de reader__delim. La comparaison non signée
+//    x <= b est réalisée par min(x, b) == x.
+
+#define SSE2_LE(x, b) _mm_cmpeq_epi8(_mm_min_epu8((x), _mm_set1_epi8(b)), (x))
+#define SSE2_IN(c, lo, len) SSE2_LE(_mm_sub_epi8((c), _mm_set1_epi8(lo)), len)
+
+__attribute__((target("sse2")))
+static unsigned reader__mask_sse2(__m128i c, bool plsp) {
+  __m128i m = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+      SSE2_IN(c, '\t', '\r' - '\t'));
+  if (plsp) {
+    __m128i graph = SSE2_IN(c, '!', '~' - '!');
+    __m128i alnum = _mm_or_si128(SSE2_IN(c, '0', 9),
+        SSE2_IN(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 25));
+    m = _mm_or_si128(m, _mm_andnot_si128(alnum, graph));
+  }
+  return (unsigned) _mm_movemask_epi8(m);
+}
+
+__attribute__((target("sse2")))
+static size_t reader__skip_sse2(const unsigned char *p, size_t n, bool plsp) {
+  size_t k = 0;
+  for (; k + 16 <= n; k += 16) {
+    unsigned m = ~reader__mask_sse2(
+        _mm_loadu_si128((const __m128i *) (p + k)), plsp) & 0xFFFF;
+    if (m != 0) {
+      return k + (size_t) __builtin_ctz(m);
+    }
+  }
+  return k + reader__skip_scalar(p + k, n - k, plsp);
+}
+
+__attribute__((target("sse2")))
+static size_t reader__span_sse2(const unsigned char *p, size_t n, bool plsp) {
+  size_t k = 0;
+  for (; k + 16 <= n; k += 16) {
+    unsigned m = reader__mask_sse2(
+        _mm_loadu_si128((const __m128i *) (p + k)), plsp);
+    if (m != 0) {
+      return k + (size_t) __builtin_ctz(m);
+    }
+  }
+  return k + reader__span_scalar(p + k, n - k, plsp);
+}
+
+__attribute__((target("sse2")))
+static void reader__upper_sse2(unsigned char *d, const unsigned char *p,
+    size_t n) {
+  size_t k = 0;
+  for (; k + 16 <= n; k += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *) (p + k));
+    __m128i lower = SSE2_IN(c, 'a', 25);
+    c = _mm_sub_epi8(c, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+    _mm_storeu_si128((__m128i *) (d + k), c);
+  }
+  reader__upper_scalar(d + k, p + k, n - k);
+}
+
+//  Noyau AVX2 : la classification se fait par consultation de deux tables de
+//    16 octets indexées par les quartets bas et haut de chaque octet. Le bit h
+//    de reader__nib_lo[plsp][l] vaut 1 si et seulement si l'octet 16h + l est
+//    un séparateur ; reader__nib_hi[h] vaut 1 << h pour h < 8, zéro sinon. Le
+//    noyau n'est retenu que si aucun séparateur n'est supérieur à 0x7F.
+
+static unsigned char reader__nib_lo[2][16];
+static unsigned char reader__nib_hi[16];
+
+#define AVX2_LE(x, b) \
+  _mm256_cmpeq_epi8(_mm256_min_epu8((x), _mm256_set1_epi8(b)), (x))
+
+__attribute__((target("avx2")))
+static unsigned reader__mask_avx2(__m256i c, __m256i lo, __m256i hi) {
+  __m256i nl = _mm256_and_si256(c, _mm256_set1_epi8(0x0F));
+  __m256i nh = _mm256_and_si256(_mm256_srli_epi16(c, 4),
+      _mm256_set1_epi8(0x0F));
+  __m256i m = _mm256_and_si256(_mm256_shuffle_epi8(lo, nl),
+      _mm256_shuffle_epi8(hi, nh));
+  return ~(unsigned) _mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(m, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2")))
+static size_t reader__skip_avx2(const unsigned char *p, size_t n, bool plsp) {
+  __m256i lo = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) reader__nib_lo[plsp]));
+  __m256i hi = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) reader__nib_hi));
+  size_t k = 0;
+  for (; k + 32 <= n; k += 32) {
+    unsigned m = ~reader__mask_avx2(
+        _mm256_loadu_si256((const __m256i *) (p + k)), lo, hi);
+    if (m != 0) {
+      return k + (size_t) __builtin_ctz(m);
+    }
+  }
+  return k + reader__skip_sse2(p + k, n - k, plsp);
+}
+
+__attribute__((target("avx2")))
+static size_t reader__span_avx2(const unsigned char *p, size_t n, bool plsp) {
+  __m256i lo = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) reader__nib_lo[plsp]));
+  __m256i hi = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) reader__nib_hi));
+  size_t k = 0;
+  for (; k + 32 <= n; k += 32) {
+    unsigned m = reader__mask_avx2(
+        _mm256_loadu_si256((const __m256i *) (p + k)), lo, hi);
+    if (m != 0) {
+      return k + (size_t) __builtin_ctz(m);
+    }
+  }
+  return k + reader__span_sse2(p + k, n - k, plsp);
+}
+
+__attribute__((target("avx2")))
+static void reader__upper_avx2(unsigned char *d, const unsigned char *p,
+    size_t n) {
+  size_t k = 0;
+  for (; k + 32 <= n; k += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *) (p + k));
+    __m256i lower = AVX2_LE(_mm256_sub_epi8(c, _mm256_set1_epi8('a')), 25);
+    c = _mm256_sub_epi8(c, _mm256_and_si256(lower, _mm256_set1_epi8(0x20)));
+    _mm256_storeu_si256((__m256i *) (d + k), c);
+  }
+  reader__upper_sse2(d + k, p + k, n - k);
+}
+
+//  reader__sse2_agrees : vérifie que les classes codées en dur du noyau SSE2
+//    coïncident avec les tables de la locale "C" calculées par reader_setup.
+static bool reader__sse2_agrees(void) {
+  for (int c = 0; c < 256; ++c) {
+    bool space = c == ' ' || (c >= '\t' && c <= '\r');
+    bool punct = c >= '!' && c <= '~' && !(c >= '0' && c <= '9')
+        && !((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+    bool lower = c >= 'a' && c <= 'z';
+    if (reader__delim[0][c] != space || reader__delim[1][c] != (space || punct)
+        || reader__upper[c] != (lower ? c - 0x20 : c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
+
+//  struct reader__urange, struct reader__umap : éléments des tables Unicode
+//    produites par ucdgen.py. Un élément de type struct reader__urange désigne
+//    les points de code de lo à hi ; un élément de type struct reader__umap
+//    associe le décalage delta à ceux d'entre eux qui sont distants de lo d'un
+//    multiple de stride.
+struct reader__urange {
+  uint32_t lo;
+  uint32_t hi;
+};
+
+struct reader__umap {
+  uint32_t lo;
+  uint32_t hi;
+  int32_t delta;
+  uint32_t stride;
+};
+
+#include "ucdtab.h"
+
+//  READER__NELEMS : nombre d'éléments du tableau a.
+#define READER__NELEMS(a) (sizeof(a) / sizeof *(a))
+
+//  READER__USPACE, READER__UPUNCT : classes d'un point de code, combinables par
+//    ou bit à bit.
+#define READER__USPACE 0x1
+#define READER__UPUNCT 0x2
+
+//  READER__U2 : borne des points de code dont la classe et le décalage de
+//    passage en majuscule sont mémorisés directement, à savoir ceux des
+//    séquences d'au plus deux octets.
+#define READER__U2 0x800
+
+//  reader__u2class, reader__u2upper : classes et décalages de passage en
+//    majuscule des points de code inférieurs à READER__U2, calculés par
+//    reader_setup à partir des tables Unicode.
+static unsigned char reader__u2class[READER__U2];
+static int32_t reader__u2upper[READER__U2];
+
+//  reader__urange_find : détermine si c appartient à l'un des intervalles du
+//    tableau trié de n éléments pointé par t.
+static bool reader__urange_find(const struct reader__urange *t, size_t n,
+    uint32_t c) {
+  const struct reader__urange *end = t + n;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (t[half].hi < c) {
+      t += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return t < end && t->lo <= c;
+}
+
+//  reader__umap_find : renvoie le décalage de passage en majuscule de c selon
+//    la table reader__ucd_upper, zéro si c n'y figure pas.
+static int32_t reader__umap_find(uint32_t c) {
+  const struct reader__umap *t = reader__ucd_upper;
+  size_t lo = 0;
+  size_t n = READER__NELEMS(reader__ucd_upper);
+  while (n > 0) {
+    size_t half = n / 2;
+    if (t[lo + half].hi < c) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  if (lo == READER__NELEMS(reader__ucd_upper) || c < t[lo].lo
+      || (c - t[lo].lo) % t[lo].stride != 0) {
+    return 0;
+  }
+  return t[lo].delta;
+}
+
+//  reader__uclass_find : renvoie la classe du point de code c selon les tables
+//    reader__ucd_space et reader__ucd_punct.
+static int reader__uclass_find(uint32_t c) {
+  return (reader__urange_find(reader__ucd_space,
+      READER__NELEMS(reader__ucd_space), c) ? READER__USPACE : 0)
+      | (reader__urange_find(reader__ucd_punct,
+      READER__NELEMS(reader__ucd_punct), c) ? READER__UPUNCT : 0);
+}
+
+//  reader__uclass : renvoie la classe du point de code c supérieur à 0x7F.
+static int reader__uclass(uint32_t c) {
+  return c < READER__U2 ? reader__u2class[c] : reader__uclass_find(c);
+}
+
+//  reader__uupper : renvoie la forme majuscule simple du point de code c
+//    supérieur à 0x7F.
+static uint32_t reader__uupper(uint32_t c) {
+  int32_t d = c < READER__U2 ? reader__u2upper[c] : reader__umap_find(c);
+  return (uint32_t) ((int32_t) c + d);
+}
+
+void reader_setup(void) {
+  for (int c = 0; c < 256; ++c) {
+    reader__delim[0][c] = isspace(c) != 0;
+    reader__delim[1][c] = isspace(c) || ispunct(c);
+    reader__upper[c] = (unsigned char) (islower(c) ? toupper(c) : c);
+  }
+  for (uint32_t c = 0x80; c < READER__U2; ++c) {
+    reader__u2class[c] = (unsigned char) reader__uclass_find(c);
+    reader__u2upper[c] = reader__umap_find(c);
+  }
+#ifdef READER__X86
+  if (!reader__sse2_agrees()) {
+    return;
+  }
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    reader__kernel = (struct reader__kernel) {
+      reader__skip_sse2,
+      reader__span_sse2,
+      reader__upper_sse2,
+    };
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    for (int h = 0; h < 16; ++h) {
+      reader__nib_hi[h] = (unsigned char) (h < 8 ? 1 << h : 0);
+    }
+    for (int l = 0; l < 16; ++l) {
+      for (int k = 0; k < 2; ++k) {
+        unsigned char b = 0;
+        for (int h = 0; h < 8; ++h) {
+          b = (unsigned char) (b | (reader__delim[k][16 * h + l] << h));
+        }
+        reader__nib_lo[k][l] = b;
+      }
+    }
+    reader__kernel = (struct reader__kernel) {
+      reader__skip_avx2,
+      reader__span_avx2,
+      reader__upper_avx2,
+    };
+  }
+#endif
+}
+
+//  READER__BUFSIZE : taille en octets du tampon de lecture utilisé lorsque la
+//    source ne peut pas être projetée en mémoire.
+#define READER__BUFSIZE (1 << 20)
+
+//  struct reader, reader : le composant fd mémorise le descripteur de fichier
+//    sous-jacent au flot, mode les drapeaux de lecture. Les octets disponibles
+//    sont ceux d'indices [pos; end[ du tableau pointé par data. Si la source
+//    est projetée, data pointe sur la projection de longueur maplen et offset
+//    mémorise la position dans le fichier correspondant à data[0] ; le champ
+//    buf vaut alors NULL. Sinon, data et buf pointent sur le tampon interne. Le
+//    champ eof indique si la fin de la source a été atteinte, errnum le code
+//    de la dernière erreur de lecture survenue, total le nombre d'octets de la
+//    source mis à disposition. Si la source est compressée, dc est la
+//    structure qui la décompresse, NULL sinon : data pointe alors sur le
+//    dernier tampon obtenu de decomp_next ou sur le tampon interne, toujours
+//    alloué, et les octets mis à disposition sont ceux décompressés.
+struct reader {
+  int fd;
+  int mode;
+  const unsigned char *data;
+  size_t pos;
+  size_t end;
+  void *map;
+  size_t maplen;
+  off_t offset;
+  unsigned char *buf;
+  bool eof;
+  int errnum;
+  size_t total;
+  decomp *dc;
+};
+
+//  reader__map : tente de projeter en mémoire la source associée à r à partir
+//    de la position courante du descripteur. Renvoie une valeur non nulle si
+//    la source n'est pas un fichier régulier ou si la projection a échoué.
+//    Renvoie sinon zéro.
+static int reader__map(reader *r) {
+  struct stat st;
+  if (fstat(r->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return -1;
+  }
+  off_t cur = lseek(r->fd, 0, SEEK_CUR);
+  if (cur < 0 || cur > st.st_size
+      || (uintmax_t) (st.st_size - cur) > SIZE_MAX / 2) {
+    return -1;
+  }
+  if (cur == st.st_size) {
+    r->eof = true;
+    r->offset = cur;
+    return 0;
+  }
+  long pagesize = sysconf(_SC_PAGESIZE);
+  off_t base = pagesize > 0 ? cur - cur % pagesize : 0;
+  size_t len = (size_t) (st.st_size - base);
+  void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, r->fd, base);
+  if (p == MAP_FAILED) {
+    return -1;
+  }
+  posix_madvise(p, len, POSIX_MADV_SEQUENTIAL);
+  r->map = p;
+  r->maplen = len;
+  r->offset = base;
+  r->data = p;
+  r->pos = (size_t) (cur - base);
+  r->end = len;
+  r->total = len - r->pos;
+  r->eof = true;
+  return 0;
+}
+
+//  reader__fill : recharge le tampon interne de r lorsque les octets
+//    disponibles ont été consommés. Renvoie false si la fin de la source a été
+//    atteinte ou si une erreur de lecture est survenue. Renvoie sinon true.
+static bool reader__fill(reader *r) {
+  if (r->eof) {
+    return false;
+  }
+  if (r->dc != NULL) {
+    const unsigned char *p;
+    size_t len = decomp_next(r->dc, &p);
+    if (len == 0) {
+      r->errnum = decomp_error(r->dc);
+      r->eof = true;
+      return false;
+    }
+    r->data = p;
+    r->pos = 0;
+    r->end = len;
+    r->total += len;
+    return true;
+  }
+  ssize_t n;
+  do {
+    n = read(r->fd, r->buf, READER__BUFSIZE);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    if (n < 0) {
+      r->errnum = errno;
+    }
+    r->eof = true;
+    return false;
+  }
+  r->pos = 0;
+  r->end = (size_t) n;
+  r->total += (size_t) n;
+  return true;
+}
+
+//  reader__topup : si la source associée à r n'est pas projetée ou est
+//    compressée, et que moins de n octets, n <= READER_MAXSEQ, sont
+//    disponibles, ramène ceux-ci au début du tampon interne puis le complète
+//    jusqu'à ce qu'au moins n octets le soient ou que la fin de la source soit
+//    atteinte.
+static void reader__topup(reader *r, size_t n) {
+  if (r->buf == NULL || r->end - r->pos >= n || r->eof) {
+    return;
+  }
+  size_t tail = r->end - r->pos;
+  memmove(r->buf, r->data + r->pos, tail);
+  r->data = r->buf;
+  r->pos = 0;
+  r->end = tail;
+  while (r->end < n && !r->eof) {
+    //  Un tampon d'octets décompressés, d'au plus READER__BUFSIZE -
+    //    READER_MAXSEQ octets, tient toujours après les octets restants.
+    if (r->dc != NULL) {
+      const unsigned char *p;
+      size_t len = decomp_next(r->dc, &p);
+      if (len == 0) {
+        r->errnum = decomp_error(r->dc);
+        r->eof = true;
+        break;
+      }
+      memcpy(r->buf + r->end, p, len);
+      r->end += len;
+      r->total += len;
+      continue;
+    }
+    ssize_t m = read(r->fd, r->buf + r->end, READER__BUFSIZE - r->end);
+    if (m < 0 && errno == EINTR) {
+      continue;
+    }
+    if (m <= 0) {
+      if (m < 0) {
+        r->errnum = errno;
+      }
+      r->eof = true;
+      break;
+    }
+    r->end += (size_t) m;
+    r->total += (size_t) m;
+  }
+}
+
+//  reader__unpack : examine les premiers octets de la source associée à r et,
+//    s'ils sont ceux d'une source compressée, lance sa décompression à partir
+//    d'eux : les octets mis à disposition sont désormais ceux décompressés. Un
+//    format de compression non pris en charge est une erreur de lecture,
+//    ENOTSUP. Renvoie une valeur non nulle en cas de dépassement de capacité
+//    ou si la décompression n'a pu être lancée. Renvoie sinon zéro.
+static int reader__unpack(reader *r) {
+  if (r->map == NULL) {
+    if (!reader__fill(r)) {
+      return 0;
+    }
+    reader__topup(r, DECOMP_MAGICLEN);
+  }
+  int format = decomp_format(r->data + r->pos, r->end - r->pos);
+  if (format == DECOMP_NONE) {
+    return 0;
+  }
+  if (!decomp_supported(format)) {
+    r->errnum = ENOTSUP;
+    r->pos = 0;
+    r->end = 0;
+    r->total = 0;
+    r->eof = true;
+    return 0;
+  }
+  if (r->buf == NULL && (r->buf = malloc(READER__BUFSIZE)) == NULL) {
+    return -1;
+  }
+  //  Une source projetée est décompressée directement depuis la projection.
+  r->dc = decomp_open(format, r->data + r->pos, r->end - r->pos,
+      r->map != NULL ? -1 : r->fd, READER__BUFSIZE - READER_MAXSEQ);
+  if (r->dc == NULL) {
+    return -1;
+  }
+  r->data = r->buf;
+  r->pos = 0;
+  r->end = 0;
+  r->total = 0;
+  r->eof = false;
+  return 0;
+}
+
+reader *reader_open(FILE *f, int mode) {
+  reader *r = malloc(sizeof *r);
+  if (r == NULL) {
+    return NULL;
+  }
+  r->fd = fileno(f);
+  r->mode = mode;
+  r->data = NULL;
+  r->pos = 0;
+  r->end = 0;
+  r->map = NULL;
+  r->maplen = 0;
+  r->offset = 0;
+  r->buf = NULL;
+  r->eof = false;
+  r->errnum = 0;
+  r->total = 0;
+  r->dc = NULL;
+  if (reader__map(r) != 0) {
+    r->buf = malloc(READER__BUFSIZE);
+    if (r->buf == NULL) {
+      free(r);
+      return NULL;
+    }
+    r->data = r->buf;
+  }
+  if (reader__unpack(r) != 0) {
+    reader_dispose(&r);
+    return NULL;
+  }
+  return r;
+}
+
+//  READER__AVAIL : détermine si au moins un octet est disponible dans la
+//    source associée à r, en rechargeant au besoin le tampon interne.
+#define READER__AVAIL(r) ((r)->pos < (r)->end || reader__fill(r))
+
+//  READER__HASZERO : détermine si l'un des octets du mot de 64 bits v est nul.
+#define READER__HASZERO(v) \
+  ((((v) - 0x0101010101010101) & ~(v) & 0x8080808080808080) != 0)
+
+//  struct reader__hash : état du calcul au fil de la copie de la somme de
+//    hachage au sens de strhash d'un mot : les hashed premiers octets du mot
+//    ont été ajoutés à la somme partielle h ; haszero indique si l'un d'eux est
+//    nul.
+struct reader__hash {
+  size_t hashed;
+  uint64_t h;
+  bool haszero;
+};
+
+#define READER__HASH_INIT { 0, strhash_init(), false }
+
+//  reader__hash_feed : ajoute à la somme partielle associée à hs les octets
+//    de buf huit par huit, tant qu'ils appartiennent aux lim premiers.
+static inline void reader__hash_feed(struct reader__hash *hs, const char *buf,
+    size_t lim) {
+  for (; hs->hashed + 8 <= lim; hs->hashed += 8) {
+    uint64_t c = strhash_load(buf + hs->hashed, 8);
+    hs->haszero = hs->haszero || READER__HASZERO(c);
+    hs->h = strhash_step(hs->h, c);
+  }
+}
+
+//  reader__hash_end : termine la chaine de longueur *wlenptr copiée dans buf et
+//    renvoie sa somme de hachage, calculée à partir de l'état associé à hs. Un
+//    octet nul lu dans la source termine prématurément la chaine : *wlenptr
+//    est alors mis à jour et la somme recalculée sur la chaine effective.
+static inline uint64_t reader__hash_end(struct reader__hash *hs, char *buf,
+    size_t *wlenptr) {
+  size_t wlen = *wlenptr;
+  buf[wlen] = '\0';
+  //  Les derniers octets sont assemblés comme par strhash_load, la recherche
+  //    d'un octet nul se faisant au passage.
+  uint64_t t = 0;
+  for (size_t j = wlen; j > hs->hashed; --j) {
+    unsigned char c = (unsigned char) buf[j - 1];
+    hs->haszero = hs->haszero || c == '\0';
+    t = t << 8 | c;
+  }
+  if (hs->haszero) {
+    *wlenptr = strlen(buf);
+    return strhash_mem(buf, *wlenptr);
+  }
+  return strhash_final(hs->h, t, wlen);
+}
+
+//  READER__INVALID : valeur affectée par reader__decode au point de code d'une
+//    séquence UTF-8 invalide.
+#define READER__INVALID UINT32_MAX
+
+//  reader__decode : décode la séquence UTF-8 débutant le tableau de n octets,
+//    n > 0, pointé par p. Affecte le point de code à *cptr et renvoie la
+//    longueur de la séquence. Une séquence invalide ou incomplète est réduite
+//    à son premier octet, *cptr valant alors READER__INVALID.
+static size_t reader__decode(const unsigned char *p, size_t n, uint32_t *cptr) {
+  unsigned char b = p[0];
+  *cptr = READER__INVALID;
+  size_t m = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : 2;
+  if (b < 0xC2 || b > 0xF4 || n < m) {
+    return 1;
+  }
+  //  Bornes du deuxième octet excluant les formes trop longues, les
+  //    substituts et les points de code supérieurs à 0x10FFFF.
+  unsigned char lo = b == 0xE0 ? 0xA0 : b == 0xF0 ? 0x90 : 0x80;
+  unsigned char hi = b == 0xED ? 0x9F : b == 0xF4 ? 0x8F : 0xBF;
+  if (p[1] < lo || p[1] > hi) {
+    return 1;
+  }
+  uint32_t c = b & (0x7F >> m);
+  for (size_t k = 1; k < m; ++k) {
+    if ((p[k] & 0xC0) != 0x80) {
+      return 1;
+    }
+    c = c << 6 | (p[k] & 0x3F);
+  }
+  *cptr = c;
+  return m;
+}
+
+//  reader__encode : écrit à l'adresse d la séquence UTF-8 la plus courte du
+//    point de code c. Renvoie sa longueur. Le passage en majuscule d'un point
+//    de code supérieur à 0x7F peut produire un point de code ASCII, comme
+//    U+0131 vers 'I', écrit alors sur un seul octet.
+static size_t reader__encode(unsigned char *d, uint32_t c) {
+  if (c < 0x80) {
+    d[0] = (unsigned char) c;
+    return 1;
+  }
+  if (c < 0x800) {
+    d[0] = (unsigned char) (0xC0 | c >> 6);
+    d[1] = (unsigned char) (0x80 | (c & 0x3F));
+    return 2;
+  }
+  if (c < 0x10000) {
+    d[0] = (unsigned char) (0xE0 | c >> 12);
+    d[1] = (unsigned char) (0x80 | (c >> 6 & 0x3F));
+    d[2] = (unsigned char) (0x80 | (c & 0x3F));
+    return 3;
+  }
+  d[0] = (unsigned char) (0xF0 | c >> 18);
+  d[1] = (unsigned char) (0x80 | (c >> 12 & 0x3F));
+  d[2] = (unsigned char) (0x80 | (c >> 6 & 0x3F));
+  d[3] = (unsigned char) (0x80 | (c & 0x3F));
+  return 4;
+}
+
+//  reader__udecode : décode au sens de reader__decode la séquence débutant à
+//    la position courante de r, qui doit désigner un octet disponible. Les
+//    octets disponibles sont au besoin complétés par reader__topup, de sorte
+//    qu'une séquence à cheval sur deux blocs soit entière.
+static size_t reader__udecode(reader *r, uint32_t *cptr) {
+  reader__topup(r, READER_MAXSEQ);
+  return reader__decode(r->data + r->pos, r->end - r->pos, cptr);
+}
+
+//  reader__ascii : renvoie la longueur du plus long préfixe d'octets inférieurs
+//    à 0x80 des n octets pointés par p. Les octets sont examinés huit à huit.
+static size_t reader__ascii(const unsigned char *p, size_t n) {
+  size_t k = 0;
+  for (; k + 8 <= n; k += 8) {
+    uint64_t v;
+    memcpy(&v, p + k, sizeof v);
+    if ((v & 0x8080808080808080) != 0) {
+      break;
+    }
+  }
+  while (k < n && p[k] < 0x80) {
+    ++k;
+  }
+  return k;
+}
+
+//  reader__next_utf8 : implantation de reader_next pour le drapeau
+//    READER_UTF8. Les suites d'octets inférieurs à 0x80 sont découpées, copiées
+//    et converties par le noyau comme en mode octet ; seuls les autres octets
+//    sont décodés. Le nombre de caractères renvoyé et la limite len comptent
+//    des points de code.
+static size_t reader__next_utf8(reader *r, char *buf, size_t len,
+    size_t *wlenptr, size_t *hashptr) {
+  bool plsp = (r->mode & READER_PLSP) != 0;
+  bool uppr = (r->mode & READER_UPPR) != 0;
+  int sep = READER__USPACE | (plsp ? READER__UPUNCT : 0);
+  for (;;) {
+    if (!READER__AVAIL(r)) {
+      buf[0] = '\0';
+      return 0;
+    }
+    r->pos += reader__kernel.skip(r->data + r->pos, r->end - r->pos, plsp);
+    if (r->pos == r->end) {
+      continue;
+    }
+    if (r->data[r->pos] < 0x80) {
+      break;
+    }
+    uint32_t c;
+    size_t m = reader__udecode(r, &c);
+    if (c == READER__INVALID || (reader__uclass(c) & sep) == 0) {
+      break;
+    }
+    r->pos += m;
+  }
+  //  k compte les points de code du mot jusqu'à len + 1 ; seuls les len
+  //    premiers sont copiés dans buf, sur w octets.
+  size_t k = 0;
+  size_t w = 0;
+  unsigned char *d = (unsigned char *) buf;
+  struct reader__hash hs = READER__HASH_INIT;
+  while (READER__AVAIL(r)) {
+    const unsigned char *p = r->data + r->pos;
+    size_t n = reader__kernel.span(p, r->end - r->pos, plsp);
+    size_t a = reader__ascii(p, n);
+    if (k <= len) {
+      size_t m = a < len - k ? a : len - k;
+      if (uppr) {
+        reader__kernel.upper(d + w, p, m);
+      } else {
+        memcpy(d + w, p, m);
+      }
+      w += m;
+      k = a > m ? len + 1 : k + m;
+      reader__hash_feed(&hs, buf, w);
+    }
+    r->pos += a;
+    if (a == n) {
+      if (r->pos < r->end) {
+        break;
+      }
+      continue;
+    }
+    uint32_t c;
+    size_t m = reader__udecode(r, &c);
+    if (c != READER__INVALID && (reader__uclass(c) & sep) != 0) {
+      break;
+    }
+    if (k < len) {
+      if (c == READER__INVALID) {
+        d[w++] = r->data[r->pos];
+      } else {
+        w += reader__encode(d + w, uppr ? reader__uupper(c) : c);
+      }
+      reader__hash_feed(&hs, buf, w);
+    }
+    k += k <= len;
+    r->pos += m;
+  }
+  if (r->errnum != 0) {
+    return 0;
+  }
+  *hashptr = (size_t) reader__hash_end(&hs, buf, &w);
+  *wlenptr = w;
+  return k;
+}
+
+size_t reader_next(reader *r, char *buf, size_t len, size_t *wlenptr,
+    size_t *hashptr) {
+  if ((r->mode & READER_UTF8) != 0) {
+    return reader__next_utf8(r, buf, len, wlenptr, hashptr);
+  }
+  bool plsp = (r->mode & READER_PLSP) != 0;
+  bool uppr = (r->mode & READER_UPPR) != 0;
+  do {
+    if (!READER__AVAIL(r)) {
+      buf[0] = '\0';
+      return 0;
+    }
+    r->pos += reader__kernel.skip(r->data + r->pos, r->end - r->pos, plsp);
+  } while (r->pos == r->end);
+  //  Les octets du mot sont ajoutés à la somme de hachage huit par huit, dès
+  //    leur copie dans buf, tant qu'ils appartiennent aux len premiers.
+  size_t k = 0;
+  struct reader__hash hs = READER__HASH_INIT;
+  do {
+    size_t n = reader__kernel.span(r->data + r->pos, r->end - r->pos, plsp);
+    if (k <= len) {
+      size_t m = n < len + 1 - k ? n : len + 1 - k;
+      if (uppr) {
+        reader__kernel.upper((unsigned char *) buf + k, r->data + r->pos, m);
+      } else {
+        memcpy(buf + k, r->data + r->pos, m);
+      }
+      k += m;
+      reader__hash_feed(&hs, buf, k > len ? len : k);
+    }
+    r->pos += n;
+  } while (r->pos == r->end && READER__AVAIL(r));
+  if (r->errnum != 0) {
+    return 0;
+  }
+  size_t wlen = k > len ? len : k;
+  *hashptr = (size_t) reader__hash_end(&hs, buf, &wlen);
+  *wlenptr = wlen;
+  return k;
+}
+
+size_t reader_bytes(const reader *r) {
+  return r->total;
+}
+
+size_t reader_consumed(const reader *r) {
+  //  Les octets mis à disposition mais non consommés sont ceux d'indices
+  //    [pos; end[, que la source soit projetée ou non.
+  return r->total - (r->end - r->pos);
+}
+
+int reader_error(const reader *r) {
+  return r->errnum;
+}
+
+void reader_dispose(reader **rptr) {
+  if (*rptr == NULL) {
+    return;
+  }
+  reader *r = *rptr;
+  //  La position dans une source compressée ne correspond à aucune position
+  //    dans le fichier.
+  if (r->map != NULL && r->dc == NULL) {
+    lseek(r->fd, r->offset + (off_t) r->pos, SEEK_SET);
+  }
+  decomp_dispose(&r->dc);
+  if (r->map != NULL) {
+    munmap(r->map, r->maplen);
+  }
+  free(r->buf);
+  free(r);
+  *rptr = NULL;
+}
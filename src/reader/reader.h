@@ -18,4 +18,88 @@
 //    len, sinon len + 1.
 extern size_t reader_read(FILE *f, char *buf, size_t len, bool plsp, bool uppr);
 
+//  reader_setup : calcule, à partir des classes de caractères de la locale
+//    "C", les tables de séparateurs et de passage en majuscule utilisées par
+//    reader_next, puis sélectionne le noyau de découpage le plus rapide pris
+//    en charge par le processeur. Doit être appelée une fois, au démarrage du
+//    programme, avant tout appel à reader_open.
+extern void reader_setup(void);
+
+//  READER_PLSP, READER_UPPR : drapeaux de lecture combinables par ou bit à bit
+//    et fournis à reader_open. Ils jouent respectivement le rôle des paramètres
+//    plsp et uppr de reader_read.
+#define READER_PLSP 0x1
+#define READER_UPPR 0x2
+
+//  READER_UTF8 : drapeau de lecture fourni à reader_open pour une source codée
+//    en UTF-8. Les espaces et, avec READER_PLSP, les ponctuations et symboles
+//    Unicode sont alors des séparateurs, READER_UPPR applique le passage
+//    simple en majuscule d'Unicode et la limite de reader_next ainsi que le
+//    nombre de caractères qu'elle renvoie comptent des points de code. Une
+//    séquence invalide compte pour un caractère par octet.
+#define READER_UTF8 0x4
+
+//  READER_MAXSEQ : longueur maximale en octets d'une séquence UTF-8. Avec
+//    READER_UTF8, le tampon fourni à reader_next pour une limite de len
+//    caractères doit être de taille au moins len * READER_MAXSEQ + 1.
+#define READER_MAXSEQ 4
+
+//  struct reader, reader : structure regroupant les informations permettant
+//    de lire mot à mot une source de fichier sans passer par les fonctions de
+//    lecture caractère par caractère de la bibliothèque standard. Si la source
+//    est un fichier régulier, son contenu est projeté en mémoire et découpé
+//    directement depuis la projection. Sinon (entrée standard, tube...), il est
+//    lu par blocs de grande taille dans un tampon interne. Une source
+//    compressée au format gzip ou zstd, reconnue à ses premiers octets, est
+//    lue décompressée, la décompression étant confiée à un fil d'exécution
+//    propre à la source. La création de la structure de données associée est
+//    confiée à la fonction reader_open.
+
+typedef struct reader reader;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type reader * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    reader_open et non révoqué depuis par reader_dispose. Cette règle ne
+//    souffre que d'une seule exception : reader_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  reader_open : crée une structure de données permettant la lecture mot à mot
+//    de la source associée au flot contrôlé par f à partir de sa position
+//    courante, selon les drapeaux mode. Le flot ne doit plus être lu par
+//    ailleurs tant que la structure n'a pas été révoquée. Une source compressée
+//    dans un format non pris en charge produit l'erreur de lecture ENOTSUP.
+//    Renvoie NULL en cas de dépassement de capacité ou si la décompression
+//    n'a pu être lancée. Renvoie sinon un pointeur vers l'objet qui gère la
+//    structure de données.
+extern reader *reader_open(FILE *f, int mode);
+
+//  reader_next : a le même comportement que reader_read appliquée au flot et
+//    aux drapeaux associés à r. Si un mot est lu, affecte de plus à *wlenptr
+//    la longueur de la chaine copiée dans buf et à *hashptr sa somme de
+//    hachage au sens de strhash, calculée au cours de la copie.
+extern size_t reader_next(reader *r, char *buf, size_t len, size_t *wlenptr,
+    size_t *hashptr);
+
+//  reader_bytes : renvoie le nombre d'octets de la source associée à r mis à
+//    disposition depuis la création de r. Une fois la source lue jusqu'à sa
+//    fin, il s'agit du nombre d'octets lus.
+extern size_t reader_bytes(const reader *r);
+
+//  reader_consumed : renvoie le nombre d'octets de la source associée à r
+//    consommés depuis la création de r, autrement dit : lus jusqu'à la fin du
+//    dernier mot renvoyé par reader_next.
+extern size_t reader_consumed(const reader *r);
+
+//  reader_error : renvoie zéro si aucune erreur de lecture n'est survenue sur
+//    la source associée à r. Renvoie sinon le code d'erreur correspondant, au
+//    sens de errno.
+extern int reader_error(const reader *r);
+
+//  reader_dispose : si *rptr ne vaut pas NULL, libère les ressources allouées
+//    à la structure de données associée à *rptr, positionne si possible le
+//    flot associé à la fin des données consommées, ce qui n'est pas le cas
+//    d'une source compressée, puis affecte à *rptr la valeur NULL. Le flot
+//    n'est pas fermé.
+extern void reader_dispose(reader **rptr);
+
 #endif
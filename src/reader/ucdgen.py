@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#  ucdgen.py - produit sur la sortie standard les tables Unicode du module
+#    reader (ucdtab.h) à partir de la base de caractères fournie par le module
+#    unicodedata de Python. Seuls les points de code supérieurs à 0x7F y
+#    figurent, les autres relevant des tables de la locale "C".
+#
+#  * reader__ucd_space : intervalles des espaces (catégories Zs, Zl, Zp et
+#      U+0085) ;
+#  * reader__ucd_punct : intervalles des ponctuations et symboles (catégories
+#      P* et S*, qui forment ensemble l'équivalent de ispunct) ;
+#  * reader__ucd_upper : passage simple en majuscule, par suites de points de
+#      code de pas 1 ou 2 partageant le même décalage.
+
+import sys
+import unicodedata
+
+MAXCP = 0x110000
+
+
+def ranges(pred):
+    out = []
+    lo = None
+    for c in range(0x80, MAXCP + 1):
+        inside = c < MAXCP and pred(c)
+        if inside and lo is None:
+            lo = c
+        elif not inside and lo is not None:
+            out.append((lo, c - 1))
+            lo = None
+    return out
+
+
+def is_space(c):
+    return c == 0x85 or unicodedata.category(chr(c)) in ('Zs', 'Zl', 'Zp')
+
+
+def is_punct(c):
+    return unicodedata.category(chr(c))[0] in 'PS'
+
+
+def upper_deltas():
+    #  Seules les correspondances d'un point de code vers un seul point de code
+    #    sont retenues : les autres n'ont pas de forme simple.
+    deltas = {}
+    for c in range(0x80, MAXCP):
+        u = chr(c).upper()
+        if len(u) == 1 and ord(u) != c:
+            deltas[c] = ord(u) - c
+    return deltas
+
+
+def upper_runs(deltas):
+    out = []
+    cps = sorted(deltas)
+    k = 0
+    while k < len(cps):
+        lo = cps[k]
+        d = deltas[lo]
+        best = (lo, 1)
+        for stride in (1, 2):
+            hi = lo
+            while deltas.get(hi + stride) == d \
+                    and all(hi + j not in deltas for j in range(1, stride)):
+                hi += stride
+            if hi > best[0]:
+                best = (hi, stride)
+        hi, stride = best
+        out.append((lo, hi, d, stride))
+        while k < len(cps) and cps[k] <= hi:
+            k += 1
+    return out
+
+
+def emit_ranges(name, rs):
+    print('static const struct reader__urange %s[] = {' % name)
+    for lo, hi in rs:
+        print('  {0x%04X, 0x%04X},' % (lo, hi))
+    print('};')
+    print()
+
+
+def main():
+    print('//  ucdtab.h - fichier produit par ucdgen.py à partir de la version '
+          '%s' % unicodedata.unidata_version)
+    print('//    de la base de caractères Unicode. Ne pas modifier.')
+    print()
+    emit_ranges('reader__ucd_space', ranges(is_space))
+    emit_ranges('reader__ucd_punct', ranges(is_punct))
+    print('static const struct reader__umap reader__ucd_upper[] = {')
+    for lo, hi, d, stride in upper_runs(upper_deltas()):
+        print('  {0x%04X, 0x%04X, %d, %d},' % (lo, hi, d, stride))
+    print('};')
+
+
+if __name__ == '__main__':
+    sys.exit(main())
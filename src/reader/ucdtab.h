@@ -0,0 +1,546 @@
+//  ucdtab.h - fichier produit par ucdgen.py à partir de la version 14.0.0
+//    de la base de caractères Unicode. Ne pas modifier.
+
+static const struct reader__urange reader__ucd_space[] = {
+  {0x0085, 0x0085},
+  {0x00A0, 0x00A0},
+  {0x1680, 0x1680},
+  {0x2000, 0x200A},
+  {0x2028, 0x2029},
+  {0x202F, 0x202F},
+  {0x205F, 0x205F},
+  {0x3000, 0x3000},
+};
+
+static const struct reader__urange reader__ucd_punct[] = {
+  {0x00A1, 0x00A9},
+  {0x00AB, 0x00AC},
+  {0x00AE, 0x00B1},
+  {0x00B4, 0x00B4},
+  {0x00B6, 0x00B8},
+  {0x00BB, 0x00BB},
+  {0x00BF, 0x00BF},
+  {0x00D7, 0x00D7},
+  {0x00F7, 0x00F7},
+  {0x02C2, 0x02C5},
+  {0x02D2, 0x02DF},
+  {0x02E5, 0x02EB},
+  {0x02ED, 0x02ED},
+  {0x02EF, 0x02FF},
+  {0x0375, 0x0375},
+  {0x037E, 0x037E},
+  {0x0384, 0x0385},
+  {0x0387, 0x0387},
+  {0x03F6, 0x03F6},
+  {0x0482, 0x0482},
+  {0x055A, 0x055F},
+  {0x0589, 0x058A},
+  {0x058D, 0x058F},
+  {0x05BE, 0x05BE},
+  {0x05C0, 0x05C0},
+  {0x05C3, 0x05C3},
+  {0x05C6, 0x05C6},
+  {0x05F3, 0x05F4},
+  {0x0606, 0x060F},
+  {0x061B, 0x061B},
+  {0x061D, 0x061F},
+  {0x066A, 0x066D},
+  {0x06D4, 0x06D4},
+  {0x06DE, 0x06DE},
+  {0x06E9, 0x06E9},
+  {0x06FD, 0x06FE},
+  {0x0700, 0x070D},
+  {0x07F6, 0x07F9},
+  {0x07FE, 0x07FF},
+  {0x0830, 0x083E},
+  {0x085E, 0x085E},
+  {0x0888, 0x0888},
+  {0x0964, 0x0965},
+  {0x0970, 0x0970},
+  {0x09F2, 0x09F3},
+  {0x09FA, 0x09FB},
+  {0x09FD, 0x09FD},
+  {0x0A76, 0x0A76},
+  {0x0AF0, 0x0AF1},
+  {0x0B70, 0x0B70},
+  {0x0BF3, 0x0BFA},
+  {0x0C77, 0x0C77},
+  {0x0C7F, 0x0C7F},
+  {0x0C84, 0x0C84},
+  {0x0D4F, 0x0D4F},
+  {0x0D79, 0x0D79},
+  {0x0DF4, 0x0DF4},
+  {0x0E3F, 0x0E3F},
+  {0x0E4F, 0x0E4F},
+  {0x0E5A, 0x0E5B},
+  {0x0F01, 0x0F17},
+  {0x0F1A, 0x0F1F},
+  {0x0F34, 0x0F34},
+  {0x0F36, 0x0F36},
+  {0x0F38, 0x0F38},
+  {0x0F3A, 0x0F3D},
+  {0x0F85, 0x0F85},
+  {0x0FBE, 0x0FC5},
+  {0x0FC7, 0x0FCC},
+  {0x0FCE, 0x0FDA},
+  {0x104A, 0x104F},
+  {0x109E, 0x109F},
+  {0x10FB, 0x10FB},
+  {0x1360, 0x1368},
+  {0x1390, 0x1399},
+  {0x1400, 0x1400},
+  {0x166D, 0x166E},
+  {0x169B, 0x169C},
+  {0x16EB, 0x16ED},
+  {0x1735, 0x1736},
+  {0x17D4, 0x17D6},
+  {0x17D8, 0x17DB},
+  {0x1800, 0x180A},
+  {0x1940, 0x1940},
+  {0x1944, 0x1945},
+  {0x19DE, 0x19FF},
+  {0x1A1E, 0x1A1F},
+  {0x1AA0, 0x1AA6},
+  {0x1AA8, 0x1AAD},
+  {0x1B5A, 0x1B6A},
+  {0x1B74, 0x1B7E},
+  {0x1BFC, 0x1BFF},
+  {0x1C3B, 0x1C3F},
+  {0x1C7E, 0x1C7F},
+  {0x1CC0, 0x1CC7},
+  {0x1CD3, 0x1CD3},
+  {0x1FBD, 0x1FBD},
+  {0x1FBF, 0x1FC1},
+  {0x1FCD, 0x1FCF},
+  {0x1FDD, 0x1FDF},
+  {0x1FED, 0x1FEF},
+  {0x1FFD, 0x1FFE},
+  {0x2010, 0x2027},
+  {0x2030, 0x205E},
+  {0x207A, 0x207E},
+  {0x208A, 0x208E},
+  {0x20A0, 0x20C0},
+  {0x2100, 0x2101},
+  {0x2103, 0x2106},
+  {0x2108, 0x2109},
+  {0x2114, 0x2114},
+  {0x2116, 0x2118},
+  {0x211E, 0x2123},
+  {0x2125, 0x2125},
+  {0x2127, 0x2127},
+  {0x2129, 0x2129},
+  {0x212E, 0x212E},
+  {0x213A, 0x213B},
+  {0x2140, 0x2144},
+  {0x214A, 0x214D},
+  {0x214F, 0x214F},
+  {0x218A, 0x218B},
+  {0x2190, 0x2426},
+  {0x2440, 0x244A},
+  {0x249C, 0x24E9},
+  {0x2500, 0x2775},
+  {0x2794, 0x2B73},
+  {0x2B76, 0x2B95},
+  {0x2B97, 0x2BFF},
+  {0x2CE5, 0x2CEA},
+  {0x2CF9, 0x2CFC},
+  {0x2CFE, 0x2CFF},
+  {0x2D70, 0x2D70},
+  {0x2E00, 0x2E2E},
+  {0x2E30, 0x2E5D},
+  {0x2E80, 0x2E99},
+  {0x2E9B, 0x2EF3},
+  {0x2F00, 0x2FD5},
+  {0x2FF0, 0x2FFB},
+  {0x3001, 0x3004},
+  {0x3008, 0x3020},
+  {0x3030, 0x3030},
+  {0x3036, 0x3037},
+  {0x303D, 0x303F},
+  {0x309B, 0x309C},
+  {0x30A0, 0x30A0},
+  {0x30FB, 0x30FB},
+  {0x3190, 0x3191},
+  {0x3196, 0x319F},
+  {0x31C0, 0x31E3},
+  {0x3200, 0x321E},
+  {0x322A, 0x3247},
+  {0x3250, 0x3250},
+  {0x3260, 0x327F},
+  {0x328A, 0x32B0},
+  {0x32C0, 0x33FF},
+  {0x4DC0, 0x4DFF},
+  {0xA490, 0xA4C6},
+  {0xA4FE, 0xA4FF},
+  {0xA60D, 0xA60F},
+  {0xA673, 0xA673},
+  {0xA67E, 0xA67E},
+  {0xA6F2, 0xA6F7},
+  {0xA700, 0xA716},
+  {0xA720, 0xA721},
+  {0xA789, 0xA78A},
+  {0xA828, 0xA82B},
+  {0xA836, 0xA839},
+  {0xA874, 0xA877},
+  {0xA8CE, 0xA8CF},
+  {0xA8F8, 0xA8FA},
+  {0xA8FC, 0xA8FC},
+  {0xA92E, 0xA92F},
+  {0xA95F, 0xA95F},
+  {0xA9C1, 0xA9CD},
+  {0xA9DE, 0xA9DF},
+  {0xAA5C, 0xAA5F},
+  {0xAA77, 0xAA79},
+  {0xAADE, 0xAADF},
+  {0xAAF0, 0xAAF1},
+  {0xAB5B, 0xAB5B},
+  {0xAB6A, 0xAB6B},
+  {0xABEB, 0xABEB},
+  {0xFB29, 0xFB29},
+  {0xFBB2, 0xFBC2},
+  {0xFD3E, 0xFD4F},
+  {0xFDCF, 0xFDCF},
+  {0xFDFC, 0xFDFF},
+  {0xFE10, 0xFE19},
+  {0xFE30, 0xFE52},
+  {0xFE54, 0xFE66},
+  {0xFE68, 0xFE6B},
+  {0xFF01, 0xFF0F},
+  {0xFF1A, 0xFF20},
+  {0xFF3B, 0xFF40},
+  {0xFF5B, 0xFF65},
+  {0xFFE0, 0xFFE6},
+  {0xFFE8, 0xFFEE},
+  {0xFFFC, 0xFFFD},
+  {0x10100, 0x10102},
+  {0x10137, 0x1013F},
+  {0x10179, 0x10189},
+  {0x1018C, 0x1018E},
+  {0x10190, 0x1019C},
+  {0x101A0, 0x101A0},
+  {0x101D0, 0x101FC},
+  {0x1039F, 0x1039F},
+  {0x103D0, 0x103D0},
+  {0x1056F, 0x1056F},
+  {0x10857, 0x10857},
+  {0x10877, 0x10878},
+  {0x1091F, 0x1091F},
+  {0x1093F, 0x1093F},
+  {0x10A50, 0x10A58},
+  {0x10A7F, 0x10A7F},
+  {0x10AC8, 0x10AC8},
+  {0x10AF0, 0x10AF6},
+  {0x10B39, 0x10B3F},
+  {0x10B99, 0x10B9C},
+  {0x10EAD, 0x10EAD},
+  {0x10F55, 0x10F59},
+  {0x10F86, 0x10F89},
+  {0x11047, 0x1104D},
+  {0x110BB, 0x110BC},
+  {0x110BE, 0x110C1},
+  {0x11140, 0x11143},
+  {0x11174, 0x11175},
+  {0x111C5, 0x111C8},
+  {0x111CD, 0x111CD},
+  {0x111DB, 0x111DB},
+  {0x111DD, 0x111DF},
+  {0x11238, 0x1123D},
+  {0x112A9, 0x112A9},
+  {0x1144B, 0x1144F},
+  {0x1145A, 0x1145B},
+  {0x1145D, 0x1145D},
+  {0x114C6, 0x114C6},
+  {0x115C1, 0x115D7},
+  {0x11641, 0x11643},
+  {0x11660, 0x1166C},
+  {0x116B9, 0x116B9},
+  {0x1173C, 0x1173F},
+  {0x1183B, 0x1183B},
+  {0x11944, 0x11946},
+  {0x119E2, 0x119E2},
+  {0x11A3F, 0x11A46},
+  {0x11A9A, 0x11A9C},
+  {0x11A9E, 0x11AA2},
+  {0x11C41, 0x11C45},
+  {0x11C70, 0x11C71},
+  {0x11EF7, 0x11EF8},
+  {0x11FD5, 0x11FF1},
+  {0x11FFF, 0x11FFF},
+  {0x12470, 0x12474},
+  {0x12FF1, 0x12FF2},
+  {0x16A6E, 0x16A6F},
+  {0x16AF5, 0x16AF5},
+  {0x16B37, 0x16B3F},
+  {0x16B44, 0x16B45},
+  {0x16E97, 0x16E9A},
+  {0x16FE2, 0x16FE2},
+  {0x1BC9C, 0x1BC9C},
+  {0x1BC9F, 0x1BC9F},
+  {0x1CF50, 0x1CFC3},
+  {0x1D000, 0x1D0F5},
+  {0x1D100, 0x1D126},
+  {0x1D129, 0x1D164},
+  {0x1D16A, 0x1D16C},
+  {0x1D183, 0x1D184},
+  {0x1D18C, 0x1D1A9},
+  {0x1D1AE, 0x1D1EA},
+  {0x1D200, 0x1D241},
+  {0x1D245, 0x1D245},
+  {0x1D300, 0x1D356},
+  {0x1D6C1, 0x1D6C1},
+  {0x1D6DB, 0x1D6DB},
+  {0x1D6FB, 0x1D6FB},
+  {0x1D715, 0x1D715},
+  {0x1D735, 0x1D735},
+  {0x1D74F, 0x1D74F},
+  {0x1D76F, 0x1D76F},
+  {0x1D789, 0x1D789},
+  {0x1D7A9, 0x1D7A9},
+  {0x1D7C3, 0x1D7C3},
+  {0x1D800, 0x1D9FF},
+  {0x1DA37, 0x1DA3A},
+  {0x1DA6D, 0x1DA74},
+  {0x1DA76, 0x1DA83},
+  {0x1DA85, 0x1DA8B},
+  {0x1E14F, 0x1E14F},
+  {0x1E2FF, 0x1E2FF},
+  {0x1E95E, 0x1E95F},
+  {0x1ECAC, 0x1ECAC},
+  {0x1ECB0, 0x1ECB0},
+  {0x1ED2E, 0x1ED2E},
+  {0x1EEF0, 0x1EEF1},
+  {0x1F000, 0x1F02B},
+  {0x1F030, 0x1F093},
+  {0x1F0A0, 0x1F0AE},
+  {0x1F0B1, 0x1F0BF},
+  {0x1F0C1, 0x1F0CF},
+  {0x1F0D1, 0x1F0F5},
+  {0x1F10D, 0x1F1AD},
+  {0x1F1E6, 0x1F202},
+  {0x1F210, 0x1F23B},
+  {0x1F240, 0x1F248},
+  {0x1F250, 0x1F251},
+  {0x1F260, 0x1F265},
+  {0x1F300, 0x1F6D7},
+  {0x1F6DD, 0x1F6EC},
+  {0x1F6F0, 0x1F6FC},
+  {0x1F700, 0x1F773},
+  {0x1F780, 0x1F7D8},
+  {0x1F7E0, 0x1F7EB},
+  {0x1F7F0, 0x1F7F0},
+  {0x1F800, 0x1F80B},
+  {0x1F810, 0x1F847},
+  {0x1F850, 0x1F859},
+  {0x1F860, 0x1F887},
+  {0x1F890, 0x1F8AD},
+  {0x1F8B0, 0x1F8B1},
+  {0x1F900, 0x1FA53},
+  {0x1FA60, 0x1FA6D},
+  {0x1FA70, 0x1FA74},
+  {0x1FA78, 0x1FA7C},
+  {0x1FA80, 0x1FA86},
+  {0x1FA90, 0x1FAAC},
+  {0x1FAB0, 0x1FABA},
+  {0x1FAC0, 0x1FAC5},
+  {0x1FAD0, 0x1FAD9},
+  {0x1FAE0, 0x1FAE7},
+  {0x1FAF0, 0x1FAF6},
+  {0x1FB00, 0x1FB92},
+  {0x1FB94, 0x1FBCA},
+};
+
+static const struct reader__umap reader__ucd_upper[] = {
+  {0x00B5, 0x00B5, 743, 1},
+  {0x00E0, 0x00F6, -32, 1},
+  {0x00F8, 0x00FE, -32, 1},
+  {0x00FF, 0x00FF, 121, 1},
+  {0x0101, 0x012F, -1, 2},
+  {0x0131, 0x0131, -232, 1},
+  {0x0133, 0x0137, -1, 2},
+  {0x013A, 0x0148, -1, 2},
+  {0x014B, 0x0177, -1, 2},
+  {0x017A, 0x017E, -1, 2},
+  {0x017F, 0x017F, -300, 1},
+  {0x0180, 0x0180, 195, 1},
+  {0x0183, 0x0185, -1, 2},
+  {0x0188, 0x0188, -1, 1},
+  {0x018C, 0x018C, -1, 1},
+  {0x0192, 0x0192, -1, 1},
+  {0x0195, 0x0195, 97, 1},
+  {0x0199, 0x0199, -1, 1},
+  {0x019A, 0x019A, 163, 1},
+  {0x019E, 0x019E, 130, 1},
+  {0x01A1, 0x01A5, -1, 2},
+  {0x01A8, 0x01A8, -1, 1},
+  {0x01AD, 0x01AD, -1, 1},
+  {0x01B0, 0x01B0, -1, 1},
+  {0x01B4, 0x01B6, -1, 2},
+  {0x01B9, 0x01B9, -1, 1},
+  {0x01BD, 0x01BD, -1, 1},
+  {0x01BF, 0x01BF, 56, 1},
+  {0x01C5, 0x01C5, -1, 1},
+  {0x01C6, 0x01C6, -2, 1},
+  {0x01C8, 0x01C8, -1, 1},
+  {0x01C9, 0x01C9, -2, 1},
+  {0x01CB, 0x01CB, -1, 1},
+  {0x01CC, 0x01CC, -2, 1},
+  {0x01CE, 0x01DC, -1, 2},
+  {0x01DD, 0x01DD, -79, 1},
+  {0x01DF, 0x01EF, -1, 2},
+  {0x01F2, 0x01F2, -1, 1},
+  {0x01F3, 0x01F3, -2, 1},
+  {0x01F5, 0x01F5, -1, 1},
+  {0x01F9, 0x021F, -1, 2},
+  {0x0223, 0x0233, -1, 2},
+  {0x023C, 0x023C, -1, 1},
+  {0x023F, 0x0240, 10815, 1},
+  {0x0242, 0x0242, -1, 1},
+  {0x0247, 0x024F, -1, 2},
+  {0x0250, 0x0250, 10783, 1},
+  {0x0251, 0x0251, 10780, 1},
+  {0x0252, 0x0252, 10782, 1},
+  {0x0253, 0x0253, -210, 1},
+  {0x0254, 0x0254, -206, 1},
+  {0x0256, 0x0257, -205, 1},
+  {0x0259, 0x0259, -202, 1},
+  {0x025B, 0x025B, -203, 1},
+  {0x025C, 0x025C, 42319, 1},
+  {0x0260, 0x0260, -205, 1},
+  {0x0261, 0x0261, 42315, 1},
+  {0x0263, 0x0263, -207, 1},
+  {0x0265, 0x0265, 42280, 1},
+  {0x0266, 0x0266, 42308, 1},
+  {0x0268, 0x0268, -209, 1},
+  {0x0269, 0x0269, -211, 1},
+  {0x026A, 0x026A, 42308, 1},
+  {0x026B, 0x026B, 10743, 1},
+  {0x026C, 0x026C, 42305, 1},
+  {0x026F, 0x026F, -211, 1},
+  {0x0271, 0x0271, 10749, 1},
+  {0x0272, 0x0272, -213, 1},
+  {0x0275, 0x0275, -214, 1},
+  {0x027D, 0x027D, 10727, 1},
+  {0x0280, 0x0280, -218, 1},
+  {0x0282, 0x0282, 42307, 1},
+  {0x0283, 0x0283, -218, 1},
+  {0x0287, 0x0287, 42282, 1},
+  {0x0288, 0x0288, -218, 1},
+  {0x0289, 0x0289, -69, 1},
+  {0x028A, 0x028B, -217, 1},
+  {0x028C, 0x028C, -71, 1},
+  {0x0292, 0x0292, -219, 1},
+  {0x029D, 0x029D, 42261, 1},
+  {0x029E, 0x029E, 42258, 1},
+  {0x0345, 0x0345, 84, 1},
+  {0x0371, 0x0373, -1, 2},
+  {0x0377, 0x0377, -1, 1},
+  {0x037B, 0x037D, 130, 1},
+  {0x03AC, 0x03AC, -38, 1},
+  {0x03AD, 0x03AF, -37, 1},
+  {0x03B1, 0x03C1, -32, 1},
+  {0x03C2, 0x03C2, -31, 1},
+  {0x03C3, 0x03CB, -32, 1},
+  {0x03CC, 0x03CC, -64, 1},
+  {0x03CD, 0x03CE, -63, 1},
+  {0x03D0, 0x03D0, -62, 1},
+  {0x03D1, 0x03D1, -57, 1},
+  {0x03D5, 0x03D5, -47, 1},
+  {0x03D6, 0x03D6, -54, 1},
+  {0x03D7, 0x03D7, -8, 1},
+  {0x03D9, 0x03EF, -1, 2},
+  {0x03F0, 0x03F0, -86, 1},
+  {0x03F1, 0x03F1, -80, 1},
+  {0x03F2, 0x03F2, 7, 1},
+  {0x03F3, 0x03F3, -116, 1},
+  {0x03F5, 0x03F5, -96, 1},
+  {0x03F8, 0x03F8, -1, 1},
+  {0x03FB, 0x03FB, -1, 1},
+  {0x0430, 0x044F, -32, 1},
+  {0x0450, 0x045F, -80, 1},
+  {0x0461, 0x0481, -1, 2},
+  {0x048B, 0x04BF, -1, 2},
+  {0x04C2, 0x04CE, -1, 2},
+  {0x04CF, 0x04CF, -15, 1},
+  {0x04D1, 0x052F, -1, 2},
+  {0x0561, 0x0586, -48, 1},
+  {0x10D0, 0x10FA, 3008, 1},
+  {0x10FD, 0x10FF, 3008, 1},
+  {0x13F8, 0x13FD, -8, 1},
+  {0x1C80, 0x1C80, -6254, 1},
+  {0x1C81, 0x1C81, -6253, 1},
+  {0x1C82, 0x1C82, -6244, 1},
+  {0x1C83, 0x1C84, -6242, 1},
+  {0x1C85, 0x1C85, -6243, 1},
+  {0x1C86, 0x1C86, -6236, 1},
+  {0x1C87, 0x1C87, -6181, 1},
+  {0x1C88, 0x1C88, 35266, 1},
+  {0x1D79, 0x1D79, 35332, 1},
+  {0x1D7D, 0x1D7D, 3814, 1},
+  {0x1D8E, 0x1D8E, 35384, 1},
+  {0x1E01, 0x1E95, -1, 2},
+  {0x1E9B, 0x1E9B, -59, 1},
+  {0x1EA1, 0x1EFF, -1, 2},
+  {0x1F00, 0x1F07, 8, 1},
+  {0x1F10, 0x1F15, 8, 1},
+  {0x1F20, 0x1F27, 8, 1},
+  {0x1F30, 0x1F37, 8, 1},
+  {0x1F40, 0x1F45, 8, 1},
+  {0x1F51, 0x1F57, 8, 2},
+  {0x1F60, 0x1F67, 8, 1},
+  {0x1F70, 0x1F71, 74, 1},
+  {0x1F72, 0x1F75, 86, 1},
+  {0x1F76, 0x1F77, 100, 1},
+  {0x1F78, 0x1F79, 128, 1},
+  {0x1F7A, 0x1F7B, 112, 1},
+  {0x1F7C, 0x1F7D, 126, 1},
+  {0x1FB0, 0x1FB1, 8, 1},
+  {0x1FBE, 0x1FBE, -7205, 1},
+  {0x1FD0, 0x1FD1, 8, 1},
+  {0x1FE0, 0x1FE1, 8, 1},
+  {0x1FE5, 0x1FE5, 7, 1},
+  {0x214E, 0x214E, -28, 1},
+  {0x2170, 0x217F, -16, 1},
+  {0x2184, 0x2184, -1, 1},
+  {0x24D0, 0x24E9, -26, 1},
+  {0x2C30, 0x2C5F, -48, 1},
+  {0x2C61, 0x2C61, -1, 1},
+  {0x2C65, 0x2C65, -10795, 1},
+  {0x2C66, 0x2C66, -10792, 1},
+  {0x2C68, 0x2C6C, -1, 2},
+  {0x2C73, 0x2C73, -1, 1},
+  {0x2C76, 0x2C76, -1, 1},
+  {0x2C81, 0x2CE3, -1, 2},
+  {0x2CEC, 0x2CEE, -1, 2},
+  {0x2CF3, 0x2CF3, -1, 1},
+  {0x2D00, 0x2D25, -7264, 1},
+  {0x2D27, 0x2D27, -7264, 1},
+  {0x2D2D, 0x2D2D, -7264, 1},
+  {0xA641, 0xA66D, -1, 2},
+  {0xA681, 0xA69B, -1, 2},
+  {0xA723, 0xA72F, -1, 2},
+  {0xA733, 0xA76F, -1, 2},
+  {0xA77A, 0xA77C, -1, 2},
+  {0xA77F, 0xA787, -1, 2},
+  {0xA78C, 0xA78C, -1, 1},
+  {0xA791, 0xA793, -1, 2},
+  {0xA794, 0xA794, 48, 1},
+  {0xA797, 0xA7A9, -1, 2},
+  {0xA7B5, 0xA7C3, -1, 2},
+  {0xA7C8, 0xA7CA, -1, 2},
+  {0xA7D1, 0xA7D1, -1, 1},
+  {0xA7D7, 0xA7D9, -1, 2},
+  {0xA7F6, 0xA7F6, -1, 1},
+  {0xAB53, 0xAB53, -928, 1},
+  {0xAB70, 0xABBF, -38864, 1},
+  {0xFF41, 0xFF5A, -32, 1},
+  {0x10428, 0x1044F, -40, 1},
+  {0x104D8, 0x104FB, -40, 1},
+  {0x10597, 0x105A1, -39, 1},
+  {0x105A3, 0x105B1, -39, 1},
+  {0x105B3, 0x105B9, -39, 1},
+  {0x105BB, 0x105BC, -39, 1},
+  {0x10CC0, 0x10CF2, -64, 1},
+  {0x118C0, 0x118DF, -32, 1},
+  {0x16E60, 0x16E7F, -32, 1},
+  {0x1E922, 0x1E943, -34, 1},
+};
@@ -0,0 +1,425 @@
+//  Implantation du module server - chaque fil d'exécution du serveur attend,
+//    par poll, qu'une connexion soit prête sur la socket ou que l'arrêt soit
+//    signalé par l'écriture d'un octet dans un tube par le fil principal. La
+//    requête est lue en entier, champs terminés par un caractère nul, jusqu'à
+//    la fermeture en écriture de la connexion par le client. La réponse est
+//    produite en mémoire avant d'être envoyée : une ligne d'entête
+//    "<code de retour> <longueur d'erreur> <longueur de sortie>", le texte
+//    d'erreur puis le texte de sortie.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "server.h"
+
+//  SERVER__BACKLOG : nombre maximal de connexions en attente d'acceptation.
+#define SERVER__BACKLOG 64
+
+//  SERVER__REQMAX : taille maximale d'une requête, en octets.
+#define SERVER__REQMAX (4 * 1024 * 1024)
+
+//  SERVER__TIMEOUT : délai maximal, en secondes, d'une lecture ou d'une
+//    écriture sur une connexion acceptée par le serveur, au-delà duquel la
+//    connexion est abandonnée.
+#define SERVER__TIMEOUT 30
+
+//  SERVER__HEADMAX : longueur maximale de la ligne d'entête d'une réponse.
+#define SERVER__HEADMAX 64
+
+//  SERVER__CHUNK : taille des blocs lus sur une connexion.
+#define SERVER__CHUNK 4096
+
+//  struct server__pool : le composant listenfd est le descripteur de la
+//    socket d'écoute, stopfd celui de la sortie du tube d'arrêt, handler et
+//    context le gestionnaire des requêtes et son contexte.
+struct server__pool {
+  int listenfd;
+  int stopfd;
+  server_handler handler;
+  void *context;
+};
+
+//  server__write : écrit les n octets pointés par p sur le descripteur fd.
+//    Renvoie une valeur non nulle en cas d'échec. Renvoie sinon zéro.
+static int server__write(int fd, const char *p, size_t n) {
+  while (n > 0) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0 && errno == EINTR) {
+      continue;
+    }
+    if (w <= 0) {
+      return -1;
+    }
+    p += w;
+    n -= (size_t) w;
+  }
+  return 0;
+}
+
+//  server__address : remplit la structure associée à addr pour la socket
+//    locale de nom path. Renvoie ENAMETOOLONG si le nom est trop long. Renvoie
+//    sinon zéro.
+static int server__address(struct sockaddr_un *addr, const char *path) {
+  if (strlen(path) >= sizeof addr->sun_path) {
+    return ENAMETOOLONG;
+  }
+  memset(addr, 0, sizeof *addr);
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, path);
+  return 0;
+}
+
+//  server__stale : teste si la socket locale d'adresse addr existe sans
+//    qu'aucun serveur ne s'en serve.
+static bool server__stale(const struct sockaddr_un *addr) {
+  struct stat st;
+  if (lstat(addr->sun_path, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+    return false;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  bool stale = connect(fd, (const struct sockaddr *) addr, sizeof *addr) != 0
+      && errno == ECONNREFUSED;
+  close(fd);
+  return stale;
+}
+
+//  server__read_request : lit la requête reçue sur le descripteur fd dans un
+//    tampon alloué, affecté à *bufptr, et affecte sa taille à *lenptr. Renvoie
+//    une valeur non nulle en cas d'échec, de dépassement de capacité ou de
+//    requête trop longue. Renvoie sinon zéro.
+static int server__read_request(int fd, char **bufptr, size_t *lenptr) {
+  char *buf = NULL;
+  size_t len = 0;
+  size_t size = 0;
+  while (true) {
+    if (size - len < SERVER__CHUNK) {
+      if (size >= SERVER__REQMAX) {
+        goto error;
+      }
+      size_t s = size == 0 ? SERVER__CHUNK
+          : size > SERVER__REQMAX / 2 ? SERVER__REQMAX : size * 2;
+      char *b = realloc(buf, s);
+      if (b == NULL) {
+        goto error;
+      }
+      buf = b;
+      size = s;
+    }
+    ssize_t r = read(fd, buf + len, size - len);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r < 0) {
+      goto error;
+    }
+    if (r == 0) {
+      break;
+    }
+    len += (size_t) r;
+  }
+  *bufptr = buf;
+  *lenptr = len;
+  return 0;
+  error:
+  free(buf);
+  return -1;
+}
+
+//  server__serve : répond à la requête reçue sur la connexion de descripteur
+//    fd à l'aide du gestionnaire de la structure associée à p. La connexion
+//    est abandonnée sans réponse si la requête est mal formée ou en cas de
+//    dépassement de capacité.
+static void server__serve(const struct server__pool *p, int fd) {
+  struct timeval tv = {
+    .tv_sec = SERVER__TIMEOUT,
+    .tv_usec = 0,
+  };
+  char *buf = NULL;
+  size_t len;
+  char **fields = NULL;
+  char *outbuf = NULL;
+  size_t outlen = 0;
+  char *errbuf = NULL;
+  size_t errlen = 0;
+  FILE *out = NULL;
+  FILE *err = NULL;
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv) != 0
+      || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv) != 0
+      || server__read_request(fd, &buf, &len) != 0
+      || (len > 0 && buf[len - 1] != '\0')) {
+    goto dispose;
+  }
+  size_t fieldcnt = 0;
+  for (size_t k = 0; k < len; ++k) {
+    fieldcnt += buf[k] == '\0';
+  }
+  fields = malloc((fieldcnt > 0 ? fieldcnt : 1) * sizeof *fields);
+  if (fields == NULL) {
+    goto dispose;
+  }
+  for (size_t k = 0, j = 0; j < fieldcnt; ++j) {
+    fields[j] = buf + k;
+    k += strlen(buf + k) + 1;
+  }
+  out = open_memstream(&outbuf, &outlen);
+  err = open_memstream(&errbuf, &errlen);
+  if (out == NULL || err == NULL) {
+    goto dispose;
+  }
+  int status = p->handler(p->context, fieldcnt, fields, out, err);
+  //  La fermeture des flots fixe le contenu et la longueur de leurs tampons.
+  int e = fclose(out);
+  out = NULL;
+  e |= fclose(err);
+  err = NULL;
+  if (e != 0) {
+    goto dispose;
+  }
+  char head[SERVER__HEADMAX];
+  int n = snprintf(head, sizeof head, "%d %zu %zu\n", status, errlen,
+      outlen);
+  if (n < 0 || (size_t) n >= sizeof head) {
+    goto dispose;
+  }
+  if (server__write(fd, head, (size_t) n) == 0
+      && server__write(fd, errbuf, errlen) == 0) {
+    (void) server__write(fd, outbuf, outlen);
+  }
+  dispose:
+  if (out != NULL) {
+    fclose(out);
+  }
+  if (err != NULL) {
+    fclose(err);
+  }
+  free(outbuf);
+  free(errbuf);
+  free(fields);
+  free(buf);
+}
+
+//  server__worker : boucle d'un fil d'exécution du serveur, de paramètre un
+//    pointeur vers la structure struct server__pool commune à tous.
+static void *server__worker(void *arg) {
+  const struct server__pool *p = arg;
+  struct pollfd fds[2] = {
+    {
+      .fd = p->listenfd, .events = POLLIN,
+    },
+    {
+      .fd = p->stopfd, .events = POLLIN,
+    },
+  };
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    //  L'octet du tube n'est jamais lu : tous les fils voient l'arrêt.
+    if (fds[1].revents != 0) {
+      break;
+    }
+    //  La socket d'écoute est non bloquante : la connexion a pu être acceptée
+    //    entretemps par un autre fil.
+    int fd = accept(p->listenfd, NULL, NULL);
+    if (fd < 0) {
+      continue;
+    }
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0 && fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) == 0) {
+      server__serve(p, fd);
+    }
+    close(fd);
+  }
+  return NULL;
+}
+
+int server_run(const char *path, size_t threadcnt, server_handler handler,
+    void *context) {
+  struct sockaddr_un addr;
+  int e = server__address(&addr, path);
+  if (e != 0) {
+    return e;
+  }
+  int stop[2] = {
+    -1, -1,
+  };
+  pthread_t *threads = NULL;
+  size_t started = 0;
+  bool bound = false;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return errno;
+  }
+  if (bind(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+    e = errno;
+    if (e != EADDRINUSE || !server__stale(&addr) || unlink(path) != 0
+        || bind(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+      goto close;
+    }
+  }
+  bound = true;
+  int flags;
+  if (listen(fd, SERVER__BACKLOG) != 0 || (flags = fcntl(fd, F_GETFL)) < 0
+      || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0 || pipe(stop) != 0) {
+    e = errno;
+    goto close;
+  }
+  //  Les signaux d'arrêt sont bloqués avant le lancement des fils, qui en
+  //    héritent le masque : seul le fil principal les reçoit, par sigwait.
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGINT);
+  sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGHUP);
+  e = pthread_sigmask(SIG_BLOCK, &set, NULL);
+  if (e != 0) {
+    goto close;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  threads = malloc((threadcnt > 0 ? threadcnt : 1) * sizeof *threads);
+  if (threads == NULL) {
+    e = ENOMEM;
+    goto close;
+  }
+  struct server__pool pool = {
+    .listenfd = fd,
+    .stopfd = stop[0],
+    .handler = handler,
+    .context = context,
+  };
+  while (started < threadcnt) {
+    e = pthread_create(&threads[started], NULL, server__worker, &pool);
+    if (e != 0) {
+      break;
+    }
+    ++started;
+  }
+  if (e == 0) {
+    int sig;
+    e = sigwait(&set, &sig);
+  }
+  if (started > 0 && server__write(stop[1], "", 1) != 0 && e == 0) {
+    e = errno;
+  }
+  for (size_t k = 0; k < started; ++k) {
+    pthread_join(threads[k], NULL);
+  }
+  close:
+  free(threads);
+  if (stop[0] >= 0) {
+    close(stop[0]);
+    close(stop[1]);
+  }
+  close(fd);
+  if (bound) {
+    unlink(path);
+  }
+  return e;
+}
+
+//  server__copy : recopie les n octets suivants du flot contrôlé par src sur
+//    celui contrôlé par dest. Renvoie EPROTO si le flot src se termine avant,
+//    le code d'erreur au sens de errno en cas d'erreur de lecture ou
+//    d'écriture. Renvoie sinon zéro.
+static int server__copy(FILE *dest, FILE *src, size_t n) {
+  char buf[SERVER__CHUNK];
+  while (n > 0) {
+    size_t r = fread(buf, 1, n < sizeof buf ? n : sizeof buf, src);
+    if (r == 0) {
+      return ferror(src) ? errno : EPROTO;
+    }
+    if (fwrite(buf, 1, r, dest) != r) {
+      return errno;
+    }
+    n -= r;
+  }
+  return 0;
+}
+
+int server_request(const char *path, size_t fieldcnt,
+    const char * const *fields, FILE *out, FILE *err, int *statusptr) {
+  struct sockaddr_un addr;
+  int e = server__address(&addr, path);
+  if (e != 0) {
+    return e;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return errno;
+  }
+  if (connect(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+    e = errno;
+    close(fd);
+    return e;
+  }
+  for (size_t k = 0; k < fieldcnt; ++k) {
+    if (server__write(fd, fields[k], strlen(fields[k]) + 1) != 0) {
+      e = errno;
+      close(fd);
+      return e;
+    }
+  }
+  FILE *f;
+  if (shutdown(fd, SHUT_WR) != 0 || (f = fdopen(fd, "r")) == NULL) {
+    e = errno;
+    close(fd);
+    return e;
+  }
+  char head[SERVER__HEADMAX];
+  int status;
+  size_t errlen;
+  size_t outlen;
+  char nl;
+  if (fgets(head, sizeof head, f) == NULL
+      || sscanf(head, "%d %zu %zu%c", &status, &errlen, &outlen, &nl) != 4
+      || nl != '\n') {
+    e = ferror(f) ? errno : EPROTO;
+    goto close;
+  }
+  e = server__copy(err, f, errlen);
+  if (e == 0) {
+    e = server__copy(out, f, outlen);
+  }
+  if (e == 0 && fgetc(f) != EOF) {
+    e = EPROTO;
+  }
+  if (e == 0) {
+    *statusptr = status;
+  }
+  close:
+  fclose(f);
+  return e;
+}
+
+int server_field_size(const char *field, size_t *nptr) {
+  if (*field < '0' || *field > '9') {
+    return -1;
+  }
+  char *end;
+  errno = 0;
+  unsigned long long n = strtoull(field, &end, 10);
+  if (*end != '\0' || errno != 0 || n > SIZE_MAX) {
+    return -1;
+  }
+  *nptr = (size_t) n;
+  return 0;
+}
@@ -0,0 +1,51 @@
+//  Interface du module server - module implémentant un serveur de requêtes
+//    sur une socket locale, ainsi que son client. Une requête est une suite de
+//    champs, chaines de caractères ; sa réponse est formée d'un code de
+//    retour, d'un texte de sortie et d'un texte d'erreur, produits par le
+//    gestionnaire fourni au serveur. Le serveur comme le client ignorent le
+//    signal SIGPIPE pour le processus entier.
+
+#ifndef SERVER__H
+#define SERVER__H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  server_handler : type des gestionnaires de requêtes. Un gestionnaire reçoit
+//    le contexte context fourni à server_run et la requête formée des fieldcnt
+//    champs du tableau pointé par fields. Il écrit sa sortie sur le flot
+//    contrôlé par out, ses messages d'erreur sur celui contrôlé par err, et
+//    renvoie le code de retour de la requête. Il peut être appelé simultanément
+//    par plusieurs fils d'exécution.
+typedef int (*server_handler)(void *context, size_t fieldcnt,
+    char * const *fields, FILE *out, FILE *err);
+
+//  server_run : crée la socket locale de nom path puis répond aux requêtes
+//    reçues à l'aide de threadcnt fils d'exécution et du gestionnaire handler
+//    avec le contexte context, jusqu'à ce que le processus reçoive l'un des
+//    signaux SIGINT, SIGTERM ou SIGHUP. Une socket de même nom dont aucun
+//    serveur ne se sert plus est remplacée ; la socket est supprimée à l'arrêt.
+//    Doit être appelée par le fil principal, avant le lancement de tout autre
+//    fil d'exécution. Renvoie EADDRINUSE si un serveur se sert déjà de la
+//    socket, un autre code d'erreur au sens de errno si elle n'a pu être créée
+//    ou si les fils d'exécution n'ont pu être lancés. Renvoie sinon zéro.
+extern int server_run(const char *path, size_t threadcnt,
+    server_handler handler, void *context);
+
+//  server_request : envoie la requête formée des fieldcnt champs du tableau
+//    pointé par fields au serveur de la socket locale de nom path, écrit le
+//    texte d'erreur de sa réponse sur le flot contrôlé par err puis son texte
+//    de sortie sur celui contrôlé par out, et affecte à *statusptr son code de
+//    retour. Renvoie EPROTO si la réponse est mal formée, un autre code
+//    d'erreur au sens de errno si le serveur n'a pu être joint ou la réponse
+//    écrite. Renvoie sinon zéro.
+extern int server_request(const char *path, size_t fieldcnt,
+    const char * const *fields, FILE *out, FILE *err, int *statusptr);
+
+//  server_field_size : affecte à *nptr la valeur de l'entier non signé écrit
+//    en décimal dans le champ de requête pointé par field. Renvoie une valeur
+//    non nulle si le champ n'est pas l'écriture d'un tel entier représentable.
+//    Renvoie sinon zéro.
+extern int server_field_size(const char *field, size_t *nptr);
+
+#endif
@@ -0,0 +1,277 @@
+//  Implantation du module shard - la file du producteur p vers le fil
+//    d'agrégation s est queues[p * shardcnt + s]. Les files d'un même fil
+//    d'agrégation partagent une sonnette : le fil obtient un ticket avant de
+//    les parcourir et ne s'endort, s'il les a toutes trouvées vides, que
+//    jusqu'à la prochaine publication ou fermeture sur l'une d'elles. Chaque
+//    tampon contient une suite d'enregistrements, chacun formé d'un en-tête
+//    suivi de la chaine du mot.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "shard.h"
+#include "spsc.h"
+
+//  SHARD__SLOTCNT, SHARD__SLOTSIZE : respectivement le nombre de tampons de
+//    chacune des files et leur taille minimale.
+#define SHARD__SLOTCNT 4
+#define SHARD__SLOTSIZE (16 * 1024)
+
+//  struct shard__record : en-tête de l'enregistrement d'un mot : la somme de
+//    hachage hash et la longueur len de sa chaine, qui suit l'en-tête,
+//    caractère nul compris, ainsi que son nombre occ d'occurrences dans
+//    l'entrée d'indice idx.
+struct shard__record {
+  size_t hash;
+  size_t len;
+  size_t idx;
+  SHW_OCCURRENCES_TYPE occ;
+};
+
+//  SHARD__RECORD_SIZE : taille occupée dans un tampon par l'enregistrement
+//    d'un mot de len caractères, arrondie afin que l'en-tête suivant soit
+//    aligné.
+#define SHARD__RECORD_SIZE(len)                                                \
+  ((sizeof(struct shard__record) + (len) + _Alignof(struct shard__record))     \
+    / _Alignof(struct shard__record) * _Alignof(struct shard__record))
+
+//  struct shard__agg : structure propre à chaque fil d'agrégation : sa table,
+//    ses prodcnt files, d'adresses queues[0], queues[stride],
+//    queues[2 * stride]..., leur sonnette commune, le nombre minimal de
+//    fichiers des mots conservés à la réduction de la table, le nombre
+//    distinct de ses mots avant celle-ci et le code d'erreur error, nul tant
+//    qu'aucune erreur n'est survenue.
+struct shard__agg {
+  wordtable *wt;
+  spsc **queues;
+  spsc_bell *bell;
+  size_t prodcnt;
+  size_t stride;
+  size_t minfiles;
+  size_t distinct;
+  int error;
+};
+
+//  struct shard, shard : le tableau queues des prodcnt * shardcnt files, et
+//    pour chacune l'adresse slots du tampon en cours de remplissage, NULL s'il
+//    n'y en a pas, et le nombre fills d'octets déjà écrits dans celui-ci. Le
+//    tableau finished indique pour chaque producteur si ses files ont été
+//    closes. Les fils d'agrégation lancés, au nombre de started, ont les
+//    identifiants du tableau threads et les travaux du tableau aggs.
+struct shard {
+  size_t shardcnt;
+  size_t prodcnt;
+  spsc **queues;
+  char **slots;
+  size_t *fills;
+  bool *finished;
+  spsc_bell **bells;
+  struct shard__agg *aggs;
+  pthread_t *threads;
+  size_t started;
+  bool joined;
+};
+
+//  shard__aggregate : fonction exécutée par les fils d'agrégation. Marque dans
+//    la table du travail associé à a les mots reçus sur ses files jusqu'à ce
+//    que toutes soient closes et vides, puis réduit la table. Après un
+//    dépassement de capacité, les files continuent d'être vidées afin de ne
+//    pas bloquer les producteurs.
+static void *shard__aggregate(struct shard__agg *a) {
+  for (;;) {
+    unsigned t = spsc_bell_ticket(a->bell);
+    bool idle = true;
+    size_t donecnt = 0;
+    for (size_t p = 0; p < a->prodcnt; ++p) {
+      spsc *q = a->queues[p * a->stride];
+      const char *slot;
+      size_t len;
+      bool done;
+      while ((slot = spsc_front(q, &len, &done)) != NULL) {
+        idle = false;
+        for (size_t i = 0; i < len; ) {
+          const struct shard__record *r
+            = (const struct shard__record *) (slot + i);
+          if (a->error == 0) {
+            shword *shw = wordtable_insert_hashed(a->wt,
+                (const char *) (r + 1), r->len, r->hash);
+            if (shw == NULL) {
+              a->error = ENOMEM;
+            } else {
+              //  Inutile de vérifier la valeur de retour : le compteur est
+              //    saturé.
+              shword_add(shw, r->idx, r->occ);
+            }
+          }
+          i += SHARD__RECORD_SIZE(r->len);
+        }
+        spsc_pop(q);
+      }
+      donecnt += done;
+    }
+    if (donecnt == a->prodcnt) {
+      break;
+    }
+    if (idle) {
+      spsc_bell_wait(a->bell, t);
+    }
+  }
+  a->distinct = holdall_count(wordtable_words(a->wt));
+  if (a->error == 0 && a->minfiles > 1
+      && wordtable_compact(a->wt, a->minfiles) != 0) {
+    a->error = ENOMEM;
+  }
+  return NULL;
+}
+
+int shard_open(shard **sdptr, wordtable **tables, size_t shardcnt,
+    size_t prodcnt, size_t lenmax, size_t minfiles) {
+  shard *sd = malloc(sizeof *sd);
+  if (sd == NULL) {
+    return ENOMEM;
+  }
+  size_t slotsize = SHARD__RECORD_SIZE(lenmax);
+  if (slotsize < SHARD__SLOTSIZE) {
+    slotsize = SHARD__SLOTSIZE;
+  }
+  sd->shardcnt = shardcnt;
+  sd->prodcnt = prodcnt;
+  sd->queues = calloc(prodcnt * shardcnt, sizeof *sd->queues);
+  sd->slots = calloc(prodcnt * shardcnt, sizeof *sd->slots);
+  sd->fills = calloc(prodcnt * shardcnt, sizeof *sd->fills);
+  sd->finished = calloc(prodcnt, sizeof *sd->finished);
+  sd->bells = calloc(shardcnt, sizeof *sd->bells);
+  sd->aggs = calloc(shardcnt, sizeof *sd->aggs);
+  sd->threads = malloc(shardcnt * sizeof *sd->threads);
+  sd->started = 0;
+  sd->joined = false;
+  int e = ENOMEM;
+  if (sd->queues == NULL || sd->slots == NULL || sd->fills == NULL
+      || sd->finished == NULL || sd->bells == NULL || sd->aggs == NULL
+      || sd->threads == NULL) {
+    goto error;
+  }
+  for (size_t s = 0; s < shardcnt; ++s) {
+    sd->bells[s] = spsc_bell_empty();
+    if (sd->bells[s] == NULL) {
+      goto error;
+    }
+    for (size_t p = 0; p < prodcnt; ++p) {
+      sd->queues[p * shardcnt + s] = spsc_empty(SHARD__SLOTCNT, slotsize,
+          sd->bells[s]);
+      if (sd->queues[p * shardcnt + s] == NULL) {
+        goto error;
+      }
+    }
+  }
+  while (sd->started < shardcnt) {
+    size_t s = sd->started;
+    sd->aggs[s] = (struct shard__agg) {
+      .wt = tables[s],
+      .queues = sd->queues + s,
+      .bell = sd->bells[s],
+      .prodcnt = prodcnt,
+      .stride = shardcnt,
+      .minfiles = minfiles,
+      .distinct = 0,
+      .error = 0,
+    };
+    e = pthread_create(&sd->threads[s], NULL,
+        (void *(*)(void *))shard__aggregate, &sd->aggs[s]);
+    if (e != 0) {
+      goto error;
+    }
+    ++sd->started;
+  }
+  *sdptr = sd;
+  return 0;
+  error:
+  shard_dispose(&sd);
+  return e;
+}
+
+int shard_route(shard *sd, size_t p, const char *w, size_t len, size_t h,
+    size_t k, SHW_OCCURRENCES_TYPE occ) {
+  size_t i = p * sd->shardcnt + SHARD_OF(h, sd->shardcnt);
+  size_t n = SHARD__RECORD_SIZE(len);
+  if (sd->slots[i] == NULL
+      || spsc_slotsize(sd->queues[i]) - sd->fills[i] < n) {
+    if (sd->slots[i] != NULL) {
+      spsc_push(sd->queues[i], sd->fills[i]);
+    }
+    sd->slots[i] = spsc_back(sd->queues[i]);
+    sd->fills[i] = 0;
+  }
+  struct shard__record *r = (struct shard__record *) (sd->slots[i]
+      + sd->fills[i]);
+  *r = (struct shard__record) {
+    .hash = h,
+    .len = len,
+    .idx = k,
+    .occ = occ,
+  };
+  memcpy(r + 1, w, len);
+  ((char *) (r + 1))[len] = '\0';
+  sd->fills[i] += n;
+  return 0;
+}
+
+void shard_finish(shard *sd, size_t p) {
+  for (size_t i = p * sd->shardcnt; i < (p + 1) * sd->shardcnt; ++i) {
+    if (sd->slots[i] != NULL) {
+      spsc_push(sd->queues[i], sd->fills[i]);
+      sd->slots[i] = NULL;
+    }
+    spsc_close(sd->queues[i]);
+  }
+  sd->finished[p] = true;
+}
+
+int shard_join(shard *sd, size_t *distinctptr) {
+  for (size_t p = 0; p < sd->prodcnt; ++p) {
+    if (!sd->finished[p]) {
+      shard_finish(sd, p);
+    }
+  }
+  int e = 0;
+  for (size_t s = 0; s < sd->started; ++s) {
+    pthread_join(sd->threads[s], NULL);
+    if (sd->aggs[s].error != 0) {
+      e = sd->aggs[s].error;
+    }
+    *distinctptr += sd->aggs[s].distinct;
+  }
+  sd->joined = true;
+  return e;
+}
+
+void shard_dispose(shard **sdptr) {
+  shard *sd = *sdptr;
+  if (sd == NULL) {
+    return;
+  }
+  //  Les files ne peuvent être closes que si elles ont toutes été créées ;
+  //    aucun fil d'agrégation n'est lancé sinon.
+  if (!sd->joined && sd->started > 0) {
+    size_t distinct = 0;
+    shard_join(sd, &distinct);
+  }
+  for (size_t k = 0; sd->queues != NULL && k < sd->prodcnt * sd->shardcnt;
+      ++k) {
+    spsc_dispose(&sd->queues[k]);
+  }
+  for (size_t s = 0; sd->bells != NULL && s < sd->shardcnt; ++s) {
+    spsc_bell_dispose(&sd->bells[s]);
+  }
+  free(sd->queues);
+  free(sd->slots);
+  free(sd->fills);
+  free(sd->finished);
+  free(sd->bells);
+  free(sd->aggs);
+  free(sd->threads);
+  free(sd);
+  *sdptr = NULL;
+}
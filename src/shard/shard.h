@@ -0,0 +1,74 @@
+//  Interface du module shard - module implémentant l'agrégation répartie de
+//    mots partagés : les mots transmis par plusieurs producteurs sont répartis
+//    selon leur somme de hachage entre plusieurs tables disjointes, chacune
+//    n'étant modifiée que par son propre fil d'exécution d'agrégation. Chaque
+//    producteur est relié à chaque fil d'agrégation par une file spsc ; un fil
+//    d'agrégation dont toutes les files sont vides s'endort jusqu'à ce que
+//    l'une d'elles reçoive un tampon ou soit close, et un producteur dont la
+//    file est pleine jusqu'à ce qu'un tampon lui soit rendu.
+
+#ifndef SHARD__H
+#define SHARD__H
+
+#include <stdlib.h>
+#include "shword.h"
+#include "wordtable.h"
+
+//  SHARD_OF : renvoie l'indice, parmi n, de la table d'un mot de somme de
+//    hachage h, déterminé par les bits de poids fort de h afin que les bits de
+//    poids faible restent répartis dans la table de hachage de la table.
+#define SHARD_OF(h, n)                                                         \
+  ((h) / (SIZE_MAX / (n)) < (n) ? (h) / (SIZE_MAX / (n)) : (n) - 1)
+
+//  struct shard, shard : structure regroupant les files, les tampons en cours
+//    de remplissage des producteurs et les fils d'agrégation. La création de
+//    la structure de données associée est confiée à la fonction shard_open.
+typedef struct shard shard;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type shard * n'est pas l'adresse d'un objet préalablement affecté par
+//    shard_open et non révoqué depuis par shard_dispose. Cette règle ne souffre
+//    que d'une seule exception : shard_dispose tolère que la déréférence de son
+//    argument ait pour valeur NULL. Les fonctions shard_route et shard_finish
+//    ne doivent être appelées pour un même producteur que par un même fil
+//    d'exécution, et jamais après shard_join.
+
+//  shard_open : crée un moteur d'agrégation, dans les shardcnt tables du
+//    tableau pointé par tables, des mots d'au plus lenmax caractères transmis
+//    par prodcnt producteurs d'indices 0 à prodcnt - 1, puis lance ses
+//    shardcnt fils d'agrégation. Le mot de somme de hachage h est agrégé dans
+//    la table d'indice SHARD_OF(h, shardcnt). Si minfiles est supérieur à un,
+//    chaque table est réduite par wordtable_compact avec minfiles une fois
+//    toutes ses files closes. Renvoie ENOMEM en cas de dépassement de
+//    capacité, le code d'erreur de pthread_create si un fil d'agrégation n'a pu
+//    être lancé. Affecte sinon à *sdptr un pointeur vers l'objet qui gère la
+//    structure de données et renvoie zéro.
+extern int shard_open(shard **sdptr, wordtable **tables, size_t shardcnt,
+    size_t prodcnt, size_t lenmax, size_t minfiles);
+
+//  shard_route : transmet, pour le producteur d'indice p, le mot de longueur
+//    len et de somme de hachage h pointé par w, de nombre d'occurrences occ
+//    dans l'entrée d'indice k, au fil d'agrégation de sa table dans la
+//    structure associée à sd. Le tampon en cours de remplissage n'est publié
+//    que lorsqu'il ne peut plus contenir le mot. Renvoie zéro.
+extern int shard_route(shard *sd, size_t p, const char *w, size_t len,
+    size_t h, size_t k, SHW_OCCURRENCES_TYPE occ);
+
+//  shard_finish : publie les tampons en cours de remplissage du producteur
+//    d'indice p de la structure associée à sd puis clôt ses files.
+extern void shard_finish(shard *sd, size_t p);
+
+//  shard_join : clôt à l'aide de shard_finish les files des producteurs de la
+//    structure associée à sd qui ne l'ont pas été, attend la fin des fils
+//    d'agrégation puis ajoute à *distinctptr le nombre de mots distincts des
+//    tables avant leur réduction. Renvoie ENOMEM si un fil d'agrégation a
+//    rencontré un dépassement de capacité. Renvoie sinon zéro.
+extern int shard_join(shard *sd, size_t *distinctptr);
+
+//  shard_dispose : si *sdptr ne vaut pas NULL, exécute shard_join sur la
+//    structure de données associée à *sdptr si ce n'a pas été fait, libère les
+//    ressources allouées à celle-ci, les tables exceptées, puis affecte à
+//    *sdptr la valeur NULL.
+extern void shard_dispose(shard **sdptr);
+
+#endif
@@ -1,45 +1,83 @@
-//  Implantation du module shword - le motif d'occurrences est déterminé par un
-//    entier dont le nombre de bits (8 * sizeof(type)) conditionne le nombre
-//    maximal de fichiers pouvant être pris en charge par ladite structure.
+//  Implantation du module shword - le motif d'occurrences est un ensemble de
+//    bits formé d'autant de mots de type SHW_PATTERN_TYPE que nécessaire au
+//    nombre de fichiers fixé au démarrage. Le fichier d'indice idx est associé
+//    au bit d'indice idx % SHW_PATTERN_BITS du mot d'indice
+//    idx / SHW_PATTERN_BITS.
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "shword.h"
 
-#define FLAG_HAS(d, f) ((d & (1 << f)) == (1 << f))
-#define FLAG_SET(d, f) (d |= (1 << f))
+//  shword__npat : nombre de mots de type SHW_PATTERN_TYPE du motif
+//    d'occurrences de chaque mot partagé, fixé par shword_setup.
+static size_t shword__npat = 1;
 
+//  shword__render : table associant à chaque valeur d'un octet de motif
+//    d'occurrences les huit caractères qui le représentent à l'affichage,
+//    celui du bit de poids faible en premier.
+static char shword__render[256][8];
+
+//  PAT_WORD, PAT_BIT : respectivement l'indice du mot de motif et le masque du
+//    bit associés au fichier d'indice idx.
+#define PAT_WORD(idx) ((idx) / SHW_PATTERN_BITS)
+#define PAT_BIT(idx) ((SHW_PATTERN_TYPE) 1 << (idx) % SHW_PATTERN_BITS)
+
+//  struct shword : le motif d'occurrences est formé des shword__npat mots du
+//    membre tableau flexible pat ; la chaine du mot est mémorisée à leur suite.
 struct shword {
-  const char *w;
-  SHW_PATTERN_TYPE pat;
   SHW_OCCURRENCES_TYPE occ;
   size_t fcount;
+  SHW_PATTERN_TYPE pat[];
 };
 
-shword *shword_create(const char *w) {
-  shword *p = malloc(sizeof *p);
-  if (p == NULL) {
+//  SHW__WORD : adresse de la chaine du mot partagé associé à shw.
+#define SHW__WORD(shw) ((char *) ((shw)->pat + shword__npat))
+
+//  SHW__HEAD : taille en octets d'un mot partagé hors chaine, son motif
+//    d'occurrences comptant npat mots.
+#define SHW__HEAD(npat) \
+  (offsetof(shword, pat) + (npat) * sizeof(SHW_PATTERN_TYPE))
+
+int shword_setup(size_t inputcnt) {
+  size_t n = SHW_PATTERN_WORDS(inputcnt);
+  if (n > (SIZE_MAX - sizeof(shword)) / sizeof(SHW_PATTERN_TYPE) / 2) {
+    return -1;
+  }
+  shword__npat = n;
+  for (size_t v = 0; v < 256; ++v) {
+    for (size_t b = 0; b < 8; ++b) {
+      shword__render[v][b] = (v >> b) & 1 ? 'x' : '-';
+    }
+  }
+  return 0;
+}
+
+shword *shword_create(arena *ar, const char *w, size_t len) {
+  size_t head = SHW__HEAD(shword__npat);
+  if (w == NULL || len > SIZE_MAX - head - 1) {
     return NULL;
   }
-  p->w = malloc(strlen(w) + 1);
-  if (p->w == NULL) {
-    free(p);
+  shword *p = arena_alloc(ar, head + len + 1, _Alignof(shword));
+  if (p == NULL) {
     return NULL;
   }
-  strcpy((char *) p->w, w);
-  p->pat = 0;
+  memcpy(SHW__WORD(p), w, len + 1);
+  memset(p->pat, 0, shword__npat * sizeof(SHW_PATTERN_TYPE));
   p->occ = 0;
   p->fcount = 0;
   return p;
 }
 
 int shword_increment(shword *shw, size_t idx) {
-  if (idx >= SHW_PATTERN_MAX) {
+  if (PAT_WORD(idx) >= shword__npat) {
     return 2;
   }
-  if (!FLAG_HAS(shw->pat, idx)) {
-    FLAG_SET(shw->pat, idx);
+  SHW_PATTERN_TYPE *p = &shw->pat[PAT_WORD(idx)];
+  if ((*p & PAT_BIT(idx)) == 0) {
+    *p |= PAT_BIT(idx);
     ++shw->fcount;
   }
   if (shw->occ == SHW_OCCURRENCES_MAX) {
@@ -49,15 +87,103 @@ int shword_increment(shword *shw, size_t idx) {
   return 0;
 }
 
+int shword_add(shword *shw, size_t idx, SHW_OCCURRENCES_TYPE n) {
+  if (PAT_WORD(idx) >= shword__npat) {
+    return 2;
+  }
+  SHW_PATTERN_TYPE *p = &shw->pat[PAT_WORD(idx)];
+  if ((*p & PAT_BIT(idx)) == 0) {
+    *p |= PAT_BIT(idx);
+    ++shw->fcount;
+  }
+  if (n >= SHW_OCCURRENCES_MAX - shw->occ) {
+    shw->occ = SHW_OCCURRENCES_MAX;
+    return 1;
+  }
+  shw->occ += n;
+  return 0;
+}
+
+int shword_increment_atomic(shword *shw, size_t idx) {
+  return shword_add_atomic(shw, idx, 1);
+}
+
+//  Les composants d'un mot partagé ne sont pas déclarés atomiques : les
+//    fonctions qui suivent y accèdent par les primitives __atomic de GCC, sans
+//    contrainte d'ordre, seul le résultat final important. Le bit du fichier
+//    est posé par un « ou » atomique dont l'ancienne valeur indique si le
+//    nombre de fichiers doit être augmenté. Le nombre d'occurrences est
+//    augmenté par une addition atomique : si elle a dépassé la limite, la
+//    limite est rétablie. Une addition concurrente qui aurait porté sur la
+//    valeur dépassée est ensuite écrasée, ce qui est sans effet puisque le
+//    compteur est alors saturé.
+
+int shword_add_atomic(shword *shw, size_t idx, SHW_OCCURRENCES_TYPE n) {
+  if (PAT_WORD(idx) >= shword__npat) {
+    return 2;
+  }
+  SHW_PATTERN_TYPE old = __atomic_fetch_or(&shw->pat[PAT_WORD(idx)],
+      PAT_BIT(idx), __ATOMIC_RELAXED);
+  if ((old & PAT_BIT(idx)) == 0) {
+    __atomic_fetch_add(&shw->fcount, 1, __ATOMIC_RELAXED);
+  }
+  SHW_OCCURRENCES_TYPE occ = __atomic_fetch_add(&shw->occ, n,
+      __ATOMIC_RELAXED);
+  if (occ >= SHW_OCCURRENCES_MAX - n) {
+    __atomic_store_n(&shw->occ, SHW_OCCURRENCES_MAX, __ATOMIC_RELAXED);
+    return 1;
+  }
+  return 0;
+}
+
+//  shword__merge : a le même comportement que shword_merge, seuls les npat
+//    premiers mots du motif d'occurrences de src étant pris en compte.
+static int shword__merge(shword *dest, const shword *src, size_t npat) {
+  size_t fcount = 0;
+  for (size_t k = 0; k < shword__npat; ++k) {
+    if (k < npat) {
+      dest->pat[k] |= src->pat[k];
+    }
+    fcount += (size_t) __builtin_popcountl(dest->pat[k]);
+  }
+  dest->fcount = fcount;
+  if (src->occ >= SHW_OCCURRENCES_MAX - dest->occ) {
+    dest->occ = SHW_OCCURRENCES_MAX;
+    return 1;
+  }
+  dest->occ += src->occ;
+  return 0;
+}
+
+int shword_merge(shword *dest, const shword *src) {
+  return shword__merge(dest, src, shword__npat);
+}
+
+int shword_merge_image(shword *dest, const shword *src, size_t inputcnt) {
+  return shword__merge(dest, src, SHW_PATTERN_WORDS(inputcnt));
+}
+
+size_t shword_sizeof(const shword *shw) {
+  return SHW__HEAD(shword__npat) + strlen(SHW__WORD(shw)) + 1;
+}
+
+size_t shword_headersize(size_t inputcnt) {
+  return SHW__HEAD(SHW_PATTERN_WORDS(inputcnt));
+}
+
+const char *shword_image_word(const shword *shw, size_t inputcnt) {
+  return (const char *) shw + shword_headersize(inputcnt);
+}
+
 SHW_OCCURRENCES_TYPE shword_occurrences(const shword *shw) {
   return shw->occ;
 }
 
 bool shword_occursin(const shword *shw, size_t idx) {
-  if (idx >= SHW_PATTERN_MAX) {
+  if (PAT_WORD(idx) >= shword__npat) {
     return false;
   }
-  return FLAG_HAS(shw->pat, idx);
+  return (shw->pat[PAT_WORD(idx)] & PAT_BIT(idx)) != 0;
 }
 
 size_t shword_filecount(const shword *shw) {
@@ -65,18 +191,27 @@ size_t shword_filecount(const shword *shw) {
 }
 
 const char *shword_word(const shword *shw) {
-  return shw->w;
+  return SHW__WORD(shw);
 }
 
-int shword_compare(const shword *shw1, const shword *shw2) {
-  size_t filecount = shword_filecount(shw2) - shword_filecount(shw1);
-  if (filecount) {
-    return (int) filecount;
+int shword_compare_numbers(const shword *shw1, const shword *shw2) {
+  if (shw1->fcount != shw2->fcount) {
+    return shw1->fcount > shw2->fcount ? -1 : 1;
   }
-  SHW_OCCURRENCES_TYPE occurrences = shword_occurrences(shw2)
-      - shword_occurrences(shw1);
-  if (occurrences) {
-    return (int) occurrences;
+  if (shw1->occ != shw2->occ) {
+    return shw1->occ > shw2->occ ? -1 : 1;
+  }
+  return 0;
+}
+
+int shword_compare_words(const shword *shw1, const shword *shw2) {
+  return strcmp(SHW__WORD(shw1), SHW__WORD(shw2));
+}
+
+int shword_compare(const shword *shw1, const shword *shw2) {
+  int c = shword_compare_numbers(shw1, shw2);
+  if (c != 0) {
+    return c;
   }
   return strcmp(shword_word(shw1), shword_word(shw2));
 }
@@ -85,16 +220,38 @@ int shword_display(const shword *shw, const struct print_race *pr) {
   if (pr == NULL) {
     return 1;
   }
-  char pat[pr->inputcnt];
-  for (size_t k = 0; k < pr->inputcnt; ++k) {
-    pat[k] = shword_occursin(shw, k) ? 'x' : '-';
+  //  Le motif est rendu huit fichiers à la fois, octet par octet, directement
+  //    dans le tampon de sortie, puis tronqué à pr->inputcnt caractères.
+  const char *w = SHW__WORD(shw);
+  size_t len = strlen(w);
+  size_t patlen = (pr->inputcnt + 7) / 8 * 8;
+  if (len > SIZE_MAX - patlen - OUTPUT_ULONG_LEN - 3) {
+    return EOF;
+  }
+  char *q = output_reserve(pr->out, patlen + OUTPUT_ULONG_LEN + len + 3);
+  if (q == NULL) {
+    return EOF;
   }
-  int r = SHW_OCCURRENCES_MAX == shword_occurrences(shw)
-      ? printf("%.*s\t" SHW_OCCURRENCES_MANY "\t%s\n", (int) pr->inputcnt, pat,
-          shword_word(shw))
-      : printf("%.*s\t%lu\t%s\n", (int) pr->inputcnt, pat,
-          shword_occurrences(shw), shword_word(shw));
-  return r < 0 ? EOF : 0;
+  char *start = q;
+  for (size_t j = 0; j < patlen / 8; ++j) {
+    SHW_PATTERN_TYPE v = shw->pat[j / sizeof v] >> 8 * (j % sizeof v);
+    memcpy(q, shword__render[v & 0xFF], 8);
+    q += 8;
+  }
+  q = start + pr->inputcnt;
+  *q++ = '\t';
+  if (shw->occ == SHW_OCCURRENCES_MAX) {
+    memcpy(q, SHW_OCCURRENCES_MANY, sizeof SHW_OCCURRENCES_MANY - 1);
+    q += sizeof SHW_OCCURRENCES_MANY - 1;
+  } else {
+    q += output_format_ulong(q, shw->occ);
+  }
+  *q++ = '\t';
+  memcpy(q, w, len);
+  q += len;
+  *q++ = '\n';
+  output_commit(pr->out, (size_t) (q - start));
+  return 0;
 }
 
 struct print_race *shword_predisplay(struct print_race *pr, const shword *shw) {
@@ -107,19 +264,10 @@ struct print_race *shword_predisplay(struct print_race *pr, const shword *shw) {
     return pr;
   }
   if (pr->samenumbers && pr->last != NULL) {
-    if (shword_filecount(shw) == shword_filecount(pr->last)
-        && shword_occurrences(shw) == shword_occurrences(pr->last)) {
+    if (shword_compare_numbers(shw, pr->last) == 0) {
       pr->last = shw;
       return pr;
     }
   }
   return NULL;
 }
-
-int shword_destroy(shword *shw) {
-  if (shw != NULL) {
-    free((char *) shw->w);
-    free(shw);
-  }
-  return 0;
-}
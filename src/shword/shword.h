@@ -7,13 +7,21 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
-
-//  SHW_PATTERN_TYPE, SHW_PATTERN_MAX : respectivement le type utilisé pour la
-//    gestion du motif d'occurrences d'un mot, ainsi que le nombre maximal de
-//    fichiers pouvant être pris en charge par ce motif. Le nombre de fichiers
-//    maximal découle directement du type utilisé.
-#define SHW_PATTERN_TYPE long
-#define SHW_PATTERN_MAX (8 * sizeof(SHW_PATTERN_TYPE))
+#include "arena.h"
+#include "output.h"
+
+//  SHW_PATTERN_TYPE, SHW_PATTERN_BITS : respectivement le type des mots qui
+//    forment le motif d'occurrences d'un mot, ainsi que le nombre de fichiers
+//    pris en charge par chacun d'eux. Le motif compte autant de mots que
+//    nécessaire au nombre de fichiers fourni à shword_setup ; il se réduit à un
+//    seul mot jusqu'à SHW_PATTERN_BITS fichiers.
+#define SHW_PATTERN_TYPE unsigned long
+#define SHW_PATTERN_BITS (CHAR_BIT * sizeof(SHW_PATTERN_TYPE))
+
+//  SHW_PATTERN_WORDS : nombre de mots de type SHW_PATTERN_TYPE du motif
+//    d'occurrences lorsque n fichiers sont pris en charge.
+#define SHW_PATTERN_WORDS(n) \
+  ((n) <= SHW_PATTERN_BITS ? 1 : ((n) - 1) / SHW_PATTERN_BITS + 1)
 
 //  SHW_OCCURRENCES_TYPE, SHW_OCCURRENCES_MAX, SHW_OCCURRENCES_MANY :
 //    respectivement le type utilisé pour la gestion du nombre maximal
@@ -26,7 +34,9 @@
 #define SHW_OCCURRENCES_MANY "many"
 
 //  struct shword, shword : structure regroupant les données d'un mot partagé.
-//    La création de la structure est confiée à la fonction shword_create.
+//    La création de la structure est confiée à la fonction shword_create. Un
+//    mot partagé et sa chaine occupent une seule zone allouée dans une
+//    réserve ; ils vivent aussi longtemps que celle-ci.
 typedef struct shword shword;
 
 //  struct print_race : structure regroupant les informations utiles à
@@ -36,26 +46,76 @@ struct print_race {
   const shword *last; //  dernier mot affiché par shword_display.
   size_t remaining;   //  nombre de mots restants à afficher.
   bool samenumbers;   //  afficher ou non les mots "égaux" au dernier de la lim.
+  output *out;        //  sortie tamponnée sur laquelle les mots sont affichés.
 };
 
-//  shword_create : crée une instance de mot partagé ciblant le mot dénoté par
-//    la chaine pointée par w. Renvoie NULL en cas de dépassement de capacité,
-//    ou si w vaut NULL. Renvoie sinon un pointeur vers l'objet associé au mot.
-extern shword *shword_create(const char *w);
+//  shword_setup : fixe à inputcnt le nombre de fichiers pris en charge par les
+//    motifs d'occurrences des mots partagés. Doit être appelée une fois, avant
+//    toute création de mot partagé. Renvoie une valeur non nulle si la taille
+//    du motif ne peut être représentée. Renvoie sinon zéro.
+extern int shword_setup(size_t inputcnt);
+
+//  shword_create : crée dans la réserve associée à ar une instance de mot
+//    partagé ciblant le mot dénoté par la chaine de longueur len pointée par w.
+//    Renvoie NULL en cas de dépassement de capacité, ou si w vaut NULL. Renvoie
+//    sinon un pointeur vers l'objet associé au mot.
+extern shword *shword_create(arena *ar, const char *w, size_t len);
 
 //  shword_increment : marque une occurrence du mot partagé associé à shw dans
 //    le fichier d'indice idx. Renvoie une valeur non nulle si le mot a atteint
-//    la limite d'occurrences SHW_OCCURRENCES_MAX ou si idx est supérieur ou
-//    égal à SHW_PATTERN_MAX. Renvoie sinon zéro.
+//    la limite d'occurrences SHW_OCCURRENCES_MAX ou si idx n'est pas pris en
+//    charge par le motif d'occurrences. Renvoie sinon zéro.
 extern int shword_increment(shword *shw, size_t idx);
 
+//  shword_add : marque n occurrences du mot partagé associé à shw dans le
+//    fichier d'indice idx. Renvoie les mêmes valeurs que shword_increment.
+extern int shword_add(shword *shw, size_t idx, SHW_OCCURRENCES_TYPE n);
+
+//  shword_increment_atomic, shword_add_atomic : ont respectivement le même
+//    comportement que shword_increment et shword_add, mais peuvent être
+//    appelées simultanément sur un même mot partagé par plusieurs fils
+//    d'exécution. Le mot partagé ne doit être lu qu'une fois tous ces appels
+//    terminés.
+extern int shword_increment_atomic(shword *shw, size_t idx);
+extern int shword_add_atomic(shword *shw, size_t idx,
+    SHW_OCCURRENCES_TYPE n);
+
+//  shword_merge : ajoute au mot partagé associé à dest les fichiers dans
+//    lesquels le mot partagé associé à src a été déclaré présent ainsi que ses
+//    occurrences. Renvoie une valeur non nulle si le nombre d'occurrences de
+//    dest a atteint la limite SHW_OCCURRENCES_MAX. Renvoie sinon zéro.
+extern int shword_merge(shword *dest, const shword *src);
+
+//  shword_sizeof : renvoie la taille en octets de l'objet associé au mot
+//    partagé shw, chaine comprise. Un mot partagé ne contient aucune adresse :
+//    une copie octet par octet de cet objet, placée à une adresse multiple de
+//    _Alignof(max_align_t), en est une image, que les fonctions de ce module
+//    qui ne modifient pas leur argument acceptent tant que le nombre de
+//    fichiers fixé par shword_setup reste le même.
+extern size_t shword_sizeof(const shword *shw);
+
+//  shword_headersize : renvoie la taille en octets d'une image de mot partagé
+//    créée alors que inputcnt fichiers étaient pris en charge, chaine non
+//    comprise : la chaine débute juste après.
+extern size_t shword_headersize(size_t inputcnt);
+
+//  shword_image_word : renvoie la chaine de l'image de mot partagé associée à
+//    shw, créée alors que inputcnt fichiers étaient pris en charge.
+extern const char *shword_image_word(const shword *shw, size_t inputcnt);
+
+//  shword_merge_image : a le même comportement que shword_merge, src étant
+//    l'image d'un mot partagé créée alors que inputcnt fichiers, au plus autant
+//    qu'actuellement, étaient pris en charge.
+extern int shword_merge_image(shword *dest, const shword *src,
+    size_t inputcnt);
+
 //  shword_occurrences : renvoie le nombre d'occurrences du mot partagé associé
 //    à shw.
 extern SHW_OCCURRENCES_TYPE shword_occurrences(const shword *shw);
 
 //  shword_occursin : renvoie true ou false selon si le mot partagé associé à
 //    shw a été déclaré présent dans le fichier d'indice idx. Renvoie false si
-//    idx est supérieur ou égal à SHW_PATTERN_MAX.
+//    idx n'est pas pris en charge par le motif d'occurrences.
 extern bool shword_occursin(const shword *shw, size_t idx);
 
 //  shword_filecount : renvoie le nombre de fichiers dans lequel le mot partagé
@@ -66,6 +126,16 @@ extern size_t shword_filecount(const shword *shw);
 //    associé à shw.
 extern const char *shword_word(const shword *shw);
 
+//  shword_compare_numbers : compare les mots partagés associés à shw1 et shw2
+//    selon les clés primaire et secondaire de shword_compare seulement.
+//    Renvoie une valeur négative, nulle ou positive selon que shw1 précède, a
+//    les mêmes nombres que ou suit shw2.
+extern int shword_compare_numbers(const shword *shw1, const shword *shw2);
+
+//  shword_compare_words : compare les chaines des mots partagés associés à
+//    shw1 et shw2 via strcmp. Renvoie la valeur renvoyée par strcmp.
+extern int shword_compare_words(const shword *shw1, const shword *shw2);
+
 //  shword_compare : compare les mots partagés associés à shw1 et shw2 selon le
 //    schéma suivant.
 //  * Clé primaire : nombre de fichiers dans lequel le mot partagé apparait.
@@ -75,11 +145,11 @@ extern const char *shword_word(const shword *shw);
 //    positive si shw1 est supérieur à shw2, ou zéro si shw1 et shw2 sont égaux.
 extern int shword_compare(const shword *shw1, const shword *shw2);
 
-//  shword_display : si pr ne vaut pas NULL, affiche sur la sortie standard le
-//    motif d'occurrences du mot partagé associé à shw, son nombre total d'occu
-//    -rrences ainsi que le mot avant un retour à la ligne. La fonction renvoie
-//    une valeur positive si pr vaut NULL, EOF en cas d'erreur d'écriture sur
-//    la sortie standard. Renvoie sinon zéro.
+//  shword_display : si pr ne vaut pas NULL, écrit sur la sortie tamponnée
+//    pr->out le motif d'occurrences du mot partagé associé à shw, son nombre
+//    total d'occurrences ainsi que le mot avant un retour à la ligne. La
+//    fonction renvoie une valeur positive si pr vaut NULL, EOF en cas d'erreur
+//    d'écriture ou de dépassement de capacité. Renvoie sinon zéro.
 extern int shword_display(const shword *shw, const struct print_race *pr);
 
 //  shword_predisplay : détermine si le mot partagé par shw doit être affiché ou
@@ -88,9 +158,4 @@ extern int shword_display(const shword *shw, const struct print_race *pr);
 extern struct print_race *shword_predisplay(struct print_race *pr,
     const shword *shw);
 
-//  shword_destroy : si shw ne vaut pas NULL, désalloue les composants du mot
-//    partagé associé à shw (sa chaine de caractères associée et la structure en
-//    elle-même). Renvoie zéro dans tous les cas.
-extern int shword_destroy(shword *shw);
-
 #endif
@@ -0,0 +1,354 @@
+//  Implantation du module snapshot - l'index est écrit par les fonctions de
+//    flot de la bibliothèque standard et relu par une projection privée en
+//    lecture seule. Les entiers sont enregistrés sur 64 bits dans l'ordre des
+//    octets de la machine.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "snapshot.h"
+
+//  SNAPSHOT__MAGIC, SNAPSHOT__VERSION : respectivement la signature qui
+//    débute tout fichier d'index et la version de son format. La version doit
+//    être incrémentée à chaque modification du format.
+#define SNAPSHOT__MAGIC "WSINDEX"
+#define SNAPSHOT__VERSION 1
+
+//  SNAPSHOT__BYTEORDER, SNAPSHOT__ABI : valeurs enregistrées dans l'en-tête
+//    permettant de vérifier que l'ordre des octets, ainsi que la taille des
+//    entiers qui composent une image de mot partagé, sont ceux de l'exécutable.
+#define SNAPSHOT__BYTEORDER 0x01020304
+#define SNAPSHOT__ABI                                                          \
+  (sizeof(size_t) | sizeof(SHW_OCCURRENCES_TYPE) << 8                          \
+    | sizeof(SHW_PATTERN_TYPE) << 16)
+
+//  SNAPSHOT__ALIGN : alignement des images de mots partagés dans le fichier.
+//    Une projection débutant à une adresse multiple de la taille d'une page,
+//    les images projetées sont alignées pour tout type.
+#define SNAPSHOT__ALIGN _Alignof(max_align_t)
+
+//  struct snapshot__header : en-tête d'un fichier d'index. Les composants
+//    words et inputs sont les positions de la table des positions des images
+//    et de la suite des noms des sources, size la taille du fichier. Le
+//    fichier se termine par un caractère nul : toute chaine qu'il contient est
+//    donc terminée à l'intérieur de la projection.
+struct snapshot__header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteorder;
+  uint64_t abi;
+  uint64_t inputcnt;
+  uint64_t charcnt;
+  uint64_t mode;
+  uint64_t wordcnt;
+  uint64_t sharedcnt;
+  uint64_t words;
+  uint64_t inputs;
+  uint64_t size;
+};
+
+//  SNAPSHOT__ROUND : plus petit multiple de SNAPSHOT__ALIGN supérieur ou égal à
+//    n.
+#define SNAPSHOT__ROUND(n) \
+  (((n) + SNAPSHOT__ALIGN - 1) / SNAPSHOT__ALIGN * SNAPSHOT__ALIGN)
+
+//  SNAPSHOT__FIRST : position de la première image de mot partagé.
+#define SNAPSHOT__FIRST SNAPSHOT__ROUND(sizeof(struct snapshot__header))
+
+//  struct snapshot__writer : structure regroupant les informations utiles à
+//    l'écriture d'un fichier d'index : le flot, la position courante, la table
+//    des positions des images déjà écrites et leur nombre, le nombre de mots
+//    présents dans au moins deux fichiers parmi elles.
+struct snapshot__writer {
+  FILE *f;
+  uint64_t pos;
+  uint64_t *offsets;
+  size_t count;
+  size_t sharedcnt;
+};
+
+//  snapshot__write : écrit les n octets pointés par p sur le flot de w puis,
+//    si pad vaut true, des octets nuls jusqu'à la prochaine position multiple
+//    de SNAPSHOT__ALIGN. Renvoie une valeur non nulle en cas d'erreur
+//    d'écriture. Renvoie sinon zéro.
+static int snapshot__write(struct snapshot__writer *w, const void *p, size_t n,
+    bool pad) {
+  static const char zeros[SNAPSHOT__ALIGN];
+  if (fwrite(p, 1, n, w->f) != n) {
+    return -1;
+  }
+  w->pos += n;
+  if (pad) {
+    size_t r = (size_t) (SNAPSHOT__ROUND(w->pos) - w->pos);
+    if (fwrite(zeros, 1, r, w->f) != r) {
+      return -1;
+    }
+    w->pos += r;
+  }
+  return 0;
+}
+
+//  snapshot__record : écrit sur le flot de w l'image du mot partagé associé à
+//    shw et mémorise sa position. Renvoie NULL en cas d'erreur d'écriture.
+//    Renvoie sinon w.
+static struct snapshot__writer *snapshot__record(struct snapshot__writer *w,
+    const shword *shw) {
+  w->offsets[w->count] = w->pos;
+  if (snapshot__write(w, shw, shword_sizeof(shw), true) != 0) {
+    return NULL;
+  }
+  w->count += 1;
+  if (shword_filecount(shw) >= 2) {
+    w->sharedcnt += 1;
+  }
+  return w;
+}
+
+//  snapshot__status : renvoie une valeur non nulle si w vaut NULL. Renvoie
+//    sinon zéro.
+static int snapshot__status(const shword *shw,
+    const struct snapshot__writer *w) {
+  (void) shw;
+  return w == NULL ? -1 : 0;
+}
+
+//  SNAPSHOT__TMPSUFFIX : suffixe du nom temporaire d'un fichier d'index en
+//    cours d'écriture.
+#define SNAPSHOT__TMPSUFFIX ".tmp"
+
+int snapshot_save(const char *path, holdall *ha, size_t inputcnt,
+    const char * const *input, size_t charcnt, int mode) {
+  size_t n = holdall_count(ha);
+  struct snapshot__writer w = {
+    .f = NULL,
+    .pos = 0,
+    .offsets = malloc((n > 0 ? n : 1) * sizeof *w.offsets),
+    .count = 0,
+    .sharedcnt = 0,
+  };
+  char *tmp = malloc(strlen(path) + sizeof SNAPSHOT__TMPSUFFIX);
+  int e = ENOMEM;
+  if (w.offsets == NULL || tmp == NULL) {
+    goto dispose;
+  }
+  strcpy(tmp, path);
+  strcat(tmp, SNAPSHOT__TMPSUFFIX);
+  w.f = fopen(tmp, "wb");
+  if (w.f == NULL) {
+    e = errno;
+    goto dispose;
+  }
+  errno = 0;
+  struct snapshot__header hd;
+  memset(&hd, 0, sizeof hd);
+  if (snapshot__write(&w, &hd, sizeof hd, true) != 0
+      || holdall_apply_context(ha, &w,
+          (void *(*)(void *, void *))snapshot__record,
+          (int (*)(void *, void *))snapshot__status) != 0) {
+    goto error;
+  }
+  hd.words = w.pos;
+  if (snapshot__write(&w, w.offsets, w.count * sizeof *w.offsets, false)
+      != 0) {
+    goto error;
+  }
+  hd.inputs = w.pos;
+  for (size_t k = 0; k < inputcnt; ++k) {
+    const char *name = input[k] == NULL ? "" : input[k];
+    if (snapshot__write(&w, name, strlen(name) + 1, false) != 0) {
+      goto error;
+    }
+  }
+  if (snapshot__write(&w, "", 1, false) != 0) {
+    goto error;
+  }
+  memcpy(hd.magic, SNAPSHOT__MAGIC, sizeof hd.magic);
+  hd.version = SNAPSHOT__VERSION;
+  hd.byteorder = SNAPSHOT__BYTEORDER;
+  hd.abi = SNAPSHOT__ABI;
+  hd.inputcnt = inputcnt;
+  hd.charcnt = charcnt;
+  hd.mode = (uint64_t) mode;
+  hd.wordcnt = w.count;
+  hd.sharedcnt = w.sharedcnt;
+  hd.size = w.pos;
+  if (fseek(w.f, 0, SEEK_SET) != 0
+      || fwrite(&hd, sizeof hd, 1, w.f) != 1) {
+    goto error;
+  }
+  FILE *f = w.f;
+  w.f = NULL;
+  if (fclose(f) != 0 || rename(tmp, path) != 0) {
+    goto error;
+  }
+  e = 0;
+  goto dispose;
+  error:
+  e = errno != 0 ? errno : EIO;
+  if (w.f != NULL) {
+    fclose(w.f);
+    w.f = NULL;
+  }
+  remove(tmp);
+  dispose:
+  free(w.offsets);
+  free(tmp);
+  return e;
+}
+
+//  struct snapshot, snapshot : le composant data pointe sur la projection du
+//    fichier, de size octets, hd sur son en-tête et words sur la table des
+//    positions des images. Le composant input pointe sur un tableau des noms
+//    des sources, ceux-ci étant lus dans la projection.
+struct snapshot {
+  const unsigned char *data;
+  size_t size;
+  const struct snapshot__header *hd;
+  const uint64_t *words;
+  const char **input;
+};
+
+//  snapshot__check : vérifie la cohérence de l'en-tête du fichier d'index
+//    projeté de size octets pointé par data. Renvoie une valeur non nulle en
+//    cas d'incohérence. Renvoie sinon zéro.
+static int snapshot__check(const unsigned char *data, size_t size) {
+  if (size < SNAPSHOT__FIRST + 1) {
+    return -1;
+  }
+  const struct snapshot__header *hd = (const struct snapshot__header *) data;
+  return memcmp(hd->magic, SNAPSHOT__MAGIC, sizeof hd->magic) != 0
+    || hd->version != SNAPSHOT__VERSION
+    || hd->byteorder != SNAPSHOT__BYTEORDER
+    || hd->abi != SNAPSHOT__ABI
+    || hd->size != size
+    || data[size - 1] != '\0'
+    || hd->words < SNAPSHOT__FIRST
+    || hd->words % SNAPSHOT__ALIGN != 0
+    || hd->inputs < hd->words
+    || hd->inputs >= size
+    || hd->wordcnt > (hd->inputs - hd->words) / sizeof(uint64_t)
+    || hd->sharedcnt > hd->wordcnt
+    || hd->inputcnt > size - hd->inputs;
+}
+
+int snapshot_open(snapshot **sptr, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return errno;
+  }
+  struct stat st;
+  int e = 0;
+  if (fstat(fd, &st) != 0) {
+    e = errno;
+    goto close;
+  }
+  if (!S_ISREG(st.st_mode) || (uintmax_t) st.st_size > SIZE_MAX) {
+    e = SNAPSHOT_BADFORMAT;
+    goto close;
+  }
+  size_t size = (size_t) st.st_size;
+  if (size < SNAPSHOT__FIRST + 1) {
+    e = SNAPSHOT_BADFORMAT;
+    goto close;
+  }
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    e = errno;
+    goto close;
+  }
+  if (snapshot__check(data, size) != 0) {
+    e = SNAPSHOT_BADFORMAT;
+    goto unmap;
+  }
+  snapshot *s = malloc(sizeof *s);
+  const struct snapshot__header *hd = data;
+  const char **input = malloc((hd->inputcnt > 0 ? hd->inputcnt : 1)
+      * sizeof *input);
+  if (s == NULL || input == NULL) {
+    free(s);
+    free(input);
+    e = ENOMEM;
+    goto unmap;
+  }
+  const char *p = (const char *) data + hd->inputs;
+  for (size_t k = 0; k < hd->inputcnt; ++k) {
+    if (p >= (const char *) data + size - 1) {
+      free(s);
+      free(input);
+      e = SNAPSHOT_BADFORMAT;
+      goto unmap;
+    }
+    input[k] = *p == '\0' ? NULL : p;
+    p += strlen(p) + 1;
+  }
+  posix_madvise(data, size, POSIX_MADV_WILLNEED);
+  s->data = data;
+  s->size = size;
+  s->hd = hd;
+  s->words = (const uint64_t *) ((const unsigned char *) data + hd->words);
+  s->input = input;
+  *sptr = s;
+  goto close;
+  unmap:
+  munmap(data, size);
+  close:
+  close(fd);
+  return e;
+}
+
+size_t snapshot_inputcnt(const snapshot *s) {
+  return s->hd->inputcnt;
+}
+
+const char *snapshot_input(const snapshot *s, size_t k) {
+  return s->input[k];
+}
+
+size_t snapshot_charcnt(const snapshot *s) {
+  return s->hd->charcnt;
+}
+
+int snapshot_mode(const snapshot *s) {
+  return (int) s->hd->mode;
+}
+
+size_t snapshot_wordcnt(const snapshot *s) {
+  return s->hd->wordcnt;
+}
+
+size_t snapshot_sharedcnt(const snapshot *s) {
+  return s->hd->sharedcnt;
+}
+
+const shword *snapshot_word(const snapshot *s, size_t k) {
+  if (k >= s->hd->wordcnt) {
+    return NULL;
+  }
+  //  L'image doit débuter entre l'en-tête et la table des positions, et sa
+  //    partie qui précède la chaine doit tenir avant cette table.
+  uint64_t o = s->words[k];
+  uint64_t head = shword_headersize(s->hd->inputcnt);
+  if (o < SNAPSHOT__FIRST || o % SNAPSHOT__ALIGN != 0 || o >= s->hd->words
+      || s->hd->words - o <= head) {
+    return NULL;
+  }
+  return (const shword *) (s->data + o);
+}
+
+void snapshot_dispose(snapshot **sptr) {
+  if (*sptr == NULL) {
+    return;
+  }
+  munmap((void *) (*sptr)->data, (*sptr)->size);
+  free((*sptr)->input);
+  free(*sptr);
+  *sptr = NULL;
+}
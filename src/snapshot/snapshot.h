@@ -0,0 +1,88 @@
+//  Interface du module snapshot - module implémentant l'enregistrement des mots
+//    partagés d'une session dans un fichier d'index, ainsi que leur relecture
+//    par projection de ce fichier en mémoire.
+
+#ifndef SNAPSHOT__H
+#define SNAPSHOT__H
+
+#include <stdlib.h>
+#include "holdall.h"
+#include "shword.h"
+
+//  Un fichier d'index est formé d'un en-tête, des images des mots partagés au
+//    sens de shword_sizeof, de la table des positions de ces images dans le
+//    fichier puis des noms des sources de fichiers. Il ne contient aucune
+//    adresse : toutes les références internes sont des positions relatives au
+//    début du fichier. L'en-tête comporte un numéro de version ainsi que de
+//    quoi vérifier que l'ordre des octets et la taille des entiers sont ceux
+//    de l'exécutable qui le relit.
+
+//  SNAPSHOT_BADFORMAT : code d'erreur renvoyé par snapshot_open si le fichier
+//    n'est pas un fichier d'index valide pour cet exécutable. Les autres codes
+//    d'erreur du module sont ceux de errno.
+#define SNAPSHOT_BADFORMAT -1
+
+//  snapshot_save : enregistre dans le fichier de nom path les mots partagés du
+//    fourretout associé à ha, qui doit être trié selon shword_compare, avec les
+//    noms des inputcnt sources du tableau pointé par input (NULL désignant
+//    l'entrée standard), le nombre de caractères significatifs charcnt et les
+//    drapeaux de lecture mode au sens de reader_open. Le fichier est écrit sous
+//    un nom temporaire puis renommé : un fichier de nom path existant n'est
+//    remplacé qu'en cas de succès. Renvoie zéro en cas de succès. Renvoie sinon
+//    le code d'erreur au sens de errno.
+extern int snapshot_save(const char *path, holdall *ha, size_t inputcnt,
+    const char * const *input, size_t charcnt, int mode);
+
+//  struct snapshot, snapshot : structure regroupant les informations
+//    permettant d'accéder au contenu d'un fichier d'index projeté en mémoire.
+//    La création de la structure de données associée est confiée à la
+//    fonction snapshot_open.
+typedef struct snapshot snapshot;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type snapshot * n'est pas l'adresse d'un objet préalablement obtenu par
+//    snapshot_open et non révoqué depuis par snapshot_dispose. Cette règle ne
+//    souffre que d'une seule exception : snapshot_dispose tolère que la
+//    déréférence de son argument ait pour valeur NULL.
+
+//  snapshot_open : projette en mémoire le fichier d'index de nom path et
+//    vérifie son en-tête. Renvoie SNAPSHOT_BADFORMAT si le fichier n'est pas un
+//    fichier d'index valide, ENOMEM en cas de dépassement de capacité, le code
+//    d'erreur au sens de errno si le fichier n'a pu être ouvert ou projeté.
+//    Renvoie sinon zéro après avoir affecté à *sptr un pointeur vers l'objet
+//    qui gère la structure de données.
+extern int snapshot_open(snapshot **sptr, const char *path);
+
+//  snapshot_inputcnt : renvoie le nombre de sources de fichiers enregistrées
+//    dans l'index associé à s.
+extern size_t snapshot_inputcnt(const snapshot *s);
+
+//  snapshot_input : renvoie le nom de la source de fichier d'indice k de
+//    l'index associé à s, NULL s'il s'agit de l'entrée standard.
+extern const char *snapshot_input(const snapshot *s, size_t k);
+
+//  snapshot_charcnt, snapshot_mode : renvoient respectivement le nombre de
+//    caractères significatifs et les drapeaux de lecture avec lesquels les
+//    sources de l'index associé à s ont été lues.
+extern size_t snapshot_charcnt(const snapshot *s);
+extern int snapshot_mode(const snapshot *s);
+
+//  snapshot_wordcnt, snapshot_sharedcnt : renvoient respectivement le nombre
+//    de mots partagés de l'index associé à s et le nombre de ceux d'entre eux
+//    qui sont présents dans au moins deux fichiers.
+extern size_t snapshot_wordcnt(const snapshot *s);
+extern size_t snapshot_sharedcnt(const snapshot *s);
+
+//  snapshot_word : renvoie l'image de mot partagé d'indice k, dans l'ordre de
+//    shword_compare, de l'index associé à s. Cette image a été créée alors que
+//    snapshot_inputcnt(s) fichiers étaient pris en charge et reste valide
+//    jusqu'à la révocation de s. Renvoie NULL si k est supérieur ou égal à
+//    snapshot_wordcnt(s) ou si la position de l'image est incohérente.
+extern const shword *snapshot_word(const snapshot *s, size_t k);
+
+//  snapshot_dispose : si *sptr ne vaut pas NULL, libère les ressources
+//    allouées à la structure de données associée à *sptr, projection comprise,
+//    puis affecte à *sptr la valeur NULL.
+extern void snapshot_dispose(snapshot **sptr);
+
+#endif
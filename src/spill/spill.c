@@ -0,0 +1,268 @@
+//  Implantation du module spill - chaque partition est un fichier temporaire
+//    formé d'une suite d'enregistrements : la taille, de type size_t, de
+//    l'image d'un mot partagé au sens de shword_sizeof, suivie de cette image.
+//    Un mot est affecté à une partition selon les bits de poids fort de sa
+//    valeur de hachage, les bits de poids faible restant ainsi répartis dans la
+//    table de hachage de chaque partition lors de son agrégation.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "spill.h"
+#include "strhash.h"
+
+//  SPILL__TMPDIR, SPILL__TMPNAME : respectivement le répertoire des fichiers
+//    temporaires à défaut de la variable d'environnement TMPDIR et le modèle,
+//    au sens de mkstemp, de leur nom.
+#define SPILL__TMPDIR "/tmp"
+#define SPILL__TMPNAME "/ws-spill.XXXXXX"
+
+//  struct spill, spill : le tableau files de partcnt flots contrôle les
+//    fichiers des partitions, NULL tant que spill_write n'a pas été appelée.
+//    Le composant used indique si un appel à spill_write a abouti.
+struct spill {
+  FILE **files;
+  size_t partcnt;
+  bool used;
+};
+
+spill *spill_open(size_t partcnt) {
+  spill *sp = malloc(sizeof *sp);
+  if (sp == NULL) {
+    return NULL;
+  }
+  sp->files = NULL;
+  sp->partcnt = partcnt;
+  sp->used = false;
+  return sp;
+}
+
+//  spill__tmpfile : crée un fichier temporaire aussitôt supprimé et l'ouvre en
+//    lecture et en écriture. Renvoie NULL en cas d'erreur, errno étant alors
+//    positionné. Renvoie sinon le flot qui contrôle le fichier.
+static FILE *spill__tmpfile(void) {
+  const char *dir = getenv("TMPDIR");
+  if (dir == NULL || *dir == '\0') {
+    dir = SPILL__TMPDIR;
+  }
+  char *name = malloc(strlen(dir) + sizeof SPILL__TMPNAME);
+  if (name == NULL) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  strcpy(name, dir);
+  strcat(name, SPILL__TMPNAME);
+  FILE *f = NULL;
+  int fd = mkstemp(name);
+  if (fd != -1) {
+    unlink(name);
+    f = fdopen(fd, "w+b");
+    if (f == NULL) {
+      int e = errno;
+      close(fd);
+      errno = e;
+    }
+  }
+  free(name);
+  return f;
+}
+
+//  spill__files : crée si besoin les fichiers des partitions de la structure
+//    associée à sp. Renvoie les mêmes valeurs que spill_write.
+static int spill__files(spill *sp) {
+  if (sp->files != NULL) {
+    return 0;
+  }
+  sp->files = calloc(sp->partcnt, sizeof *sp->files);
+  if (sp->files == NULL) {
+    return ENOMEM;
+  }
+  for (size_t p = 0; p < sp->partcnt; ++p) {
+    sp->files[p] = spill__tmpfile();
+    if (sp->files[p] == NULL) {
+      return errno;
+    }
+  }
+  return 0;
+}
+
+//  spill__put : écrit l'enregistrement du mot partagé associé à shw dans sa
+//    partition de la structure associée à sp. Renvoie une valeur non nulle en
+//    cas d'erreur d'écriture. Renvoie sinon zéro.
+static int spill__put(spill *sp, const shword *shw) {
+  const char *w = shword_word(shw);
+  size_t h = strhash_mem(w, strlen(w));
+  size_t p = h / (SIZE_MAX / sp->partcnt);
+  if (p >= sp->partcnt) {
+    p = sp->partcnt - 1;
+  }
+  size_t n = shword_sizeof(shw);
+  FILE *f = sp->files[p];
+  return fwrite(&n, sizeof n, 1, f) != 1 || fwrite(shw, 1, n, f) != n;
+}
+
+int spill_write(spill *sp, holdall *ha) {
+  int e = spill__files(sp);
+  if (e != 0) {
+    return e;
+  }
+  for (size_t k = 0; k < holdall_count(ha); ++k) {
+    errno = 0;
+    if (spill__put(sp, holdall_at(ha, k)) != 0) {
+      return errno != 0 ? errno : EIO;
+    }
+  }
+  sp->used = true;
+  return 0;
+}
+
+bool spill_used(const spill *sp) {
+  return sp->used;
+}
+
+size_t spill_partcnt(const spill *sp) {
+  return sp->partcnt;
+}
+
+int spill_read(spill *sp, size_t p, wordtable *wt, size_t inputcnt) {
+  FILE *f = sp->files == NULL ? NULL : sp->files[p];
+  if (f == NULL) {
+    return 0;
+  }
+  if (fflush(f) == EOF || fseek(f, 0, SEEK_SET) != 0) {
+    return errno;
+  }
+  //  Le tampon, obtenu par malloc, est convenablement aligné pour accueillir
+  //    une image de mot partagé.
+  int e = 0;
+  shword *img = NULL;
+  size_t capacity = 0;
+  size_t n;
+  while (fread(&n, sizeof n, 1, f) == 1) {
+    if (n > capacity) {
+      free(img);
+      img = malloc(n);
+      if (img == NULL) {
+        e = ENOMEM;
+        goto dispose;
+      }
+      capacity = n;
+    }
+    if (fread(img, 1, n, f) != n) {
+      e = ferror(f) ? EIO : EINVAL;
+      goto dispose;
+    }
+    if (wordtable_import(wt, img, inputcnt) != 0) {
+      e = ENOMEM;
+      goto dispose;
+    }
+  }
+  if (ferror(f)) {
+    e = EIO;
+  }
+  dispose:
+  free(img);
+  return e;
+}
+
+int spill_over(spill *sp, wordtable *wt, size_t limit) {
+  if (wordtable_footprint(wt) <= limit) {
+    return 0;
+  }
+  int e = spill_write(sp, wordtable_words(wt));
+  if (e != 0) {
+    return e;
+  }
+  return wordtable_clear(wt) != 0 ? ENOMEM : 0;
+}
+
+//  spill__keep_top : ajoute à la table associée à dest, au sens de
+//    wordtable_merge, les wordcnt premiers mots partagés du fourretout associé
+//    à ha selon shword_compare, suivis si samenumbers est vrai de ceux qui ont
+//    les mêmes nombres que le dernier d'entre eux, tous si wordcnt vaut zéro.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité. Renvoie
+//    sinon zéro.
+static int spill__keep_top(wordtable *dest, holdall *ha, size_t wordcnt,
+    bool samenumbers) {
+  int (*equiv)(const void *, const void *) = samenumbers
+      ? (int (*)(const void *, const void *))shword_compare_numbers : NULL;
+  if (holdall_sort_top(ha, wordcnt,
+      (int (*)(const void *, const void *))shword_compare, equiv) != 0) {
+    return -1;
+  }
+  size_t n = holdall_count(ha);
+  if (wordcnt > 0 && wordcnt < n) {
+    const shword *last = holdall_at(ha, wordcnt - 1);
+    size_t m = wordcnt;
+    while (m < n && equiv != NULL && equiv(holdall_at(ha, m), last) == 0) {
+      ++m;
+    }
+    n = m;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    const shword *shw = holdall_at(ha, k);
+    shword *d = wordtable_insert(dest, shword_word(shw));
+    if (d == NULL) {
+      return -1;
+    }
+    //  Inutile de vérifier la valeur de retour : d est vierge.
+    shword_merge(d, shw);
+  }
+  return 0;
+}
+
+int spill_gather(spill *sp, wordtable *wt, size_t inputcnt,
+    size_t minfiles, size_t wordcnt, bool samenumbers, size_t *distinctptr,
+    size_t *sharedptr) {
+  int e = spill_write(sp, wordtable_words(wt));
+  if (e != 0) {
+    return e;
+  }
+  if (wordtable_clear(wt) != 0) {
+    return ENOMEM;
+  }
+  //  Chaque chaine figurant dans une seule partition, l'agrégation d'une
+  //    partition fournit les nombres définitifs de ses mots. Si tous les mots
+  //    sont conservés, la taille de la table n'est plus bornée.
+  for (size_t p = 0; p < sp->partcnt; ++p) {
+    wordtable *part = wordtable_empty();
+    if (part == NULL) {
+      return ENOMEM;
+    }
+    e = spill_read(sp, p, part, inputcnt);
+    if (e == 0 && minfiles <= 1) {
+      e = wordtable_merge(wt, part) != 0 ? ENOMEM : 0;
+    } else if (e == 0) {
+      *distinctptr += holdall_count(wordtable_words(part));
+      if (wordtable_compact(part, minfiles) != 0) {
+        e = ENOMEM;
+      } else {
+        *sharedptr += holdall_count(wordtable_words(part));
+        e = spill__keep_top(wt, wordtable_words(part), wordcnt, samenumbers)
+            != 0 ? ENOMEM : 0;
+      }
+    }
+    wordtable_dispose(&part);
+    if (e != 0) {
+      return e;
+    }
+  }
+  return 0;
+}
+
+void spill_dispose(spill **spptr) {
+  if (*spptr == NULL) {
+    return;
+  }
+  for (size_t p = 0; (*spptr)->files != NULL && p < (*spptr)->partcnt; ++p) {
+    if ((*spptr)->files[p] != NULL) {
+      fclose((*spptr)->files[p]);
+    }
+  }
+  free((*spptr)->files);
+  free(*spptr);
+  *spptr = NULL;
+}
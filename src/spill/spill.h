@@ -0,0 +1,85 @@
+//  Interface du module spill - module implémentant le déversement sur disque
+//    de tables de mots partagés : les mots sont répartis selon leur valeur de
+//    hachage entre plusieurs partitions, chacune enregistrée dans son propre
+//    fichier temporaire, si bien qu'une chaine donnée figure toujours dans la
+//    même partition. Chaque partition peut ensuite être relue et agrégée
+//    indépendamment des autres.
+
+#ifndef SPILL__H
+#define SPILL__H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "holdall.h"
+#include "wordtable.h"
+
+//  Les fichiers temporaires sont créés dans le répertoire désigné par la
+//    variable d'environnement TMPDIR, ou à défaut dans /tmp. Ils sont
+//    supprimés dès leur création et disparaissent donc avec le processus.
+
+//  struct spill, spill : structure regroupant les fichiers temporaires des
+//    partitions. La création de la structure de données associée est confiée à
+//    la fonction spill_open.
+typedef struct spill spill;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type spill * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    spill_open et non révoqué depuis par spill_dispose. Cette règle ne souffre
+//    que d'une seule exception : spill_dispose tolère que la déréférence de son
+//    argument ait pour valeur NULL.
+
+//  spill_open : crée une structure de données de partcnt partitions vides. Les
+//    fichiers temporaires ne sont créés qu'au premier appel à spill_write.
+//    Renvoie NULL en cas de dépassement de capacité. Renvoie sinon un pointeur
+//    vers l'objet qui gère la structure de données.
+extern spill *spill_open(size_t partcnt);
+
+//  spill_write : ajoute à leurs partitions les mots partagés du fourretout
+//    associé à ha. Renvoie ENOMEM en cas de dépassement de capacité, un autre
+//    code d'erreur au sens de errno en cas d'erreur de création ou d'écriture
+//    d'un fichier temporaire. Renvoie sinon zéro.
+extern int spill_write(spill *sp, holdall *ha);
+
+//  spill_used : détermine si au moins un appel à spill_write a abouti pour la
+//    structure associée à sp.
+extern bool spill_used(const spill *sp);
+
+//  spill_partcnt : renvoie le nombre de partitions de la structure associée à
+//    sp.
+extern size_t spill_partcnt(const spill *sp);
+
+//  spill_read : importe au sens de wordtable_import, dans la table associée à
+//    wt, les mots partagés de la partition d'indice p, inférieur à
+//    spill_partcnt(sp), de la structure associée à sp, écrits alors que
+//    inputcnt fichiers étaient pris en charge. Renvoie ENOMEM en cas de
+//    dépassement de capacité, un autre code d'erreur au sens de errno en cas
+//    d'erreur de lecture. Renvoie sinon zéro.
+extern int spill_read(spill *sp, size_t p, wordtable *wt, size_t inputcnt);
+
+//  spill_over : si la taille de la table associée à wt, au sens de
+//    wordtable_footprint, dépasse limit, ajoute ses mots partagés à leurs
+//    partitions de la structure associée à sp puis vide la table. Renvoie les
+//    mêmes valeurs que spill_write, ENOMEM si la table n'a pu être vidée.
+extern int spill_over(spill *sp, wordtable *wt, size_t limit);
+
+//  spill_gather : ajoute les mots partagés restants de la table associée à wt
+//    à leurs partitions de la structure associée à sp, vide la table puis y
+//    agrège une à une les partitions, écrites alors que inputcnt fichiers
+//    étaient pris en charge. Si minfiles est supérieur à un, seuls sont
+//    conservés pour chaque partition ses mots présents dans au moins minfiles
+//    fichiers et, parmi eux, les wordcnt premiers selon shword_compare, suivis
+//    si samenumbers est vrai de ceux qui ont les mêmes nombres que le dernier
+//    d'entre eux, tous si wordcnt vaut zéro ; le nombre de mots distincts des
+//    partitions et celui de leurs mots conservés avant cette dernière
+//    sélection sont alors ajoutés respectivement à *distinctptr et à
+//    *sharedptr. Renvoie les mêmes valeurs que spill_read.
+extern int spill_gather(spill *sp, wordtable *wt, size_t inputcnt,
+    size_t minfiles, size_t wordcnt, bool samenumbers, size_t *distinctptr,
+    size_t *sharedptr);
+
+//  spill_dispose : si *spptr ne vaut pas NULL, libère les ressources allouées
+//    à la structure de données associée à *spptr, fichiers temporaires
+//    compris, puis affecte à *spptr la valeur NULL.
+extern void spill_dispose(spill **spptr);
+
+#endif
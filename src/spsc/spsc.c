@@ -0,0 +1,238 @@
+//  Implantation du module spsc - les compteurs head et tail croissent sans
+//    fin : head est le nombre de tampons publiés par le producteur, tail celui
+//    des tampons rendus par le consommateur, et le tampon de rang n de l'anneau
+//    est celui d'indice n % slotcnt. Chaque compteur n'est écrit que par un
+//    seul fil d'exécution, avec une sémantique de publication, et lu par
+//    l'autre avec une sémantique d'acquisition : le contenu d'un tampon est
+//    ainsi visible de son lecteur dès que le compteur qui le lui cède l'est.
+//    Les deux compteurs sont placés sur des lignes de cache distinctes afin que
+//    les écritures de l'un n'invalident pas les lectures de l'autre.
+//  Une sonnette est un compteur d'évènements : sonner incrémente son ticket
+//    puis, seulement si un fil d'exécution s'est déclaré endormi, réveille
+//    celui-ci sous son verrou. Le fil qui s'endort se déclare avant de relire
+//    le ticket sous le verrou ; l'ordre séquentiellement cohérent de ces
+//    opérations garantit qu'un ticket sonné entre l'obtention et l'attente
+//    n'est jamais manqué. Tant que personne ne dort, sonner ne coûte qu'une
+//    opération atomique, une fois par tampon publié ou rendu.
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "spsc.h"
+
+//  SPSC__LINE : taille supposée d'une ligne de cache.
+#define SPSC__LINE 64
+
+//  SPSC__ROUND : arrondit n au multiple de _Alignof(max_align_t) supérieur.
+#define SPSC__ROUND(n)                                                         \
+  (((n) + alignof(max_align_t) - 1) / alignof(max_align_t)                     \
+    * alignof(max_align_t))
+
+//  struct spsc_bell, spsc_bell : le ticket est incrémenté à chaque sonnerie ;
+//    sleepers est le nombre de fils d'exécution endormis ou sur le point de
+//    l'être, réveillés par la variable de condition cond sous le verrou lock.
+struct spsc_bell {
+  alignas(SPSC__LINE) atomic_uint ticket;
+  atomic_size_t sleepers;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+};
+
+//  struct spsc, spsc : les slotcnt tampons de slotsize octets sont contigus à
+//    partir de l'adresse slots, leur taille étant arrondie à stride. Le tableau
+//    lens mémorise le nombre d'octets publiés de chaque tampon. Le producteur
+//    s'endort sur la sonnette room, sonnée à chaque tampon rendu, le
+//    consommateur sur celle d'adresse bell, qui est own à défaut d'une
+//    sonnette commune.
+struct spsc {
+  alignas(SPSC__LINE) atomic_size_t head;
+  alignas(SPSC__LINE) atomic_size_t tail;
+  alignas(SPSC__LINE) atomic_bool closed;
+  size_t slotcnt;
+  size_t slotsize;
+  size_t stride;
+  size_t *lens;
+  char *slots;
+  spsc_bell *bell;
+  spsc_bell room;
+  spsc_bell own;
+};
+
+//  spsc__bell_init : initialise la sonnette associée à b. Renvoie une valeur
+//    non nulle en cas d'échec. Renvoie sinon zéro.
+static int spsc__bell_init(spsc_bell *b) {
+  atomic_init(&b->ticket, 0);
+  atomic_init(&b->sleepers, 0);
+  if (pthread_mutex_init(&b->lock, NULL) != 0) {
+    return -1;
+  }
+  if (pthread_cond_init(&b->cond, NULL) != 0) {
+    pthread_mutex_destroy(&b->lock);
+    return -1;
+  }
+  return 0;
+}
+
+//  spsc__bell_destroy : libère les ressources de la sonnette associée à b,
+//    initialisée par spsc__bell_init.
+static void spsc__bell_destroy(spsc_bell *b) {
+  pthread_cond_destroy(&b->cond);
+  pthread_mutex_destroy(&b->lock);
+}
+
+//  spsc__ring : sonne la sonnette associée à b.
+static void spsc__ring(spsc_bell *b) {
+  atomic_fetch_add(&b->ticket, 1);
+  if (atomic_load(&b->sleepers) > 0) {
+    pthread_mutex_lock(&b->lock);
+    pthread_cond_broadcast(&b->cond);
+    pthread_mutex_unlock(&b->lock);
+  }
+}
+
+spsc_bell *spsc_bell_empty(void) {
+  spsc_bell *b = aligned_alloc(alignof(spsc_bell), sizeof *b);
+  if (b == NULL) {
+    return NULL;
+  }
+  if (spsc__bell_init(b) != 0) {
+    free(b);
+    return NULL;
+  }
+  return b;
+}
+
+unsigned spsc_bell_ticket(spsc_bell *b) {
+  return atomic_load(&b->ticket);
+}
+
+void spsc_bell_wait(spsc_bell *b, unsigned t) {
+  atomic_fetch_add(&b->sleepers, 1);
+  pthread_mutex_lock(&b->lock);
+  while (atomic_load(&b->ticket) == t) {
+    pthread_cond_wait(&b->cond, &b->lock);
+  }
+  pthread_mutex_unlock(&b->lock);
+  atomic_fetch_sub(&b->sleepers, 1);
+}
+
+void spsc_bell_dispose(spsc_bell **bptr) {
+  if (*bptr == NULL) {
+    return;
+  }
+  spsc__bell_destroy(*bptr);
+  free(*bptr);
+  *bptr = NULL;
+}
+
+spsc *spsc_empty(size_t slotcnt, size_t slotsize, spsc_bell *bell) {
+  size_t stride = SPSC__ROUND(slotsize);
+  if (stride < slotsize || SIZE_MAX / slotcnt < stride) {
+    return NULL;
+  }
+  //  La taille d'une structure est un multiple de son alignement, comme
+  //    l'exige aligned_alloc.
+  spsc *q = aligned_alloc(alignof(spsc), sizeof *q);
+  if (q == NULL) {
+    return NULL;
+  }
+  q->lens = malloc(slotcnt * sizeof *q->lens);
+  q->slots = malloc(slotcnt * stride);
+  if (q->lens == NULL || q->slots == NULL) {
+    goto error;
+  }
+  if (spsc__bell_init(&q->room) != 0) {
+    goto error;
+  }
+  if (spsc__bell_init(&q->own) != 0) {
+    spsc__bell_destroy(&q->room);
+    goto error;
+  }
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+  atomic_init(&q->closed, false);
+  q->slotcnt = slotcnt;
+  q->slotsize = slotsize;
+  q->stride = stride;
+  q->bell = bell != NULL ? bell : &q->own;
+  return q;
+  error:
+  free(q->lens);
+  free(q->slots);
+  free(q);
+  return NULL;
+}
+
+size_t spsc_slotsize(const spsc *q) {
+  return q->slotsize;
+}
+
+void *spsc_back(spsc *q) {
+  size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  for (;;) {
+    unsigned t = spsc_bell_ticket(&q->room);
+    if (head - atomic_load_explicit(&q->tail, memory_order_acquire)
+        != q->slotcnt) {
+      break;
+    }
+    spsc_bell_wait(&q->room, t);
+  }
+  return q->slots + head % q->slotcnt * q->stride;
+}
+
+void spsc_push(spsc *q, size_t len) {
+  size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  q->lens[head % q->slotcnt] = len;
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+  spsc__ring(q->bell);
+}
+
+void spsc_close(spsc *q) {
+  atomic_store_explicit(&q->closed, true, memory_order_release);
+  spsc__ring(q->bell);
+}
+
+const void *spsc_front(spsc *q, size_t *lenptr, bool *doneptr) {
+  size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  //  La fermeture est lue avant le compteur des tampons publiés : une file
+  //    close et vide à ce moment-là le reste.
+  bool closed = atomic_load_explicit(&q->closed, memory_order_acquire);
+  if (tail == atomic_load_explicit(&q->head, memory_order_acquire)) {
+    *doneptr = closed;
+    return NULL;
+  }
+  *lenptr = q->lens[tail % q->slotcnt];
+  return q->slots + tail % q->slotcnt * q->stride;
+}
+
+const void *spsc_front_wait(spsc *q, size_t *lenptr) {
+  for (;;) {
+    unsigned t = spsc_bell_ticket(q->bell);
+    bool done;
+    const void *p = spsc_front(q, lenptr, &done);
+    if (p != NULL || done) {
+      return p;
+    }
+    spsc_bell_wait(q->bell, t);
+  }
+}
+
+void spsc_pop(spsc *q) {
+  size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+  spsc__ring(&q->room);
+}
+
+void spsc_dispose(spsc **qptr) {
+  if (*qptr == NULL) {
+    return;
+  }
+  spsc__bell_destroy(&(*qptr)->room);
+  spsc__bell_destroy(&(*qptr)->own);
+  free((*qptr)->lens);
+  free((*qptr)->slots);
+  free(*qptr);
+  *qptr = NULL;
+}
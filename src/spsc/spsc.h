@@ -0,0 +1,106 @@
+//  Interface du module spsc - module implémentant une file bornée à un seul
+//    producteur et un seul consommateur, sans verrou : la file est un anneau de
+//    tampons de taille fixe que le producteur remplit directement puis publie,
+//    et que le consommateur lit directement puis rend. Les deux fils
+//    d'exécution ne partagent que deux compteurs atomiques, ainsi que des
+//    sonnettes sur lesquelles chacun s'endort lorsque la file, pleine ou vide,
+//    ne lui permet pas de progresser.
+
+#ifndef SPSC__H
+#define SPSC__H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+//  struct spsc_bell, spsc_bell : sonnette d'un consommateur, qui peut être
+//    commune à plusieurs files dont il est le seul consommateur afin
+//    d'attendre que l'une d'elles progresse. La création de la structure de
+//    données associée est confiée à la fonction spsc_bell_empty.
+typedef struct spsc_bell spsc_bell;
+
+//  Les fonctions spsc_bell_* ont un comportement indéterminé si leur paramètre
+//    de type spsc_bell * n'est pas l'adresse d'un objet préalablement renvoyé
+//    par spsc_bell_empty et non révoqué depuis par spsc_bell_dispose, à
+//    l'exception de spsc_bell_dispose qui tolère que la déréférence de son
+//    argument ait pour valeur NULL. Une sonnette ne doit être révoquée
+//    qu'après les files qui la partagent.
+
+//  spsc_bell_empty : crée une sonnette. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers l'objet qui gère la structure de
+//    données.
+extern spsc_bell *spsc_bell_empty(void);
+
+//  spsc_bell_ticket : renvoie le ticket courant de la sonnette associée à b, à
+//    obtenir avant d'examiner les files qui la partagent.
+extern unsigned spsc_bell_ticket(spsc_bell *b);
+
+//  spsc_bell_wait : attend que la sonnette associée à b ait sonné depuis
+//    l'obtention du ticket t, c'est-à-dire qu'un tampon ait été publié dans
+//    l'une des files qui la partagent ou que l'une d'elles ait été close.
+//    Revient aussitôt si c'est déjà le cas.
+extern void spsc_bell_wait(spsc_bell *b, unsigned t);
+
+//  spsc_bell_dispose : si *bptr ne vaut pas NULL, libère les ressources
+//    allouées à la structure de données associée à *bptr puis affecte à *bptr
+//    la valeur NULL.
+extern void spsc_bell_dispose(spsc_bell **bptr);
+
+//  struct spsc, spsc : structure regroupant les tampons de la file et ses
+//    compteurs. La création de la structure de données associée est confiée à
+//    la fonction spsc_empty.
+typedef struct spsc spsc;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type spsc * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    spsc_empty et non révoqué depuis par spsc_dispose. Cette règle ne souffre
+//    que d'une seule exception : spsc_dispose tolère que la déréférence de son
+//    argument ait pour valeur NULL. Les fonctions spsc_back, spsc_push et
+//    spsc_close ne doivent être appelées que par un même fil d'exécution, le
+//    producteur, et les fonctions spsc_front et spsc_pop par un même fil
+//    d'exécution, le consommateur.
+
+//  spsc_empty : crée une file vide de slotcnt tampons de slotsize octets,
+//    slotcnt étant non nul, qui sonne la sonnette associée à bell à chaque
+//    publication et à sa fermeture, ou une sonnette qui lui est propre si bell
+//    vaut NULL. Renvoie NULL en cas de dépassement de capacité. Renvoie sinon
+//    un pointeur vers l'objet qui gère la structure de données.
+extern spsc *spsc_empty(size_t slotcnt, size_t slotsize, spsc_bell *bell);
+
+//  spsc_slotsize : renvoie la taille des tampons de la file associée à q.
+extern size_t spsc_slotsize(const spsc *q);
+
+//  spsc_back : renvoie l'adresse du tampon que le producteur peut remplir,
+//    convenablement aligné pour tout type d'objet, en s'endormant si la file
+//    associée à q est pleine jusqu'à ce que le consommateur en rende un.
+extern void *spsc_back(spsc *q);
+
+//  spsc_push : publie dans la file associée à q les len premiers octets du
+//    tampon renvoyé par le dernier appel à spsc_back.
+extern void spsc_push(spsc *q, size_t len);
+
+//  spsc_close : signale que le producteur ne publiera plus rien dans la file
+//    associée à q.
+extern void spsc_close(spsc *q);
+
+//  spsc_front : si la file associée à q contient un tampon publié, affecte à
+//    *lenptr le nombre d'octets publiés et renvoie l'adresse du plus ancien de
+//    ces tampons. Renvoie sinon NULL sans attendre ; *doneptr reçoit alors
+//    true si la file est de plus close, false sinon.
+extern const void *spsc_front(spsc *q, size_t *lenptr, bool *doneptr);
+
+//  spsc_front_wait : tient le rôle de spsc_front mais, si la file associée à q
+//    est vide sans être close, s'endort sur sa sonnette jusqu'à ce qu'un tampon
+//    y soit publié ou qu'elle soit close. Renvoie NULL si et seulement si la
+//    file est close et vide.
+extern const void *spsc_front_wait(spsc *q, size_t *lenptr);
+
+//  spsc_pop : rend au producteur le tampon renvoyé par le dernier appel à
+//    spsc_front sur la file associée à q.
+extern void spsc_pop(spsc *q);
+
+//  spsc_dispose : si *qptr ne vaut pas NULL, libère les ressources allouées à
+//    la structure de données associée à *qptr puis affecte à *qptr la valeur
+//    NULL.
+extern void spsc_dispose(spsc **qptr);
+
+#endif
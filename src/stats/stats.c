@@ -0,0 +1,255 @@
+//  Implantation du module stats - les compteurs matériels sont obtenus de
+//    perf_event_open sous Linux. Ils sont ouverts une fois pour toutes avec
+//    héritage, afin de compter aussi les fils d'exécution lancés ensuite, et ne
+//    sont jamais remis à zéro : la valeur d'une phase est la différence des
+//    lectures faites à son début et à sa fin. Ailleurs, ou si le noyau les
+//    refuse, seules les durées sont mesurées.
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "stats.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+//  STATS__PREFIX : début de chaque ligne du rapport, suivi du nom du programme.
+#define STATS__PREFIX "%s: stats: "
+
+//  STATS__EVENTCNT : nombre de compteurs matériels.
+#define STATS__EVENTCNT 4
+
+//  stats__evname : noms d'affichage des compteurs matériels.
+static const char *const stats__evname[STATS__EVENTCNT] = {
+  "cycles", "instructions", "llc-misses", "branch-misses",
+};
+
+//  stats__phname : noms d'affichage des phases.
+static const char *const stats__phname[STATS_PHASECNT] = {
+  "ingest", "sort", "display",
+};
+
+//  struct stats__phase : mesures d'une phase. Les composants wall, cpu et
+//    events valent leurs lectures au début de la phase jusqu'à sa fin, puis la
+//    différence avec celles faites à la fin.
+struct stats__phase {
+  bool begun;
+  bool done;
+  double wall;
+  double cpu;
+  uint64_t events[STATS__EVENTCNT];
+};
+
+//  struct stats__input : mesures d'une entrée.
+struct stats__input {
+  bool seen;
+  size_t bytes;
+  size_t words;
+};
+
+//  stats__inputs : tableau des mesures des stats__inputcnt entrées, NULL tant
+//    que la collecte n'est pas active.
+static struct stats__input *stats__inputs = NULL;
+static size_t stats__inputcnt = 0;
+
+static struct stats__phase stats__phases[STATS_PHASECNT];
+static size_t stats__distinct = 0;
+static size_t stats__shared = 0;
+static size_t stats__estimate = 0;
+
+//  stats__fds : descripteurs des compteurs matériels ; stats__fderr vaut zéro
+//    s'ils ont tous été ouverts, le code d'erreur au sens de errno sinon.
+static int stats__fds[STATS__EVENTCNT] = {
+  -1, -1, -1, -1,
+};
+static int stats__fderr = ENOSYS;
+
+//  stats__clock : renvoie la valeur en secondes de l'horloge id.
+static double stats__clock(clockid_t id) {
+  struct timespec ts;
+  if (clock_gettime(id, &ts) != 0) {
+    return 0.0;
+  }
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+#ifdef __linux__
+
+//  stats__open : ouvre le compteur matériel de type type et de configuration
+//    config pour le processus et les fils d'exécution qu'il lancera. Renvoie
+//    son descripteur, ou -1 en cas d'échec.
+static int stats__open(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = type;
+  attr.config = config;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0UL);
+}
+
+//  stats__open_all : ouvre les compteurs matériels et renvoie zéro, ou le
+//    code d'erreur au sens de errno du premier échec.
+static int stats__open_all(void) {
+  static const uint64_t configs[STATS__EVENTCNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+  };
+  for (size_t k = 0; k < STATS__EVENTCNT; ++k) {
+    stats__fds[k] = stats__open(PERF_TYPE_HARDWARE, configs[k]);
+    if (stats__fds[k] < 0) {
+      return errno;
+    }
+  }
+  return 0;
+}
+
+#else
+
+static int stats__open_all(void) {
+  return ENOSYS;
+}
+
+#endif
+
+//  stats__read : affecte aux STATS__EVENTCNT éléments du tableau pointé par
+//    events les valeurs des compteurs matériels. Renvoie une valeur non nulle
+//    en cas d'échec. Renvoie sinon zéro.
+static int stats__read(uint64_t *events) {
+  for (size_t k = 0; k < STATS__EVENTCNT; ++k) {
+    if (read(stats__fds[k], &events[k], sizeof events[k])
+        != (ssize_t) sizeof events[k]) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//  stats__close : ferme les compteurs matériels ouverts.
+static void stats__close(void) {
+  for (size_t k = 0; k < STATS__EVENTCNT; ++k) {
+    if (stats__fds[k] >= 0) {
+      close(stats__fds[k]);
+      stats__fds[k] = -1;
+    }
+  }
+}
+
+int stats_setup(size_t inputcnt) {
+  stats__inputs = calloc(inputcnt > 0 ? inputcnt : 1, sizeof *stats__inputs);
+  if (stats__inputs == NULL) {
+    return -1;
+  }
+  stats__inputcnt = inputcnt;
+  stats__fderr = stats__open_all();
+  if (stats__fderr != 0) {
+    stats__close();
+  }
+  return 0;
+}
+
+void stats_begin(int phase) {
+  if (stats__inputs == NULL) {
+    return;
+  }
+  struct stats__phase *ph = &stats__phases[phase];
+  ph->begun = true;
+  if (stats__fderr == 0 && stats__read(ph->events) != 0) {
+    stats__fderr = errno;
+  }
+  ph->cpu = stats__clock(CLOCK_PROCESS_CPUTIME_ID);
+  ph->wall = stats__clock(CLOCK_MONOTONIC);
+}
+
+void stats_end(int phase) {
+  if (stats__inputs == NULL || !stats__phases[phase].begun) {
+    return;
+  }
+  struct stats__phase *ph = &stats__phases[phase];
+  ph->wall = stats__clock(CLOCK_MONOTONIC) - ph->wall;
+  ph->cpu = stats__clock(CLOCK_PROCESS_CPUTIME_ID) - ph->cpu;
+  uint64_t events[STATS__EVENTCNT] = {
+    0,
+  };
+  if (stats__fderr == 0 && stats__read(events) != 0) {
+    stats__fderr = errno;
+  }
+  for (size_t k = 0; k < STATS__EVENTCNT; ++k) {
+    ph->events[k] = events[k] - ph->events[k];
+  }
+  ph->done = true;
+}
+
+void stats_input(size_t k, size_t bytes, size_t words) {
+  if (stats__inputs == NULL) {
+    return;
+  }
+  stats__inputs[k].seen = true;
+  stats__inputs[k].bytes += bytes;
+  stats__inputs[k].words += words;
+}
+
+void stats_words(size_t distinct, size_t shared) {
+  stats__distinct += distinct;
+  stats__shared += shared;
+}
+
+void stats_vocabulary(size_t estimate) {
+  stats__estimate = estimate;
+}
+
+void stats_report(FILE *f, const char *prname, const char * const *names,
+    size_t resizes) {
+  if (stats__inputs == NULL) {
+    return;
+  }
+  for (int p = 0; p < STATS_PHASECNT; ++p) {
+    const struct stats__phase *ph = &stats__phases[p];
+    if (!ph->done) {
+      continue;
+    }
+    fprintf(f, STATS__PREFIX "%s: %.3f s wall, %.3f s cpu", prname,
+        stats__phname[p], ph->wall, ph->cpu);
+    for (size_t k = 0; stats__fderr == 0 && k < STATS__EVENTCNT; ++k) {
+      fprintf(f, ", %llu %s", (unsigned long long) ph->events[k],
+          stats__evname[k]);
+    }
+    fputc('\n', f);
+  }
+  if (stats__fderr != 0) {
+    fprintf(f, STATS__PREFIX "hardware counters unavailable: %s\n", prname,
+        strerror(stats__fderr));
+  }
+  for (size_t k = 0; k < stats__inputcnt; ++k) {
+    const struct stats__input *in = &stats__inputs[k];
+    if (in->seen) {
+      fprintf(f, STATS__PREFIX "'%s': %zu bytes, %zu words\n", prname,
+          names[k] == NULL ? "stdin" : names[k], in->bytes, in->words);
+    }
+  }
+  fprintf(f, STATS__PREFIX "words: %zu distinct, %zu shared\n", prname,
+      stats__distinct, stats__shared);
+  if (stats__estimate > 0) {
+    fprintf(f, STATS__PREFIX "words: %zu distinct estimated\n", prname,
+        stats__estimate);
+  }
+  fprintf(f, STATS__PREFIX "hash table resizes: %zu\n", prname, resizes);
+}
+
+void stats_dispose(void) {
+  stats__close();
+  free(stats__inputs);
+  stats__inputs = NULL;
+  stats__inputcnt = 0;
+}
@@ -0,0 +1,61 @@
+//  Interface du module stats - module de collecte des statistiques d'une
+//    exécution : durées et compteurs matériels de chacune de ses phases,
+//    octets et mots lus dans chaque entrée, nombres de mots distincts et
+//    partagés. La collecte n'a lieu qu'une fois activée par stats_setup : les
+//    autres fonctions du module sont sinon sans effet.
+
+#ifndef STATS__H
+#define STATS__H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//  STATS_INGEST, STATS_SORT, STATS_DISPLAY : phases mesurées, respectivement
+//    la lecture des entrées jusqu'à l'obtention des mots partagés, leur tri et
+//    leur affichage. STATS_PHASECNT est le nombre de phases.
+enum STATS_PHASES {
+  STATS_INGEST,
+  STATS_SORT,
+  STATS_DISPLAY,
+  STATS_PHASECNT,
+};
+
+//  stats_setup : active la collecte pour inputcnt entrées et, si le noyau le
+//    permet, ouvre les compteurs matériels du processus. Doit être appelée au
+//    plus une fois, avant le lancement de tout fil d'exécution. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+extern int stats_setup(size_t inputcnt);
+
+//  stats_begin, stats_end : marquent respectivement le début et la fin de la
+//    phase phase. Ne doivent être appelées que par le fil principal.
+extern void stats_begin(int phase);
+extern void stats_end(int phase);
+
+//  stats_input : ajoute bytes octets et words mots lus aux statistiques de
+//    l'entrée d'indice k. Peut être appelée simultanément par plusieurs fils
+//    d'exécution pour des entrées distinctes.
+extern void stats_input(size_t k, size_t bytes, size_t words);
+
+//  stats_words : ajoute distinct mots distincts et shared mots présents dans
+//    au moins deux fichiers aux statistiques. Ne doit être appelée que par le
+//    fil principal.
+extern void stats_words(size_t distinct, size_t shared);
+
+//  stats_vocabulary : mémorise l'estimation estimate du nombre de mots
+//    distincts faite avant la lecture des entrées. Ne doit être appelée que par
+//    le fil principal.
+extern void stats_vocabulary(size_t estimate);
+
+//  stats_report : si la collecte est active, écrit sur le flot contrôlé par f
+//    le rapport des statistiques, chaque ligne étant précédée du nom du
+//    programme prname. Le nom de l'entrée d'indice k est names[k], NULL
+//    désignant l'entrée standard. Le rapport se termine par le nombre resizes
+//    d'agrandissements de tables de hachage.
+extern void stats_report(FILE *f, const char *prname,
+    const char * const *names, size_t resizes);
+
+//  stats_dispose : libère les ressources allouées par stats_setup et
+//    désactive la collecte.
+extern void stats_dispose(void);
+
+#endif
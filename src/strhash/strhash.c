@@ -0,0 +1,50 @@
+//  Implantation du module strhash - la graine est lue sur /dev/urandom ; à
+//    défaut, elle est dérivée de l'heure, de l'horloge processeur et d'une
+//    adresse de la pile.
+
+#include <stdio.h>
+#include <time.h>
+#include "strhash.h"
+
+uint64_t strhash__secret[4];
+
+//  strhash__splitmix : fait avancer l'état pointé par s du générateur
+//    splitmix64 et renvoie la valeur produite.
+static uint64_t strhash__splitmix(uint64_t *s) {
+  uint64_t z = (*s += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+void strhash_setup(void) {
+  uint64_t seed = 0;
+  FILE *f = fopen("/dev/urandom", "rb");
+  if (f == NULL || fread(&seed, sizeof seed, 1, f) != 1) {
+    seed = (uint64_t) time(NULL) ^ ((uint64_t) clock() << 32)
+        ^ (uint64_t) (uintptr_t) &seed;
+  }
+  if (f != NULL) {
+    fclose(f);
+  }
+  for (size_t k = 0; k < sizeof strhash__secret / sizeof *strhash__secret;
+      ++k) {
+    //  Chaque constante est impaire et a ses bits hauts et bas non nuls, ce
+    //    qui évite les produits dégénérés dans strhash_mix.
+    strhash__secret[k] = strhash__splitmix(&seed) | 0x8000000000000001;
+  }
+}
+
+size_t strhash(const char *s) {
+  return strhash_mem(s, strlen(s));
+}
+
+size_t strhash_mem(const void *p, size_t n) {
+  const unsigned char *b = p;
+  uint64_t h = strhash_init();
+  size_t k = 0;
+  for (; k + 8 <= n; k += 8) {
+    h = strhash_step(h, strhash_load(b + k, 8));
+  }
+  return strhash_final(h, strhash_load(b + k, n - k), n);
+}
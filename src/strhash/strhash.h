@@ -0,0 +1,94 @@
+//  Interface du module strhash - module implémentant une fonction de hachage
+//    de chaines de caractères traitant les octets huit par huit, paramétrée
+//    par une graine tirée aléatoirement au démarrage de chaque processus.
+
+#ifndef STRHASH__H
+#define STRHASH__H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  strhash_setup : tire la graine du processus et en dérive les constantes de
+//    hachage. Doit être appelée une fois, au démarrage du programme, avant
+//    tout autre appel aux fonctions du module.
+extern void strhash_setup(void);
+
+//  strhash : calcule la somme de hachage de la chaine de caractères pointée par
+//    s. La valeur est égale à strhash_mem(s, strlen(s)).
+extern size_t strhash(const char *s);
+
+//  strhash_mem : calcule la somme de hachage des n octets pointés par p.
+extern size_t strhash_mem(const void *p, size_t n);
+
+//  Les fonctions qui suivent permettent de calculer la somme de hachage de
+//    manière incrémentale, par exemple au fur et à mesure de la lecture d'un
+//    mot : pour des octets b[0], ..., b[n - 1], la valeur
+//      strhash_final(strhash_step(...strhash_step(strhash_init(), c[0])...,
+//          c[q - 1]), t, n)
+//    où q = n / 8, c[i] est le mot de 64 bits formé des octets b[8i], ...,
+//    b[8i + 7] selon strhash_load et t celui formé des n % 8 derniers octets
+//    complétés par des zéros, est égale à strhash_mem(b, n).
+
+//  strhash__secret : constantes dérivées de la graine par strhash_setup. Ne
+//    doivent pas être utilisées en dehors du module.
+extern uint64_t strhash__secret[4];
+
+//  strhash_load : renvoie le mot de 64 bits formé, dans l'ordre petit-boutiste,
+//    des n premiers octets pointés par p, n étant au plus 8, complétés par des
+//    zéros.
+static inline uint64_t strhash_load(const void *p, size_t n) {
+  const unsigned char *b = p;
+  uint64_t c = 0;
+  if (n == 8) {
+    memcpy(&c, b, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    c = __builtin_bswap64(c);
+#endif
+    return c;
+  }
+  for (size_t k = n; k > 0; --k) {
+    c = c << 8 | b[k - 1];
+  }
+  return c;
+}
+
+//  strhash_mix : renvoie le ou exclusif des moitiés basse et haute du produit
+//    sur 128 bits de a et b.
+static inline uint64_t strhash_mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 strhash_u128;
+  strhash_u128 r = (strhash_u128) a * b;
+  return (uint64_t) r ^ (uint64_t) (r >> 64);
+#else
+  uint64_t al = a & 0xFFFFFFFF;
+  uint64_t ah = a >> 32;
+  uint64_t bl = b & 0xFFFFFFFF;
+  uint64_t bh = b >> 32;
+  uint64_t ll = al * bl;
+  uint64_t hl = ah * bl;
+  uint64_t x = (ll >> 32) + (hl & 0xFFFFFFFF) + al * bh;
+  uint64_t hi = ah * bh + (hl >> 32) + (x >> 32);
+  return ((x << 32) | (ll & 0xFFFFFFFF)) ^ hi;
+#endif
+}
+
+//  strhash_init : renvoie l'état initial d'un calcul incrémental.
+static inline uint64_t strhash_init(void) {
+  return strhash__secret[0];
+}
+
+//  strhash_step : renvoie l'état obtenu en ajoutant le mot de 64 bits c à
+//    l'état h.
+static inline uint64_t strhash_step(uint64_t h, uint64_t c) {
+  return strhash_mix(c ^ strhash__secret[1], h ^ strhash__secret[2]);
+}
+
+//  strhash_final : renvoie la somme de hachage obtenue en ajoutant à l'état h
+//    le mot de 64 bits t formé des derniers octets et la longueur totale n.
+static inline size_t strhash_final(uint64_t h, uint64_t t, size_t n) {
+  h = strhash_mix(t ^ strhash__secret[3], h ^ (uint64_t) n);
+  return (size_t) strhash_mix(h ^ strhash__secret[1], strhash__secret[0]);
+}
+
+#endif
@@ -0,0 +1,286 @@
+//  cachetest - test du module cache dans un répertoire temporaire : une entrée
+//    enregistrée pour une source doit être retrouvée à la réouverture, avec
+//    les mêmes mots, nombres d'occurrences et mots tronqués, ces derniers dans
+//    l'ordre. Elle ne doit pas l'être pour un autre nombre de caractères
+//    significatifs, d'autres drapeaux de lecture, une source modifiée ou une
+//    entrée tronquée ou altérée. L'enregistrement dans un répertoire
+//    inexistant doit échouer.
+
+#define _XOPEN_SOURCE 700
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "arena.h"
+#include "cache.h"
+#include "holdall.h"
+#include "shword.h"
+
+//  WORD_CNT : nombre de mots de l'entrée enregistrée.
+#define WORD_CNT 1000
+
+//  CHARCNT, MODE : nombre de caractères significatifs et drapeaux de lecture
+//    de l'entrée enregistrée.
+#define CHARCNT 63
+#define MODE 0
+
+//  TRUNCS : mots tronqués de l'entrée enregistrée.
+static const char *truncs[] = {
+  "truncated", "again", "truncated",
+};
+
+#define TRUNC_CNT (sizeof truncs / sizeof *truncs)
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec what.
+static void fail(const char *what) {
+  fprintf(stderr, "cachetest: %s.\n", what);
+  ++failures;
+}
+
+//  lookup : ouvre dans le répertoire dir l'entrée de la source de nom path
+//    pour charcnt et mode, affecte à *cptr l'objet obtenu et renvoie le
+//    résultat de cache_hit. Renvoie false, *cptr valant NULL, en cas d'échec.
+static bool lookup(cache **cptr, const char *dir, const char *path,
+    size_t charcnt, int mode) {
+  *cptr = NULL;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  int e = cache_open(cptr, dir, path, fd, charcnt, mode);
+  close(fd);
+  return e == 0 && cache_hit(*cptr);
+}
+
+//  probe : teste si une entrée valide existe dans le répertoire dir pour la
+//    source de nom path, charcnt et mode.
+static bool probe(const char *dir, const char *path, size_t charcnt,
+    int mode) {
+  cache *c;
+  bool hit = lookup(&c, dir, path, charcnt, mode);
+  cache_dispose(&c);
+  return hit;
+}
+
+//  store : enregistre dans le répertoire dir l'entrée de la source de nom
+//    path formée des mots partagés du fourretout associé à ha et des mots
+//    tronqués de truncs. Renvoie zéro en cas de succès, une valeur non nulle
+//    sinon.
+static int store(const char *dir, const char *path, holdall *ha) {
+  cache *c;
+  if (lookup(&c, dir, path, CHARCNT, MODE)) {
+    fail("entry found before being stored");
+  }
+  int e = c == NULL ? -1 : 0;
+  for (size_t k = 0; e == 0 && k < TRUNC_CNT; ++k) {
+    e = cache_trunc(c, truncs[k]);
+  }
+  if (e == 0) {
+    e = cache_store(c, ha);
+  }
+  cache_dispose(&c);
+  return e;
+}
+
+//  check_entry : vérifie que l'entrée de la source de nom path du répertoire
+//    dir contient les WORD_CNT mots "w<k>" de k + 1 occurrences et les mots
+//    tronqués de truncs.
+static void check_entry(const char *dir, const char *path) {
+  cache *c;
+  if (!lookup(&c, dir, path, CHARCNT, MODE)) {
+    fail("stored entry not found");
+    cache_dispose(&c);
+    return;
+  }
+  bool seen[WORD_CNT] = { false };
+  size_t cnt = 0;
+  const char *w;
+  size_t len;
+  SHW_OCCURRENCES_TYPE occ;
+  while (cache_next_word(c, &w, &len, &occ)) {
+    char *end;
+    unsigned long k = strtoul(w + 1, &end, 10);
+    if (w[0] != 'w' || *end != '\0' || k >= WORD_CNT || seen[k]
+        || occ != k + 1 || len != strlen(w)) {
+      fail("unexpected word in entry");
+      break;
+    }
+    seen[k] = true;
+    ++cnt;
+  }
+  if (cnt != WORD_CNT) {
+    fail("words missing from entry");
+  }
+  for (size_t k = 0; k < TRUNC_CNT; ++k) {
+    if (!cache_next_trunc(c, &w) || strcmp(w, truncs[k]) != 0) {
+      fail("wrong truncated word");
+    }
+  }
+  if (cache_next_trunc(c, &w)) {
+    fail("extra truncated word");
+  }
+  cache_dispose(&c);
+}
+
+//  entry_name : affecte au tampon de size octets pointé par buf le nom de
+//    l'unique entrée du répertoire dir. Renvoie une valeur non nulle si elle
+//    n'a pu être trouvée. Renvoie sinon zéro.
+static int entry_name(const char *dir, char *buf, size_t size) {
+  DIR *d = opendir(dir);
+  if (d == NULL) {
+    return -1;
+  }
+  int e = -1;
+  struct dirent *de;
+  while ((de = readdir(d)) != NULL) {
+    if (de->d_name[0] != '.') {
+      e = snprintf(buf, size, "%s/%s", dir, de->d_name) < (int) size ? 0 : -1;
+    }
+  }
+  closedir(d);
+  return e;
+}
+
+//  write_file : remplace le contenu du fichier de nom path par les n octets
+//    pointés par p. Renvoie une valeur non nulle en cas d'échec. Renvoie sinon
+//    zéro.
+static int write_file(const char *path, const void *p, size_t n) {
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    return -1;
+  }
+  size_t w = fwrite(p, 1, n, f);
+  return fclose(f) != 0 || w != n ? -1 : 0;
+}
+
+//  read_file : renvoie le contenu alloué du fichier de nom path, dont la
+//    taille est affectée à *nptr. Renvoie NULL en cas d'échec.
+static unsigned char *read_file(const char *path, size_t *nptr) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return NULL;
+  }
+  unsigned char *p = NULL;
+  long n;
+  if (fseek(f, 0, SEEK_END) == 0 && (n = ftell(f)) > 0
+      && fseek(f, 0, SEEK_SET) == 0 && (p = malloc((size_t) n)) != NULL
+      && fread(p, 1, (size_t) n, f) != (size_t) n) {
+    free(p);
+    p = NULL;
+  }
+  fclose(f);
+  if (p != NULL) {
+    *nptr = (size_t) n;
+  }
+  return p;
+}
+
+//  check_corrupt : vérifie qu'aucune entrée n'est trouvée pour la source de
+//    nom path du répertoire dir une fois son entrée, de nom name, tronquée,
+//    puis privée du caractère nul final de son dernier mot tronqué.
+static void check_corrupt(const char *dir, const char *path,
+    const char *name) {
+  size_t n;
+  unsigned char *p = read_file(name, &n);
+  if (p == NULL) {
+    fail("failed to read entry");
+    return;
+  }
+  if (write_file(name, p, n / 2) != 0 || probe(dir, path, CHARCNT, MODE)) {
+    fail("truncated entry accepted");
+  }
+  p[n - 1] = 'x';
+  if (write_file(name, p, n) != 0 || probe(dir, path, CHARCNT, MODE)) {
+    fail("corrupt entry accepted");
+  }
+  free(p);
+}
+
+int main(void) {
+  if (shword_setup(1) != 0) {
+    return EXIT_FAILURE;
+  }
+  char dir[] = "/tmp/cachetest.XXXXXX";
+  if (mkdtemp(dir) == NULL) {
+    fprintf(stderr, "cachetest: Failed to create temporary directory.\n");
+    return EXIT_FAILURE;
+  }
+  char cdir[sizeof dir + 8];
+  char path[sizeof dir + 8];
+  char name[1024];
+  snprintf(cdir, sizeof cdir, "%s/cache", dir);
+  snprintf(path, sizeof path, "%s/src", dir);
+  arena *ar = arena_empty();
+  holdall *ha = holdall_empty();
+  int r = EXIT_FAILURE;
+  if (ar == NULL || ha == NULL) {
+    fprintf(stderr, "cachetest: Not enough memory.\n");
+    goto dispose;
+  }
+  for (size_t k = 0; k < WORD_CNT; ++k) {
+    char w[32];
+    int len = snprintf(w, sizeof w, "w%zu", k);
+    shword *shw = shword_create(ar, w, (size_t) len);
+    if (shw == NULL || holdall_put(ha, shw) != 0) {
+      fprintf(stderr, "cachetest: Not enough memory.\n");
+      goto dispose;
+    }
+    shword_add(shw, 0, k + 1);
+  }
+  if (write_file(path, "source\n", 7) != 0 || mkdir(cdir, 0700) != 0) {
+    fprintf(stderr, "cachetest: Failed to create source.\n");
+    goto dispose;
+  }
+  if (store(cdir, path, ha) != 0) {
+    fail("failed to store entry");
+  }
+  check_entry(cdir, path);
+  if (probe(cdir, path, CHARCNT + 1, MODE)) {
+    fail("entry found for another -i");
+  }
+  if (probe(cdir, path, CHARCNT, MODE | 1)) {
+    fail("entry found for other read flags");
+  }
+  if (write_file(path, "source changed\n", 15) != 0
+      || probe(cdir, path, CHARCNT, MODE)) {
+    fail("entry found for a modified source");
+  }
+  if (store(cdir, path, ha) != 0) {
+    fail("failed to replace entry");
+  }
+  check_entry(cdir, path);
+  if (entry_name(cdir, name, sizeof name) != 0) {
+    fail("entry not found in directory");
+  } else {
+    check_corrupt(cdir, path, name);
+    remove(name);
+  }
+  char missing[sizeof dir + 16];
+  snprintf(missing, sizeof missing, "%s/missing", dir);
+  cache *c;
+  if (!lookup(&c, missing, path, CHARCNT, MODE) && c != NULL
+      && cache_store(c, ha) == 0) {
+    fail("entry stored in a missing directory");
+  }
+  cache_dispose(&c);
+  printf("cachetest: %d words, %zu truncated words: %s\n", WORD_CNT,
+      TRUNC_CNT, failures == 0 ? "ok" : "FAILED");
+  if (failures == 0) {
+    r = EXIT_SUCCESS;
+  }
+  dispose:
+  remove(path);
+  rmdir(cdir);
+  rmdir(dir);
+  holdall_dispose(&ha);
+  arena_dispose(&ar);
+  return r;
+}
@@ -0,0 +1,244 @@
+//  chashtabletest - test de charge du module chashtable : plusieurs fils
+//    d'exécution ajoutent simultanément les mêmes clés, chacun dans un ordre
+//    qui lui est propre, à une table vide qui subit ainsi de nombreux
+//    agrandissements. Pour chaque clé, tous les fils doivent obtenir la même
+//    valeur, la table doit compter exactement une valeur par clé et son
+//    parcours doit rencontrer chacune une et une seule fois. Le test est
+//    répété avec une fonction de pré-hachage qui regroupe les clés, afin que
+//    les séquences de sondage soient longues et franchissent les tranches de
+//    transfert. Le nombre de clés et celui des fils peuvent être fournis en
+//    argument.
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "chashtable.h"
+
+//  KEY_CNT, THREAD_CNT : nombres par défaut de clés et de fils d'exécution.
+#define KEY_CNT 1000000
+#define THREAD_CNT 8
+
+//  GROUP : nombre de clés consécutives de même valeur de pré-hachage avec
+//    hash_grouped.
+#define GROUP 16
+
+//  struct value : une valeur de clé key.
+struct value {
+  size_t key;
+};
+
+//  struct job : structure propre à chaque fil d'exécution, d'indice index :
+//    la table commune, sa fonction de pré-hachage, le tableau commun seen des
+//    valeurs obtenues pour chacune des keycnt clés, le réservoir pool des
+//    valeurs que le fil peut créer, dont used ont été créées, et le nombre de
+//    désaccords constatés.
+struct job {
+  chashtable *ht;
+  size_t (*hashfun)(const void *);
+  _Atomic(struct value *) *seen;
+  size_t keycnt;
+  size_t index;
+  struct value *pool;
+  size_t used;
+  size_t mismatches;
+};
+
+//  struct visit : contexte du parcours de la table : le tableau seen des
+//    valeurs attendues pour chacune des keycnt clés, le tableau visited des
+//    clés déjà rencontrées.
+struct visit {
+  _Atomic(struct value *) *seen;
+  bool *visited;
+  size_t keycnt;
+};
+
+//  compar_key : fonction de comparaison des clés.
+static int compar_key(const void *a, const void *b) {
+  size_t x = *(const size_t *) a;
+  size_t y = *(const size_t *) b;
+  return (x > y) - (x < y);
+}
+
+//  hash_mixed, hash_grouped : fonctions de pré-hachage des clés, la seconde
+//    donnant la même valeur à GROUP clés consécutives.
+static size_t hash_mixed(const void *k) {
+  uint64_t z = (uint64_t) *(const size_t *) k * 0x9E3779B97F4A7C15u;
+  return (size_t) (z ^ (z >> 29));
+}
+
+static size_t hash_grouped(const void *k) {
+  size_t g = *(const size_t *) k / GROUP;
+  return hash_mixed(&g);
+}
+
+//  key_of : renvoie l'adresse de la clé de la valeur associée à v.
+static const void *key_of(const void *v) {
+  return &((const struct value *) v)->key;
+}
+
+//  create : crée dans le réservoir du travail associé à job une valeur de clé
+//    *keyptr.
+static void *create(struct job *job, const size_t *keyptr) {
+  struct value *v = &job->pool[job->used++];
+  v->key = *keyptr;
+  return v;
+}
+
+//  gcd : renvoie le plus grand commun diviseur de a et b.
+static size_t gcd(size_t a, size_t b) {
+  while (b != 0) {
+    size_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+//  worker : fonction exécutée par les fils d'exécution. Ajoute à la table les
+//    clés dans l'ordre de la suite (i * step + index) % keycnt, step étant
+//    premier avec keycnt et propre au fil, et compare chaque valeur obtenue à
+//    celle obtenue pour la même clé par les autres fils d'exécution.
+static void *worker(struct job *job) {
+  size_t step = 7919 + 2 * job->index;
+  while (gcd(step, job->keycnt) != 1) {
+    ++step;
+  }
+  for (size_t i = 0; i < job->keycnt; ++i) {
+    size_t key = (i * step + job->index) % job->keycnt;
+    struct value *v = chashtable_find_or_insert(job->ht, &key,
+        job->hashfun(&key), (void *(*)(void *, const void *))create, job);
+    if (v == NULL) {
+      fprintf(stderr, "chashtabletest: Not enough memory.\n");
+      exit(EXIT_FAILURE);
+    }
+    struct value *expected = NULL;
+    if (v->key != key
+        || (!atomic_compare_exchange_strong(&job->seen[key], &expected, v)
+          && expected != v)) {
+      ++job->mismatches;
+    }
+  }
+  return NULL;
+}
+
+//  visit : vérifie que la valeur associée à v, rencontrée par le parcours de
+//    contexte associé à c, est celle obtenue par les fils d'exécution pour sa
+//    clé et qu'elle n'a pas déjà été rencontrée. Renvoie une valeur non nulle
+//    en cas d'échec. Renvoie sinon zéro.
+static int visit(struct visit *c, const struct value *v) {
+  if (v->key >= c->keycnt || c->visited[v->key]
+      || atomic_load(&c->seen[v->key]) != v) {
+    return -1;
+  }
+  c->visited[v->key] = true;
+  return 0;
+}
+
+//  run : exécute le test avec keycnt clés, threadcnt fils d'exécution et la
+//    fonction de pré-hachage hashfun de nom name. Renvoie zéro en cas de
+//    succès, une valeur non nulle sinon.
+static int run(size_t keycnt, size_t threadcnt,
+    size_t (*hashfun)(const void *), const char *name) {
+  int r = -1;
+  size_t started = 0;
+  chashtable *ht = chashtable_empty(compar_key, hashfun, key_of);
+  _Atomic(struct value *) *seen = calloc(keycnt, sizeof *seen);
+  bool *visited = calloc(keycnt, sizeof *visited);
+  struct job *jobs = calloc(threadcnt, sizeof *jobs);
+  pthread_t *threads = malloc(threadcnt * sizeof *threads);
+  if (ht == NULL || seen == NULL || visited == NULL || jobs == NULL
+      || threads == NULL) {
+    fprintf(stderr, "chashtabletest: Not enough memory.\n");
+    goto dispose;
+  }
+  for (size_t k = 0; k < keycnt; ++k) {
+    atomic_init(&seen[k], NULL);
+  }
+  for (size_t t = 0; t < threadcnt; ++t) {
+    jobs[t] = (struct job) {
+      .ht = ht,
+      .hashfun = hashfun,
+      .seen = seen,
+      .keycnt = keycnt,
+      .index = t,
+      .pool = malloc(keycnt * sizeof *jobs[t].pool),
+      .used = 0,
+      .mismatches = 0,
+    };
+    if (jobs[t].pool == NULL) {
+      fprintf(stderr, "chashtabletest: Not enough memory.\n");
+      goto join;
+    }
+  }
+  while (started < threadcnt) {
+    if (pthread_create(&threads[started], NULL,
+        (void *(*)(void *))worker, &jobs[started]) != 0) {
+      fprintf(stderr, "chashtabletest: Failed to start threads.\n");
+      goto join;
+    }
+    ++started;
+  }
+  join:
+  for (size_t t = 0; t < started; ++t) {
+    pthread_join(threads[t], NULL);
+  }
+  if (started < threadcnt) {
+    goto dispose;
+  }
+  size_t mismatches = 0;
+  for (size_t t = 0; t < threadcnt; ++t) {
+    mismatches += jobs[t].mismatches;
+  }
+  struct visit c = {
+    .seen = seen,
+    .visited = visited,
+    .keycnt = keycnt,
+  };
+  if (mismatches > 0) {
+    fprintf(stderr, "chashtabletest: %s: %zu values differ between threads.\n",
+        name, mismatches);
+  } else if (chashtable_count(ht) != keycnt) {
+    fprintf(stderr, "chashtabletest: %s: %zu values instead of %zu.\n", name,
+        chashtable_count(ht), keycnt);
+  } else if (chashtable_apply_context(ht, &c,
+      (int (*)(void *, void *))visit) != 0) {
+    fprintf(stderr, "chashtabletest: %s: Unexpected value in table.\n", name);
+  } else {
+    printf("chashtabletest: %zu keys, %zu threads, %s hash: ok\n", keycnt,
+        threadcnt, name);
+    r = 0;
+  }
+  dispose:
+  for (size_t t = 0; jobs != NULL && t < threadcnt; ++t) {
+    free(jobs[t].pool);
+  }
+  chashtable_dispose(&ht);
+  free(seen);
+  free(visited);
+  free(jobs);
+  free(threads);
+  return r;
+}
+
+int main(int argc, char **argv) {
+  size_t keycnt = KEY_CNT;
+  size_t threadcnt = THREAD_CNT;
+  if (argc > 1) {
+    keycnt = strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    threadcnt = strtoul(argv[2], NULL, 10);
+  }
+  if (keycnt == 0 || threadcnt == 0) {
+    fprintf(stderr, "Usage: %s [KEYS [THREADS]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (run(keycnt, threadcnt, hash_mixed, "mixed") != 0
+      || run(keycnt, threadcnt, hash_grouped, "grouped") != 0) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+//  decomptest - test de la lecture par le module reader des sources
+//    compressées, confiée au module decomp : un texte de plusieurs mégaoctets
+//    est compressé en deux membres gzip et en deux trames zstd, coupés hors
+//    d'une limite de mot. Pour chaque format pris en charge, la suite des mots
+//    lus doit être celle du texte, que la source soit un fichier régulier ou
+//    un tube ; une source tronquée ou dont la somme de contrôle est altérée
+//    doit produire l'erreur EIO ; une source révoquée avant d'avoir été lue en
+//    entier ne doit ni bloquer ni fuir. Pour chaque format non pris en charge
+//    par le module, la lecture doit produire l'erreur ENOTSUP sans aucun mot.
+//    Un format dont la bibliothèque manque au test lui-même n'est pas testé.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "decomp.h"
+#include "reader.h"
+#include "strhash.h"
+
+//  TEXT_SIZE : taille minimale du texte, plusieurs fois celle des tampons du
+//    module reader.
+#define TEXT_SIZE (4 * 1024 * 1024)
+
+//  WORD_LEN : nombre de caractères significatifs des mots lus.
+#define WORD_LEN 63
+
+//  EARLY_WORDS : nombre de mots lus avant une révocation anticipée.
+#define EARLY_WORDS 1000
+
+//  struct digest : nombre de mots lus et empreinte de leur suite.
+struct digest {
+  size_t words;
+  uint64_t sum;
+};
+
+//  struct feed : travail du fil d'exécution qui écrit les n octets pointés
+//    par p sur le descripteur fd puis le ferme.
+struct feed {
+  const unsigned char *p;
+  size_t n;
+  int fd;
+};
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec what du format de nom name sur une source de genre
+//    kind.
+static void fail(const char *name, const char *kind, const char *what) {
+  fprintf(stderr, "decomptest: %s, %s: %s.\n", name, kind, what);
+  ++failures;
+}
+
+//  make_text : renvoie un texte alloué d'au moins TEXT_SIZE octets formé de
+//    mots pseudo-aléatoires, dont la longueur est affectée à *nptr. Renvoie
+//    NULL en cas de dépassement de capacité.
+static unsigned char *make_text(size_t *nptr) {
+  unsigned char *t = malloc(TEXT_SIZE + WORD_LEN + 2);
+  if (t == NULL) {
+    return NULL;
+  }
+  uint64_t z = 1;
+  size_t n = 0;
+  while (n < TEXT_SIZE) {
+    z = z * 6364136223846793005u + 1442695040888963407u;
+    size_t len = 1 + (size_t) (z >> 59);
+    for (size_t k = 0; k < len; ++k) {
+      t[n++] = (unsigned char) ('a' + (z >> (k * 2 % 40)) % 6);
+    }
+    t[n++] = (z >> 20) % 8 == 0 ? '\n' : ' ';
+  }
+  *nptr = n;
+  return t;
+}
+
+//  feed : fonction exécutée par le fil d'écriture dans un tube.
+static void *feed(struct feed *fe) {
+  const unsigned char *p = fe->p;
+  size_t n = fe->n;
+  while (n > 0) {
+    ssize_t w = write(fe->fd, p, n);
+    if (w < 0 && errno == EINTR) {
+      continue;
+    }
+    if (w <= 0) {
+      break;
+    }
+    p += w;
+    n -= (size_t) w;
+  }
+  close(fe->fd);
+  return NULL;
+}
+
+//  read_source : lit mot à mot, sans drapeau, la source formée des n octets
+//    pointés par p, fichier régulier si piped vaut false, tube sinon, et
+//    renseigne *dgptr. Si limit n'est pas nul, la lecture est abandonnée
+//    après limit mots. Renvoie l'erreur de lecture, ou -1 si la source n'a pu
+//    être créée ou lue faute de mémoire.
+static int read_source(const unsigned char *p, size_t n, bool piped,
+    size_t limit, struct digest *dgptr) {
+  FILE *f = NULL;
+  struct feed fe = {
+    .p = p,
+    .n = n,
+    .fd = -1,
+  };
+  pthread_t th;
+  bool started = false;
+  if (piped) {
+    int pfd[2];
+    if (pipe(pfd) != 0) {
+      return -1;
+    }
+    fe.fd = pfd[1];
+    f = fdopen(pfd[0], "r");
+    if (f == NULL) {
+      close(pfd[0]);
+      close(pfd[1]);
+      return -1;
+    }
+    if (pthread_create(&th, NULL, (void *(*)(void *))feed, &fe) != 0) {
+      close(pfd[1]);
+      fclose(f);
+      return -1;
+    }
+    started = true;
+  } else {
+    f = tmpfile();
+    if (f == NULL || fwrite(p, 1, n, f) != n || fflush(f) != 0
+        || fseek(f, 0, SEEK_SET) != 0) {
+      if (f != NULL) {
+        fclose(f);
+      }
+      return -1;
+    }
+  }
+  int e = -1;
+  *dgptr = (struct digest) {
+    .words = 0,
+    .sum = 0,
+  };
+  reader *r = reader_open(f, 0);
+  if (r != NULL) {
+    char buf[WORD_LEN + 1];
+    size_t wlen;
+    size_t h;
+    while ((limit == 0 || dgptr->words < limit)
+        && reader_next(r, buf, WORD_LEN, &wlen, &h) > 0) {
+      dgptr->sum = (dgptr->sum ^ h ^ wlen) * 0x100000001B3u;
+      ++dgptr->words;
+    }
+    e = reader_error(r);
+    reader_dispose(&r);
+  }
+  //  La fermeture du tube libère le fil d'écriture d'une lecture abandonnée.
+  fclose(f);
+  if (started) {
+    pthread_join(th, NULL);
+  }
+  return e;
+}
+
+//  check_format : exécute les cas du format format de nom name sur sa forme
+//    compressée des n octets pointés par z, dont la suite des mots doit avoir
+//    l'empreinte ref.
+static void check_format(int format, const char *name, unsigned char *z,
+    size_t n, const struct digest *ref) {
+  static const char *kinds[] = {
+    "file", "pipe",
+  };
+  for (int piped = 0; piped <= 1; ++piped) {
+    const char *kind = kinds[piped];
+    struct digest dg;
+    int e = read_source(z, n, piped, 0, &dg);
+    if (!decomp_supported(format)) {
+      if (e != ENOTSUP || dg.words != 0) {
+        fail(name, kind, "unsupported format not reported");
+      }
+      continue;
+    }
+    if (e != 0 || dg.words != ref->words || dg.sum != ref->sum) {
+      fail(name, kind, "words differ from plain text");
+    }
+    if (read_source(z, n / 2, piped, 0, &dg) != EIO) {
+      fail(name, kind, "truncated source not reported");
+    }
+    z[n - 1] ^= 0x5A;
+    e = read_source(z, n, piped, 0, &dg);
+    z[n - 1] ^= 0x5A;
+    if (e != EIO) {
+      fail(name, kind, "corrupt source not reported");
+    }
+    if (read_source(z, n, piped, EARLY_WORDS, &dg) != 0
+        || dg.words != EARLY_WORDS) {
+      fail(name, kind, "early dispose");
+    }
+  }
+}
+
+#ifdef HAVE_ZLIB
+
+//  gzip_members : renvoie la compression allouée au format gzip des n octets
+//    pointés par t, en deux membres coupés à l'octet d'indice cut, dont la
+//    longueur est affectée à *zlenptr. Renvoie NULL en cas d'échec.
+static unsigned char *gzip_members(const unsigned char *t, size_t n,
+    size_t cut, size_t *zlenptr) {
+  size_t size = 2 * compressBound((uLong) n) + 64;
+  unsigned char *z = malloc(size);
+  if (z == NULL) {
+    return NULL;
+  }
+  size_t zlen = 0;
+  size_t bounds[] = {
+    0, cut, n,
+  };
+  for (size_t k = 0; k < 2; ++k) {
+    z_stream zs = {
+      .zalloc = Z_NULL,
+      .zfree = Z_NULL,
+      .opaque = Z_NULL,
+    };
+    if (deflateInit2(&zs, 6, Z_DEFLATED, 16 + MAX_WBITS, 8,
+        Z_DEFAULT_STRATEGY) != Z_OK) {
+      free(z);
+      return NULL;
+    }
+    zs.next_in = (Bytef *) (t + bounds[k]);
+    zs.avail_in = (uInt) (bounds[k + 1] - bounds[k]);
+    zs.next_out = z + zlen;
+    zs.avail_out = (uInt) (size - zlen);
+    int ret = deflate(&zs, Z_FINISH);
+    zlen += zs.total_out;
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END) {
+      free(z);
+      return NULL;
+    }
+  }
+  *zlenptr = zlen;
+  return z;
+}
+
+#endif
+
+#ifdef HAVE_ZSTD
+
+//  zstd_frames : renvoie la compression allouée au format zstd des n octets
+//    pointés par t, en deux trames dotées d'une somme de contrôle et coupées à
+//    l'octet d'indice cut, dont la longueur est affectée à *zlenptr. Renvoie
+//    NULL en cas d'échec.
+static unsigned char *zstd_frames(const unsigned char *t, size_t n,
+    size_t cut, size_t *zlenptr) {
+  size_t size = 2 * ZSTD_compressBound(n);
+  unsigned char *z = malloc(size);
+  ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  if (z == NULL || cctx == NULL
+      || ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1))) {
+    goto error;
+  }
+  size_t zlen = 0;
+  size_t bounds[] = {
+    0, cut, n,
+  };
+  for (size_t k = 0; k < 2; ++k) {
+    size_t ret = ZSTD_compress2(cctx, z + zlen, size - zlen, t + bounds[k],
+        bounds[k + 1] - bounds[k]);
+    if (ZSTD_isError(ret)) {
+      goto error;
+    }
+    zlen += ret;
+  }
+  ZSTD_freeCCtx(cctx);
+  *zlenptr = zlen;
+  return z;
+  error:
+  ZSTD_freeCCtx(cctx);
+  free(z);
+  return NULL;
+}
+
+#endif
+
+int main(void) {
+  reader_setup();
+  strhash_setup();
+  //  Un tube dont la lecture est abandonnée ne doit pas interrompre le test.
+  signal(SIGPIPE, SIG_IGN);
+  size_t n;
+  unsigned char *t = make_text(&n);
+  if (t == NULL) {
+    fprintf(stderr, "decomptest: Not enough memory.\n");
+    return EXIT_FAILURE;
+  }
+  struct digest ref;
+  if (read_source(t, n, false, 0, &ref) != 0) {
+    fprintf(stderr, "decomptest: Failed to read plain text.\n");
+    free(t);
+    return EXIT_FAILURE;
+  }
+  //  Coupure au milieu d'un mot, hors de toute limite de tampon.
+  size_t cut = n / 3;
+  while (t[cut] == ' ' || t[cut] == '\n') {
+    ++cut;
+  }
+  const char *gzstat = "untested";
+  const char *zststat = "untested";
+#ifdef HAVE_ZLIB
+  size_t gzlen;
+  unsigned char *gz = gzip_members(t, n, cut, &gzlen);
+  if (gz == NULL) {
+    fail("gzip", "memory", "compression failed");
+  } else {
+    check_format(DECOMP_GZIP, "gzip", gz, gzlen, &ref);
+    free(gz);
+  }
+  gzstat = decomp_supported(DECOMP_GZIP) ? "read" : "unsupported";
+#endif
+#ifdef HAVE_ZSTD
+  size_t zstlen;
+  unsigned char *zst = zstd_frames(t, n, cut, &zstlen);
+  if (zst == NULL) {
+    fail("zstd", "memory", "compression failed");
+  } else {
+    check_format(DECOMP_ZSTD, "zstd", zst, zstlen, &ref);
+    free(zst);
+  }
+  zststat = decomp_supported(DECOMP_ZSTD) ? "read" : "unsupported";
+#endif
+  printf("decomptest: %zu words, gzip %s, zstd %s: %s\n", ref.words, gzstat,
+      zststat, failures == 0 ? "ok" : "FAILED");
+  free(t);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
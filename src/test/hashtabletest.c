@@ -0,0 +1,262 @@
+//  hashtabletest - test du module hashtable : des clés sont ajoutées,
+//    remplacées, retirées et recherchées en alternance dans une table agrandie
+//    en une fois, puis de manière incrémentale avec plusieurs nombres de
+//    listes migrées par opération, et chaque résultat est comparé à celui
+//    attendu. Le bilan de santé doit signaler une migration en cours dans le
+//    seul mode incrémental et un taux de remplissage jamais supérieur au seuil
+//    de la table ; une réservation doit éviter tout agrandissement ultérieur
+//    de la table, ou achever la migration en cours. Le test est répété en une
+//    fois avec un seuil fixé par hashtable_setup, puis les seuils refusés par
+//    l'implantation sont vérifiés. Le nombre de clés peut être fourni en
+//    argument.
+//  Si la macroconstante OPEN_ADDRESSING est définie, l'implantation testée est
+//    celle par adressage ouvert, qui doit refuser le mode incrémental, les cas
+//    correspondants n'étant alors pas exécutés, et les seuils supérieurs ou
+//    égaux à 1.
+
+#define HASHTABLE_CHECKUP
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hashtable.h"
+
+//  KEY_CNT, KEY_MIN : nombres de clés par défaut et minimal, ce dernier
+//    assurant que des migrations ont lieu avec tous les pas testés.
+#define KEY_CNT 200000
+#define KEY_MIN 4096
+
+//  CHECK_PERIOD : nombre d'opérations entre deux bilans de santé, dont le coût
+//    est proportionnel à la taille de la table. Un bilan est de plus effectué
+//    juste après chaque agrandissement.
+#define CHECK_PERIOD 1024
+
+//  LD_NUMER, LD_DENOM : seuil du taux de remplissage fixé par hashtable_setup
+//    pour la dernière exécution du test.
+#define LD_NUMER 1
+#define LD_DENOM 4
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec what pour la clé key avec le pas step.
+static void fail(size_t step, size_t key, const char *what) {
+  if (failures < 10) {
+    fprintf(stderr, "hashtabletest: step %zu, key %zu: %s.\n", step, key,
+        what);
+  }
+  ++failures;
+}
+
+//  compar_key : fonction de comparaison des clés.
+static int compar_key(const void *a, const void *b) {
+  size_t x = *(const size_t *) a;
+  size_t y = *(const size_t *) b;
+  return (x > y) - (x < y);
+}
+
+//  hash_key : fonction de pré-hachage des clés.
+static size_t hash_key(const void *k) {
+  uint64_t z = (uint64_t) *(const size_t *) k * 0x9E3779B97F4A7C15u;
+  return (size_t) (z ^ (z >> 29));
+}
+
+//  run : exécute le test sur les n clés du tableau keys avec le pas step, les
+//    valeurs attendues des clés présentes étant conservées dans le tableau
+//    vals, NULL pour une clé absente, et alt fournissant des valeurs de
+//    remplacement. Si ldfactmax n'est pas nul, il s'agit du seuil attendu du
+//    taux de remplissage de la table. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int run(size_t step, double ldfactmax, const size_t *keys,
+    const size_t **vals, const size_t *alt, size_t n) {
+  if (hashtable_setup_incremental(step) != 0) {
+    return -1;
+  }
+  hashtable *ht = hashtable_empty(compar_key, hash_key);
+  hashtable_setup_incremental(0);
+  if (ht == NULL) {
+    return -1;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    vals[k] = NULL;
+  }
+  size_t count = 0;
+  bool migrating = false;
+  bool reserved = false;
+  size_t resizes = hashtable_resizecount();
+  size_t reservedresizes = 0;
+  uint64_t z = step + 1;
+  for (size_t i = 0; i < n; ++i) {
+    if (hashtable_add(ht, &keys[i], &keys[i]) == NULL) {
+      hashtable_dispose(&ht);
+      return -1;
+    }
+    vals[i] = &keys[i];
+    ++count;
+    z = z * 6364136223846793005u + 1442695040888963407u;
+    size_t j = (size_t) (z >> 33) % (i + 1);
+    switch (i % 4) {
+      case 0:
+        if (hashtable_remove(ht, &keys[j]) != vals[j]) {
+          fail(step, j, "wrong removed value");
+        }
+        count -= vals[j] != NULL;
+        vals[j] = NULL;
+        break;
+      case 1:
+        if (vals[j] != NULL) {
+          if (hashtable_add(ht, &keys[j], &alt[j]) != &alt[j]) {
+            hashtable_dispose(&ht);
+            return -1;
+          }
+          vals[j] = &alt[j];
+        }
+        break;
+      default:
+        if (hashtable_search(ht, &keys[j]) != vals[j]) {
+          fail(step, j, "wrong value found");
+        }
+    }
+    if (step == 0 && i == n / 2) {
+      //  Une réservation pour toutes les clés évite tout agrandissement
+      //    ultérieur.
+      if (hashtable_reserve(ht, n) != 0) {
+        hashtable_dispose(&ht);
+        return -1;
+      }
+      reservedresizes = hashtable_resizecount();
+      reserved = true;
+    }
+    if (i % CHECK_PERIOD != 0 && i + 1 < n
+        && hashtable_resizecount() == resizes) {
+      continue;
+    }
+    resizes = hashtable_resizecount();
+    struct hashtable_checkup cu;
+    hashtable_get_checkup(ht, &cu);
+    if (cu.nentries != count) {
+      fail(step, i, "wrong entry count");
+    }
+    if (cu.ldfactcurr > cu.ldfactmax) {
+      fail(step, i, "load factor above limit");
+    }
+    if (ldfactmax != 0.0 && cu.ldfactmax != ldfactmax) {
+      fail(step, i, "load factor limit not set");
+    }
+    if (cu.oldnslots > 0) {
+      migrating = true;
+      if (!reserved && cu.migrated > 0) {
+        //  Une réservation au cours d'une migration l'achève d'abord.
+        if (hashtable_reserve(ht, 2 * count) != 0) {
+          hashtable_dispose(&ht);
+          return -1;
+        }
+        hashtable_get_checkup(ht, &cu);
+        if (cu.oldnslots != 0) {
+          fail(step, i, "migration not finished by reserve");
+        }
+        reserved = true;
+      }
+    }
+  }
+  if (migrating != (step > 0)) {
+    fail(step, n, migrating ? "unexpected migration" : "no migration seen");
+  } else if (!reserved) {
+    fail(step, n, "no reserve during a migration");
+  } else if (step == 0 && hashtable_resizecount() != reservedresizes) {
+    fail(step, n, "resize after reserve");
+  }
+  for (size_t k = 0; k < n; ++k) {
+    if (hashtable_search(ht, &keys[k]) != vals[k]) {
+      fail(step, k, "wrong final value");
+    }
+  }
+  hashtable_dispose(&ht);
+  return 0;
+}
+
+//  check_setup : vérifie que les seuils nuls, et, avec l'adressage ouvert,
+//    ceux supérieurs ou égaux à 1, sont refusés par hashtable_setup, les autres
+//    étant acceptés. Le seuil en vigueur est ensuite indéterminé.
+static void check_setup(void) {
+  if (hashtable_setup(0, 1) == 0) {
+    fail(0, 0, "zero load factor accepted");
+  }
+#ifdef OPEN_ADDRESSING
+  if (hashtable_setup(1, 1) == 0 || hashtable_setup(3, 2) == 0) {
+    fail(0, 0, "load factor not below one accepted");
+  }
+#else
+  if (hashtable_setup(1, 1) != 0 || hashtable_setup(3, 2) != 0) {
+    fail(0, 0, "load factor not below one refused");
+  }
+#endif
+  if (hashtable_setup(1, 2) != 0) {
+    fail(0, 0, "load factor one half refused");
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t n = KEY_CNT;
+  if (argc > 1) {
+    n = strtoul(argv[1], NULL, 10);
+  }
+  if (n < KEY_MIN) {
+    fprintf(stderr, "Usage: %s [KEYS], KEYS >= %d\n", argv[0], KEY_MIN);
+    return EXIT_FAILURE;
+  }
+  static const size_t steps[] = {
+    0, 1, 4, 64,
+  };
+  size_t *keys = malloc(n * sizeof *keys);
+  size_t *alt = malloc(n * sizeof *alt);
+  const size_t **vals = malloc(n * sizeof *vals);
+  int r = EXIT_FAILURE;
+  if (keys == NULL || alt == NULL || vals == NULL) {
+    fprintf(stderr, "hashtabletest: Not enough memory.\n");
+    goto dispose;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    keys[k] = k;
+    alt[k] = k;
+  }
+  for (size_t s = 0; s < sizeof steps / sizeof *steps; ++s) {
+#ifdef OPEN_ADDRESSING
+    if (steps[s] > 0) {
+      if (hashtable_setup_incremental(steps[s]) == 0) {
+        hashtable_setup_incremental(0);
+        fail(steps[s], 0, "incremental mode accepted");
+      }
+      continue;
+    }
+#endif
+    if (run(steps[s], 0.0, keys, vals, alt, n) != 0) {
+      fprintf(stderr, "hashtabletest: step %zu: Not enough memory.\n",
+          steps[s]);
+      goto dispose;
+    }
+  }
+  if (hashtable_setup(LD_NUMER, LD_DENOM) != 0) {
+    fail(0, 0, "load factor refused");
+  } else if (run(0, (double) LD_NUMER / LD_DENOM, keys, vals, alt, n) != 0) {
+    fprintf(stderr, "hashtabletest: Not enough memory.\n");
+    goto dispose;
+  }
+  check_setup();
+#ifdef OPEN_ADDRESSING
+  const char *mode = "open addressing, step 0";
+#else
+  const char *mode = "separate chaining, steps 0 1 4 64";
+#endif
+  printf("hashtabletest: %zu keys, %s, load factor %d/%d: %s\n", n, mode,
+      LD_NUMER, LD_DENOM, failures == 0 ? "ok" : "FAILED");
+  if (failures == 0) {
+    r = EXIT_SUCCESS;
+  }
+  dispose:
+  free(keys);
+  free(alt);
+  free(vals);
+  return r;
+}
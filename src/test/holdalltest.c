@@ -0,0 +1,179 @@
+//  holdalltest - test de charge du module holdall : un fourretout de plusieurs
+//    dizaines de millions d'adresses est trié par holdall_sort, puis l'ordre
+//    des parcours est vérifié, ainsi que la stabilité du tri : des adresses
+//    équivalentes doivent rester dans leur ordre relatif de parcours avant le
+//    tri. Le mode d'insertion, en tête ou en queue selon la macroconstante
+//    HOLDALL_INSERT_TAIL de la compilation du module, est reconnu à
+//    l'exécution. La sélection par holdall_sort_top est ensuite vérifiée sur un
+//    fourretout plus petit. Le nombre d'adresses peut être fourni en argument.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "holdall.h"
+
+//  ITEM_CNT : nombre d'adresses par défaut.
+#define ITEM_CNT 20000000
+
+//  KEY_DIV : rapport entre le nombre d'adresses et le nombre de clés
+//    distinctes, qui fixe la taille moyenne des groupes d'adresses
+//    équivalentes.
+#define KEY_DIV 8
+
+//  TOP_CNT, TOP_K : nombre d'adresses et rang de la sélection vérifiée.
+#define TOP_CNT 1000000
+#define TOP_K 1000
+
+//  struct item : un objet pointé, de clé key, ajouté en rang seq.
+struct item {
+  uint32_t key;
+  uint32_t seq;
+};
+
+//  compar_item : fonction de comparaison de deux objets selon leur clé.
+static int compar_item(const struct item *a, const struct item *b) {
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de la suite d'état
+//    *stateptr, selon l'algorithme splitmix64.
+static uint64_t rng_next(uint64_t *stateptr) {
+  uint64_t z = (*stateptr += 0x9E3779B97F4A7C15u);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+  return z ^ (z >> 31);
+}
+
+//  fill : renseigne les n objets du tableau pointé par items, de clés
+//    aléatoires parmi n / KEY_DIV + 1, et ajoute leurs adresses dans l'ordre
+//    au fourretout associé à ha. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int fill(holdall *ha, struct item *items, size_t n, uint64_t *stateptr) {
+  uint32_t keycnt = (uint32_t) (n / KEY_DIV + 1);
+  for (size_t k = 0; k < n; ++k) {
+    items[k].key = (uint32_t) (rng_next(stateptr) % keycnt);
+    items[k].seq = (uint32_t) k;
+    if (holdall_put(ha, &items[k]) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//  check_sorted : vérifie que les m premières adresses dans l'ordre des
+//    parcours du fourretout associé à ha, de n adresses, sont triées et que
+//    le tri a été stable, dir valant 1 si les parcours suivaient l'ordre des
+//    ajouts avant le tri, -1 s'ils le suivaient à rebours, zéro si la
+//    stabilité n'est pas attendue. Vérifie de plus, si m vaut n, que chaque
+//    objet est parcouru une et une seule fois. Renvoie zéro en cas de succès,
+//    une valeur non nulle sinon.
+static int check_sorted(holdall *ha, size_t n, size_t m, int dir) {
+  if (holdall_count(ha) != n) {
+    fprintf(stderr, "holdalltest: %zu addresses instead of %zu.\n",
+        holdall_count(ha), n);
+    return -1;
+  }
+  uint64_t seqsum = 0;
+  const struct item *prev = NULL;
+  for (size_t k = 0; k < m; ++k) {
+    const struct item *it = holdall_at(ha, k);
+    seqsum += it->seq;
+    bool unstable = prev != NULL && prev->key == it->key
+        && (dir > 0 ? prev->seq > it->seq : dir < 0 && prev->seq < it->seq);
+    if (prev != NULL && (prev->key > it->key || unstable)) {
+      fprintf(stderr, "holdalltest: Rank %zu out of order: key %u seq %u"
+          " after key %u seq %u.\n", k, it->key, it->seq, prev->key,
+          prev->seq);
+      return -1;
+    }
+    prev = it;
+  }
+  if (m == n && seqsum != (uint64_t) n * (n - 1) / 2) {
+    fprintf(stderr, "holdalltest: Addresses lost or duplicated.\n");
+    return -1;
+  }
+  return 0;
+}
+
+//  check_top : vérifie sur un fourretout de n adresses que holdall_sort_top
+//    place en tête, triées, les k plus petites ; la sélection n'est pas tenue
+//    d'être stable. Renvoie zéro en cas de succès, une valeur non nulle sinon.
+static int check_top(size_t n, size_t k, uint64_t *stateptr) {
+  holdall *ha = holdall_empty();
+  struct item *items = malloc(n * sizeof *items);
+  int e = -1;
+  if (ha == NULL || items == NULL || fill(ha, items, n, stateptr) != 0) {
+    fprintf(stderr, "holdalltest: Not enough memory.\n");
+    goto dispose;
+  }
+  //  La plus grande des k plus petites clés, par comptage.
+  uint32_t keycnt = (uint32_t) (n / KEY_DIV + 1);
+  size_t *counts = calloc(keycnt, sizeof *counts);
+  if (counts == NULL) {
+    fprintf(stderr, "holdalltest: Not enough memory.\n");
+    goto dispose;
+  }
+  for (size_t j = 0; j < n; ++j) {
+    counts[items[j].key] += 1;
+  }
+  uint32_t kth = 0;
+  for (size_t c = 0; c + counts[kth] < k; c += counts[kth], ++kth);
+  free(counts);
+  if (holdall_sort_top(ha, k,
+      (int (*)(const void *, const void *))compar_item,
+      (int (*)(const void *, const void *))compar_item) != 0) {
+    fprintf(stderr, "holdalltest: Not enough memory.\n");
+    goto dispose;
+  }
+  if (check_sorted(ha, n, k, 0) != 0) {
+    goto dispose;
+  }
+  const struct item *last = holdall_at(ha, k - 1);
+  if (last->key != kth) {
+    fprintf(stderr, "holdalltest: Selected key %u instead of %u.\n",
+        last->key, kth);
+    goto dispose;
+  }
+  e = 0;
+  dispose:
+  holdall_dispose(&ha);
+  free(items);
+  return e;
+}
+
+int main(int argc, char **argv) {
+  size_t n = ITEM_CNT;
+  if (argc > 1) {
+    n = strtoul(argv[1], NULL, 10);
+  }
+  if (n == 0 || n > UINT32_MAX) {
+    fprintf(stderr, "Usage: %s [COUNT]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  uint64_t state = 1;
+  int r = EXIT_FAILURE;
+  holdall *ha = holdall_empty();
+  struct item *items = malloc(n * sizeof *items);
+  if (ha == NULL || items == NULL || fill(ha, items, n, &state) != 0) {
+    fprintf(stderr, "holdalltest: Not enough memory.\n");
+    goto dispose;
+  }
+  int dir = holdall_at(ha, 0) == &items[0] ? 1 : -1;
+  if (holdall_sort(ha, (int (*)(const void *, const void *))compar_item)
+      != 0) {
+    fprintf(stderr, "holdalltest: Not enough memory.\n");
+    goto dispose;
+  }
+  if (check_sorted(ha, n, n, dir) != 0 || check_top(TOP_CNT, TOP_K, &state)
+      != 0) {
+    goto dispose;
+  }
+  printf("holdalltest: %zu addresses, insertion at %s: ok\n", n,
+      dir > 0 ? "tail" : "head");
+  r = EXIT_SUCCESS;
+  dispose:
+  holdall_dispose(&ha);
+  free(items);
+  return r;
+}
@@ -0,0 +1,222 @@
+//  kerneltest - test d'équivalence des noyaux de découpage du module reader :
+//    les fonctions skip, span et upper des noyaux SSE2 et AVX2 pris en charge
+//    par le processeur doivent produire les mêmes résultats que celles du
+//    noyau scalaire de référence, sur des tampons aléatoires et sur des
+//    tampons dont les mots franchissent les limites des blocs de 16 et 32
+//    octets. La lecture par reader_next avec chaque noyau et chaque
+//    combinaison des drapeaux READER_PLSP et READER_UPPR doit par ailleurs
+//    produire les mêmes mots que reader_read. Le module est inclus afin
+//    d'accéder à ses noyaux.
+
+#include "reader.c"
+
+#include <stdlib.h>
+
+//  BUF_MAX : longueur maximale des tampons testés.
+#define BUF_MAX 300
+
+//  RANDOM_CNT : nombre de tampons aléatoires testés.
+#define RANDOM_CNT 4000
+
+//  WORD_LEN : nombre de caractères significatifs des mots lus par la
+//    comparaison de reader_next à reader_read, faible afin que des mots soient
+//    tronqués.
+#define WORD_LEN 21
+
+//  struct kernel : un noyau de nom name.
+struct kernel {
+  const char *name;
+  struct reader__kernel k;
+};
+
+static struct kernel kernels[3];
+static size_t kernelcnt;
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec du test name pour le noyau kernel sur le tampon de n
+//    octets pointé par p, à partir de la position offset, avec plsp.
+static void fail(const char *name, const char *kernel,
+    const unsigned char *p, size_t n, size_t offset, bool plsp) {
+  if (failures < 10) {
+    fprintf(stderr, "kerneltest: %s differs with %s on %zu bytes at offset"
+        " %zu, plsp %d:", name, kernel, n, offset, plsp);
+    for (size_t k = 0; k < n; ++k) {
+      fprintf(stderr, " %02x", p[k]);
+    }
+    fputc('\n', stderr);
+  }
+  ++failures;
+}
+
+//  rng_next : renvoie le prochain entier pseudo-aléatoire de la suite d'état
+//    *stateptr, selon l'algorithme splitmix64.
+static uint64_t rng_next(uint64_t *stateptr) {
+  uint64_t z = (*stateptr += 0x9E3779B97F4A7C15u);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+  return z ^ (z >> 31);
+}
+
+//  check_kernels : compare aux résultats du noyau scalaire ceux des autres
+//    noyaux sur les suffixes du tampon de n octets pointé par p débutant à
+//    chaque décalage d'un bloc de 32 octets.
+static void check_kernels(const unsigned char *p, size_t n) {
+  unsigned char ref[BUF_MAX];
+  unsigned char got[BUF_MAX];
+  for (size_t offset = 0; offset <= n && offset < 32; ++offset) {
+    const unsigned char *q = p + offset;
+    size_t m = n - offset;
+    reader__upper_scalar(ref, q, m);
+    for (size_t j = 1; j < kernelcnt; ++j) {
+      const struct kernel *kn = &kernels[j];
+      for (int plsp = 0; plsp < 2; ++plsp) {
+        if (kn->k.skip(q, m, plsp) != reader__skip_scalar(q, m, plsp)) {
+          fail("skip", kn->name, p, n, offset, plsp);
+        }
+        if (kn->k.span(q, m, plsp) != reader__span_scalar(q, m, plsp)) {
+          fail("span", kn->name, p, n, offset, plsp);
+        }
+      }
+      kn->k.upper(got, q, m);
+      if (memcmp(got, ref, m) != 0) {
+        fail("upper", kn->name, p, n, offset, false);
+      }
+    }
+  }
+}
+
+//  check_reader : compare, pour chaque noyau et chaque combinaison des
+//    drapeaux READER_PLSP et READER_UPPR, les mots lus par reader_next dans le
+//    flot f, de contenu le tableau de n octets pointé par p, à ceux lus par
+//    reader_read.
+static void check_reader(FILE *f, const unsigned char *p, size_t n) {
+  char ref[WORD_LEN + 1];
+  char got[WORD_LEN + 1];
+  for (int mode = 0; mode <= (READER_PLSP | READER_UPPR); ++mode) {
+    bool plsp = (mode & READER_PLSP) != 0;
+    bool uppr = (mode & READER_UPPR) != 0;
+    for (size_t j = 0; j < kernelcnt; ++j) {
+      reader__kernel = kernels[j].k;
+      rewind(f);
+      FILE *g = fmemopen((void *) p, n == 0 ? 1 : n, "r");
+      reader *r = reader_open(f, mode);
+      if (g == NULL || r == NULL) {
+        fprintf(stderr, "kerneltest: Not enough memory.\n");
+        exit(EXIT_FAILURE);
+      }
+      size_t k;
+      do {
+        size_t wlen;
+        size_t h;
+        k = n == 0 ? 0 : reader_read(g, ref, WORD_LEN, plsp, uppr);
+        if (reader_next(r, got, WORD_LEN, &wlen, &h) != k
+            || (k > 0 && strcmp(got, ref) != 0)) {
+          fail("reader_next", kernels[j].name, p, n, 0, plsp);
+          break;
+        }
+      } while (k > 0);
+      reader_dispose(&r);
+      fclose(g);
+    }
+  }
+  reader__kernel = kernels[0].k;
+}
+
+//  check : soumet le tampon de n octets pointé par p aux deux comparaisons,
+//    à l'aide du fichier temporaire f.
+static void check(FILE *f, const unsigned char *p, size_t n) {
+  check_kernels(p, n);
+  if (ftruncate(fileno(f), 0) != 0 || fseek(f, 0, SEEK_SET) != 0
+      || fwrite(p, 1, n, f) != n || fflush(f) != 0) {
+    fprintf(stderr, "kerneltest: Failed to write temporary file.\n");
+    exit(EXIT_FAILURE);
+  }
+  check_reader(f, p, n);
+}
+
+int main(void) {
+  reader_setup();
+  strhash_setup();
+  kernels[kernelcnt++] = (struct kernel) {
+    "scalar", {
+      reader__skip_scalar, reader__span_scalar, reader__upper_scalar,
+    },
+  };
+#ifdef READER__X86
+  __builtin_cpu_init();
+  if (reader__sse2_agrees() && __builtin_cpu_supports("sse2")) {
+    kernels[kernelcnt++] = (struct kernel) {
+      "sse2", {
+        reader__skip_sse2, reader__span_sse2, reader__upper_sse2,
+      },
+    };
+  }
+  //  reader_setup n'initialise les tables du noyau AVX2 que s'il le retient.
+  if (reader__kernel.skip == reader__skip_avx2) {
+    kernels[kernelcnt++] = (struct kernel) {
+      "avx2", {
+        reader__skip_avx2, reader__span_avx2, reader__upper_avx2,
+      },
+    };
+  }
+#endif
+  reader__kernel = kernels[0].k;
+  FILE *f = tmpfile();
+  if (f == NULL) {
+    fprintf(stderr, "kerneltest: Failed to create temporary file.\n");
+    return EXIT_FAILURE;
+  }
+  unsigned char buf[BUF_MAX];
+  size_t bufcnt = 0;
+  //  Mots d'une lettre à 80 lettres, précédés et suivis de séparateurs
+  //    ou de ponctuations, à chaque décalage par rapport aux blocs.
+  static const unsigned char seps[] = {
+    ' ', '\t', '\n', '\v', '\f', '\r', '.', '-', '~', '@', '[', '`', '{',
+  };
+  for (size_t len = 1; len <= 80; ++len) {
+    for (size_t lead = 0; lead < 40; lead += 3) {
+      unsigned char s = seps[(len + lead) % sizeof seps];
+      size_t n = 0;
+      for (size_t k = 0; k < lead; ++k) {
+        buf[n++] = s;
+      }
+      for (size_t k = 0; k < len; ++k) {
+        buf[n++] = (unsigned char) ("aZz0A9_\x80\xC3\xA9\xFF"[k % 11]);
+      }
+      buf[n++] = s;
+      buf[n++] = 'q';
+      check(f, buf, n);
+      ++bufcnt;
+    }
+  }
+  //  Tampons uniformes de chaque octet, de longueur franchissant 16 et 32.
+  for (int c = 0; c < 256; ++c) {
+    memset(buf, c, 70);
+    check(f, buf, (size_t) c % 71);
+    ++bufcnt;
+  }
+  //  Tampons aléatoires, tirés soit parmi tous les octets, soit parmi un
+  //    alphabet où séparateurs, ponctuations et octets supérieurs à 0x7F sont
+  //    fréquents.
+  static const unsigned char alpha[] = "  \t\n.,;!?-'\"()aAzZmM09\x7F\x80\xFF";
+  uint64_t state = 1;
+  for (size_t j = 0; j < RANDOM_CNT; ++j) {
+    size_t n = (size_t) (rng_next(&state) % BUF_MAX);
+    bool full = j % 2 == 0;
+    for (size_t k = 0; k < n; ++k) {
+      uint64_t r = rng_next(&state);
+      buf[k] = full ? (unsigned char) r : alpha[r % (sizeof alpha - 1)];
+    }
+    check(f, buf, n);
+    ++bufcnt;
+  }
+  fclose(f);
+  printf("kerneltest: %zu buffers,", bufcnt);
+  for (size_t j = 0; j < kernelcnt; ++j) {
+    printf(" %s", kernels[j].name);
+  }
+  printf(": %s\n", failures == 0 ? "ok" : "FAILED");
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+//  utf8test - test du passage simple en majuscule du mode UTF-8 du module
+//    reader sur l'ensemble des tables générées par ucdgen.py : pour chaque
+//    point de code supérieur à 0x7F, la forme majuscule doit être un point de
+//    code valide et sa séquence produite par le module doit être la plus
+//    courte, y compris lorsque la forme majuscule est ASCII. Chaque lettre qui
+//    a une forme majuscule distincte est ensuite lue par reader_next avec
+//    READER_UPPR, le mot lu devant être la séquence la plus courte de cette
+//    forme. Le module est inclus afin d'accéder à ses tables.
+
+#include "reader.c"
+
+#include <stdlib.h>
+
+//  UTF8_MAXCP : borne des points de code Unicode.
+#define UTF8_MAXCP 0x110000
+
+//  WORD_LEN : nombre de caractères significatifs des mots lus.
+#define WORD_LEN 63
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec du test name pour le point de code c, de forme
+//    majuscule u.
+static void fail(const char *name, uint32_t c, uint32_t u) {
+  if (failures < 10) {
+    fprintf(stderr, "utf8test: %s for U+%04X, upper U+%04X.\n", name,
+        (unsigned) c, (unsigned) u);
+  }
+  ++failures;
+}
+
+//  utf8_put : écrit à l'adresse d la séquence UTF-8 la plus courte du point de
+//    code c, valide. Renvoie sa longueur.
+static size_t utf8_put(unsigned char *d, uint32_t c) {
+  if (c < 0x80) {
+    d[0] = (unsigned char) c;
+    return 1;
+  }
+  size_t n = c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+  for (size_t k = n - 1; k > 0; --k) {
+    d[k] = (unsigned char) (0x80 | (c & 0x3F));
+    c >>= 6;
+  }
+  d[0] = (unsigned char) ((0xF00 >> n) | c);
+  return n;
+}
+
+//  is_scalar : détermine si c est un point de code Unicode hors substituts.
+static bool is_scalar(uint32_t c) {
+  return c < UTF8_MAXCP && !(c >= 0xD800 && c <= 0xDFFF);
+}
+
+int main(void) {
+  reader_setup();
+  strhash_setup();
+  FILE *f = tmpfile();
+  if (f == NULL) {
+    fprintf(stderr, "utf8test: Failed to create temporary file.\n");
+    return EXIT_FAILURE;
+  }
+  size_t mapped = 0;
+  for (uint32_t c = 0x80; c < UTF8_MAXCP; ++c) {
+    if (!is_scalar(c)) {
+      continue;
+    }
+    uint32_t u = reader__uupper(c);
+    if (!is_scalar(u)) {
+      fail("invalid upper case", c, u);
+      continue;
+    }
+    unsigned char got[READER_MAXSEQ];
+    unsigned char ref[READER_MAXSEQ];
+    size_t n = reader__encode(got, u);
+    if (n != utf8_put(ref, u) || memcmp(got, ref, n) != 0) {
+      fail("not the shortest sequence", c, u);
+    }
+    if (u != c) {
+      unsigned char w[READER_MAXSEQ];
+      fwrite(w, 1, utf8_put(w, c), f);
+      fputc(' ', f);
+      ++mapped;
+    }
+  }
+  if (fflush(f) != 0 || fseek(f, 0, SEEK_SET) != 0) {
+    fprintf(stderr, "utf8test: Failed to write temporary file.\n");
+    return EXIT_FAILURE;
+  }
+  reader *r = reader_open(f, READER_UTF8 | READER_UPPR);
+  if (r == NULL) {
+    fprintf(stderr, "utf8test: Not enough memory.\n");
+    return EXIT_FAILURE;
+  }
+  size_t words = 0;
+  for (uint32_t c = 0x80; c < UTF8_MAXCP; ++c) {
+    uint32_t u = is_scalar(c) ? reader__uupper(c) : c;
+    if (u == c || !is_scalar(u)) {
+      continue;
+    }
+    char buf[WORD_LEN * READER_MAXSEQ + 1];
+    unsigned char ref[READER_MAXSEQ];
+    size_t n = utf8_put(ref, u);
+    size_t wlen;
+    size_t h;
+    if (reader_next(r, buf, WORD_LEN, &wlen, &h) != 1 || wlen != n
+        || memcmp(buf, ref, n) != 0) {
+      fail("reader_next", c, u);
+    }
+    ++words;
+  }
+  reader_dispose(&r);
+  fclose(f);
+  printf("utf8test: %zu upper case mappings, %zu words read: %s\n", mapped,
+      words, failures == 0 ? "ok" : "FAILED");
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+//  wordtabletest - test du compactage du module wordtable : des mots présents
+//    dans des ensembles variés de fichiers sont insérés dans une table, par
+//    leur chaine seule ou avec leur longueur et leur somme de hachage, puis la
+//    table est compactée. Elle ne doit plus contenir, une et une seule fois,
+//    que les mots présents dans au moins deux fichiers, avec leurs fichiers et
+//    leurs nombres d'occurrences inchangés, et doit occuper moins de mémoire
+//    qu'auparavant. Le nombre de mots peut être fourni en argument.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "holdall.h"
+#include "shword.h"
+#include "strhash.h"
+#include "wordtable.h"
+
+//  WORD_CNT : nombre de mots par défaut.
+#define WORD_CNT 100000
+
+//  INPUT_CNT : nombre de fichiers. Le mot d'indice k est présent dans les
+//    fichiers dont le rang est celui d'un bit à un de k % (1 << INPUT_CNT).
+#define INPUT_CNT 3
+
+//  MIN_FILES : nombre minimal de fichiers des mots conservés.
+#define MIN_FILES 2
+
+//  failures : nombre d'échecs constatés.
+static size_t failures;
+
+//  fail : signale l'échec what pour le mot d'indice k.
+static void fail(size_t k, const char *what) {
+  if (failures < 10) {
+    fprintf(stderr, "wordtabletest: word %zu: %s.\n", k, what);
+  }
+  ++failures;
+}
+
+//  files : renvoie le nombre de fichiers dans lesquels est présent le mot
+//    d'indice k.
+static size_t files(size_t k) {
+  size_t n = 0;
+  for (size_t i = 0; i < INPUT_CNT; ++i) {
+    n += (k >> i) & 1;
+  }
+  return n;
+}
+
+//  occurrences : renvoie le nombre d'occurrences du mot d'indice k dans
+//    chacun des fichiers où il est présent.
+static SHW_OCCURRENCES_TYPE occurrences(size_t k) {
+  return k % 5 + 1;
+}
+
+//  fill : insère les n mots "w<k>" dans la table associée à wt. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+static int fill(wordtable *wt, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    char w[32];
+    int len = snprintf(w, sizeof w, "w%zu", k);
+    shword *shw = k % 2 == 0 ? wordtable_insert(wt, w)
+        : wordtable_insert_hashed(wt, w, (size_t) len, strhash(w));
+    if (shw == NULL) {
+      return -1;
+    }
+    for (size_t i = 0; i < INPUT_CNT; ++i) {
+      if (((k >> i) & 1) != 0 && shword_add(shw, i, occurrences(k)) != 0) {
+        return -1;
+      }
+    }
+    if (wordtable_insert(wt, w) != shw) {
+      fail(k, "inserted twice");
+    }
+  }
+  return 0;
+}
+
+//  check : vérifie que les mots partagés de la table associée à wt, compactée
+//    à partir des n mots "w<k>", sont ceux attendus. Le tableau seen, de n
+//    éléments, est utilisé pour repérer les mots rencontrés.
+static void check(wordtable *wt, size_t n, bool *seen) {
+  holdall *ha = wordtable_words(wt);
+  size_t expected = 0;
+  for (size_t k = 0; k < n; ++k) {
+    seen[k] = false;
+    expected += files(k) >= MIN_FILES;
+  }
+  if (holdall_count(ha) != expected) {
+    fail(n, "wrong word count");
+  }
+  for (size_t j = 0; j < holdall_count(ha); ++j) {
+    const shword *shw = holdall_at(ha, j);
+    const char *w = shword_word(shw);
+    char *end;
+    size_t k = strtoul(w + 1, &end, 10);
+    if (w[0] != 'w' || *end != '\0' || k >= n || seen[k]) {
+      fail(k, "unexpected word");
+      continue;
+    }
+    seen[k] = true;
+    if (files(k) < MIN_FILES) {
+      fail(k, "word kept");
+    }
+    if (shword_filecount(shw) != files(k)
+        || shword_occurrences(shw) != files(k) * occurrences(k)) {
+      fail(k, "wrong counts");
+    }
+    for (size_t i = 0; i < INPUT_CNT; ++i) {
+      if (shword_occursin(shw, i) != (((k >> i) & 1) != 0)) {
+        fail(k, "wrong files");
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t n = WORD_CNT;
+  if (argc > 1) {
+    n = strtoul(argv[1], NULL, 10);
+  }
+  if (n == 0) {
+    fprintf(stderr, "Usage: %s [WORDS]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  strhash_setup();
+  if (shword_setup(INPUT_CNT) != 0) {
+    return EXIT_FAILURE;
+  }
+  wordtable *wt = wordtable_empty();
+  bool *seen = malloc(n * sizeof *seen);
+  int r = EXIT_FAILURE;
+  if (wt == NULL || seen == NULL || fill(wt, n) != 0) {
+    fprintf(stderr, "wordtabletest: Not enough memory.\n");
+    goto dispose;
+  }
+  size_t before = wordtable_footprint(wt);
+  if (wordtable_compact(wt, MIN_FILES) != 0) {
+    fprintf(stderr, "wordtabletest: Not enough memory.\n");
+    goto dispose;
+  }
+  check(wt, n, seen);
+  size_t after = wordtable_footprint(wt);
+  if (after >= before) {
+    fail(n, "footprint not reduced");
+  }
+  printf("wordtabletest: %zu words, %zu kept, %zu -> %zu bytes: %s\n", n,
+      holdall_count(wordtable_words(wt)), before, after,
+      failures == 0 ? "ok" : "FAILED");
+  if (failures == 0) {
+    r = EXIT_SUCCESS;
+  }
+  dispose:
+  wordtable_dispose(&wt);
+  free(seen);
+  return r;
+}
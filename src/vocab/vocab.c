@@ -0,0 +1,416 @@
+//  Implantation du module vocab - les vocabulaires sont indexés par une table
+//    de hachage dont les clés sont formées des drapeaux de lecture, du nombre
+//    de caractères significatifs et du chemin absolu de la source. La table est
+//    protégée par un verrou, que la lecture d'une source ne retient pas : deux
+//    fils d'exécution peuvent lire simultanément la même source, le premier
+//    vocabulaire enregistré étant alors seul conservé. La longueur et la somme
+//    de hachage de chaque mot, fournies par reader_next à la lecture de la
+//    source, sont mémorisées par la table du vocabulaire : les requêtes
+//    ajoutent les mots à leur table sans les hacher de nouveau.
+
+#define _XOPEN_SOURCE 700
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "arena.h"
+#include "hashtable.h"
+#include "reader.h"
+#include "shword.h"
+#include "strhash.h"
+#include "vocab.h"
+#include "wordtable.h"
+
+//  VOCAB__TRUNCMIN : capacité initiale du tableau des mots tronqués d'un
+//    vocabulaire.
+#define VOCAB__TRUNCMIN 16
+
+//  struct vocab__id : identité d'une source au moment de sa lecture.
+struct vocab__id {
+  off_t size;
+  time_t mtime;
+  long mtimensec;
+  ino_t ino;
+  dev_t dev;
+};
+
+//  struct vocab_file : le composant key est la clé du vocabulaire, id
+//    l'identité de la source lue, wt la table de ses mots partagés, privée de
+//    son index une fois la source lue. Le composant truncs pointe sur un
+//    tableau de truncsize chaines dont les trunccnt premières sont ses mots
+//    tronqués, dans l'ordre de lecture, alloués dans la réserve truncwords. Le
+//    composant users est le nombre d'utilisateurs du vocabulaire, stored
+//    indique s'il est conservé par la mémoire : il est libéré dès qu'il n'a
+//    plus d'utilisateur s'il ne l'est pas. Les vocabulaires conservés sont
+//    doublement chainés par leurs composants prev et next.
+struct vocab_file {
+  char *key;
+  struct vocab__id id;
+  wordtable *wt;
+  char **truncs;
+  size_t trunccnt;
+  size_t truncsize;
+  arena *truncwords;
+  size_t users;
+  bool stored;
+  vocab_file *prev;
+  vocab_file *next;
+};
+
+//  struct vocab, vocab : le composant ht est la table de hachage qui associe
+//    à sa clé chaque vocabulaire conservé, first le premier de leur liste ;
+//    lock protège ces deux composants ainsi que les composants users, stored,
+//    prev et next de chaque vocabulaire.
+struct vocab {
+  hashtable *ht;
+  vocab_file *first;
+  pthread_mutex_t lock;
+};
+
+//  vocab__same : teste si les identités associées à id1 et id2 coïncident.
+static bool vocab__same(const struct vocab__id *id1,
+    const struct vocab__id *id2) {
+  return id1->size == id2->size && id1->mtime == id2->mtime
+      && id1->mtimensec == id2->mtimensec && id1->ino == id2->ino
+      && id1->dev == id2->dev;
+}
+
+//  vocab__free : libère les ressources allouées au vocabulaire associé à vf.
+static void vocab__free(vocab_file *vf) {
+  free(vf->key);
+  wordtable_dispose(&vf->wt);
+  free(vf->truncs);
+  arena_dispose(&vf->truncwords);
+  free(vf);
+}
+
+//  vocab__unstore : retire de la mémoire associée à v le vocabulaire conservé
+//    associé à vf, qui est libéré s'il n'a plus d'utilisateur.
+static void vocab__unstore(vocab *v, vocab_file *vf) {
+  hashtable_remove(v->ht, vf->key);
+  if (vf->prev != NULL) {
+    vf->prev->next = vf->next;
+  } else {
+    v->first = vf->next;
+  }
+  if (vf->next != NULL) {
+    vf->next->prev = vf->prev;
+  }
+  vf->stored = false;
+  if (vf->users == 0) {
+    vocab__free(vf);
+  }
+}
+
+//  vocab__trunc : mémorise dans le vocabulaire associé à vf que le mot de
+//    chaine w a été tronqué. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int vocab__trunc(vocab_file *vf, const char *w) {
+  if (vf->trunccnt == vf->truncsize) {
+    if (vf->truncsize > SIZE_MAX / 2 / sizeof *vf->truncs) {
+      return -1;
+    }
+    size_t n = vf->truncsize == 0 ? VOCAB__TRUNCMIN : vf->truncsize * 2;
+    char **a = realloc(vf->truncs, n * sizeof *a);
+    if (a == NULL) {
+      return -1;
+    }
+    vf->truncs = a;
+    vf->truncsize = n;
+  }
+  size_t len = strlen(w);
+  char *s = arena_alloc(vf->truncwords, len + 1, 1);
+  if (s == NULL) {
+    return -1;
+  }
+  memcpy(s, w, len + 1);
+  vf->truncs[vf->trunccnt] = s;
+  ++vf->trunccnt;
+  return 0;
+}
+
+//  vocab__read : lit mot à mot la source associée au flot contrôlé par f dans
+//    le vocabulaire associé à vf, avec charcnt caractères significatifs et les
+//    drapeaux mode. Renvoie ENOMEM en cas de dépassement de capacité, le code
+//    d'erreur au sens de errno si la source n'a pu être lue. Renvoie sinon
+//    zéro.
+static int vocab__read(vocab_file *vf, FILE *f, size_t charcnt, int mode) {
+  size_t bufsize = (mode & READER_UTF8) == 0 ? charcnt + 1
+      : charcnt > (SIZE_MAX - 1) / READER_MAXSEQ ? SIZE_MAX
+      : charcnt * READER_MAXSEQ + 1;
+  char *buf = malloc(bufsize);
+  reader *rd = reader_open(f, mode);
+  int e = ENOMEM;
+  if (buf == NULL || rd == NULL) {
+    goto dispose;
+  }
+  size_t rcount;
+  size_t wlen;
+  size_t h;
+  while ((rcount = reader_next(rd, buf, charcnt, &wlen, &h)) > 0) {
+    if (rcount == charcnt + 1 && vocab__trunc(vf, buf) != 0) {
+      goto dispose;
+    }
+    shword *shw = wordtable_insert_hashed(vf->wt, buf, wlen, h);
+    if (shw == NULL) {
+      goto dispose;
+    }
+    shword_increment(shw, 0);
+  }
+  e = reader_error(rd);
+  //  L'index des chaines n'est plus utile : seuls les mots sont conservés.
+  wordtable_drop_index(vf->wt);
+  dispose:
+  reader_dispose(&rd);
+  free(buf);
+  return e;
+}
+
+//  vocab__load : crée le vocabulaire de clé key de la source ouverte sur le
+//    flot contrôlé par f, d'identité id, et le lit. Renvoie ENOMEM en cas de
+//    dépassement de capacité, le code d'erreur au sens de errno si la source
+//    n'a pu être lue. Renvoie sinon zéro après avoir affecté à *vfptr un
+//    pointeur vers le vocabulaire, doté d'un utilisateur.
+static int vocab__load(vocab_file **vfptr, char *key, FILE *f,
+    const struct vocab__id *id, size_t charcnt, int mode) {
+  vocab_file *vf = malloc(sizeof *vf);
+  if (vf == NULL) {
+    free(key);
+    return ENOMEM;
+  }
+  vf->key = key;
+  vf->id = *id;
+  vf->wt = wordtable_empty();
+  vf->truncs = NULL;
+  vf->trunccnt = 0;
+  vf->truncsize = 0;
+  vf->truncwords = arena_empty();
+  vf->users = 1;
+  vf->stored = false;
+  vf->prev = NULL;
+  vf->next = NULL;
+  int e = ENOMEM;
+  if (vf->wt == NULL || vf->truncwords == NULL
+      || (e = vocab__read(vf, f, charcnt, mode)) != 0) {
+    vocab__free(vf);
+    return e;
+  }
+  *vfptr = vf;
+  return 0;
+}
+
+vocab *vocab_empty(void) {
+  vocab *v = malloc(sizeof *v);
+  if (v == NULL) {
+    return NULL;
+  }
+  if (pthread_mutex_init(&v->lock, NULL) != 0) {
+    free(v);
+    return NULL;
+  }
+  v->first = NULL;
+  v->ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))strhash);
+  if (v->ht == NULL) {
+    vocab_dispose(&v);
+    return NULL;
+  }
+  return v;
+}
+
+int vocab_get(vocab *v, vocab_file **vfptr, const char *path,
+    size_t charcnt, int mode) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return errno;
+  }
+  int e;
+  struct stat st;
+  char *abspath = NULL;
+  char *key = NULL;
+  if (fstat(fileno(f), &st) != 0 || (abspath = realpath(path, NULL)) == NULL) {
+    e = errno;
+    goto close;
+  }
+  struct vocab__id id = {
+    .size = st.st_size,
+    .mtime = st.st_mtim.tv_sec,
+    .mtimensec = st.st_mtim.tv_nsec,
+    .ino = st.st_ino,
+    .dev = st.st_dev,
+  };
+  e = ENOMEM;
+  int n = snprintf(NULL, 0, "%d:%zu:%s", mode, charcnt, abspath);
+  if (n < 0 || (key = malloc((size_t) n + 1)) == NULL) {
+    goto close;
+  }
+  snprintf(key, (size_t) n + 1, "%d:%zu:%s", mode, charcnt, abspath);
+  bool regular = S_ISREG(st.st_mode);
+  if (regular) {
+    pthread_mutex_lock(&v->lock);
+    vocab_file *vf = (vocab_file *) hashtable_search(v->ht, key);
+    if (vf != NULL && vocab__same(&vf->id, &id)) {
+      vf->users += 1;
+      *vfptr = vf;
+      e = 0;
+    }
+    pthread_mutex_unlock(&v->lock);
+    if (e == 0) {
+      goto close;
+    }
+  }
+  vocab_file *vf;
+  e = vocab__load(&vf, key, f, &id, charcnt, mode);
+  key = NULL;
+  if (e != 0) {
+    goto close;
+  }
+  *vfptr = vf;
+  if (!regular) {
+    goto close;
+  }
+  //  Le vocabulaire conservé entretemps par un autre fil d'exécution pour la
+  //    même source est préféré ; celui d'une source modifiée depuis est
+  //    remplacé, et libéré dès qu'il n'a plus d'utilisateur.
+  pthread_mutex_lock(&v->lock);
+  vocab_file *old = (vocab_file *) hashtable_search(v->ht, vf->key);
+  if (old != NULL && vocab__same(&old->id, &id)) {
+    old->users += 1;
+    *vfptr = old;
+    pthread_mutex_unlock(&v->lock);
+    vocab__free(vf);
+    goto close;
+  }
+  if (old != NULL) {
+    vocab__unstore(v, old);
+  }
+  //  Faute de place dans la table, le vocabulaire déjà lu est rendu sans être
+  //    conservé.
+  if (hashtable_add(v->ht, vf->key, vf) != NULL) {
+    vf->stored = true;
+    vf->next = v->first;
+    if (v->first != NULL) {
+      v->first->prev = vf;
+    }
+    v->first = vf;
+  }
+  pthread_mutex_unlock(&v->lock);
+  close:
+  free(key);
+  free(abspath);
+  fclose(f);
+  return e;
+}
+
+//  vocab__path : renvoie le chemin de la source de nom name relativement au
+//    répertoire de chemin absolu dir, alloué. Renvoie NULL en cas de
+//    dépassement de capacité.
+static char *vocab__path(const char *dir, const char *name) {
+  size_t dlen = *name == '/' ? 0 : strlen(dir) + 1;
+  size_t nlen = strlen(name);
+  char *path = malloc(dlen + nlen + 1);
+  if (path == NULL) {
+    return NULL;
+  }
+  if (dlen > 0) {
+    memcpy(path, dir, dlen - 1);
+    path[dlen - 1] = '/';
+  }
+  memcpy(path + dlen, name, nlen + 1);
+  return path;
+}
+
+//  struct vocab__gathering : table wt à laquelle sont ajoutés les mots
+//    partagés d'un vocabulaire, marqués dans le fichier d'indice k.
+struct vocab__gathering {
+  wordtable *wt;
+  size_t k;
+};
+
+//  vocab__add : ajoute à la table de g le mot partagé associé à src, de
+//    longueur len et de somme de hachage h, avec son nombre d'occurrences.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité. Renvoie
+//    sinon zéro.
+static int vocab__add(struct vocab__gathering *g, const shword *src,
+    size_t len, size_t h) {
+  shword *shw = wordtable_insert_hashed(g->wt, shword_word(src), len, h);
+  if (shw == NULL) {
+    return -1;
+  }
+  shword_add(shw, g->k, shword_occurrences(src));
+  return 0;
+}
+
+int vocab_gather(vocab *v, wordtable *wt, vocab_file **vfs, const char *dir,
+    const char * const *names, size_t n, size_t charcnt, int mode,
+    size_t *failedptr) {
+  //  Les vocabulaires sont tous obtenus avant d'être agrégés, dans l'ordre des
+  //    sources : la table est dimensionnée pour le plus grand d'entre eux.
+  size_t most = 0;
+  for (size_t k = 0; k < n; ++k) {
+    char *path = vocab__path(dir, names[k]);
+    if (path == NULL) {
+      return ENOMEM;
+    }
+    int e = vocab_get(v, &vfs[k], path, charcnt, mode);
+    free(path);
+    if (e != 0) {
+      *failedptr = k;
+      return e;
+    }
+    size_t cnt = holdall_count(wordtable_words(vfs[k]->wt));
+    most = cnt > most ? cnt : most;
+  }
+  (void) wordtable_reserve(wt, most);
+  for (size_t k = 0; k < n; ++k) {
+    struct vocab__gathering g = {
+      .wt = wt,
+      .k = k,
+    };
+    if (wordtable_apply_hashed(vfs[k]->wt, &g,
+        (int (*)(void *, shword *, size_t, size_t))vocab__add) != 0) {
+      return ENOMEM;
+    }
+  }
+  return 0;
+}
+
+holdall *vocab_file_words(const vocab_file *vf) {
+  return wordtable_words(vf->wt);
+}
+
+const char *vocab_file_trunc(const vocab_file *vf, size_t k) {
+  return k < vf->trunccnt ? vf->truncs[k] : NULL;
+}
+
+void vocab_release(vocab *v, vocab_file **vfptr) {
+  vocab_file *vf = *vfptr;
+  pthread_mutex_lock(&v->lock);
+  vf->users -= 1;
+  bool last = vf->users == 0 && !vf->stored;
+  pthread_mutex_unlock(&v->lock);
+  if (last) {
+    vocab__free(vf);
+  }
+  *vfptr = NULL;
+}
+
+void vocab_dispose(vocab **vptr) {
+  if (*vptr == NULL) {
+    return;
+  }
+  vocab *v = *vptr;
+  while (v->first != NULL) {
+    vocab_file *vf = v->first;
+    v->first = vf->next;
+    vocab__free(vf);
+  }
+  hashtable_dispose(&v->ht);
+  pthread_mutex_destroy(&v->lock);
+  free(v);
+  *vptr = NULL;
+}
@@ -0,0 +1,94 @@
+//  Interface du module vocab - module implémentant une mémoire partagée des
+//    vocabulaires des sources de fichiers : pour chaque source et chaque
+//    manière de la lire, ses mots distincts, leurs nombres d'occurrences et
+//    ses mots tronqués. Un vocabulaire est lu à la première demande puis
+//    conservé tant que la source n'est pas modifiée.
+
+#ifndef VOCAB__H
+#define VOCAB__H
+
+#include <stdlib.h>
+#include "holdall.h"
+#include "wordtable.h"
+
+//  Un vocabulaire est identifié par le chemin absolu de la source, le nombre
+//    de caractères significatifs et les drapeaux de lecture. Il mémorise de
+//    plus la taille, la date de modification, le numéro d'inode et le
+//    périphérique de la source : il n'est réutilisé que si tous coïncident avec
+//    ceux de la source au moment de la demande, et est sinon relu. Seuls les
+//    vocabulaires des fichiers réguliers sont conservés.
+
+//  struct vocab, vocab : structure regroupant les vocabulaires conservés. La
+//    création de la structure de données associée est confiée à la fonction
+//    vocab_empty.
+typedef struct vocab vocab;
+
+//  struct vocab_file, vocab_file : structure regroupant le vocabulaire d'une
+//    source, obtenu par vocab_get et rendu par vocab_release. Un vocabulaire
+//    n'est jamais modifié une fois obtenu : il reste valide jusqu'à ce qu'il
+//    soit rendu, même si la source est modifiée entretemps.
+typedef struct vocab_file vocab_file;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type vocab * n'est pas l'adresse d'un objet préalablement renvoyé par
+//    vocab_empty et non révoqué depuis par vocab_dispose, ou si leur paramètre
+//    de type vocab_file * n'est pas l'adresse d'un objet obtenu par vocab_get
+//    et non rendu depuis. Cette règle ne souffre que d'une seule exception :
+//    vocab_dispose tolère que la déréférence de son argument ait pour valeur
+//    NULL. Les fonctions vocab_get et vocab_release peuvent être appelées
+//    simultanément par plusieurs fils d'exécution.
+
+//  vocab_empty : crée une structure de données correspondant initialement à
+//    une mémoire vide. Renvoie NULL en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers l'objet qui gère la structure de données.
+extern vocab *vocab_empty(void);
+
+//  vocab_get : recherche dans la mémoire associée à v le vocabulaire de la
+//    source de nom path pour une lecture avec charcnt caractères significatifs
+//    et les drapeaux mode au sens de reader_open, et le lit si la mémoire n'en
+//    a pas de valide. Renvoie ENOMEM en cas de dépassement de capacité, un
+//    autre code d'erreur au sens de errno si la source n'a pu être ouverte ou
+//    lue. Renvoie sinon zéro après avoir affecté à *vfptr un pointeur vers le
+//    vocabulaire.
+extern int vocab_get(vocab *v, vocab_file **vfptr, const char *path,
+    size_t charcnt, int mode);
+
+//  vocab_gather : obtient par vocab_get de la mémoire associée à v, dans
+//    l'ordre, les vocabulaires des n sources dont les noms sont pointés par
+//    names, relatifs au répertoire de chemin absolu dir s'ils ne sont pas
+//    absolus, pour une lecture avec charcnt caractères significatifs et les
+//    drapeaux mode, et les affecte à vfs[0], ..., vfs[n - 1], qui doivent
+//    valoir initialement NULL. Ajoute ensuite à la table associée à wt les
+//    mots partagés de chacun, ceux du vocabulaire vfs[k] étant marqués dans le
+//    fichier d'indice k avec leur nombre d'occurrences. Renvoie ENOMEM en cas
+//    de dépassement de capacité. Renvoie un autre code d'erreur au sens de
+//    errno si une source n'a pu être ouverte ou lue, son indice étant affecté
+//    à *failedptr. Renvoie sinon zéro. Dans tous les cas, les vocabulaires
+//    obtenus doivent être rendus par vocab_release.
+extern int vocab_gather(vocab *v, wordtable *wt, vocab_file **vfs,
+    const char *dir, const char * const *names, size_t n, size_t charcnt,
+    int mode, size_t *failedptr);
+
+//  vocab_file_words : renvoie le fourretout des mots partagés du vocabulaire
+//    associé à vf. Leur motif d'occurrences ne comprend que le fichier
+//    d'indice 0, leur nombre d'occurrences est celui de la source. Le
+//    fourretout reste la propriété du vocabulaire : il ne doit être ni
+//    modifié ni révoqué.
+extern holdall *vocab_file_words(const vocab_file *vf);
+
+//  vocab_file_trunc : renvoie la chaine, limitée aux caractères significatifs,
+//    du mot tronqué d'indice k, dans l'ordre de lecture de la source, du
+//    vocabulaire associé à vf. Renvoie NULL si k est au moins égal au nombre
+//    de mots tronqués.
+extern const char *vocab_file_trunc(const vocab_file *vf, size_t k);
+
+//  vocab_release : rend à la mémoire associée à v le vocabulaire associé à
+//    *vfptr, qui a dû être obtenu d'elle, puis affecte à *vfptr la valeur NULL.
+extern void vocab_release(vocab *v, vocab_file **vfptr);
+
+//  vocab_dispose : si *vptr ne vaut pas NULL, libère les ressources allouées à
+//    la structure de données associée à *vptr puis affecte à *vptr la valeur
+//    NULL. Tous les vocabulaires doivent avoir été rendus.
+extern void vocab_dispose(vocab **vptr);
+
+#endif
@@ -0,0 +1,254 @@
+//  Implantation du module wordtable - les mots partagés sont mémorisés dans un
+//    fourretout et indexés par une table de hachage dont les clés sont leurs
+//    chaines. La longueur et la somme de hachage de la chaine de chaque mot
+//    sont conservées à sa création, dans l'ordre des ajouts au fourretout :
+//    la fusion d'une table dans une autre n'a ainsi pas à les recalculer.
+
+#include <string.h>
+#include "hashtable.h"
+#include "strhash.h"
+#include "wordtable.h"
+
+//  WORDTABLE__KEYMIN : capacité initiale du tableau des longueurs et sommes
+//    de hachage des mots partagés. La capacité est ensuite doublée à chaque
+//    fois que le tableau est plein.
+#define WORDTABLE__KEYMIN 64
+
+//  struct wordtable__key : longueur len et somme de hachage hash au sens de
+//    strhash de la chaine d'un mot partagé.
+struct wordtable__key {
+  size_t len;
+  size_t hash;
+};
+
+//  struct wordtable, wordtable : le composant ht est la table de hachage qui
+//    associe à la chaine d'un mot partagé ce mot, ha le fourretout qui les
+//    mémorise tous et words la réserve dans laquelle ils sont alloués. Le
+//    composant keys pointe sur un tableau de keysize éléments dont les
+//    holdall_count(ha) premiers sont les longueurs et sommes de hachage des
+//    mots partagés, dans l'ordre de leurs ajouts au fourretout.
+struct wordtable {
+  hashtable *ht;
+  holdall *ha;
+  arena *words;
+  struct wordtable__key *keys;
+  size_t keysize;
+};
+
+wordtable *wordtable_empty(void) {
+  wordtable *wt = malloc(sizeof *wt);
+  if (wt == NULL) {
+    return NULL;
+  }
+  wt->ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      (size_t (*)(const void *))strhash);
+  wt->ha = holdall_empty();
+  wt->words = arena_empty();
+  wt->keys = NULL;
+  wt->keysize = 0;
+  if (wt->ht == NULL || wt->ha == NULL || wt->words == NULL) {
+    wordtable_dispose(&wt);
+    return NULL;
+  }
+  return wt;
+}
+
+int wordtable_reserve(wordtable *wt, size_t n) {
+  return hashtable_reserve(wt->ht, n);
+}
+
+shword *wordtable_insert(wordtable *wt, const char *w) {
+  size_t len = strlen(w);
+  return wordtable_insert_hashed(wt, w, len, strhash_mem(w, len));
+}
+
+shword *wordtable_insert_hashed(wordtable *wt, const char *w, size_t len,
+    size_t h) {
+  shword *shw = (shword *) hashtable_search_hashed(wt->ht, w, h);
+  if (shw != NULL) {
+    return shw;
+  }
+  size_t n = holdall_count(wt->ha);
+  if (n == wt->keysize) {
+    size_t m = n == 0 ? WORDTABLE__KEYMIN : 2 * n;
+    struct wordtable__key *a;
+    if (m > SIZE_MAX / 2 / sizeof *a
+        || (a = realloc(wt->keys, m * sizeof *a)) == NULL) {
+      return NULL;
+    }
+    wt->keys = a;
+    wt->keysize = m;
+  }
+  shw = shword_create(wt->words, w, len);
+  if (shw == NULL || holdall_put(wt->ha, shw) != 0) {
+    return NULL;
+  }
+  wt->keys[n] = (struct wordtable__key) {
+    .len = len,
+    .hash = h,
+  };
+  if (hashtable_add_hashed(wt->ht, shword_word(shw), h, shw) == NULL) {
+    return NULL;
+  }
+  return shw;
+}
+
+//  wordtable__counterpart : renvoie le mot partagé de la table associée à dest
+//    de même chaine que celui associé à shw, en le créant au besoin. Renvoie
+//    NULL en cas de dépassement de capacité.
+static shword *wordtable__counterpart(wordtable *dest, const shword *shw) {
+  return wordtable_insert(dest, shword_word(shw));
+}
+
+//  wordtable__merge_into : fusionne le mot partagé associé à shw dans celui
+//    associé à d. Renvoie une valeur non nulle si d vaut NULL. Renvoie sinon
+//    zéro.
+static int wordtable__merge_into(const shword *shw, shword *d) {
+  if (d == NULL) {
+    return -1;
+  }
+  //  Inutile de vérifier la valeur de retour : si le nb. d'occ. a été atteint,
+  //    le compteur est simplement saturé.
+  shword_merge(d, shw);
+  return 0;
+}
+
+int wordtable_apply_hashed(wordtable *wt, void *context,
+    int (*fun)(void *context, shword *shw, size_t len, size_t h)) {
+  for (size_t k = 0; k < holdall_count(wt->ha); ++k) {
+    int r = fun(context, holdall_at_added(wt->ha, k), wt->keys[k].len,
+        wt->keys[k].hash);
+    if (r != 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
+//  wordtable__merge_hashed : fusionne le mot partagé associé à shw, dont la
+//    chaine est de longueur len et de somme de hachage h, dans son homologue
+//    de la table associée à dest, en le créant au besoin. Renvoie une valeur
+//    non nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+static int wordtable__merge_hashed(wordtable *dest, const shword *shw,
+    size_t len, size_t h) {
+  return wordtable__merge_into(shw,
+      wordtable_insert_hashed(dest, shword_word(shw), len, h));
+}
+
+int wordtable_merge(wordtable *dest, wordtable *src) {
+  return wordtable_apply_hashed(src, dest,
+      (int (*)(void *, shword *, size_t, size_t))wordtable__merge_hashed);
+}
+
+int wordtable_merge_words(wordtable *dest, holdall *ha) {
+  return holdall_apply_context(ha, dest,
+      (void *(*)(void *, void *))wordtable__counterpart,
+      (int (*)(void *, void *))wordtable__merge_into);
+}
+
+int wordtable_import(wordtable *wt, const shword *img, size_t inputcnt) {
+  shword *d = wordtable_insert(wt, shword_image_word(img, inputcnt));
+  if (d == NULL) {
+    return -1;
+  }
+  //  Inutile de vérifier la valeur de retour : le compteur est saturé.
+  shword_merge_image(d, img, inputcnt);
+  return 0;
+}
+
+//  wordtable__keep : ajoute au fourretout associé à ha et à la réserve associée
+//    à words une copie du mot partagé associé à shw, de longueur len, et
+//    affecte sa longueur et sa somme de hachage h à *kptr. Renvoie une valeur
+//    non nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+static int wordtable__keep(holdall *ha, arena *words,
+    struct wordtable__key *kptr, const shword *shw, size_t len, size_t h) {
+  shword *d = shword_create(words, shword_word(shw), len);
+  if (d == NULL || holdall_put(ha, d) != 0) {
+    return -1;
+  }
+  //  Inutile de vérifier la valeur de retour : d est vierge.
+  shword_merge(d, shw);
+  *kptr = (struct wordtable__key) {
+    .len = len,
+    .hash = h,
+  };
+  return 0;
+}
+
+int wordtable_compact(wordtable *wt, size_t minfiles) {
+  size_t n = holdall_count(wt->ha);
+  size_t kept = 0;
+  for (size_t k = 0; k < n; ++k) {
+    kept += shword_filecount(holdall_at_added(wt->ha, k)) >= minfiles;
+  }
+  holdall *ha = holdall_empty();
+  arena *words = arena_empty();
+  struct wordtable__key *keys = malloc(kept * sizeof *keys);
+  if (ha == NULL || words == NULL || (keys == NULL && kept > 0)) {
+    goto error;
+  }
+  for (size_t k = 0, j = 0; k < n; ++k) {
+    const shword *shw = holdall_at_added(wt->ha, k);
+    if (shword_filecount(shw) >= minfiles
+        && wordtable__keep(ha, words, &keys[j++], shw, wt->keys[k].len,
+          wt->keys[k].hash) != 0) {
+      goto error;
+    }
+  }
+  //  L'index n'est révoqué qu'une fois la copie achevée : en cas d'échec, la
+  //    table reste entière.
+  hashtable_dispose(&wt->ht);
+  holdall_dispose(&wt->ha);
+  arena_dispose(&wt->words);
+  free(wt->keys);
+  wt->ha = ha;
+  wt->words = words;
+  wt->keys = keys;
+  wt->keysize = kept;
+  return 0;
+  error:
+  holdall_dispose(&ha);
+  arena_dispose(&words);
+  free(keys);
+  return -1;
+}
+
+void wordtable_drop_index(wordtable *wt) {
+  hashtable_dispose(&wt->ht);
+}
+
+int wordtable_clear(wordtable *wt) {
+  wordtable *e = wordtable_empty();
+  if (e == NULL) {
+    return -1;
+  }
+  wordtable t = *wt;
+  *wt = *e;
+  *e = t;
+  wordtable_dispose(&e);
+  return 0;
+}
+
+size_t wordtable_footprint(const wordtable *wt) {
+  //  La table de hachage est révoquée par wordtable_compact et
+  //    wordtable_drop_index.
+  return sizeof *wt + (wt->ht == NULL ? 0 : hashtable_footprint(wt->ht))
+      + holdall_footprint(wt->ha) + arena_footprint(wt->words)
+      + wt->keysize * sizeof *wt->keys;
+}
+
+holdall *wordtable_words(wordtable *wt) {
+  return wt->ha;
+}
+
+void wordtable_dispose(wordtable **wtptr) {
+  if (*wtptr == NULL) {
+    return;
+  }
+  hashtable_dispose(&(*wtptr)->ht);
+  holdall_dispose(&(*wtptr)->ha);
+  arena_dispose(&(*wtptr)->words);
+  free((*wtptr)->keys);
+  free(*wtptr);
+  *wtptr = NULL;
+}
@@ -0,0 +1,112 @@
+//  Interface du module wordtable - module regroupant, au sein d'une même
+//    structure, les mots partagés lus dans diverses sources de fichiers ainsi
+//    que l'index permettant de les retrouver à partir de leur chaine.
+
+#ifndef WORDTABLE__H
+#define WORDTABLE__H
+
+#include <stdlib.h>
+#include "holdall.h"
+#include "shword.h"
+
+//  struct wordtable, wordtable : structure associant à des chaines de
+//    caractères des mots partagés. La création de la structure de données
+//    associée est confiée à la fonction wordtable_empty. Les mots partagés
+//    sont créés par la structure elle-même, dans une réserve qui lui est
+//    propre, et détruits avec elle.
+typedef struct wordtable wordtable;
+
+//  Les fonctions qui suivent ont un comportement indéterminé si leur paramètre
+//    de type wordtable * n'est pas l'adresse d'un objet préalablement renvoyé
+//    par wordtable_empty et non révoqué depuis par wordtable_dispose. Cette
+//    règle ne souffre que d'une seule exception : wordtable_dispose tolère que
+//    la déréférence de son argument ait pour valeur NULL.
+
+//  wordtable_empty : crée une structure de données correspondant initialement
+//    à une table de mots vide. Renvoie NULL en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers l'objet qui gère la structure de données.
+extern wordtable *wordtable_empty(void);
+
+//  wordtable_reserve : dimensionne l'index de la table associée à wt pour que
+//    n mots partagés au moins y tiennent sans qu'il ait à être agrandi. Renvoie
+//    une valeur non nulle en cas de dépassement de capacité. Renvoie sinon
+//    zéro.
+extern int wordtable_reserve(wordtable *wt, size_t n);
+
+//  wordtable_insert : recherche dans la table associée à wt le mot partagé
+//    associé à la chaine pointée par w. S'il n'existe pas, il est créé sans
+//    aucune occurrence. Renvoie NULL en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers le mot partagé.
+extern shword *wordtable_insert(wordtable *wt, const char *w);
+
+//  wordtable_insert_hashed : a le même comportement que wordtable_insert, la
+//    longueur de la chaine pointée par w et sa somme de hachage au sens de
+//    strhash étant fournies par len et h au lieu d'être calculées.
+extern shword *wordtable_insert_hashed(wordtable *wt, const char *w,
+    size_t len, size_t h);
+
+//  wordtable_apply_hashed : exécute fun(context, shw, len, h) sur chacun des
+//    mots partagés shw de la table associée à wt, dans l'ordre de leur
+//    création, len et h étant la longueur de sa chaine et sa somme de hachage
+//    au sens de strhash, mémorisées à sa création. Si fun renvoie une valeur
+//    non nulle, l'exécution prend fin et cette valeur est renvoyée. Sinon,
+//    renvoie zéro. Le comportement est indéterminé si le fourretout des mots
+//    partagés de la table a été trié.
+extern int wordtable_apply_hashed(wordtable *wt, void *context,
+    int (*fun)(void *context, shword *shw, size_t len, size_t h));
+
+//  wordtable_merge : ajoute aux mots partagés de la table associée à dest les
+//    motifs d'occurrences et les nombres d'occurrences des mots partagés de la
+//    table associée à src, en créant au besoin ceux qui manquent, sans hacher
+//    de nouveau leurs chaines. La table associée à src n'est pas modifiée et
+//    son fourretout ne doit pas avoir été trié. Renvoie une valeur non nulle
+//    en cas de dépassement de capacité. Renvoie sinon zéro.
+extern int wordtable_merge(wordtable *dest, wordtable *src);
+
+//  wordtable_merge_words : a le même comportement que wordtable_merge, les mots
+//    partagés ajoutés étant ceux du fourretout associé à ha.
+extern int wordtable_merge_words(wordtable *dest, holdall *ha);
+
+//  wordtable_import : ajoute à la table associée à wt le mot partagé dont
+//    l'image, créée alors que inputcnt fichiers étaient pris en charge, est
+//    associée à img, au sens de shword_merge_image. Renvoie une valeur non
+//    nulle en cas de dépassement de capacité. Renvoie sinon zéro.
+extern int wordtable_import(wordtable *wt, const shword *img, size_t inputcnt);
+
+//  wordtable_compact : ne conserve dans la table associée à wt que les mots
+//    partagés présents dans au moins minfiles fichiers. Ceux-ci sont recopiés
+//    dans une nouvelle réserve, l'ancienne étant libérée avec les autres mots,
+//    et l'index des chaines est révoqué : la table n'accepte alors plus aucun
+//    ajout, et seules wordtable_words, wordtable_apply_hashed,
+//    wordtable_footprint et wordtable_dispose peuvent lui être appliquées.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité, la table
+//    restant alors inchangée et son index intact. Renvoie sinon zéro.
+extern int wordtable_compact(wordtable *wt, size_t minfiles);
+
+//  wordtable_drop_index : révoque l'index des chaines de la table associée à
+//    wt, dont les mots partagés restent inchangés : la table n'accepte alors
+//    plus aucun ajout, et seules wordtable_words, wordtable_apply_hashed,
+//    wordtable_footprint et wordtable_dispose peuvent lui être appliquées.
+extern void wordtable_drop_index(wordtable *wt);
+
+//  wordtable_clear : révoque tous les mots partagés de la table associée à wt,
+//    qui redevient vide, et libère la mémoire qu'ils occupaient. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, la table restant alors
+//    inchangée. Renvoie sinon zéro.
+extern int wordtable_clear(wordtable *wt);
+
+//  wordtable_footprint : renvoie le nombre d'octets obtenus du système par la
+//    table associée à wt, mots partagés compris.
+extern size_t wordtable_footprint(const wordtable *wt);
+
+//  wordtable_words : renvoie le fourretout des mots partagés de la table
+//    associée à wt. Le fourretout reste la propriété de la table : il peut être
+//    trié ou parcouru mais ne doit être ni complété ni révoqué.
+extern holdall *wordtable_words(wordtable *wt);
+
+//  wordtable_dispose : si *wtptr ne vaut pas NULL, libère les ressources
+//    allouées à la structure de données associée à *wtptr, mots partagés
+//    compris, puis affecte à *wtptr la valeur NULL.
+extern void wordtable_dispose(wordtable **wtptr);
+
+#endif